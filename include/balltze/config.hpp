@@ -3,6 +3,8 @@
 #ifndef BALLTZE_API__CONFIG_HPP
 #define BALLTZE_API__CONFIG_HPP
 
+#include <cstddef>
+#include <functional>
 #include <string>
 #include <vector>
 #include <utility>
@@ -13,7 +15,13 @@
 #include "api.hpp"
 
 namespace Balltze::Config {
+    template<typename T>
+    class ConfigKey;
+
     class BALLTZE_API Config {
+    template<typename T>
+    friend class ConfigKey;
+
     private:
         /** Path to the config file */
         std::filesystem::path filepath;
@@ -33,6 +41,18 @@ namespace Balltze::Config {
          * @return Vector of keys
          */
         std::vector<std::string> split_key(std::string key);
+
+        /**
+         * Invalidate the key handles and call the change callbacks of a key, its parents and its children
+         * @param key   Dotted key that changed; every callback is called if nullopt
+         */
+        void notify_change(std::optional<std::string> key);
+
+        /**
+         * Get the counter incremented on every change of any config, so key handles know when to
+         * resolve their value again. It is not a member, so the layout of the class stays the same.
+         */
+        static std::size_t const &generation() noexcept;
         
     public:
         /**
@@ -60,11 +80,17 @@ namespace Balltze::Config {
         void load();
 
         /**
-         * Save config file
-         * @throws std::runtime_error if config file cannot be saved
+         * Save config file. The file is written in the background once no more saves
+         * come in for a short while, so several changes in a row cause a single write.
+         * Write errors are logged.
          */
         void save();
 
+        /**
+         * Write the config file now if a save is pending
+         */
+        void flush();
+
         /**
          * Get value from config
          * @param key   Key to get value from
@@ -153,6 +179,7 @@ namespace Balltze::Config {
                 }
             }
             *slice = value;
+            notify_change(key);
         }
 
         /**
@@ -185,6 +212,7 @@ namespace Balltze::Config {
             for(T item : array) {
                 (*slice).push_back(item);
             }
+            notify_change(key);
         }
 
         /**
@@ -226,7 +254,74 @@ namespace Balltze::Config {
                 *slice = nlohmann::json::array();
                 (*slice).push_back(value);
             }
+            notify_change(key);
+        }
+
+        /**
+         * Call a function when a key, one of its parents or one of its children changes, or when the file is loaded again.
+         * Callbacks belong to this object; copies of it do not call them.
+         * @param key       Dotted key to watch
+         * @param callback  Function to call after the change
+         * @return          Identifier of the callback, to remove it
+         */
+        std::size_t add_change_callback(std::string key, std::function<void()> callback);
+
+        /**
+         * Stop calling a change callback
+         * @param id Identifier returned by add_change_callback
+         */
+        void remove_change_callback(std::size_t id) noexcept;
+    };
+
+    /**
+     * Handle to a config key. The key path is parsed once, and the value is kept until
+     * the config changes, so reading it repeatedly does not walk the JSON tree.
+     * The config must outlive the handle.
+     * @tparam T Type of value
+     */
+    template<typename T>
+    class ConfigKey {
+    public:
+        /**
+         * Constructor for ConfigKey class
+         * @param config    Config to read the value from
+         * @param key       Dotted key of the value
+         */
+        ConfigKey(Config &config, std::string const &key) : m_config(&config), m_config_generation(&Config::generation()) {
+            for(auto &key_part : config.split_key(key)) {
+                m_pointer /= key_part;
+            }
         }
+
+        /**
+         * Get value from config
+         * @return Value if key exists and has the right type, std::nullopt otherwise
+         */
+        std::optional<T> const &get() {
+            if(m_generation != *m_config_generation) {
+                m_generation = *m_config_generation;
+                m_value = std::nullopt;
+                auto &config = std::as_const(m_config->config);
+                if(config.contains(m_pointer)) {
+                    auto &value = config[m_pointer];
+                    if(value.is_primitive()) {
+                        try {
+                            m_value = value.template get<T>();
+                        }
+                        catch(...) {
+                        }
+                    }
+                }
+            }
+            return m_value;
+        }
+
+    private:
+        Config *m_config;
+        std::size_t const *m_config_generation;
+        nlohmann::json::json_pointer m_pointer;
+        std::size_t m_generation = static_cast<std::size_t>(-1);
+        std::optional<T> m_value;
     };
 
     /**
@@ -327,7 +422,7 @@ namespace Balltze::Config {
         Ini(Ini &&move) = default;
 
     private:
-        /** Values of the Ini */
+        /** Values of the Ini, sorted by key */
         std::vector<std::pair<std::string, std::string>> p_values;
 
         /**
@@ -942,8 +942,8 @@ namespace Balltze::Engine {
     BALLTZE_API std::uint8_t get_master_volume() noexcept;
 
     /**
-     * Get the duration of a sound permutation
-     * @param sound                 Pointer to sound tag data
+     * Get the duration of a sound permutation.
+     * The duration is worked out from the size and format of the samples and kept until another map is loaded.
      * @param permutation           Pointer to sound permutation 
      * @return                      Duration of the sound permutation in milliseconds
      */
@@ -2,3 +2,6 @@
 
 #include "features/user_interface.hpp"
 #include "features/tags_handling.hpp"
+#include "features/tag_data_prefetch.hpp"
+#include "features/object_spatial_index.hpp"
+#include "features/job_system.hpp"
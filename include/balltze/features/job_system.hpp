@@ -0,0 +1,50 @@
+// SPDX-License-Identifier: GPL-3.0-only
+
+#ifndef BALLTZE_API__FEATURES__JOB_SYSTEM_HPP
+#define BALLTZE_API__FEATURES__JOB_SYSTEM_HPP
+
+#include <cstddef>
+#include <functional>
+#include <optional>
+#include "../api.hpp"
+
+namespace Balltze::Features {
+    using JobHandle = std::size_t;
+
+    enum JobStatus {
+        JOB_STATUS_PENDING,
+        JOB_STATUS_RUNNING,
+        JOB_STATUS_COMPLETED
+    };
+
+    /**
+     * Run a function on the worker pool.
+     * Jobs submitted from the game thread are spread across the workers; jobs submitted from
+     * inside a job go to the queue of the same worker, and idle workers steal from busy ones.
+     * @param work          Function to run on a worker thread; it must not touch the game state
+     * @param on_complete   Function called on the game thread during the first tick after the work is done
+     * @return              Handle of the job
+     */
+    BALLTZE_API JobHandle submit_job(std::function<void()> work, std::function<void()> on_complete = nullptr);
+
+    /**
+     * Cancel a job which has not started yet. Cancelled jobs never call their completion function.
+     * @param handle    Handle of the job
+     * @return          True if the job was cancelled, false if it was already running or finished
+     */
+    BALLTZE_API bool cancel_job(JobHandle handle) noexcept;
+
+    /**
+     * Get the status of a job
+     * @param handle    Handle of the job
+     * @return          Status of the job, or nothing if the job does not exist, was cancelled or its completion function was already called
+     */
+    BALLTZE_API std::optional<JobStatus> get_job_status(JobHandle handle) noexcept;
+
+    /**
+     * Get the number of threads of the worker pool
+     */
+    BALLTZE_API std::size_t get_job_worker_count() noexcept;
+}
+
+#endif
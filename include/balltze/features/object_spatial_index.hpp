@@ -0,0 +1,40 @@
+// SPDX-License-Identifier: GPL-3.0-only
+
+#ifndef BALLTZE_API__FEATURES__OBJECT_SPATIAL_INDEX_HPP
+#define BALLTZE_API__FEATURES__OBJECT_SPATIAL_INDEX_HPP
+
+#include <cstddef>
+#include <limits>
+#include <vector>
+#include "../engine/data_types.hpp"
+#include "../api.hpp"
+
+namespace Balltze::Features {
+    /**
+     * Find the objects which center is within a sphere.
+     * The index is built from the object table at most once per tick, on the first query of the tick.
+     * @param center    Center of the sphere
+     * @param radius    Radius of the sphere
+     * @return          Handles of the objects found, in no particular order
+     */
+    BALLTZE_API std::vector<Engine::ObjectHandle> find_objects_in_radius(Engine::Point3D const &center, float radius);
+
+    /**
+     * Find the objects which center is within an axis-aligned box
+     * @param min   Corner of the box with the lowest coordinates
+     * @param max   Corner of the box with the highest coordinates
+     * @return      Handles of the objects found, in no particular order
+     */
+    BALLTZE_API std::vector<Engine::ObjectHandle> find_objects_in_box(Engine::Point3D const &min, Engine::Point3D const &max);
+
+    /**
+     * Find the objects closest to a point
+     * @param point         Point to measure the distance from
+     * @param count         Maximum number of objects to return
+     * @param max_distance  Objects further than this are ignored
+     * @return              Handles of the objects found, from the closest to the furthest
+     */
+    BALLTZE_API std::vector<Engine::ObjectHandle> find_nearest_objects(Engine::Point3D const &point, std::size_t count, float max_distance = std::numeric_limits<float>::infinity());
+}
+
+#endif
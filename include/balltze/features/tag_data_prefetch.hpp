@@ -0,0 +1,52 @@
+// SPDX-License-Identifier: GPL-3.0-only
+
+#ifndef BALLTZE_API__FEATURES__TAG_DATA_PREFETCH_HPP
+#define BALLTZE_API__FEATURES__TAG_DATA_PREFETCH_HPP
+
+#include <cstddef>
+#include <vector>
+#include "../engine/tag.hpp"
+#include "../api.hpp"
+
+namespace Balltze::Features {
+    struct TagDataPrefetchStats {
+        /** Map data reads served from the prefetch cache */
+        std::size_t hits;
+
+        /** Reads of the loaded map that had to go to disk while the cache was not empty */
+        std::size_t misses;
+
+        /** Total bytes read in the background since the current map was loaded */
+        std::size_t bytes_prefetched;
+
+        /** Bytes currently held by the cache */
+        std::size_t cached_bytes;
+
+        /** Maximum size of the cache */
+        std::size_t cache_size;
+
+        /** Reads waiting for the background worker */
+        std::size_t pending_requests;
+
+        float hit_rate() const noexcept {
+            auto total = hits + misses;
+            return total > 0 ? static_cast<float>(hits) / total : 0.0f;
+        }
+    };
+
+    /**
+     * Schedule a background read of the raw resource data (bitmap pixels and sound samples)
+     * of a set of tags, so the engine loaders can take it from memory when they need it.
+     * Data stored in the shared resource maps and tags of other classes are ignored.
+     * @param tag_handles   Handles of the tags to prefetch
+     * @return              Number of reads scheduled
+     */
+    BALLTZE_API std::size_t prefetch_tag_data(std::vector<Engine::TagHandle> const &tag_handles);
+
+    /**
+     * Get the statistics of the tag data prefetch cache
+     */
+    BALLTZE_API TagDataPrefetchStats get_tag_data_prefetch_stats() noexcept;
+}
+
+#endif
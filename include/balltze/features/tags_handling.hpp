@@ -9,6 +9,20 @@
 #include "../api.hpp"
 
 namespace Balltze::Features { 
+    struct TagDataPatchSummary {
+        /** Number of fields which value was changed */
+        std::size_t fields_patched = 0;
+
+        /** Number of bytes written into the existing tag data */
+        std::size_t bytes_patched = 0;
+
+        /** Number of reflexives reallocated because their element count changed */
+        std::size_t blocks_reallocated = 0;
+
+        /** Number of data blocks reallocated because their size changed */
+        std::size_t data_reallocated = 0;
+    };
+
     /**
      * Indexes a tag from another map to load it at the next map load
      * @param map_name    Name of the map to import the tag from
@@ -32,10 +46,11 @@ namespace Balltze::Features {
     BALLTZE_API void import_tags_from_map(std::filesystem::path map_file);
 
     /**
-     * Reloads the data of a tag
+     * Reloads the data of a tag, patching in place only the fields that changed
      * @param tag_handle    Handle of the tag to reload
+     * @return              Summary of the changes applied to the tag data
      */
-    BALLTZE_API void reload_tag_data(Engine::TagHandle tag_handle);
+    BALLTZE_API TagDataPatchSummary reload_tag_data(Engine::TagHandle tag_handle);
 
     /**
      * Replace all tag references to a tag by references to another tag
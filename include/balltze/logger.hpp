@@ -3,7 +3,9 @@
 #ifndef BALLTZE_API__LOGGER_HPP
 #define BALLTZE_API__LOGGER_HPP
 
+#include <iterator>
 #include <string>
+#include <string_view>
 #include <sstream>
 #include <fstream>
 #include <filesystem>
@@ -48,9 +50,18 @@ namespace Balltze {
             LoggerStream() = default;
 
         public:
+            /**
+             * Check if messages of this level are printed at all; muted levels are not formatted
+             */
+            bool enabled() const noexcept {
+                return !(m_level == LOG_LEVEL_DEBUG && m_logger->m_mute_debug);
+            }
+
             template<typename T>
-            LoggerStream &operator<<(T value) {
-                m_stream << value;
+            LoggerStream &operator<<(T const &value) {
+                if(enabled()) {
+                    m_stream << value;
+                }
                 return *this;
             }
 
@@ -59,16 +70,28 @@ namespace Balltze {
                 return *this;
             }
 
+            /**
+             * Print a message; without arguments, the message is printed as is
+             */
             template<typename ...Args>
-            void operator()(std::string format, Args &&...args) {
-                if constexpr (sizeof...(args) == 0) {
-                    *this << format << endl;
-                } 
+            void operator()(std::string_view format, Args &&...args) {
+                if(!enabled()) {
+                    return;
+                }
+                if constexpr(sizeof...(args) == 0) {
+                    write(format);
+                }
                 else {
-                    std::string output = fmt::format(fmt::runtime(format), args...);
-                    *this << output << endl;
+                    fmt::memory_buffer message;
+                    fmt::format_to(std::back_inserter(message), fmt::runtime(format), args...);
+                    write(std::string_view(message.data(), message.size()));
                 }
             }
+
+        private:
+            inline void write(std::string_view message) {
+                write_impl(get_current_module(), *this, message);
+            }
         };
 
         LoggerStream debug;
@@ -125,9 +148,10 @@ namespace Balltze {
         void set_file_impl(HMODULE module, std::filesystem::path file_path, bool append);
 
         static void endl_impl(HMODULE module, LoggerStream &stream);
-        static void print_console(LoggerStream &stream);
-        static void print_file(LoggerStream &stream);
-        static void print_ingame(LoggerStream &stream);
+        static void write_impl(HMODULE module, LoggerStream &stream, std::string_view message);
+        static void print_console(LoggerStream &stream, std::string_view message);
+        static void print_file(LoggerStream &stream, std::string_view message);
+        static void print_ingame(LoggerStream &stream, std::string_view message);
     };
 }
 
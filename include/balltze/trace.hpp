@@ -0,0 +1,104 @@
+// SPDX-License-Identifier: GPL-3.0-only
+
+#ifndef BALLTZE_API__TRACE_HPP
+#define BALLTZE_API__TRACE_HPP
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+#include "api.hpp"
+
+namespace Balltze::Trace {
+    /**
+     * Types of the fields of a trace event.
+     * Values are stored in the trace file, so they must not change.
+     */
+    enum TraceFieldType : std::uint8_t {
+        TRACE_FIELD_BOOL = 0,
+        TRACE_FIELD_INT8,
+        TRACE_FIELD_UINT8,
+        TRACE_FIELD_INT16,
+        TRACE_FIELD_UINT16,
+        TRACE_FIELD_INT32,
+        TRACE_FIELD_UINT32,
+        TRACE_FIELD_INT64,
+        TRACE_FIELD_UINT64,
+        TRACE_FIELD_FLOAT,
+        TRACE_FIELD_DOUBLE
+    };
+
+    /** Identifier of a registered trace event; 0 means the event could not be registered */
+    using TraceEventId = std::uint16_t;
+
+    /** Maximum number of fields of a trace event */
+    constexpr std::size_t TRACE_EVENT_MAX_FIELDS = 16;
+
+    /**
+     * Register a trace event. The descriptor is written to the trace file, so records only carry the values.
+     * @param name          Name of the event
+     * @param field_names   Names of the fields of the event
+     * @param field_types   Types of the fields of the event
+     * @param field_count   Number of fields
+     * @return              Identifier of the event, or 0 if it could not be registered
+     */
+    BALLTZE_API TraceEventId register_trace_event(const char *name, const char *const *field_names, TraceFieldType const *field_types, std::size_t field_count) noexcept;
+
+    /**
+     * Check if trace records are being written
+     */
+    BALLTZE_API bool trace_enabled() noexcept;
+
+    /**
+     * Append a record to the trace buffer of the calling thread.
+     * Buffers are written to the trace file when they are full, when the thread exits and when tracing is stopped.
+     * @param event     Identifier of the event
+     * @param payload   Values of the fields, packed in the order they were registered
+     * @param size      Size of the payload
+     */
+    BALLTZE_API void write_trace_record(TraceEventId event, void const *payload, std::size_t size) noexcept;
+
+    template<typename T>
+    constexpr TraceFieldType trace_field_type() noexcept {
+        if constexpr(std::is_same_v<T, bool>) return TRACE_FIELD_BOOL;
+        else if constexpr(std::is_same_v<T, float>) return TRACE_FIELD_FLOAT;
+        else if constexpr(std::is_same_v<T, double>) return TRACE_FIELD_DOUBLE;
+        else if constexpr(std::is_integral_v<T> && sizeof(T) == 1) return std::is_signed_v<T> ? TRACE_FIELD_INT8 : TRACE_FIELD_UINT8;
+        else if constexpr(std::is_integral_v<T> && sizeof(T) == 2) return std::is_signed_v<T> ? TRACE_FIELD_INT16 : TRACE_FIELD_UINT16;
+        else if constexpr(std::is_integral_v<T> && sizeof(T) == 4) return std::is_signed_v<T> ? TRACE_FIELD_INT32 : TRACE_FIELD_UINT32;
+        else if constexpr(std::is_integral_v<T> && sizeof(T) == 8) return std::is_signed_v<T> ? TRACE_FIELD_INT64 : TRACE_FIELD_UINT64;
+        else static_assert(sizeof(T) == 0, "Unsupported trace field type");
+    }
+
+    /**
+     * A trace event with a fixed layout. Declare it as a static object so it is only registered once:
+     *
+     *     static Trace::TraceEvent<std::uint32_t, float> tick_trace("tick", {"tick_count", "delta_time"});
+     *     tick_trace(tick_count, delta_time);
+     */
+    template<typename... Fields>
+    class TraceEvent {
+    static_assert(sizeof...(Fields) <= TRACE_EVENT_MAX_FIELDS, "Too many trace event fields");
+    public:
+        TraceEvent(const char *name, std::array<const char *, sizeof...(Fields)> const &field_names) noexcept {
+            static constexpr TraceFieldType field_types[sizeof...(Fields) + 1] = {trace_field_type<Fields>()...};
+            m_id = register_trace_event(name, field_names.data(), field_types, sizeof...(Fields));
+        }
+
+        void operator()(Fields... values) noexcept {
+            if(m_id == 0 || !trace_enabled()) {
+                return;
+            }
+            std::byte payload[(sizeof(Fields) + ... + 0) + 1];
+            std::size_t offset = 0;
+            ((std::memcpy(payload + offset, &values, sizeof(Fields)), offset += sizeof(Fields)), ...);
+            write_trace_record(m_id, payload, offset);
+        }
+
+    private:
+        TraceEventId m_id;
+    };
+}
+
+#endif
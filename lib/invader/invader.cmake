@@ -6,6 +6,7 @@ add_library(invader STATIC
     lib/invader/sound/sound_encoder.cpp
     lib/invader/sound/sound_reader_16_bit_pcm_big_endian.cpp
     lib/invader/sound/sound_reader_ogg.cpp
+    lib/invader/sound/sound_reader_ogg_granule.cpp
     lib/invader/sound/sound_reader_xbox_adpcm.cpp
 )
 
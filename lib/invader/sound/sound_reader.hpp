@@ -5,6 +5,7 @@
 
 #include <cstdint>
 #include <cstddef>
+#include <optional>
 #include <vector>
 #include <string>
 
@@ -62,6 +63,15 @@ namespace Invader::SoundReader {
      */
     double ogg_vorbis_samples_duration(const std::byte *data, std::size_t data_length);
 
+    /**
+     * Get the duration of a single Ogg Vorbis stream from the sample rate in its identification header and the
+     * granule position of its last page, without decoding it. The stream is assumed to start at sample 0.
+     * @param  data        pointer to data
+     * @param  data_length data size
+     * @return             duration in seconds, or nothing if the stream is chained, truncated or not plain Vorbis
+     */
+    std::optional<double> ogg_vorbis_samples_duration_from_granule(const std::byte *data, std::size_t data_length) noexcept;
+
     /**
      * Get the sound from Xbox ADPCM data
      * @param  data          pointer to data
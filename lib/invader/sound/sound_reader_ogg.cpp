@@ -306,6 +306,10 @@ namespace Invader::SoundReader {
     }
 
     double ogg_vorbis_samples_duration(const std::byte *data, std::size_t data_size) {
+        if(auto duration = ogg_vorbis_samples_duration_from_granule(data, data_size)) {
+            return *duration;
+        }
+
         OggVorbis_File vf;
         ov_callbacks cb;
         OggVorbisContainer container = { .data = data, .length = data_size, .position = 0 };
@@ -0,0 +1,71 @@
+// SPDX-License-Identifier: GPL-3.0-only
+
+#include <algorithm>
+#include <cstring>
+#include "sound_reader.hpp"
+
+namespace Invader::SoundReader {
+    template<typename T>
+    static T read_little_endian(const std::byte *data) noexcept {
+        T value = 0;
+        for(std::size_t i = 0; i < sizeof(T); i++) {
+            value |= static_cast<T>(static_cast<std::uint8_t>(data[i])) << (i * 8);
+        }
+        return value;
+    }
+
+    std::optional<double> ogg_vorbis_samples_duration_from_granule(const std::byte *data, std::size_t data_size) noexcept {
+        constexpr std::size_t PAGE_HEADER_SIZE = 27;
+        constexpr std::size_t IDENTIFICATION_HEADER_SIZE = 30;
+
+        auto page_at = [&](std::size_t offset) -> std::optional<std::size_t> {
+            if(data_size - offset < PAGE_HEADER_SIZE || std::memcmp(data + offset, "OggS", 4) != 0 || data[offset + 4] != std::byte{0}) {
+                return std::nullopt;
+            }
+            std::size_t segment_count = static_cast<std::uint8_t>(data[offset + 26]);
+            if(data_size - offset - PAGE_HEADER_SIZE < segment_count) {
+                return std::nullopt;
+            }
+            std::size_t size = PAGE_HEADER_SIZE + segment_count;
+            for(std::size_t i = 0; i < segment_count; i++) {
+                size += static_cast<std::uint8_t>(data[offset + PAGE_HEADER_SIZE + i]);
+            }
+            if(size > data_size - offset) {
+                return std::nullopt;
+            }
+            return size;
+        };
+
+        // The first page holds nothing but the identification header
+        auto first_page_size = page_at(0);
+        if(!first_page_size) {
+            return std::nullopt;
+        }
+        std::size_t segment_count = static_cast<std::uint8_t>(data[26]);
+        const std::byte *identification = data + PAGE_HEADER_SIZE + segment_count;
+        if(*first_page_size - PAGE_HEADER_SIZE - segment_count < IDENTIFICATION_HEADER_SIZE || identification[0] != std::byte{1} || std::memcmp(identification + 1, "vorbis", 6) != 0) {
+            return std::nullopt;
+        }
+        auto serial = read_little_endian<std::uint32_t>(data + 14);
+        auto sample_rate = read_little_endian<std::uint32_t>(identification + 12);
+        if(sample_rate == 0) {
+            return std::nullopt;
+        }
+
+        // The granule position of the last page is the number of samples per channel of the stream
+        constexpr std::size_t MAX_PAGE_SIZE = PAGE_HEADER_SIZE + 255 + 255 * 255;
+        std::size_t first_offset = data_size - std::min(data_size, MAX_PAGE_SIZE);
+        for(std::size_t offset = data_size - PAGE_HEADER_SIZE + 1; offset-- > first_offset;) {
+            auto page_size = page_at(offset);
+            if(!page_size || *page_size != data_size - offset) {
+                continue;
+            }
+            auto granule_position = read_little_endian<std::uint64_t>(data + offset + 6);
+            if(granule_position == UINT64_MAX || read_little_endian<std::uint32_t>(data + offset + 14) != serial) {
+                return std::nullopt;
+            }
+            return static_cast<double>(granule_position) / static_cast<double>(sample_rate);
+        }
+        return std::nullopt;
+    }
+}
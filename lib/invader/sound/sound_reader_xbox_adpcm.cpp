@@ -1,5 +1,7 @@
 // SPDX-License-Identifier: GPL-3.0-only
 
+#include <algorithm>
+#include <array>
 #include <stdexcept>
 #include "sound_reader.hpp"
 
@@ -7,12 +9,20 @@ extern "C" {
 #include "adpcm_xq/adpcm-lib.h"
 }
 
+#if defined(__GNUC__) && (defined(__i386__) || defined(__x86_64__))
+#include <emmintrin.h>
+#define INVADER_XBOX_ADPCM_SSE2
+#endif
+
 const static int ADPCM_STEP_TABLE_MAX_INDEX = sizeof(step_table) / sizeof(step_table[0]) - 1;
 const static int XBOX_ADPCM_ENCODED_BLOCKSIZE = 36;
 const static int XBOX_ADPCM_DECODED_BLOCKSIZE = 128;
+const static int XBOX_ADPCM_CODE_CHUNKS = 8;
+const static int XBOX_ADPCM_CODES_PER_CHUNK = 8;
+const static int XBOX_ADPCM_SAMPLES_PER_CHANNEL = XBOX_ADPCM_DECODED_BLOCKSIZE / sizeof(std::int16_t);
 
 namespace Invader::SoundReader {
-    static void decode_xbadpcm_stream(std::byte *pcm_stream_buf, const std::byte *adpcm_stream_buf, std::size_t adpcm_stream_buf_len, std::uint8_t channel_count, std::uint32_t code_chunks_count);
+    static void decode_xbadpcm_stream(std::int16_t *pcm_stream, const std::uint8_t *adpcm_stream, std::size_t block_count, std::size_t channel_count);
 
     Sound sound_from_xbox_adpcm(const std::byte *data, std::size_t data_length, std::size_t channel_count, std::size_t sample_rate) {
         Sound result = {};
@@ -37,7 +47,7 @@ namespace Invader::SoundReader {
         // Do it!
         std::size_t block_count = static_cast<std::size_t>(data_length / (channel_count * XBOX_ADPCM_ENCODED_BLOCKSIZE));
         result.pcm = std::vector<std::byte>(block_count * XBOX_ADPCM_DECODED_BLOCKSIZE * channel_count);
-        decode_xbadpcm_stream(result.pcm.data(), data, data_length, static_cast<std::uint8_t>(channel_count), 8);
+        decode_xbadpcm_stream(reinterpret_cast<std::int16_t *>(result.pcm.data()), reinterpret_cast<const std::uint8_t *>(data), block_count, channel_count);
 
         // Return the result
         return result;
@@ -61,122 +71,215 @@ namespace Invader::SoundReader {
     //     channel 0: (left)   b8   b9   b10  b11
     //     channel 1: (right)  b12  b13  b14  b15
     //     cont...
+    //
+    //   Each channel of a block decodes to the initial sample plus 63 samples, so the
+    //   last code of the last chunk is not used. Channels are independent of each other
+    //   and of the other blocks, which is what the SSE2 decoder below relies on.
 
-    typedef struct {
-        std::int16_t pcm_sample;  /* the current decoded adpcm sample. When calling
-        **                     decode_adpcm_sample this is supposed to be the
-        **                     predictor for decoding the next sample. Contains
-        **                     the decoded sample when the function returns.*/
-        std::int8_t index;  /* An index into step_table.
-        **               Used for calculating the current differential step.
-        **               Contains the next step index when the function returns.*/
-        std::uint8_t code;  /* An index into index_table.
-        **              The 4bit adpcm code for calculating the next differential index.
-        **              Update this before calling decode_adpcm_sample.*/
-    } AdpcmState;
-
-
-    /* This function will decode the next adpcm sample given as an AdpcmState struct.
-    This function accepts and returns the whole struct since it can easily fit in a
-    single 32bit register, and should be more efficient than passing a pointer to a struct.
-    */
-    static AdpcmState decode_adpcm_sample(AdpcmState state) {
-        if(static_cast<std::size_t>(state.index) > sizeof(step_table) / sizeof(*step_table)) {
-            throw std::runtime_error("Invalid index");
-        }
-
-        int delta, step_size = step_table[state.index];
-        int result = state.pcm_sample;  /* pcm_sample could over/underflow in the code below,
-        **                                 so we keep the result as an int for clamping.*/
+    static void read_xbadpcm_channel_header(const std::uint8_t *header, int &pcm_sample, int &index) {
+        pcm_sample = static_cast<std::int16_t>(header[0] | (header[1] << 8));
+        index = std::clamp(static_cast<int>(static_cast<std::int8_t>(header[2])), 0, ADPCM_STEP_TABLE_MAX_INDEX);
+    }
 
-        delta = step_size >> 3;
-        if (state.code & 4) delta += step_size;
-        if (state.code & 2) delta += step_size >> 1;
-        if (state.code & 1) delta += step_size >> 2;
-        if (state.code & 8) delta = -delta;
+    static std::uint32_t read_xbadpcm_codes(const std::uint8_t *chunk) {
+        return chunk[0] | (chunk[1] << 8) | (chunk[2] << 16) | (static_cast<std::uint32_t>(chunk[3]) << 24);
+    }
 
-        result += delta;
+    // Result of decoding a code at a step index: the difference to add to the sample and the
+    // entry of the next step index, so a sample only costs a lookup and a clamp
+    struct XboxAdpcmStep {
+        std::int32_t delta;
+        std::int32_t next_entry;
+    };
 
-        if (result >= 32767)
-            state.pcm_sample = 32767;
-        else if (result <= -32768)
-            state.pcm_sample = -32768;
-        else
-            state.pcm_sample = static_cast<std::int16_t>(result);
+    static const auto xbadpcm_steps = [] {
+        std::array<XboxAdpcmStep, (ADPCM_STEP_TABLE_MAX_INDEX + 1) * 16> steps;
+        for(int index = 0; index <= ADPCM_STEP_TABLE_MAX_INDEX; index++) {
+            for(int code = 0; code < 16; code++) {
+                int step_size = step_table[index];
+                int delta = step_size >> 3;
+                if(code & 4) delta += step_size;
+                if(code & 2) delta += step_size >> 1;
+                if(code & 1) delta += step_size >> 2;
+                if(code & 8) delta = -delta;
 
-        if(static_cast<std::size_t>(state.code) > sizeof(step_table) / sizeof(*step_table)) {
-            throw std::runtime_error("Invalid code");
+                int next_index = std::clamp(index + index_table[code], 0, ADPCM_STEP_TABLE_MAX_INDEX);
+                steps[index * 16 + code] = { delta, next_index * 16 };
+            }
         }
+        return steps;
+    }();
 
-        state.index += index_table[state.code];
-        if (state.index < 0)
-            state.index = 0;
-        else if (state.index > ADPCM_STEP_TABLE_MAX_INDEX)
-            state.index = ADPCM_STEP_TABLE_MAX_INDEX;
+    static void decode_xbadpcm_channel(std::int16_t *pcm_stream, const std::uint8_t *block, std::size_t channel, std::size_t channel_count) {
+        int pcm_sample, index;
+        read_xbadpcm_channel_header(block + channel * 4, pcm_sample, index);
+        *pcm_stream = static_cast<std::int16_t>(pcm_sample);
+        pcm_stream += channel_count;
 
-        return state;
+        int entry = index * 16;
+        const std::uint8_t *chunk = block + (channel_count + channel) * 4;
+        for(int c = 0; c < XBOX_ADPCM_CODE_CHUNKS; c++, chunk += channel_count * 4) {
+            std::uint32_t codes = read_xbadpcm_codes(chunk);
+            int code_count = c == XBOX_ADPCM_CODE_CHUNKS - 1 ? XBOX_ADPCM_CODES_PER_CHUNK - 1 : XBOX_ADPCM_CODES_PER_CHUNK;
+            for(int i = 0; i < code_count; i++, codes >>= 4) {
+                auto &step = xbadpcm_steps[entry + (codes & 0xF)];
+                pcm_sample = std::clamp(pcm_sample + step.delta, -32768, 32767);
+                entry = step.next_entry;
+                *pcm_stream = static_cast<std::int16_t>(pcm_sample);
+                pcm_stream += channel_count;
+            }
+        }
     }
 
-    static void decode_xbadpcm_stream(std::byte *pcm_stream_buf, const std::byte *adpcm_stream_buf, std::size_t adpcm_stream_buf_len, std::uint8_t channel_count, std::uint32_t code_chunks_count) {
-        AdpcmState adpcm_states[MAX_AUDIO_CHANNEL_COUNT];
-        int block_count = static_cast<int>(
-            adpcm_stream_buf_len /
-            (channel_count * (4 + 4 * code_chunks_count)));
-        const std::uint8_t *adpcm_stream = reinterpret_cast<const std::uint8_t *>(adpcm_stream_buf);
-        std::int16_t *pcm_stream = reinterpret_cast<std::int16_t *>(pcm_stream_buf);
-        std::uint32_t codes;
-        std::uint32_t samples_per_chunk = 8 * channel_count;
-        std::uint32_t samples_this_chunk = 0, samples_remaining_this_block = 0;
-        std::uint32_t samples_per_block = samples_per_chunk * code_chunks_count;
-
-        for (int b = 0; b < block_count; b++) {
-            samples_remaining_this_block = samples_per_block;
-            // initialize the adpcm state structs
-            for (int c = 0; c < channel_count; c++) {
-                adpcm_states[c].pcm_sample = adpcm_stream[0] | (adpcm_stream[1] << 8);
-                adpcm_states[c].index = adpcm_stream[2];
-                adpcm_stream += 4;
-
-                pcm_stream[0] = adpcm_states[c].pcm_sample;
-                pcm_stream++;
-                samples_remaining_this_block--;
-
-                if (adpcm_states[c].index < 0)
-                    adpcm_states[c].index = 0;
-                else if (adpcm_states[c].index > ADPCM_STEP_TABLE_MAX_INDEX)
-                    adpcm_states[c].index = ADPCM_STEP_TABLE_MAX_INDEX;
+    #ifdef INVADER_XBOX_ADPCM_SSE2
+    const static std::size_t XBOX_ADPCM_SSE2_LANES = 8;
+
+    // Decode the channels of 8 / channel_count blocks at a time, one channel per 16-bit lane.
+    // Returns how many blocks were decoded; the rest is left to the scalar decoder.
+    __attribute__((target("sse2")))
+    static std::size_t decode_xbadpcm_blocks_sse2(std::int16_t *pcm_stream, const std::uint8_t *adpcm_stream, std::size_t block_count, std::size_t channel_count) {
+        const std::size_t blocks_per_group = XBOX_ADPCM_SSE2_LANES / channel_count;
+        const std::size_t encoded_block_size = XBOX_ADPCM_ENCODED_BLOCKSIZE * channel_count;
+        const std::size_t decoded_block_samples = XBOX_ADPCM_SAMPLES_PER_CHANNEL * channel_count;
+
+        const __m128i one = _mm_set1_epi16(1);
+        const __m128i two = _mm_set1_epi16(2);
+        const __m128i four = _mm_set1_epi16(4);
+        const __m128i eight = _mm_set1_epi16(8);
+        const __m128i minus_one = _mm_set1_epi16(-1);
+        const __m128i code_mask = _mm_set1_epi32(0xF);
+        const __m128i max_index = _mm_set1_epi16(ADPCM_STEP_TABLE_MAX_INDEX);
+
+        std::size_t b = 0;
+        for(; b + blocks_per_group <= block_count; b += blocks_per_group) {
+            const std::uint8_t *group = adpcm_stream + b * encoded_block_size;
+            alignas(16) std::int16_t samples[XBOX_ADPCM_SAMPLES_PER_CHANNEL][XBOX_ADPCM_SSE2_LANES];
+            alignas(16) std::uint32_t codes[XBOX_ADPCM_CODE_CHUNKS][XBOX_ADPCM_SSE2_LANES];
+            alignas(16) std::int16_t indices[XBOX_ADPCM_SSE2_LANES];
+
+            for(std::size_t lane = 0; lane < XBOX_ADPCM_SSE2_LANES; lane++) {
+                const std::uint8_t *block = group + lane / channel_count * encoded_block_size;
+                std::size_t channel = lane % channel_count;
+                int pcm_sample, index;
+                read_xbadpcm_channel_header(block + channel * 4, pcm_sample, index);
+                samples[0][lane] = static_cast<std::int16_t>(pcm_sample);
+                indices[lane] = static_cast<std::int16_t>(index);
+                for(int c = 0; c < XBOX_ADPCM_CODE_CHUNKS; c++) {
+                    codes[c][lane] = read_xbadpcm_codes(block + (channel_count * (c + 1) + channel) * 4);
+                }
             }
 
-            while (samples_remaining_this_block) {
-                // loop over each channel in each chunk
-                if (samples_remaining_this_block < samples_per_chunk)
-                    samples_this_chunk = samples_remaining_this_block;
-                else
-                    samples_this_chunk = samples_per_chunk;
-
-                for (std::size_t c = 0; c < channel_count; c++) {
-                    // OR the codes together for easy access
-                    codes = (
-                         adpcm_stream[0] |
-                        (adpcm_stream[1] << 8) |
-                        (adpcm_stream[2] << 16) |
-                        (adpcm_stream[3] << 24));
-                    adpcm_stream += 4;
-
-                    // loop over the 8 codes in this channels chunk.
-                    // loop is structured like this to properly interleave the pcm data.
-                    // otherwise we would have to store the decoded samples to several temp
-                    // buffers and then interleave those temp buffers into the pcm stream.
-                    for (std::size_t i = c; i < samples_this_chunk; i += channel_count) {
-                        adpcm_states[c].code = codes & 0xF;
-                        codes >>= 4;
-                        adpcm_states[c] = decode_adpcm_sample(adpcm_states[c]);
-                        pcm_stream[i] = adpcm_states[c].pcm_sample;
+            __m128i pcm_samples = _mm_load_si128(reinterpret_cast<const __m128i *>(samples[0]));
+            __m128i index = _mm_load_si128(reinterpret_cast<const __m128i *>(indices));
+            std::size_t s = 1;
+            for(int c = 0; c < XBOX_ADPCM_CODE_CHUNKS; c++) {
+                __m128i codes_low = _mm_load_si128(reinterpret_cast<const __m128i *>(codes[c]));
+                __m128i codes_high = _mm_load_si128(reinterpret_cast<const __m128i *>(codes[c] + 4));
+                int code_count = c == XBOX_ADPCM_CODE_CHUNKS - 1 ? XBOX_ADPCM_CODES_PER_CHUNK - 1 : XBOX_ADPCM_CODES_PER_CHUNK;
+                for(int i = 0; i < code_count; i++, s++) {
+                    __m128i code = _mm_packs_epi32(_mm_and_si128(codes_low, code_mask), _mm_and_si128(codes_high, code_mask));
+                    codes_low = _mm_srli_epi32(codes_low, 4);
+                    codes_high = _mm_srli_epi32(codes_high, 4);
+
+                    // There is no gather in SSE2, so the step sizes are looked up one lane at a time
+                    __m128i step_size = _mm_setzero_si128();
+                    step_size = _mm_insert_epi16(step_size, step_table[_mm_extract_epi16(index, 0)], 0);
+                    step_size = _mm_insert_epi16(step_size, step_table[_mm_extract_epi16(index, 1)], 1);
+                    step_size = _mm_insert_epi16(step_size, step_table[_mm_extract_epi16(index, 2)], 2);
+                    step_size = _mm_insert_epi16(step_size, step_table[_mm_extract_epi16(index, 3)], 3);
+                    step_size = _mm_insert_epi16(step_size, step_table[_mm_extract_epi16(index, 4)], 4);
+                    step_size = _mm_insert_epi16(step_size, step_table[_mm_extract_epi16(index, 5)], 5);
+                    step_size = _mm_insert_epi16(step_size, step_table[_mm_extract_epi16(index, 6)], 6);
+                    step_size = _mm_insert_epi16(step_size, step_table[_mm_extract_epi16(index, 7)], 7);
+
+                    __m128i has_4 = _mm_cmpeq_epi16(_mm_and_si128(code, four), four);
+                    __m128i has_2 = _mm_cmpeq_epi16(_mm_and_si128(code, two), two);
+                    __m128i has_1 = _mm_cmpeq_epi16(_mm_and_si128(code, one), one);
+                    __m128i negative = _mm_cmpeq_epi16(_mm_and_si128(code, eight), eight);
+
+                    // The delta can be larger than 16 bits, so it is added in two parts that have the same
+                    // sign and both fit. Saturating twice then gives the same result as clamping the sum.
+                    __m128i small_delta = _mm_srai_epi16(step_size, 3);
+                    small_delta = _mm_add_epi16(small_delta, _mm_and_si128(_mm_srai_epi16(step_size, 1), has_2));
+                    small_delta = _mm_add_epi16(small_delta, _mm_and_si128(_mm_srai_epi16(step_size, 2), has_1));
+                    __m128i large_delta = _mm_and_si128(step_size, has_4);
+                    small_delta = _mm_sub_epi16(_mm_xor_si128(small_delta, negative), negative);
+                    large_delta = _mm_sub_epi16(_mm_xor_si128(large_delta, negative), negative);
+                    pcm_samples = _mm_adds_epi16(_mm_adds_epi16(pcm_samples, small_delta), large_delta);
+                    _mm_store_si128(reinterpret_cast<__m128i *>(samples[s]), pcm_samples);
+
+                    // index_table is -1 for codes 0-3 and 2, 4, 6, 8 for codes 4-7, regardless of the sign bit
+                    __m128i index_increase = _mm_slli_epi16(_mm_add_epi16(_mm_and_si128(code, _mm_set1_epi16(3)), one), 1);
+                    index_increase = _mm_or_si128(_mm_and_si128(has_4, index_increase), _mm_andnot_si128(has_4, minus_one));
+                    index = _mm_min_epi16(_mm_max_epi16(_mm_add_epi16(index, index_increase), _mm_setzero_si128()), max_index);
+                }
+            }
+
+            // Transpose the lanes back into the blocks. For stereo, a pair of lanes is one block, so its
+            // samples are moved as 32-bit frames that are already interleaved.
+            std::int16_t *group_pcm = pcm_stream + b * decoded_block_samples;
+            if(channel_count == 1) {
+                for(int i = 0; i < XBOX_ADPCM_SAMPLES_PER_CHANNEL; i += 8) {
+                    __m128i rows[8], pairs[8], quads[8];
+                    for(int r = 0; r < 8; r++) {
+                        rows[r] = _mm_load_si128(reinterpret_cast<const __m128i *>(samples[i + r]));
+                    }
+                    for(int r = 0; r < 4; r++) {
+                        pairs[r] = _mm_unpacklo_epi16(rows[r * 2], rows[r * 2 + 1]);
+                        pairs[r + 4] = _mm_unpackhi_epi16(rows[r * 2], rows[r * 2 + 1]);
+                    }
+                    for(int r = 0; r < 2; r++) {
+                        quads[r * 4] = _mm_unpacklo_epi32(pairs[r * 4], pairs[r * 4 + 1]);
+                        quads[r * 4 + 1] = _mm_unpackhi_epi32(pairs[r * 4], pairs[r * 4 + 1]);
+                        quads[r * 4 + 2] = _mm_unpacklo_epi32(pairs[r * 4 + 2], pairs[r * 4 + 3]);
+                        quads[r * 4 + 3] = _mm_unpackhi_epi32(pairs[r * 4 + 2], pairs[r * 4 + 3]);
+                    }
+                    for(int r = 0; r < 2; r++) {
+                        for(int q = 0; q < 2; q++) {
+                            int lane = r * 4 + q * 2;
+                            __m128i low = quads[r * 4 + q], high = quads[r * 4 + q + 2];
+                            _mm_storeu_si128(reinterpret_cast<__m128i *>(group_pcm + lane * decoded_block_samples + i), _mm_unpacklo_epi64(low, high));
+                            _mm_storeu_si128(reinterpret_cast<__m128i *>(group_pcm + (lane + 1) * decoded_block_samples + i), _mm_unpackhi_epi64(low, high));
+                        }
                     }
                 }
-                // skip over the chunk of samples we just decoded
-                pcm_stream += samples_this_chunk;
-                samples_remaining_this_block -= samples_this_chunk;
+            }
+            else {
+                for(int i = 0; i < XBOX_ADPCM_SAMPLES_PER_CHANNEL; i += 4) {
+                    __m128i rows[4], pairs[4];
+                    for(int r = 0; r < 4; r++) {
+                        rows[r] = _mm_load_si128(reinterpret_cast<const __m128i *>(samples[i + r]));
+                    }
+                    pairs[0] = _mm_unpacklo_epi32(rows[0], rows[1]);
+                    pairs[1] = _mm_unpackhi_epi32(rows[0], rows[1]);
+                    pairs[2] = _mm_unpacklo_epi32(rows[2], rows[3]);
+                    pairs[3] = _mm_unpackhi_epi32(rows[2], rows[3]);
+                    for(int block = 0; block < 4; block++) {
+                        __m128i frames = block % 2 == 0 ? _mm_unpacklo_epi64(pairs[block / 2], pairs[block / 2 + 2]) : _mm_unpackhi_epi64(pairs[block / 2], pairs[block / 2 + 2]);
+                        _mm_storeu_si128(reinterpret_cast<__m128i *>(group_pcm + block * decoded_block_samples + i * 2), frames);
+                    }
+                }
+            }
+        }
+        return b;
+    }
+    #endif
+
+    static void decode_xbadpcm_stream(std::int16_t *pcm_stream, const std::uint8_t *adpcm_stream, std::size_t block_count, std::size_t channel_count) {
+        std::size_t b = 0;
+
+        #ifdef INVADER_XBOX_ADPCM_SSE2
+        static const bool sse2_supported = __builtin_cpu_supports("sse2");
+        if(sse2_supported) {
+            b = decode_xbadpcm_blocks_sse2(pcm_stream, adpcm_stream, block_count, channel_count);
+        }
+        #endif
+
+        for(; b < block_count; b++) {
+            const std::uint8_t *block = adpcm_stream + b * XBOX_ADPCM_ENCODED_BLOCKSIZE * channel_count;
+            std::int16_t *block_pcm = pcm_stream + b * XBOX_ADPCM_SAMPLES_PER_CHANNEL * channel_count;
+            for(std::size_t c = 0; c < channel_count; c++) {
+                decode_xbadpcm_channel(block_pcm + c, block, c, channel_count);
             }
         }
     }
@@ -43,11 +43,20 @@
 #define	METANAME_LUACSENUMVAL	"luacenumval" LUACS_VERSION
 
 #define	LUACS_REGISTRY_NAME	"luacstruct_registry"
+#define	LUACS_PROXIES_NAME	"luacstruct_proxies"
 
 #if LUA_VERSION_NUM == 501
 #define	lua_rawlen(_x, _i)	lua_objlen((_x), (_i))
 #define lua_absindex(_L, _i)	(((_i) > 0 || (_i) <= LUA_REGISTRYINDEX) \
 				    ? (_i) : lua_gettop(_L) + (_i) + 1)
+#define	luacs_keyidx(_i)	(((_i) > 0 || (_i) <= LUA_REGISTRYINDEX) \
+				    ? (_i) : (_i) - 1)
+#define	lua_rawgetp(_L, _i, _p)					\
+	(lua_pushlightuserdata((_L), (void *)(_p)),		\
+	    lua_rawget((_L), luacs_keyidx(_i)))
+#define	lua_rawsetp(_L, _i, _p)					\
+	(lua_pushlightuserdata((_L), (void *)(_p)), lua_insert((_L), -2), \
+	    lua_rawset((_L), luacs_keyidx(_i)))
 #endif
 
 #ifdef LUACS_DEBUG
@@ -183,6 +192,8 @@ static int	 luacs_array__next(lua_State *);
 static int	 luacs_array__pairs(lua_State *);
 static int	 luacs_array__gc(lua_State *);
 static int	 luacs_newobject1(lua_State *, void *);
+static bool	 luacs_proxy_get(lua_State *, struct luacstruct *, void *);
+static void	 luacs_proxy_set(lua_State *, struct luacstruct *, void *);
 static int	 luacs_object__luacstructdump(struct lua_State *);
 struct luacobj_compat;
 static void	 luacs_object_compat(lua_State *, int, struct luacobj_compat *);
@@ -222,6 +233,10 @@ static int	 luacenum_value_cmp(struct luacenum_value *,
 static int	 luacs_ref(lua_State *);
 static int	 luacs_getref(lua_State *, int);
 static int	 luacs_unref(lua_State *, int);
+static void	 luacs_fieldmap_set(lua_State *, struct luacstruct *,
+		    struct luacstruct_field *, bool);
+static struct luacstruct_field
+		*luacs_fieldmap_find(lua_State *, struct luacstruct *, int);
 
 SPLAY_PROTOTYPE(luacstruct_fields, luacstruct_field, tree,
     luacstruct_field_cmp);
@@ -282,6 +297,7 @@ luacs_newstruct0(lua_State *L, const char *tname, const char *supertname)
 			}
 			TAILQ_INSERT_TAIL(&cs->sorted, fieldt, queue);
 			SPLAY_INSERT(luacstruct_fields, &cs->fields, fieldt);
+			luacs_fieldmap_set(L, cs, fieldt, true);
 		}
 	}
 
@@ -342,6 +358,8 @@ luacs_struct__gc(lua_State *L)
 		while ((field = SPLAY_MIN(luacstruct_fields, &cs->fields)) !=
 		    NULL)
 			luacstruct_field_free(L, cs, field);
+		lua_pushnil(L);
+		lua_rawsetp(L, LUA_REGISTRYINDEX, cs);
 	}
 
 	return (0);
@@ -407,6 +425,7 @@ luacs_declare(lua_State *L, enum luacstruct_type _type,
 	field->type = (field->nmemb > 0)? LUACS_TARRAY : _type;
 
 	SPLAY_INSERT(luacstruct_fields, &cs->fields, field);
+	luacs_fieldmap_set(L, cs, field, true);
 	TAILQ_FOREACH(field0, &cs->sorted, queue) {
 		if (field->regeon.off < field0->regeon.off)
 			break;
@@ -491,11 +510,69 @@ luacstruct_field_free(lua_State *L, struct luacstruct *cs,
 			luacs_unref(L, field->ref);
 		TAILQ_REMOVE(&cs->sorted, field, queue);
 		SPLAY_REMOVE(luacstruct_fields, &cs->fields, field);
+		luacs_fieldmap_set(L, cs, field, false);
 		free((char *)field->fieldname);
 	}
 	free(field);
 }
 
+/*
+ * Besides the splay tree, every struct keeps a table in the registry,
+ * keyed by the struct pointer, which maps the field names to the fields.
+ * Lua strings are interned and carry their hash, so resolving an object
+ * field through it costs a hash lookup instead of a strcmp() per node.
+ * Defining LUACS_SPLAY_LOOKUP resolves the fields through the splay tree
+ * like before, to compare the two.
+ */
+void
+luacs_fieldmap_set(lua_State *L, struct luacstruct *cs,
+    struct luacstruct_field *field, bool set)
+{
+	lua_rawgetp(L, LUA_REGISTRYINDEX, cs);
+	if (lua_isnil(L, -1)) {
+		lua_pop(L, 1);
+		if (!set)
+			return;
+		lua_newtable(L);
+		lua_pushvalue(L, -1);
+		lua_rawsetp(L, LUA_REGISTRYINDEX, cs);
+	}
+	lua_pushstring(L, field->fieldname);
+	if (set)
+		lua_pushlightuserdata(L, field);
+	else
+		lua_pushnil(L);
+	lua_rawset(L, -3);
+	lua_pop(L, 1);
+}
+
+struct luacstruct_field *
+luacs_fieldmap_find(lua_State *L, struct luacstruct *cs, int keyidx)
+{
+	struct luacstruct_field	*field;
+#ifdef LUACS_SPLAY_LOOKUP
+	struct luacstruct_field	 fkey;
+
+	fkey.fieldname = luaL_checkstring(L, keyidx);
+	field = SPLAY_FIND(luacstruct_fields, &cs->fields, &fkey);
+#else
+	keyidx = lua_absindex(L, keyidx);
+	if (lua_type(L, keyidx) != LUA_TSTRING)
+		luaL_checkstring(L, keyidx);	/* numbers are converted */
+	lua_rawgetp(L, LUA_REGISTRYINDEX, cs);
+	if (lua_isnil(L, -1)) {
+		lua_pop(L, 1);
+		return (NULL);
+	}
+	lua_pushvalue(L, keyidx);
+	lua_rawget(L, -2);
+	field = lua_touserdata(L, -1);
+	lua_pop(L, 2);
+#endif
+
+	return (field);
+}
+
 int
 luacs_pushctype(lua_State *L, enum luacstruct_type _type, const char *tname)
 {
@@ -718,6 +795,13 @@ luacs_array__index(lua_State *L)
 		else {
 			luacs_getref(L, obj->tblref);
 			lua_rawgeti(L, -1, idx);
+			/* the referenced array may have been reallocated */
+			if (!lua_isnil(L, -1) && ((struct luacobject *)
+			    luaL_checkudata(L, -1, METANAME_LUACSTRUCTOBJ))->ptr
+			    != ptr) {
+				lua_pop(L, 1);
+				lua_pushnil(L);
+			}
 			if (lua_isnil(L, -1)) {
 				lua_pop(L, 1);
 				luacs_getref(L, obj->typref);
@@ -1037,6 +1121,8 @@ luacs_newobject1(lua_State *L, void *ptr)
 	size_t			 objsiz = 0;
 
 	cs = luacs_checkstruct(L, -1);
+	if (ptr != NULL && luacs_proxy_get(L, cs, ptr))
+		return (1);
 	if (ptr != NULL) {
 		obj = lua_newuserdata(L, sizeof(struct luacobject));
 		obj->ptr = ptr;
@@ -1074,9 +1160,110 @@ luacs_newobject1(lua_State *L, void *ptr)
 
 	obj->tblref = luacs_ref(L);
 
+	if (ptr != NULL)
+		luacs_proxy_set(L, cs, ptr);
+
 	return (1);
 }
 
+/*
+ * Objects pointing to existing memory are kept in weak-valued tables,
+ * one per struct type, keyed by their address.  Pushing the same address
+ * again returns the same object, along with the children it has cached,
+ * instead of allocating a new one.
+ */
+bool
+luacs_proxy_get(lua_State *L, struct luacstruct *cs, void *ptr)
+{
+	lua_getfield(L, LUA_REGISTRYINDEX, LUACS_PROXIES_NAME);
+	if (lua_isnil(L, -1)) {
+		lua_pop(L, 1);
+		return (false);
+	}
+	lua_rawgetp(L, -1, cs);
+	if (lua_isnil(L, -1)) {
+		lua_pop(L, 2);
+		return (false);
+	}
+	lua_rawgetp(L, -1, ptr);
+	if (lua_isnil(L, -1)) {
+		lua_pop(L, 3);
+		return (false);
+	}
+	lua_replace(L, -3);
+	lua_pop(L, 1);
+
+	return (true);
+}
+
+void
+luacs_proxy_set(lua_State *L, struct luacstruct *cs, void *ptr)
+{
+	lua_getfield(L, LUA_REGISTRYINDEX, LUACS_PROXIES_NAME);
+	if (lua_isnil(L, -1)) {
+		lua_pop(L, 1);
+		lua_newtable(L);
+		lua_pushvalue(L, -1);
+		lua_setfield(L, LUA_REGISTRYINDEX, LUACS_PROXIES_NAME);
+	}
+	lua_rawgetp(L, -1, cs);
+	if (lua_isnil(L, -1)) {
+		lua_pop(L, 1);
+		lua_newtable(L);
+		lua_newtable(L);
+		lua_pushliteral(L, "v");
+		lua_setfield(L, -2, "__mode");
+		lua_setmetatable(L, -2);
+		lua_pushvalue(L, -1);
+		lua_rawsetp(L, -3, cs);
+	}
+	lua_pushvalue(L, -3);
+	lua_rawsetp(L, -2, ptr);
+	lua_pop(L, 2);
+}
+
+/*
+ * Drop the cached objects whose address is in the given range, or all of
+ * them if ptr is NULL.  Objects already held by Lua remain usable, but
+ * they will not be handed out again.
+ */
+int
+luacs_invalidate_objects(lua_State *L, void *ptr, size_t size)
+{
+	uintptr_t	 addr, begin, end;
+
+	if (ptr == NULL) {
+		lua_pushnil(L);
+		lua_setfield(L, LUA_REGISTRYINDEX, LUACS_PROXIES_NAME);
+		return (0);
+	}
+	begin = (uintptr_t)ptr;
+	end = begin + size;
+	lua_getfield(L, LUA_REGISTRYINDEX, LUACS_PROXIES_NAME);
+	if (lua_isnil(L, -1)) {
+		lua_pop(L, 1);
+		return (0);
+	}
+	lua_pushnil(L);
+	while (lua_next(L, -2) != 0) {
+		lua_pushnil(L);
+		while (lua_next(L, -2) != 0) {
+			lua_pop(L, 1);
+			addr = (uintptr_t)lua_touserdata(L, -1);
+			if (begin <= addr && addr < end) {
+				/* clearing fields is allowed while traversing */
+				lua_pushvalue(L, -1);
+				lua_pushnil(L);
+				lua_rawset(L, -4);
+			}
+		}
+		lua_pop(L, 1);
+	}
+	lua_pop(L, 1);
+
+	return (0);
+}
+
 int
 luacs_object__luacstructdump(struct lua_State *L)
 {
@@ -1205,13 +1392,11 @@ int
 luacs_object__index(lua_State *L)
 {
 	struct luacobject	*obj;
-	struct luacstruct_field	 fkey, *field;
+	struct luacstruct_field	*field;
 
 	lua_settop(L, 2);
 	obj = luaL_checkudata(L, 1, METANAME_LUACSTRUCTOBJ);
-	fkey.fieldname = luaL_checkstring(L, 2);
-	if ((field = SPLAY_FIND(luacstruct_fields, &obj->cs->fields, &fkey))
-	    != NULL)
+	if ((field = luacs_fieldmap_find(L, obj->cs, 2)) != NULL)
 		return (luacs_object__get(L, obj, field));
 	else
 		lua_pushnil(L);
@@ -1305,13 +1490,11 @@ luacs_object__newindex(lua_State *L)
 {
 	struct luacstruct	*cs0;
 	struct luacobject	*obj, *ano = NULL;
-	struct luacstruct_field	 fkey, *field;
+	struct luacstruct_field	*field;
 
 	lua_settop(L, 3);
 	obj = luaL_checkudata(L, 1, METANAME_LUACSTRUCTOBJ);
-	fkey.fieldname = luaL_checkstring(L, 2);
-	if ((field = SPLAY_FIND(luacstruct_fields, &obj->cs->fields, &fkey))
-	    != NULL) {
+	if ((field = luacs_fieldmap_find(L, obj->cs, 2)) != NULL) {
 		if ((field->flags & LUACS_FREADONLY) != 0) {
 readonly:
 			lua_pushfstring(L, "field `%s' is readonly",
@@ -1373,7 +1556,7 @@ readonly:
 		}
 	} else {
 		lua_pushfstring(L, "`struct %s' doesn't have field `%s'",
-		    obj->cs->typename, fkey.fieldname);
+		    obj->cs->typename, lua_tostring(L, 2));
 		lua_error(L);
 	}
 
@@ -1418,15 +1601,14 @@ int
 luacs_object__next(lua_State *L)
 {
 	struct luacobject	*obj;
-	struct luacstruct_field	*field, fkey;
+	struct luacstruct_field	*field;
 
 	lua_settop(L, 2);
 	obj = luaL_checkudata(L, 1, METANAME_LUACSTRUCTOBJ);
 	if (lua_isnil(L, 2))
 		field = TAILQ_FIRST(&obj->cs->sorted);
 	else {
-		fkey.fieldname = luaL_checkstring(L, 2);
-		field = SPLAY_FIND(luacstruct_fields, &obj->cs->fields, &fkey);
+		field = luacs_fieldmap_find(L, obj->cs, 2);
 		if (field != NULL)
 			field = TAILQ_NEXT(field, queue);
 	}
@@ -1455,13 +1637,14 @@ int
 luacs_object__gc(lua_State *L)
 {
 	struct luacobject	*obj;
-	struct luacstruct_field	 fkey, *field;
+	struct luacstruct_field	*field;
 
 	lua_settop(L, 1);
 	obj = luaL_checkudata(L, 1, METANAME_LUACSTRUCTOBJ);
-	fkey.fieldname = "__gc";
-	if ((field = SPLAY_FIND(luacstruct_fields, &obj->cs->fields, &fkey))
-	    != NULL && field->type == LUACS_TMETHOD) {
+	lua_pushliteral(L, "__gc");
+	field = luacs_fieldmap_find(L, obj->cs, 2);
+	lua_pop(L, 1);
+	if (field != NULL && field->type == LUACS_TMETHOD) {
 		luacs_getref(L, field->ref);
 		lua_pushvalue(L, 1);
 		lua_pcall(L, 1, 0, 0);
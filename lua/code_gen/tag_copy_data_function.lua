@@ -53,8 +53,10 @@ add([[
 #include <functional>
 #include <cstdint>
 #include <cstddef>
+#include <cstring>
 #include <balltze/engine/tag.hpp>
 #include <balltze/engine/tag_definitions.hpp>
+#include <balltze/features/tags_handling.hpp>
 
 namespace Balltze::Features {
     using namespace Engine;
@@ -65,7 +67,33 @@ namespace Balltze::Features {
         if(value == nullptr) {
             return;
         }
-        value = reinterpret_cast<T>(reinterpret_cast<std::int32_t>(value) + offset);
+        value = reinterpret_cast<T>(reinterpret_cast<std::intptr_t>(value) + offset);
+    }
+
+    template<typename T>
+    static inline void patch_field(T &field, T const &source_field, TagDataPatchSummary &summary) {
+        if(std::memcmp(&field, &source_field, sizeof(T)) != 0) {
+            std::memcpy(&field, &source_field, sizeof(T));
+            summary.fields_patched++;
+            summary.bytes_patched += sizeof(T);
+        }
+    }
+
+    static inline void patch_data_offset(TagDataOffset &data_offset, TagDataOffset const &source_data_offset, std::function<std::byte *(std::byte *, std::size_t)> &data_allocator, TagDataPatchSummary &summary) {
+        if(data_offset.size != source_data_offset.size || (data_offset.pointer == nullptr) != (source_data_offset.pointer == nullptr)) {
+            data_offset.size = source_data_offset.size;
+            data_offset.pointer = source_data_offset.pointer ? data_allocator(source_data_offset.pointer, source_data_offset.size) : nullptr;
+            summary.fields_patched++;
+            summary.bytes_patched += source_data_offset.size;
+            summary.data_reallocated++;
+        }
+        else if(data_offset.pointer && data_offset.pointer != source_data_offset.pointer && std::memcmp(data_offset.pointer, source_data_offset.pointer, data_offset.size) != 0) {
+            std::memcpy(data_offset.pointer, source_data_offset.pointer, data_offset.size);
+            summary.fields_patched++;
+            summary.bytes_patched += data_offset.size;
+        }
+        patch_field(data_offset.external, source_data_offset.external, summary);
+        patch_field(data_offset.file_offset, source_data_offset.file_offset, summary);
     }
     
 ]])
@@ -136,6 +164,84 @@ for structName, struct in pairs(structs) do
     add("}\n\n")
 end
 
+for structName, _ in pairs(structs) do
+    indent(1)
+    add("static inline void patch_struct_data(" .. definitionParser.snakeCaseToCamelCase(structName) .. " &data, " .. definitionParser.snakeCaseToCamelCase(structName) .. " &source, std::function<std::byte *(std::byte *, std::size_t)> &data_allocator, TagDataPatchSummary &summary); \n");
+end
+
+add("\n")
+
+for structName, struct in pairs(structs) do
+    indent(1)
+    add("static inline void patch_struct_data(" .. definitionParser.snakeCaseToCamelCase(structName) .. " &data, " .. definitionParser.snakeCaseToCamelCase(structName) .. " &source, std::function<std::byte *(std::byte *, std::size_t)> &data_allocator, TagDataPatchSummary &summary) {\n")
+
+    if(struct.inherits and structs[definitionParser.snakeCaseToCamelCase(struct.inherits)]) then
+        indent(2)
+        add("patch_struct_data(static_cast<" .. definitionParser.snakeCaseToCamelCase(struct.inherits) .. " &>(data), static_cast<" .. definitionParser.snakeCaseToCamelCase(struct.inherits) .. " &>(source), data_allocator, summary);\n")
+    end
+
+    for _, field in ipairs(struct.fields) do
+        if(field.type ~= "pad" and field.name) then
+            local fieldAccess = "data." .. field.name
+            local sourceFieldAccess = "source." .. field.name
+            if(field.type == "TagBlock") then
+                -- Reflexives with a different element count are the only ones that get reallocated
+                indent(2)
+                add("if(" .. fieldAccess .. ".count != " .. sourceFieldAccess .. ".count) {\n")
+                indent(3)
+                add(fieldAccess .. ".count = " .. sourceFieldAccess .. ".count;\n")
+                indent(3)
+                add(fieldAccess .. ".elements = nullptr;\n")
+                indent(3)
+                add("if(" .. sourceFieldAccess .. ".count > 0) {\n")
+                indent(4)
+                add(fieldAccess .. ".elements = reinterpret_cast<decltype(" .. fieldAccess .. ".elements)>(data_allocator(reinterpret_cast<std::byte *>(" .. sourceFieldAccess .. ".elements), sizeof(" .. sourceFieldAccess .. ".elements[0]) * " .. sourceFieldAccess .. ".count));\n")
+                if(structs[definitionParser.snakeCaseToCamelCase(field.struct)]) then
+                    indent(4)
+                    add("for(std::size_t i = 0; i < " .. fieldAccess .. ".count; i++) {\n")
+                    indent(5)
+                    add("copy_struct_data(" .. fieldAccess .. ".elements[i], data_allocator, true);\n")
+                    indent(4)
+                    add("}\n")
+                end
+                indent(3)
+                add("}\n")
+                indent(3)
+                add("summary.fields_patched++;\n")
+                indent(3)
+                add("summary.blocks_reallocated++;\n")
+                indent(2)
+                add("}\n")
+                indent(2)
+                add("else if(" .. fieldAccess .. ".elements != " .. sourceFieldAccess .. ".elements) {\n")
+                indent(3)
+                add("for(std::size_t i = 0; i < " .. fieldAccess .. ".count; i++) {\n")
+                indent(4)
+                if(structs[definitionParser.snakeCaseToCamelCase(field.struct)]) then
+                    add("patch_struct_data(" .. fieldAccess .. ".elements[i], " .. sourceFieldAccess .. ".elements[i], data_allocator, summary);\n")
+                else
+                    add("patch_field(" .. fieldAccess .. ".elements[i], " .. sourceFieldAccess .. ".elements[i], summary);\n")
+                end
+                indent(3)
+                add("}\n")
+                indent(2)
+                add("}\n")
+            elseif(field.type == "TagDataOffset") then
+                indent(2)
+                add("patch_data_offset(" .. fieldAccess .. ", " .. sourceFieldAccess .. ", data_allocator, summary);\n")
+            elseif(structs[definitionParser.snakeCaseToCamelCase(field.type)] and not field.size) then
+                indent(2)
+                add("patch_struct_data(" .. fieldAccess .. ", " .. sourceFieldAccess .. ", data_allocator, summary);\n")
+            else
+                indent(2)
+                add("patch_field(" .. fieldAccess .. ", " .. sourceFieldAccess .. ", summary);\n")
+            end
+        end
+    end
+    indent(1)
+    add("}\n\n")
+end
+
 add([[
     std::byte *copy_tag_data(Tag *tag, std::function<std::byte *(std::byte *, std::size_t)> data_allocator) {
         switch(tag->primary_class) {
@@ -167,6 +273,47 @@ add([[
                 return nullptr;
         }
     }
+
+    bool patch_tag_data(Tag *tag, Tag *source_tag, std::function<std::byte *(std::byte *, std::size_t)> data_allocator, TagDataPatchSummary &summary) {
+        if(tag->primary_class != source_tag->primary_class) {
+            return false;
+        }
+        switch(tag->primary_class) {
+]])
+
+for _, file in ipairs(files) do
+    local fileName = file:match("([^/]+)$")
+    local definitionName = fileName:match("^(.+)%..+$")
+    if(definitionName ~= "enum" and definitionName ~= "bitfield" and definitionName ~= "hud_interface_types") then
+        if(definitionName == "tag_collection") then
+            indent(3)
+            add("case TAG_CLASS_UI_WIDGET_COLLECTION: \n")
+        end
+        indent(3)
+        add("case TAG_CLASS_" .. definitionName:upper() .. ": { \n")
+        if(structs[definitionParser.snakeCaseToCamelCase(definitionName)]) then
+            indent(4)
+            add("auto &tag_data = *reinterpret_cast<" .. definitionParser.snakeCaseToCamelCase(definitionName) .. " *>(tag->data); \n")
+            indent(4)
+            add("auto &source_tag_data = *reinterpret_cast<" .. definitionParser.snakeCaseToCamelCase(definitionName) .. " *>(source_tag->data); \n")
+            indent(4)
+            add("patch_struct_data(tag_data, source_tag_data, data_allocator, summary); \n")
+            indent(4)
+            add("return true; \n")
+        else
+            indent(4)
+            add("return false; \n")
+        end
+        indent(3)
+        add("} \n")
+    end
+end
+
+add([[
+            default:
+                return false;
+        }
+    }
 }
 ]])
 
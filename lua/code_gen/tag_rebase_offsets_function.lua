@@ -64,7 +64,7 @@ namespace Balltze::Features {
         if(value == nullptr) {
             return;
         }
-        value = reinterpret_cast<T>(reinterpret_cast<std::int32_t>(value) + offset);
+        value = reinterpret_cast<T>(reinterpret_cast<std::intptr_t>(value) + offset);
     }
     
 ]])
@@ -129,7 +129,7 @@ end
 
 add([[
     void rebase_tag_data_offsets(Tag *tag, std::byte *new_tag_data_address, std::optional<std::function<std::uint32_t(std::uint32_t)>> external_data_offset_resolver) {
-        std::ptrdiff_t offset_disp = reinterpret_cast<std::int32_t>(new_tag_data_address - get_tag_data_address());
+        std::ptrdiff_t offset_disp = new_tag_data_address - get_tag_data_address();
 
         switch(tag->primary_class) {
 ]])
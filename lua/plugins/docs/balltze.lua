@@ -532,9 +532,16 @@ function Balltze.features.importTagsFromMap(mapPath) end
 -- Clears all tag imports
 function Balltze.features.clearTagImports() end
 
--- Reloads the data of a tag
+---@class BalltzeTagDataPatchSummary
+---@field fieldsPatched integer @Number of fields which value was changed
+---@field bytesPatched integer @Number of bytes written into the existing tag data
+---@field reflexivesReallocated integer @Number of reflexives reallocated because their element count changed
+---@field dataReallocated integer @Number of data blocks reallocated because their size changed
+
+-- Reloads the data of a tag, patching only the fields that changed
 ---@param tagHandleOrPath EngineTagHandle|integer|string @The handle or path of the tag to reload
 ---@param tagClass? EngineTagClass @The class of the tag to reload
+---@return BalltzeTagDataPatchSummary @Summary of the changes applied to the tag data
 function Balltze.features.reloadTagData(tagHandleOrPath, tagClass) end
 
 -- Replace all tag references to a tag by references to another tag
@@ -561,6 +568,45 @@ function Balltze.features.getTagCopy(tagHandle, copyName) end
 ---@return EngineTagHandle|nil @The handle of the tag; nil if the tag does not exist
 function Balltze.features.getImportedTag(mapPath, tagPath, tagClass) end
 
+-- Reads the pixel data of bitmaps and the samples of sounds in the background, so the game
+-- takes them from memory instead of the disk the first time they are used
+---@param tagHandles (EngineTagHandle|integer)[] @The handles of the tags to prefetch
+---@return integer @The number of reads scheduled
+function Balltze.features.prefetchTagData(tagHandles) end
+
+---@class BalltzeTagDataPrefetchStats
+---@field hits integer @Map data reads served from the prefetch cache
+---@field misses integer @Reads of the loaded map that had to go to disk while the cache was not empty
+---@field hitRate number @Ratio of hits over all the reads counted
+---@field bytesPrefetched integer @Total bytes read in the background since the current map was loaded
+---@field cachedBytes integer @Bytes currently held by the cache
+---@field cacheSize integer @Maximum size of the cache
+---@field pendingRequests integer @Reads waiting for the background worker
+
+-- Get the statistics of the tag data prefetch cache
+---@return BalltzeTagDataPrefetchStats
+function Balltze.features.getTagDataPrefetchStats() end
+
+-- Find the objects which center is within a sphere.
+-- The positions are indexed at most once per tick, so this is much cheaper than checking every object.
+---@param center EnginePoint3D @Center of the sphere
+---@param radius number @Radius of the sphere
+---@return integer[] @Handle values of the objects found, in no particular order
+function Balltze.features.findObjectsInRadius(center, radius) end
+
+-- Find the objects which center is within an axis-aligned box
+---@param min EnginePoint3D @Corner of the box with the lowest coordinates
+---@param max EnginePoint3D @Corner of the box with the highest coordinates
+---@return integer[] @Handle values of the objects found, in no particular order
+function Balltze.features.findObjectsInBox(min, max) end
+
+-- Find the objects closest to a point
+---@param point EnginePoint3D @Point to measure the distance from
+---@param count integer @Maximum number of objects to return
+---@param maxDistance? number @Objects further than this are ignored
+---@return integer[] @Handle values of the objects found, from the closest to the furthest
+function Balltze.features.findNearestObjects(point, count, maxDistance) end
+
 -- Sets the aspect ratio of the user interface
 function Balltze.features.setUIAspectRatio(x, y) end
 
@@ -622,6 +668,58 @@ function Balltze.filesystem.getProfilesPath() end
 ---@return string @The game data path
 function Balltze.filesystem.getPluginPath() end
 
+-------------------------------------------------------
+-- Balltze.jobs
+-------------------------------------------------------
+
+Balltze.jobs = {}
+
+---@alias BalltzeJobReadFileFormat
+---| "text" @The content of the file as a string
+---| "lines" @An array with the lines of the file
+---| "json" @The file parsed as JSON
+
+---@alias BalltzeJobHashAlgorithm
+---| "fnv1a" @64-bit FNV-1a, as 16 hexadecimal characters
+---| "crc32" @CRC-32, as 8 hexadecimal characters
+
+---@alias BalltzeJobStatus
+---| "pending"
+---| "running"
+---| "completed"
+
+-- Read a file of the plugin directory in a worker thread.
+-- The callback is called during the next tick after the file is read, with the result or with nil and an error message.
+---@param path string @The path of the file to read
+---@param callback fun(result: any, error: string|nil) @Function called with the content of the file
+---@param format? BalltzeJobReadFileFormat @How to parse the file; defaults to "text"
+---@return integer @The handle of the job
+function Balltze.jobs.readFile(path, callback, format) end
+
+-- Hash a string in a worker thread
+---@param data string @The data to hash
+---@param callback fun(digest: string|nil, error: string|nil) @Function called with the hash
+---@param algorithm? BalltzeJobHashAlgorithm @The hash algorithm; defaults to "fnv1a"
+---@return integer @The handle of the job
+function Balltze.jobs.hash(data, callback, algorithm) end
+
+-- Sort an array of numbers in a worker thread. The array is copied, so it can be modified while the job runs.
+---@param numbers number[] @The numbers to sort
+---@param callback fun(numbers: number[]|nil, error: string|nil) @Function called with a new sorted array
+---@param descending? boolean @Sort from the highest to the lowest number
+---@return integer @The handle of the job
+function Balltze.jobs.sort(numbers, callback, descending) end
+
+-- Cancel a job which has not started yet; its callback will not be called
+---@param handle integer @The handle of the job
+---@return boolean @Whether the job was cancelled
+function Balltze.jobs.cancel(handle) end
+
+-- Get the status of a job
+---@param handle integer @The handle of the job
+---@return BalltzeJobStatus|nil @The status of the job, or nil if it was cancelled or its callback was already called
+function Balltze.jobs.getStatus(handle) end
+
 -------------------------------------------------------
 -- Balltze.logger
 -------------------------------------------------------
@@ -800,6 +898,40 @@ function Balltze.memory.readBit(address, bit) end
 ---@param value integer @The value to write
 function Balltze.memory.writeBit(address, bit, value) end
 
+-- Read several values from memory in a single call. The format works like the string.unpack one,
+-- with fields packed one after another: b/B (8-bit), h/H (16-bit), i[n]/I[n] (n bytes, 4 by default),
+-- j/J (64-bit), f (float), d (double) and x (skip a byte). Lowercase letters are signed; spaces are ignored.
+-- A format has at most 256 fields, and is parsed on every call, so add an offset to the address rather
+-- than padding up to the first field. The whole range is checked before reading, so an invalid address
+-- raises an error instead of crashing.
+---@param address integer @The address to read from
+---@param format string @The format of the values, e.g. "fff I2 b"
+---@return ...integer|number @The values read
+function Balltze.memory.readStruct(address, format) end
+
+-- Write several values to memory in a single call. Every value is checked first, so nothing is written
+-- if one of them is invalid.
+---@param address integer @The address to write to
+---@param format string @The format of the values; see readStruct
+---@param ... integer|number @The values to write, one per field of the format
+function Balltze.memory.writeStruct(address, format, ...) end
+
+-- Read an array of structs from memory in a single call
+---@param address integer @The address of the first element
+---@param format string @The format of an element; see readStruct
+---@param count integer @The number of elements to read
+---@param stride? integer @The distance in bytes between two elements; the size of the format by default
+---@return (integer|number)[] @The values of every element, one after another
+function Balltze.memory.readStructArray(address, format, count, stride) end
+
+-- Write an array of structs to memory in a single call. Every value is checked first, so nothing is written
+-- if one of them is invalid.
+---@param address integer @The address of the first element
+---@param format string @The format of an element; see readStruct
+---@param values (integer|number)[] @The values of every element, one after another
+---@param stride? integer @The distance in bytes between two elements; the size of the format by default
+function Balltze.memory.writeStructArray(address, format, values, stride) end
+
 -------------------------------------------------------
 -- Balltze.misc
 -------------------------------------------------------
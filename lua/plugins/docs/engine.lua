@@ -49,6 +49,34 @@ Engine.gameState = {}
 ---@return MetaEngineBaseObject|nil
 function Engine.gameState.getObject(handle, type) end
 
+---@alias EngineObjectQueryField "handle"|"tagHandle"|"type"|"team"|"player"|"position"|"centerPosition"|"velocity"|"health"|"shield"
+
+---@class EngineObjectQuery
+---@field types? EngineTagObjectType[] @Types of the objects to return; all types if nil
+---@field team? integer @Team index the objects must belong to
+---@field origin? EnginePoint3D @Center of the search sphere; requires radius
+---@field radius? number @Radius of the search sphere, compared against the center position of the objects
+---@field fields? EngineObjectQueryField[] @Fields to return; only the handles if nil
+
+---@class EngineObjectQueryResult
+---@field count integer @Number of objects found
+---@field handle? integer[] @Object handle values
+---@field tagHandle? integer[] @Tag handle values
+---@field type? integer[] @Object type values
+---@field team? integer[] @Team indices
+---@field player? integer[] @Player handle values
+---@field position? number[] @Positions, packed as x1, y1, z1, x2, y2, z2...
+---@field centerPosition? number[] @Center positions, packed as x1, y1, z1, x2, y2, z2...
+---@field velocity? number[] @Velocities, packed as x1, y1, z1, x2, y2, z2...
+---@field health? number[] @Health ratios
+---@field shield? number[] @Shield ratios
+
+-- Find the objects of the current game matching a set of filters and get the requested fields of all of them at once.
+-- This is much cheaper than calling getObject for every object, since no object proxies are created.
+---@param query? EngineObjectQuery @Filters and fields of the query
+---@return EngineObjectQueryResult
+function Engine.gameState.queryObjects(query) end
+
 -- Spawn an object
 ---@param tagHandle EngineTagHandle|integer @The tag handle of the object
 ---@param parentObjectHandle? EngineObjectHandle|integer @The handle of the parent object
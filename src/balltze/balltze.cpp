@@ -12,9 +12,11 @@
 #include "memory/memory.hpp"
 #include "output/draw_text.hpp"
 #include "output/subtitles.hpp"
+#include "output/trace.hpp"
 #include "plugins/loader.hpp"
 #include "command/command.hpp"
 #include "config/config.hpp"
+#include "logger.hpp"
 
 namespace Balltze {
     using namespace Event;
@@ -34,6 +36,11 @@ namespace Balltze {
         }
         logger.info << logger.endl;
 
+        auto log_queue_overflow = Config::get_config().get<std::string>("logger.queue_overflow");
+        if(log_queue_overflow) {
+            set_log_queue_drop_on_overflow(*log_queue_overflow == "drop");
+        }
+
         try {
             balltze_side = Memory::find_signatures();
             if(balltze_side == BALLTZE_SIDE_CLIENT) {
@@ -41,6 +48,7 @@ namespace Balltze {
                 Event::set_up_events();
                 Features::set_up_features();
                 Plugins::set_up_plugins();
+                Trace::set_up_trace();
                 set_up_commands();
                 load_commands_settings();
 
@@ -57,6 +65,7 @@ namespace Balltze {
                 Event::set_up_events();
                 Features::set_up_features();
                 Plugins::set_up_plugins();
+                Trace::set_up_trace();
                 set_up_commands();
                 load_commands_settings();
             }
@@ -94,6 +103,12 @@ BOOL WINAPI DllMain(HINSTANCE hinstDLL, DWORD fdwReason, LPVOID lpvReserved) {
             Balltze::initialize_balltze();
             break;
 
+        case DLL_PROCESS_DETACH:
+            Balltze::Trace::stop_trace();
+            Balltze::Config::flush_config_files();
+            Balltze::flush_log_files();
+            break;
+
         default:
             break;
     }
@@ -1,5 +1,6 @@
 // SPDX-License-Identifier: GPL-3.0-only
 
+#include <algorithm>
 #include <memory>
 #include <vector>
 #include <cstring>
@@ -15,8 +16,6 @@
 #include "command.hpp"
 
 namespace Balltze {
-    std::vector<std::shared_ptr<Command>> commands;
-
     CommandResult Command::call(std::size_t arg_count, const char **args) const noexcept {
         if(m_function == nullptr) {
             logger.debug("Command {} function has a null pointer", m_name);
@@ -81,21 +80,16 @@ namespace Balltze {
         if(m_name.empty()) {
             throw std::runtime_error("Cannot register command with empty name");
         }
-        for(const auto &command : commands) {
-            if(m_name == command->name()) {
-                throw std::runtime_error("Command " + m_name + " already registered!");
-            }
-        }
         auto *plugin = Plugins::get_dll_plugin(module_handle);
         m_plugin = reinterpret_cast<void *>(plugin);
         m_full_name = get_full_name();
-        commands.emplace_back(std::make_shared<Command>(*this));
+        add_command(std::make_shared<Command>(*this));
     }
 
     void Command::load_commands_settings_impl(HMODULE module_handle) {
         if(module_handle == get_current_module()) {
             auto &config = Config::get_config();
-            for(auto &command : commands) {
+            for(auto &command : get_commands()) {
                 auto command_key = std::string("commands.") + command->m_name;
                 if(command->m_plugin && command->m_plugin == nullptr) {
                     if(config.exists(command_key)) {
@@ -133,7 +127,7 @@ namespace Balltze {
 
             auto directory = plugin->directory();
             auto config = Config::Config(directory / "settings.json");
-            for(auto &command : commands) {
+            for(auto &command : get_commands()) {
                 auto command_key = std::string("commands.") + command->m_name;
                 if(command->m_plugin && command->m_plugin == reinterpret_cast<void *>(plugin)) {
                     if(config.exists(command_key)) {
@@ -169,170 +163,60 @@ namespace Balltze {
         return to_lower(module_name + "_" + this->name());
     }
 
-    std::vector<std::string> split_arguments(std::string command) noexcept {
-        // This is the vector to return.
-        std::vector<std::string> arguments;
-
-        // This value will be true if we are inside quotes, during which the word will not separate into arguments.
-        bool in_quotes = false;
-
-        // If using a backslash, add the next character to the string regardless of what it is.
-        bool escape_character = false;
-
-        // Regardless of if there were any characters, there was an argument.
-        bool allow_empty_argument = false;
-
-        // Get the command
-        std::size_t command_size = command.size();
-
-        // Get the argument
-        std::string argument;
-        for(std::size_t i = 0; i < command_size; i++) {
-            if(escape_character) {
-                escape_character = false;
-            }
-            // Escape character - this will be used to include the next character regardless of what it is
-            else if(command[i] == '\\') {
-                escape_character = true;
-                continue;
-            }
-            // If a whitespace or octotothorpe is in quotations in the argument, then it is considered part of the argument.
-            else if(command[i] == '"') {
-                in_quotes = !in_quotes;
-                allow_empty_argument = true;
-                continue;
-            }
-            else if((command[i] == ' ' || command[i] == '\r' || command[i] == '\n' || command[i] == '#') && !in_quotes) {
-                // Add argument if not empty.
-                if(argument != "" || allow_empty_argument) {
-                    arguments.push_back(argument);
-                    argument = "";
-                    allow_empty_argument = false;
-                }
-
-                // Terminate if beginning a comment.
-                if(command[i] == '#') {
-                    break;
-                }
-                continue;
-            }
-            argument += command[i];
-        }
-
-        // Add the last argument.
-        if(argument != "" || allow_empty_argument) {
-            arguments.push_back(argument);
-        }
-
-        return std::move(arguments);
-    }
-
-    std::string unsplit_arguments(const std::vector<std::string> &arguments) noexcept {
-        // This is the string to return.
-        std::string unsplit;
-
-        for(std::size_t i = 0; i < arguments.size(); i++) {
-            // This is a reference to the argument we're dealing with.
-            const std::string &argument = arguments[i];
-
-            // This will be the final string we append to the unsplit string.
-            std::string argument_final;
-
-            // Set this to true if we need to surround this argument with quotes.
-            bool surround_with_quotes = false;
-
-            // Go through each character and add them one-by-one to argument_final.
-            for(const char &c : argument) {
-                switch(c) {
-                    // Backslashes and quotation marks should be escaped.
-                    case '\\':
-                    case '"':
-                        argument_final += '\\';
-                        break;
-
-                    // If we're using spaces or octothorpes, the argument should be surrounded with quotation marks. We could escape those, but this is more readable.
-                    case '#':
-                    case ' ':
-                        surround_with_quotes = true;
-                        break;
-
-                    default:
-                        break;
-                }
-                argument_final += c;
-            }
-
-            if(surround_with_quotes) {
-                argument_final = std::string("\"") + argument_final + "\"";
-            }
-
-            unsplit += argument_final;
-
-            // Add the space to separate the next argument.
-            if(i + 1 < arguments.size()) {
-                unsplit += " ";
-            }
+    CommandResult Command::execute_command_impl(HMODULE module_handle, std::string input) {
+        std::vector<const char *> arguments;
+        split_arguments_in_place(input, arguments);
+        if(arguments.empty()) {
+            return COMMAND_RESULT_FAILED_ERROR_NOT_FOUND;
         }
-
-        return unsplit;
-    }
-
-    CommandResult Command::execute_command_impl(HMODULE module_handle, std::string command) {
-        std::vector<std::string> arguments = split_arguments(command);
+        const char *command_name = arguments[0];
         std::size_t arg_count = arguments.size() - 1;
-        std::string command_name = arguments[0];
-        arguments.erase(arguments.begin());
+        const char **args = arguments.data() + 1;
 
-        auto arguments_alloc(std::make_unique<const char *[]>(arg_count));
-        for(std::size_t i = 0; i < arg_count; i++) {
-            arguments_alloc[i] = arguments[i].data();
-        }
-        
         CommandResult res = COMMAND_RESULT_FAILED_ERROR_NOT_FOUND;
-        for(const auto command : commands) {
-            if(command->m_full_name == command_name) {
-                if(!command->plugin()) {
-                    logger.error("Could not get plugin for module handle {}", reinterpret_cast<std::uintptr_t>(module_handle));
-                    break;
-                }
+        auto command = find_command(command_name);
+        if(command) {
+            if(!command->plugin()) {
+                logger.error("Could not get plugin for module handle {}", reinterpret_cast<std::uintptr_t>(module_handle));
+                return res;
+            }
 
-                Plugins::Plugin *command_plugin = reinterpret_cast<Plugins::Plugin *>(*command->plugin());
-                Plugins::Plugin *module_plugin = Plugins::get_dll_plugin(module_handle);
-                if(module_handle == get_current_module() || command->is_public() || module_plugin == command_plugin) {
-                    res = command->call(arg_count, arguments_alloc.get());
-
-                    // Save if autosave is enabled
-                    if(command->m_autosave && res == COMMAND_RESULT_SUCCESS) {
-                        bool is_balltze_command = command_plugin == nullptr;
-                        if(is_balltze_command) {
-                            auto &config = Config::get_config();
-                            config.set(std::string("commands.") + command->m_name, unsplit_arguments(arguments));
-                            config.save();
-                        }
-                        else {
-                            auto directory = command_plugin->directory();
-                            auto config = Config::Config(directory / "settings.json");
-                            config.set(std::string("commands.") + command->m_name, unsplit_arguments(arguments));
-                            config.save();
-                        }
+            Plugins::Plugin *command_plugin = reinterpret_cast<Plugins::Plugin *>(*command->plugin());
+            Plugins::Plugin *module_plugin = Plugins::get_dll_plugin(module_handle);
+            if(module_handle == get_current_module() || command->is_public() || module_plugin == command_plugin) {
+                res = command->call(arg_count, args);
+
+                // Save if autosave is enabled
+                if(command->m_autosave && res == COMMAND_RESULT_SUCCESS) {
+                    auto value = unsplit_arguments(std::vector<std::string>(args, args + arg_count));
+                    bool is_balltze_command = command_plugin == nullptr;
+                    if(is_balltze_command) {
+                        auto &config = Config::get_config();
+                        config.set(std::string("commands.") + command->m_name, value);
+                        config.save();
+                    }
+                    else {
+                        auto directory = command_plugin->directory();
+                        auto config = Config::Config(directory / "settings.json");
+                        config.set(std::string("commands.") + command->m_name, value);
+                        config.save();
                     }
                 }
-                else {
-                    logger.warning("Plugin {} tried to call command {} from plugin {}", module_plugin->name(), command->m_name, command_plugin->name());
-                }              
-                break;
+            }
+            else {
+                logger.warning("Plugin {} tried to call command {} from plugin {}", module_plugin->name(), command->m_name, command_plugin->name());
             }
         }
 
         switch(res) {
             case CommandResult::COMMAND_RESULT_FAILED_NOT_ENOUGH_ARGUMENTS:
-                Engine::console_printf("Command %s failed: not enough arguments", command_name.c_str());
+                Engine::console_printf("Command %s failed: not enough arguments", command_name);
                 break;
             case CommandResult::COMMAND_RESULT_FAILED_TOO_MANY_ARGUMENTS:
-                Engine::console_printf("Command %s failed: too many arguments", command_name.c_str());
+                Engine::console_printf("Command %s failed: too many arguments", command_name);
                 break;
             case CommandResult::COMMAND_RESULT_FAILED_ERROR:
-                Engine::console_printf("Command %s failed: error", command_name.c_str());
+                Engine::console_printf("Command %s failed: error", command_name);
                 break;
             default:
                 break;
@@ -386,15 +270,4 @@ namespace Balltze {
         set_up_commands_tab_completion();
         set_up_commands_help();
     }
-
-    void remove_commands_from_plugin(PluginHandle plugin) {
-        for(auto it = commands.begin(); it != commands.end(); ) {
-            if((*it)->plugin() == plugin) {
-                it = commands.erase(it);
-            }
-            else {
-                ++it;
-            }
-        }
-    }
 }
@@ -3,13 +3,78 @@
 #ifndef BALLTZE__COMMAND__COMMAND_HPP
 #define BALLTZE__COMMAND__COMMAND_HPP
 
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
 #include <balltze/command.hpp>
+#include <balltze/engine/script.hpp>
 
 namespace Balltze {
     void set_up_commands();
     void set_up_commands_tab_completion();
     void set_up_commands_help();
     void remove_commands_from_plugin(PluginHandle plugin);
+
+    /**
+     * Add a command to the registry
+     * @param command   Command to add; its full name must be set
+     * @throws std::runtime_error if a command with the same full name is already registered
+     */
+    void add_command(std::shared_ptr<Command> command);
+
+    /**
+     * Find a registered command
+     * @param full_name     Full name of the command
+     * @return              Command, or nullptr if there is no such command
+     */
+    std::shared_ptr<Command> find_command(std::string_view full_name) noexcept;
+
+    /**
+     * Get the registered commands, in registration order
+     */
+    std::vector<std::shared_ptr<Command>> const &get_commands() noexcept;
+
+    /**
+     * Get the script function entries of the registered commands, sorted by name.
+     * Entries are added and removed along with their commands.
+     */
+    std::vector<std::unique_ptr<Engine::HscFunctionEntry>> const &get_commands_function_entries() noexcept;
+
+    /**
+     * Get a number that changes every time a command is added or removed
+     */
+    std::size_t get_commands_generation() noexcept;
+
+    /**
+     * Script functions of the game followed by those of the commands, for the hooks which swap them in
+     * for the lists of the game. The list is only built again when either changed.
+     */
+    class CommandsFunctionList {
+    public:
+        /**
+         * Get the list for the current list of the game
+         * @param game_entries      Script functions of the game
+         * @param game_entry_count  Number of script functions of the game
+         * @return                  Functions of the game, then those of the commands
+         */
+        std::vector<Engine::HscFunctionEntry *> &get(Engine::HscFunctionEntry **game_entries, std::size_t game_entry_count);
+
+    private:
+        std::vector<Engine::HscFunctionEntry *> m_entries;
+        Engine::HscFunctionEntry **m_game_entries = nullptr;
+        std::size_t m_game_entry_count = 0;
+        std::optional<std::size_t> m_generation;
+    };
+
+    /**
+     * Split a console command into arguments without copying them. The command is unescaped in place
+     * and each argument is terminated, so the pointers stay valid as long as the string is not modified.
+     * @param command       Console command input; overwritten with the arguments
+     * @param arguments     Vector the arguments are appended to
+     */
+    void split_arguments_in_place(std::string &command, std::vector<const char *> &arguments) noexcept;
 }
 
 #endif
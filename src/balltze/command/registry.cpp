@@ -0,0 +1,223 @@
+// SPDX-License-Identifier: GPL-3.0-only
+
+#include <algorithm>
+#include <memory>
+#include <stdexcept>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+#include <balltze/command.hpp>
+#include "command.hpp"
+
+namespace Balltze {
+    using HscFunctionEntry = Engine::HscFunctionEntry;
+
+    /** Hash for looking up commands without building a string */
+    struct CommandNameHash {
+        using is_transparent = void;
+
+        std::size_t operator()(std::string_view name) const noexcept {
+            return std::hash<std::string_view>{}(name);
+        }
+    };
+
+    static std::vector<std::shared_ptr<Command>> commands;
+    static std::unordered_map<std::string, std::shared_ptr<Command>, CommandNameHash, std::equal_to<>> commands_by_full_name;
+    static std::vector<std::unique_ptr<HscFunctionEntry>> commands_function_entries;
+    static std::size_t commands_generation = 0;
+
+    static auto find_function_entry(std::string_view name) noexcept {
+        return std::lower_bound(commands_function_entries.begin(), commands_function_entries.end(), name, [](auto const &entry, std::string_view name) {
+            return std::string_view(entry->name) < name;
+        });
+    }
+
+    void add_command(std::shared_ptr<Command> command) {
+        std::string full_name = command->full_name();
+        if(commands_by_full_name.contains(full_name)) {
+            throw std::runtime_error("Command " + full_name + " already registered!");
+        }
+
+        auto entry = std::make_unique<HscFunctionEntry>();
+        entry->return_type = Engine::HSC_DATA_TYPE_VOID;
+        entry->name = command->full_name();
+        entry->help_message = command->help();
+        entry->help_parameters = command->params_help();
+        *reinterpret_cast<std::uint16_t *>(entry->gap_72) = 0x15;
+        commands_function_entries.insert(find_function_entry(full_name), std::move(entry));
+
+        commands_by_full_name.emplace(std::move(full_name), command);
+        commands.emplace_back(std::move(command));
+        commands_generation++;
+    }
+
+    std::shared_ptr<Command> find_command(std::string_view full_name) noexcept {
+        auto it = commands_by_full_name.find(full_name);
+        if(it == commands_by_full_name.end()) {
+            return nullptr;
+        }
+        return it->second;
+    }
+
+    std::vector<std::shared_ptr<Command>> const &get_commands() noexcept {
+        return commands;
+    }
+
+    std::vector<std::unique_ptr<HscFunctionEntry>> const &get_commands_function_entries() noexcept {
+        return commands_function_entries;
+    }
+
+    std::size_t get_commands_generation() noexcept {
+        return commands_generation;
+    }
+
+    void remove_commands_from_plugin(PluginHandle plugin) {
+        auto removed = std::erase_if(commands, [plugin](auto const &command) {
+            if(command->plugin() != plugin) {
+                return false;
+            }
+            commands_function_entries.erase(find_function_entry(command->full_name()));
+            commands_by_full_name.erase(commands_by_full_name.find(std::string_view(command->full_name())));
+            return true;
+        });
+        if(removed > 0) {
+            commands_generation++;
+        }
+    }
+
+    std::vector<HscFunctionEntry *> &CommandsFunctionList::get(HscFunctionEntry **game_entries, std::size_t game_entry_count) {
+        auto generation = get_commands_generation();
+        if(game_entries != m_game_entries || game_entry_count != m_game_entry_count || m_generation != generation) {
+            auto &command_entries = get_commands_function_entries();
+            m_entries.clear();
+            m_entries.reserve(game_entry_count + command_entries.size());
+            m_entries.insert(m_entries.end(), game_entries, game_entries + game_entry_count);
+            for(auto const &entry : command_entries) {
+                m_entries.emplace_back(entry.get());
+            }
+            m_game_entries = game_entries;
+            m_game_entry_count = game_entry_count;
+            m_generation = generation;
+        }
+        return m_entries;
+    }
+
+    void split_arguments_in_place(std::string &command, std::vector<const char *> &arguments) noexcept {
+        // Unescaping only ever removes characters, so the arguments are written over the input as it is read.
+        char *data = command.data();
+        std::size_t command_size = command.size();
+        std::size_t write = 0;
+        std::size_t argument_start = 0;
+
+        // This value will be true if we are inside quotes, during which the word will not separate into arguments.
+        bool in_quotes = false;
+
+        // If using a backslash, add the next character to the string regardless of what it is.
+        bool escape_character = false;
+
+        // Regardless of if there were any characters, there was an argument.
+        bool allow_empty_argument = false;
+
+        for(std::size_t read = 0; read < command_size; read++) {
+            char c = data[read];
+            if(escape_character) {
+                escape_character = false;
+            }
+            // Escape character - this will be used to include the next character regardless of what it is
+            else if(c == '\\') {
+                escape_character = true;
+                continue;
+            }
+            // If a whitespace or octotothorpe is in quotations in the argument, then it is considered part of the argument.
+            else if(c == '"') {
+                in_quotes = !in_quotes;
+                allow_empty_argument = true;
+                continue;
+            }
+            else if((c == ' ' || c == '\r' || c == '\n' || c == '#') && !in_quotes) {
+                // Add argument if not empty.
+                if(write != argument_start || allow_empty_argument) {
+                    data[write++] = '\0';
+                    arguments.push_back(data + argument_start);
+                    argument_start = write;
+                    allow_empty_argument = false;
+                }
+
+                // Terminate if beginning a comment.
+                if(c == '#') {
+                    break;
+                }
+                continue;
+            }
+            data[write++] = c;
+        }
+
+        // Add the last argument.
+        if(write != argument_start || allow_empty_argument) {
+            data[write] = '\0';
+            arguments.push_back(data + argument_start);
+        }
+    }
+
+    std::vector<std::string> split_arguments(std::string command) noexcept {
+        std::vector<const char *> slices;
+        split_arguments_in_place(command, slices);
+
+        std::vector<std::string> arguments;
+        arguments.reserve(slices.size());
+        for(auto *argument : slices) {
+            arguments.emplace_back(argument);
+        }
+        return arguments;
+    }
+
+    std::string unsplit_arguments(const std::vector<std::string> &arguments) noexcept {
+        // This is the string to return.
+        std::string unsplit;
+
+        for(std::size_t i = 0; i < arguments.size(); i++) {
+            // This is a reference to the argument we're dealing with.
+            const std::string &argument = arguments[i];
+
+            // This will be the final string we append to the unsplit string.
+            std::string argument_final;
+
+            // Set this to true if we need to surround this argument with quotes.
+            bool surround_with_quotes = false;
+
+            // Go through each character and add them one-by-one to argument_final.
+            for(const char &c : argument) {
+                switch(c) {
+                    // Backslashes and quotation marks should be escaped.
+                    case '\\':
+                    case '"':
+                        argument_final += '\\';
+                        break;
+
+                    // If we're using spaces or octothorpes, the argument should be surrounded with quotation marks. We could escape those, but this is more readable.
+                    case '#':
+                    case ' ':
+                        surround_with_quotes = true;
+                        break;
+
+                    default:
+                        break;
+                }
+                argument_final += c;
+            }
+
+            if(surround_with_quotes) {
+                argument_final = std::string("\"") + argument_final + "\"";
+            }
+
+            unsplit += argument_final;
+
+            // Add the space to separate the next argument.
+            if(i + 1 < arguments.size()) {
+                unsplit += " ";
+            }
+        }
+
+        return unsplit;
+    }
+}
@@ -1,52 +1,35 @@
 // SPDX-License-Identifier: GPL-3.0-only
 
 #include <cstdint>
-#include <vector>
-#include <map>
 #include <balltze/engine/script.hpp>
 #include <balltze/hook.hpp>
 #include <balltze/plugin.hpp>
 #include <balltze/command.hpp>
 #include "../logger.hpp"
+#include "command.hpp"
 
 namespace Balltze {
     using HscFunctionEntry = Engine::HscFunctionEntry;
 
-    extern std::vector<std::shared_ptr<Command>> commands;
-
     static HscFunctionEntry ***entries = nullptr;
     static std::uint32_t *entry_count;
     static HscFunctionEntry **old_entries;
     static std::uint32_t old_entry_count;
 
-    static std::vector<HscFunctionEntry *> new_entries_list;
-    static std::vector<std::unique_ptr<HscFunctionEntry>> new_entries_added;
+    static CommandsFunctionList new_entries_list;
 
     static void on_tab_completion_start() {
         old_entry_count = *entry_count;
         old_entries = *entries;
 
-        new_entries_list = std::vector<HscFunctionEntry *>(old_entries, old_entries + old_entry_count);
-        for(const auto &command : commands) {
-            auto &new_command = new_entries_added.emplace_back(std::make_unique<HscFunctionEntry>());
-            new_command->return_type = Engine::HSC_DATA_TYPE_VOID;
-            new_command->name = command->full_name();
-            new_command->help_message = command->help();
-            new_command->help_parameters = command->params_help();
-            *reinterpret_cast<std::uint16_t *>(new_command->gap_72) = 0x15;
-            new_entries_list.emplace_back(new_command.get());
-        }
-
-        Memory::overwrite(entry_count, static_cast<std::uint32_t>(new_entries_list.size()));
-        Memory::overwrite(entries, new_entries_list.data());
+        auto &new_entries = new_entries_list.get(old_entries, old_entry_count);
+        Memory::overwrite(entry_count, static_cast<std::uint32_t>(new_entries.size()));
+        Memory::overwrite(entries, new_entries.data());
     }
 
     static void on_tab_completion_end() {
         Memory::overwrite(entry_count, old_entry_count);
         Memory::overwrite(entries, old_entries);
-
-        new_entries_list.clear();
-        new_entries_added.clear();
     }
 
     void set_up_commands_tab_completion() {
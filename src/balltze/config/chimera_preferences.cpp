@@ -3,41 +3,44 @@
 #include <cstring>
 #include <filesystem>
 #include <fstream>
+#include <iterator>
 #include <balltze/command.hpp>
 #include "config.hpp"
 #include "chimera_preferences.hpp"
 
 namespace Balltze::Config {
     const std::vector<std::string> *ChimeraPreferences::get_settings_for_command(const char *command) const {
-        for(auto &c : m_settings) {
-            if(std::strcmp(c.first.data(), command) == 0) {
-                return &c.second;
-            }
+        auto settings = m_settings.find(std::string_view(command));
+        if(settings == m_settings.end()) {
+            return nullptr;
         }
-        return nullptr;
+        return &settings->second;
     }
 
     void ChimeraPreferences::set_settings_for_command(const char *command, const std::vector<std::string> &settings) {
-        for(auto &c : m_settings) {
-            if(std::strcmp(c.first.data(), command) == 0) {
-                if(c.second == settings) {
-                    return;
-                }
-                m_settings.erase(m_settings.begin() + (&c - m_settings.data()));
-                break;
-            }
-        }
-        m_settings.emplace_back(command, settings);
+        m_settings.insert_or_assign(command, settings);
     }
 
     void ChimeraPreferences::load() {
-        std::ifstream config(m_path, std::ios_base::in);
-        std::string line;
-        while(std::getline(config, line)) {
-            auto slices = split_arguments(line);
-            if(!slices.empty()) {
-                m_settings.emplace_back(slices[0], std::vector<std::string>(slices.begin() + 1, slices.end()));
+        std::ifstream config(m_path, std::ios_base::in | std::ios_base::binary);
+        std::string data((std::istreambuf_iterator<char>(config)), std::istreambuf_iterator<char>());
+
+        std::size_t line_start = 0;
+        while(line_start < data.size()) {
+            auto line_end = data.find_first_of("\r\n", line_start);
+            if(line_end == std::string::npos) {
+                line_end = data.size();
+            }
+            if(line_end > line_start) {
+                auto slices = split_arguments(data.substr(line_start, line_end - line_start));
+                if(!slices.empty()) {
+                    // The first line of a command wins, like before
+                    auto command = std::move(slices[0]);
+                    slices.erase(slices.begin());
+                    m_settings.try_emplace(std::move(command), std::move(slices));
+                }
             }
+            line_start = line_end + 1;
         }
     }
 
@@ -4,8 +4,11 @@
 #define BALLTZE__CONFIG__CHIMERA_PREFERENCES_HPP
 
 #include <filesystem>
+#include <functional>
 #include <vector>
 #include <string>
+#include <string_view>
+#include <unordered_map>
 
 namespace Balltze::Config {
     class ChimeraPreferences {
@@ -35,8 +38,17 @@ namespace Balltze::Config {
         /** Path of the config file */
         std::string m_path;
 
-        /** Settings (command, settings pair) */
-        std::vector<std::pair<std::string, std::vector<std::string>>> m_settings;
+        /** Hash for looking up commands without building a string */
+        struct CommandHash {
+            using is_transparent = void;
+
+            std::size_t operator()(std::string_view command) const noexcept {
+                return std::hash<std::string_view>{}(command);
+            }
+        };
+
+        /** Settings of each command */
+        std::unordered_map<std::string, std::vector<std::string>, CommandHash, std::equal_to<>> m_settings;
 
         /** Load */
         void load();
@@ -1,15 +1,128 @@
 // SPDX-License-Identifier: GPL-3.0-only
 
+#include <chrono>
+#include <condition_variable>
 #include <fstream>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
 #include <nlohmann/json.hpp>
 #include <balltze/config.hpp>
 #include <balltze/engine.hpp>
 #include <balltze/plugin.hpp>
+#include "../logger.hpp"
 #include "config.hpp"
 
 namespace fs = std::filesystem;
 
 namespace Balltze::Config {
+    /** Time to wait for more changes before writing a config file */
+    static constexpr auto CONFIG_SAVE_DELAY = std::chrono::milliseconds(500);
+
+    /** Longest time a save can be delayed by further changes */
+    static constexpr auto CONFIG_SAVE_MAX_DELAY = std::chrono::seconds(2);
+
+    struct PendingSave {
+        std::shared_ptr<const nlohmann::json> data;
+        std::chrono::steady_clock::time_point first_save;
+        std::chrono::steady_clock::time_point deadline;
+    };
+
+    /**
+     * Saves waiting to be written. Lock order is pending_saves_mutex, then config_file_mutex;
+     * a save is taken out of the map while holding both, so loads never see a state in between.
+     */
+    struct ConfigSaves {
+        std::timed_mutex pending_saves_mutex;
+        std::condition_variable_any pending_saves_condition;
+        std::map<fs::path, PendingSave> pending_saves;
+        std::timed_mutex config_file_mutex;
+        std::once_flag save_writer_started;
+    };
+
+    /**
+     * Never destroyed; the writer thread is detached and may still wait on it after static destructors ran.
+     */
+    static ConfigSaves &config_saves() noexcept {
+        static auto *saves = new ConfigSaves();
+        return *saves;
+    }
+
+    /**
+     * Write a config file. Caller must hold config_file_mutex.
+     */
+    static void write_config_file(fs::path const &path, nlohmann::json const &data) noexcept {
+        try {
+            // Write to a temporary file first so a crash never leaves a truncated file behind
+            auto temporary_path = path;
+            temporary_path += ".tmp";
+            {
+                std::ofstream file(temporary_path, std::ios::trunc);
+                file << data.dump(4);
+                if(!file) {
+                    throw std::runtime_error("write failed");
+                }
+            }
+            fs::rename(temporary_path, path);
+        }
+        catch(std::exception &e) {
+            logger.error("Failed to save config file {}: {}", path.string(), e.what());
+        }
+    }
+
+    static void save_writer() {
+        auto &saves = config_saves();
+        std::unique_lock lock(saves.pending_saves_mutex);
+        while(true) {
+            if(saves.pending_saves.empty()) {
+                saves.pending_saves_condition.wait(lock);
+                continue;
+            }
+
+            auto next = saves.pending_saves.begin();
+            for(auto it = saves.pending_saves.begin(); it != saves.pending_saves.end(); it++) {
+                if(it->second.deadline < next->second.deadline) {
+                    next = it;
+                }
+            }
+            auto deadline = next->second.deadline;
+            if(std::chrono::steady_clock::now() < deadline) {
+                saves.pending_saves_condition.wait_until(lock, deadline);
+                continue;
+            }
+
+            auto path = next->first;
+            auto data = std::move(next->second.data);
+            std::unique_lock file_lock(saves.config_file_mutex);
+            saves.pending_saves.erase(next);
+            lock.unlock();
+            write_config_file(path, *data);
+            file_lock.unlock();
+            lock.lock();
+        }
+    }
+
+    struct ConfigChangeCallback {
+        std::size_t id;
+        std::string key;
+        std::function<void()> callback;
+    };
+
+    /**
+     * Change callbacks of the configs. They are kept out of the config objects, whose layout is part of
+     * the API; the map is never destroyed, since configs may be destroyed after it otherwise.
+     */
+    static std::unordered_map<Config const *, std::vector<ConfigChangeCallback>> &config_change_callbacks() noexcept {
+        static auto *callbacks = new std::unordered_map<Config const *, std::vector<ConfigChangeCallback>>();
+        return *callbacks;
+    }
+
+    static std::size_t config_generation = 0;
+    static std::size_t next_change_callback_id = 1;
+
     Config::Config(fs::path filepath, bool create) {
         this->filepath = filepath;
         try {
@@ -26,6 +139,7 @@ namespace Balltze::Config {
 
     Config::~Config() {
         //save();
+        config_change_callbacks().erase(this);
     }
 
     void Config::create_file() {
@@ -57,21 +171,59 @@ namespace Balltze::Config {
     }
 
     void Config::load() {
-        std::ifstream file(filepath);
-        if(!file.is_open()) {
-            throw std::runtime_error("Failed to load config file!");
+        auto &saves = config_saves();
+        std::unique_lock lock(saves.pending_saves_mutex);
+
+        // A save of this file may not have been written yet
+        auto pending_save = saves.pending_saves.find(filepath);
+        if(pending_save != saves.pending_saves.end()) {
+            config = *pending_save->second.data;
+            lock.unlock();
+        }
+        else {
+            std::lock_guard file_lock(saves.config_file_mutex);
+            lock.unlock();
+            std::ifstream file(filepath);
+            if(!file.is_open()) {
+                throw std::runtime_error("Failed to load config file!");
+            }
+            file >> config;
+            file.close();
         }
-        file >> config;
-        file.close();
+        notify_change(std::nullopt);
     }
 
     void Config::save() {
-        std::ofstream file(filepath);
-        if(!file.is_open()) {
-            throw std::runtime_error("Failed to save config file!");
+        auto &saves = config_saves();
+        auto data = std::make_shared<const nlohmann::json>(config);
+        auto now = std::chrono::steady_clock::now();
+        {
+            std::lock_guard lock(saves.pending_saves_mutex);
+            auto &pending_save = saves.pending_saves[filepath];
+            if(!pending_save.data) {
+                pending_save.first_save = now;
+            }
+            pending_save.data = std::move(data);
+            pending_save.deadline = std::min(now + CONFIG_SAVE_DELAY, pending_save.first_save + CONFIG_SAVE_MAX_DELAY);
+        }
+        std::call_once(saves.save_writer_started, [] {
+            std::thread(save_writer).detach();
+        });
+        saves.pending_saves_condition.notify_one();
+    }
+
+    void Config::flush() {
+        auto &saves = config_saves();
+        std::unique_lock lock(saves.pending_saves_mutex);
+        auto pending_save = saves.pending_saves.find(filepath);
+        if(pending_save == saves.pending_saves.end()) {
+            return;
         }
-        file << config.dump(4);
-        file.close();
+        auto data = std::move(pending_save->second.data);
+        std::lock_guard file_lock(saves.config_file_mutex);
+        saves.pending_saves.erase(pending_save);
+        lock.unlock();
+        write_config_file(filepath, *data);
     }
 
     
@@ -107,6 +259,7 @@ namespace Balltze::Config {
             }
         }
         *slice = value;
+        notify_change(key);
     }
 
     void Config::remove(std::string key) {
@@ -118,6 +271,7 @@ namespace Balltze::Config {
             if(json->contains(slice)) {
                 if(std::next(it) == key_slices.end()) {
                     json->erase(slice);
+                    notify_change(key);
                     break;
                 }
                 else {
@@ -145,6 +299,66 @@ namespace Balltze::Config {
         return true;
     }
 
+    void Config::notify_change(std::optional<std::string> key) {
+        config_generation++;
+
+        auto &all_callbacks = config_change_callbacks();
+        auto callbacks_it = all_callbacks.find(this);
+        if(callbacks_it == all_callbacks.end()) {
+            return;
+        }
+
+        auto is_prefix = [](std::string const &prefix, std::string const &key) {
+            return key.size() > prefix.size() && key.starts_with(prefix) && key[prefix.size()] == '.';
+        };
+
+        // Copy the callbacks, so they can add or remove callbacks
+        auto callbacks = callbacks_it->second;
+        for(auto &callback : callbacks) {
+            if(!key || callback.key == *key || is_prefix(callback.key, *key) || is_prefix(*key, callback.key)) {
+                callback.callback();
+            }
+        }
+    }
+
+    std::size_t Config::add_change_callback(std::string key, std::function<void()> callback) {
+        auto id = next_change_callback_id++;
+        config_change_callbacks()[this].push_back({id, key, std::move(callback)});
+        return id;
+    }
+
+    void Config::remove_change_callback(std::size_t id) noexcept {
+        auto &all_callbacks = config_change_callbacks();
+        auto callbacks = all_callbacks.find(this);
+        if(callbacks == all_callbacks.end()) {
+            return;
+        }
+        std::erase_if(callbacks->second, [id](ConfigChangeCallback const &callback) {
+            return callback.id == id;
+        });
+        if(callbacks->second.empty()) {
+            all_callbacks.erase(callbacks);
+        }
+    }
+
+    std::size_t const &Config::generation() noexcept {
+        return config_generation;
+    }
+
+    void flush_config_files() noexcept {
+        auto &saves = config_saves();
+        // The writer may have been killed while holding a lock if the process is exiting; do not hang on it
+        std::unique_lock lock(saves.pending_saves_mutex, std::chrono::seconds(1));
+        std::unique_lock file_lock(saves.config_file_mutex, std::chrono::seconds(1));
+        if(!lock.owns_lock() || !file_lock.owns_lock()) {
+            return;
+        }
+        for(auto &[path, pending_save] : saves.pending_saves) {
+            write_config_file(path, *pending_save.data);
+        }
+        saves.pending_saves.clear();
+    }
+
     std::filesystem::path get_balltze_directory() {
         try {
             auto path = Engine::get_path() / "balltze";
@@ -184,7 +398,7 @@ namespace Balltze::Config {
         return std::nullopt;
     }
 
-    Ini get_chimera_ini() noexcept {
+    Ini const &get_chimera_ini() noexcept {
         static std::unique_ptr<Ini> ini;
         if(!ini) {
             if(std::filesystem::exists("chimera.ini")) {
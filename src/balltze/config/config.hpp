@@ -16,9 +16,9 @@ namespace Balltze::Config {
     std::filesystem::path get_balltze_directory();
 
     /**
-     * Get Chimera INI config.
+     * Get Chimera INI config. It is loaded on the first call.
      */
-    Ini get_chimera_ini() noexcept;
+    Ini const &get_chimera_ini() noexcept;
 
     /**
      * Get the Balltze configs.
@@ -29,6 +29,11 @@ namespace Balltze::Config {
      * Get the Balltze gamepad configs.
      */
     std::optional<Config> get_gamepad_config();
+
+    /**
+     * Write every config file with a pending save.
+     */
+    void flush_config_files() noexcept;
 }
 
 #endif
@@ -1,30 +1,39 @@
 // SPDX-License-Identifier: GPL-3.0-only
 
+#include <algorithm>
 #include <variant>
 #include <fstream>
 #include <windows.h>
 #include <iostream>
 #include <istream>
-#include <locale>
-#include <codecvt>
+#include <iterator>
 #include <cstring>
 #include <balltze/utils.hpp>
 #include <balltze/config.hpp>
-#include "../logger.hpp"
 
 namespace Balltze::Config {
     #define BOOL_TO_STR(boolean) (boolean ? "true" : "false")
     #define STR_TO_BOOL(str) (std::strcmp(str, "1") == 0 || std::strcmp(str, "true") == 0)
 
-    static std::locale locale;
-    
+    /**
+     * Find the first value whose key is not less than the given key
+     * @param values values sorted by key
+     * @param key    key to look for
+     * @return       position of the value of the key, or where to insert it
+     */
+    template<typename Values>
+    static auto find_key(Values &values, std::string_view key) noexcept {
+        return std::lower_bound(values.begin(), values.end(), key, [](auto &value, std::string_view key) {
+            return value.first < key;
+        });
+    }
+
     const char *Ini::get_value(const char *key) const noexcept {
-        for(auto &i : this->p_values) {
-            if(i.first == key) {
-                return i.second.data();
-            }
+        auto value = find_key(this->p_values, key);
+        if(value == this->p_values.end() || value->first != key) {
+            return nullptr;
         }
-        return nullptr;
+        return value->second.c_str();
     }
 
     std::optional<std::string> Ini::get_value_string(const char *key) const noexcept {
@@ -92,31 +101,23 @@ namespace Balltze::Config {
     }
 
     void Ini::set_value(const char *key, const char *value) noexcept {
-        for(auto &i : this->p_values) {
-            if(i.first == key) {
-                i.second = value;
-                break;
-            }
-        }
-        this->p_values.emplace_back(key, value);
+        this->set_value(std::pair<std::string, std::string>(key, value));
     }
 
     void Ini::set_value(std::pair<std::string, std::string> key_value) noexcept {
-        for(auto &i : this->p_values) {
-            if(i.first == key_value.first) {
-                i.second = std::move(key_value.second);
-                break;
-            }
+        auto value = find_key(this->p_values, key_value.first);
+        if(value != this->p_values.end() && value->first == key_value.first) {
+            value->second = std::move(key_value.second);
+        }
+        else {
+            this->p_values.insert(value, std::move(key_value));
         }
-        this->p_values.emplace_back(key_value);
     }
 
     void Ini::delete_value(const char *key) noexcept {
-        for(auto &i : this->p_values) {
-            if(i.first == key) {
-                this->p_values.erase(this->p_values.begin() + (&i - this->p_values.data()));
-                break;
-            }
+        auto value = find_key(this->p_values, key);
+        if(value != this->p_values.end() && value->first == key) {
+            this->p_values.erase(value);
         }
     }
 
@@ -126,17 +127,23 @@ namespace Balltze::Config {
      * @param dflt default character to use if the conversion to ANSI fails
      * @return     false if the input string could not be decoded as UTF-8, true otherwise.
      */
-    static bool utf8_to_ansi(std::string& str, char dflt){
-        std::wstring wstr;
-        try {
-            wstr = std::wstring_convert<std::codecvt_utf8<wchar_t>>{}.from_bytes(str.data());
+    static bool utf8_to_ansi(std::string &str, char dflt) {
+        // ASCII is the same in UTF-8 and ANSI, and most values are only ASCII
+        if(std::all_of(str.begin(), str.end(), [](char c) { return static_cast<unsigned char>(c) < 0x80; })) {
+            return true;
         }
-        catch (std::range_error&){
+
+        int wide_length = MultiByteToWideChar(CP_UTF8, MB_ERR_INVALID_CHARS, str.data(), str.size(), nullptr, 0);
+        if(wide_length == 0) {
             return false;
         }
-        std::string tmp(wstr.size(), '0');
-        
-        std::use_facet<std::ctype<wchar_t>>(locale).narrow(wstr.data(), wstr.data() + wstr.size(), dflt, &tmp[0]);
+        std::wstring wstr(wide_length, L'\0');
+        MultiByteToWideChar(CP_UTF8, MB_ERR_INVALID_CHARS, str.data(), str.size(), wstr.data(), wide_length);
+
+        char default_char[2] = {dflt, '\0'};
+        int length = WideCharToMultiByte(CP_ACP, 0, wstr.data(), wide_length, nullptr, 0, default_char, nullptr);
+        std::string tmp(length, '\0');
+        WideCharToMultiByte(CP_ACP, 0, wstr.data(), wide_length, tmp.data(), length, default_char, nullptr);
         str.swap(tmp);
         return true;
     }
@@ -161,10 +168,13 @@ namespace Balltze::Config {
             line_length++;
         }
 
-        // Set new_offset, making sure it doesn't start on a line break
+        // Set new_offset to the start of the next line
         if(new_offset) {
             *new_offset = data + line_length;
-            while(**new_offset == '\r' || **new_offset == '\n') {
+            if(**new_offset == '\r') {
+                (*new_offset)++;
+            }
+            if(**new_offset == '\n') {
                 (*new_offset)++;
             }
         }
@@ -179,10 +189,10 @@ namespace Balltze::Config {
             return true;
         }
 
-        auto show_error = [&line_number, &data]() {
+        auto show_error = [&line_number, &data, &line_length]() {
             // We can't feasibly continue from this without causing undefined behavior. Abort the process after showing an error message.
             char error[1024];
-            std::snprintf(error, sizeof(error), "INI file error (line #%zu):\n\n%s\n\nThis line could not be parsed.\n", line_number, data);
+            std::snprintf(error, sizeof(error), "INI file error (line #%zu):\n\n%.*s\n\nThis line could not be parsed.\n", line_number, static_cast<int>(line_length), data);
             Balltze::show_error_box("INI error", error);
             std::exit(136);
         };
@@ -210,18 +220,17 @@ namespace Balltze::Config {
                 key = current_group + "." + std::string(data, equals_offset);
             }
 
-            // Get the value and decode it
+            // Get the value and decode it. Use ACK (0x06) for replacing invalid chars since it will be rendered as a box character in the error message
             value = std::string(data + equals_offset + 1, line_length - equals_offset - 1);
-            // Use ACK (0x06) for replacing invalid chars since it will be rendered as a box character in the error message
-            if (!utf8_to_ansi(value, '\x06')){
+            if(!utf8_to_ansi(value, '\x06')) {
                 Balltze::show_error_box("INI error", (std::string() + "Failed to decode value of '" + key + "' in INI file.\n\nMake sure the file is encoded using UTF-8.").data());
                 std::exit(136);
             }
-            else if (value.find('\x06') != std::string::npos){
+            else if(value.find('\x06') != std::string::npos) {
                 Balltze::show_error_box("INI error", (std::string() + "Invalid character in the value of '" + key + "' in INI file:\n\n" + value + "\n\nOnly characters your system can encode in ANSI are valid.").data());
                 std::exit(136);
             }
-            return std::pair(key, value);
+            return std::pair(std::move(key), std::move(value));
         }
 
         show_error();
@@ -242,43 +251,45 @@ namespace Balltze::Config {
         this->load_from_stream(stream);
     }
 
-    static bool try_to_set_locale(std::string locstr) {
-        try {
-            locale = std::locale(locstr);
-            return true;
-        }
-        catch(std::exception &e) {
-            logger.debug("Failed to set locale to \"{}\": {}.", locstr, e.what());
-            return false;
-        }
-    }
-
     void Ini::load_from_stream(std::istream &stream) {
-        if(!try_to_set_locale("")) {
-            logger.error("Config::Ini: Failed to set default locale. Setting C locale instead.");
-            if(!try_to_set_locale("C")) {
-                logger.error("Config::Ini: Failed to set C locale.");
-            }
-        }
-        
-        std::string group;
-        std::string line;
-        std::size_t no = 0;
-
         if(!stream.good()) {
             Balltze::show_error_box("INI error", "INI file could not be opened.\n\nMake sure it exists and you have permission to it.");
             std::exit(1);
         }
 
-        while(std::getline(stream, line)) {
-            auto result = digest_line(line.data(), nullptr, group, ++no);
+        std::string data((std::istreambuf_iterator<char>(stream)), std::istreambuf_iterator<char>());
+
+        // Skip the byte order mark some editors add
+        if(data.starts_with("\xEF\xBB\xBF")) {
+            data.erase(0, 3);
+        }
+
+        std::string group;
+        std::size_t no = 0;
+        const char *offset = data.c_str();
+        std::vector<std::pair<std::string, std::string>> values;
+        while(*offset) {
+            auto result = digest_line(offset, &offset, group, ++no);
             if(result.index() == 0) {
-                this->set_value(std::move(std::get<0>(result)));
+                values.emplace_back(std::move(std::get<0>(result)));
             }
             else if(std::get<1>(result) == false) {
                 this->p_values.clear();
                 return;
             }
         }
+
+        // Sort the values once instead of inserting each one in place; the last value of a key wins
+        std::stable_sort(values.begin(), values.end(), [](auto &a, auto &b) {
+            return a.first < b.first;
+        });
+        for(auto &value : values) {
+            if(!this->p_values.empty() && this->p_values.back().first == value.first) {
+                this->p_values.back().second = std::move(value.second);
+            }
+            else {
+                this->p_values.emplace_back(std::move(value));
+            }
+        }
     }
 }
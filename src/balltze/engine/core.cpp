@@ -22,7 +22,7 @@ namespace Balltze::Engine {
     std::filesystem::path get_path() {
         static std::optional<std::filesystem::path> path;
         if(!path) {
-            auto chimera_init = Config::get_chimera_ini();
+            auto &chimera_init = Config::get_chimera_ini();
             auto ini_path = chimera_init.get_value_string("halo.path");
             if(ini_path) {
                 path = *ini_path;
@@ -0,0 +1,43 @@
+// SPDX-License-Identifier: GPL-3.0-only
+
+#ifndef BALLTZE__ENGINE__SOUND_PERMUTATION_PCM_SIZE_HPP
+#define BALLTZE__ENGINE__SOUND_PERMUTATION_PCM_SIZE_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <balltze/engine/tag_definitions/sound.hpp>
+
+namespace Balltze::Engine {
+    /**
+     * Get the size of the 16-bit PCM data a permutation decodes to, checking the samples the same way the decoders do
+     * @param format            Format of the samples
+     * @param samples_size      Size of the samples
+     * @param channel_count     Number of channels
+     * @return                  Size of the decoded samples in bytes
+     */
+    inline std::size_t get_sound_permutation_pcm_size(TagDefinitions::SoundFormat format, std::size_t samples_size, std::size_t channel_count) {
+        switch(format) {
+            case TagDefinitions::SOUND_FORMAT_16_BIT_PCM:
+                if(samples_size % (sizeof(std::uint16_t) * channel_count) != 0) {
+                    throw std::runtime_error("Data length is not divisible by 2 x channel_count");
+                }
+                return samples_size;
+
+            case TagDefinitions::SOUND_FORMAT_XBOX_ADPCM: {
+                // Each channel of a block has a 4-byte header holding the first sample and 32 bytes of codes for 63 more
+                constexpr std::size_t encoded_block_size = 36;
+                constexpr std::size_t decoded_block_size = 64 * sizeof(std::int16_t);
+                if(samples_size % encoded_block_size != 0) {
+                    throw std::runtime_error("Data length is not divisible by Xbox ADPCM block size");
+                }
+                return samples_size / (channel_count * encoded_block_size) * decoded_block_size * channel_count;
+            }
+
+            default:
+                throw std::runtime_error("Invalid sound format");
+        }
+    }
+}
+
+#endif
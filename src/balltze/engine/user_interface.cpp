@@ -3,12 +3,18 @@
 #include <functional>
 #include <d3d9.h>
 #include <cmath>
+#include <cstring>
+#include <mutex>
+#include <string>
+#include <unordered_map>
 #include <invader/sound/sound_reader.hpp>
 #include <balltze/memory.hpp>
+#include <balltze/engine/map.hpp>
 #include <balltze/engine/netgame.hpp>
 #include <balltze/engine/tag_definitions/ui_widget_definition.hpp>
 #include <balltze/engine/user_interface.hpp>
 #include "../logger.hpp"
+#include "sound_permutation_pcm_size.hpp"
 
 namespace Balltze::Engine {
     WidgetEventGlobals *get_widget_event_globals() {
@@ -378,6 +384,17 @@ namespace Balltze::Engine {
         return *master_volume;
     }
 
+    struct SoundPermutationDuration {
+        TagHandle sound_tag;
+        TagDefinitions::SoundFormat format;
+        std::size_t samples_size;
+        std::chrono::milliseconds duration;
+    };
+
+    static std::mutex sound_permutation_durations_mutex;
+    static std::unordered_map<const TagDefinitions::SoundPermutation *, SoundPermutationDuration> sound_permutation_durations;
+    static std::string sound_permutation_durations_map;
+
     std::chrono::milliseconds get_sound_permutation_samples_duration(TagDefinitions::SoundPermutation *permutation) {
         if(!permutation) {
             throw std::runtime_error("Invalid permutation");
@@ -435,27 +452,48 @@ namespace Balltze::Engine {
             throw std::runtime_error("Samples not loaded yet");
         }
 
+        std::lock_guard lock(sound_permutation_durations_mutex);
+
+        // Permutations are only looked up by address, so the cache only holds the permutations of the current map
+        auto *map_name = get_map_name();
+        if(sound_permutation_durations_map != map_name) {
+            sound_permutation_durations.clear();
+            sound_permutation_durations_map = map_name;
+        }
+
+        auto cached = sound_permutation_durations.find(permutation);
+        if(cached != sound_permutation_durations.end()) {
+            auto &entry = cached->second;
+            if(entry.sound_tag == permutation->sound_tag_handle_0 && entry.format == permutation->format && entry.samples_size == permutation->samples.size) {
+                return entry.duration;
+            }
+        }
+
         try {
             auto *samples_pointer = reinterpret_cast<const std::byte *>(permutation->samples_pointer);
-            Invader::SoundReader::Sound sound_data;
+            std::chrono::milliseconds duration;
             switch(permutation->format) {
                 case TagDefinitions::SOUND_FORMAT_16_BIT_PCM: 
-                    sound_data = Invader::SoundReader::sound_from_16_bit_pcm_big_endian(samples_pointer, permutation->samples.size, channel_count, sample_rate);
-                    break;
-
-                case TagDefinitions::SOUND_FORMAT_XBOX_ADPCM:
-                    sound_data = Invader::SoundReader::sound_from_xbox_adpcm(samples_pointer, permutation->samples.size, channel_count, sample_rate);
+                case TagDefinitions::SOUND_FORMAT_XBOX_ADPCM: {
+                    // Work out the size of the decoded samples rather than decoding them
+                    auto pcm_size = get_sound_permutation_pcm_size(permutation->format, permutation->samples.size, channel_count);
+                    constexpr std::size_t bits_per_sample = 16;
+                    duration = std::chrono::milliseconds(static_cast<std::size_t>(std::ceil(static_cast<float>(pcm_size) / (bits_per_sample / 8.0f) / channel_count * 1000.0f / sample_rate)));
                     break;
+                }
 
                 case TagDefinitions::SOUND_FORMAT_OGG_VORBIS: {
                     auto duration_seconds = Invader::SoundReader::ogg_vorbis_samples_duration(samples_pointer, permutation->samples.size);
-                    return std::chrono::milliseconds(static_cast<std::size_t>(std::ceil(duration_seconds * 1000.0f)));
+                    duration = std::chrono::milliseconds(static_cast<std::size_t>(std::ceil(duration_seconds * 1000.0f)));
+                    break;
                 }
 
                 default:
                     throw std::runtime_error("Invalid sound format");
             }
-            return std::chrono::milliseconds(static_cast<std::size_t>(std::ceil(static_cast<float>(sound_data.pcm.size()) / (sound_data.bits_per_sample / 8.0f) / channel_count * 1000.0f / sound_data.sample_rate)));
+
+            sound_permutation_durations.insert_or_assign(permutation, SoundPermutationDuration { permutation->sound_tag_handle_0, permutation->format, permutation->samples.size, duration });
+            return duration;
         }
         catch(const std::runtime_error &e) {
             throw std::runtime_error("Could not get sound duration: " + std::string(e.what()));
@@ -2,10 +2,12 @@
 
 #include <chrono>
 #include <balltze/engine/core.hpp>
+#include <balltze/engine/game_state.hpp>
 #include <balltze/event.hpp>
 #include <balltze/command.hpp>
 #include <balltze/memory.hpp>
 #include <balltze/hook.hpp>
+#include <balltze/trace.hpp>
 #include "../logger.hpp"
 
 namespace Balltze::Event {
@@ -33,6 +35,12 @@ namespace Balltze::Event {
         TickEventContext args(tick_duration.count(), tick_count);
         TickEvent tick_event(EVENT_TIME_AFTER, args);
         tick_event.dispatch();
+
+        if(Trace::trace_enabled()) {
+            static Trace::TraceEvent<std::uint32_t, std::uint32_t, std::uint16_t, float> tick_trace("tick", {"tick_count", "delta_time_ms", "object_count", "dispatch_time_ms"});
+            auto dispatch_time = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - current_tick);
+            tick_trace(tick_count, tick_duration.count(), Engine::get_object_table().count, dispatch_time.count());
+        }
     }
 
     static bool debug_tick_event(int arg_count, const char **args) {
@@ -14,6 +14,8 @@ namespace Balltze::Features {
     void set_up_loading_screen() noexcept;
     void set_up_map_data_read_warden() noexcept;
     void set_up_map_textures_preloading() noexcept;
+    void set_up_tag_data_prefetch() noexcept;
+    void set_up_object_spatial_index() noexcept;
     void set_up_extended_limits();
     void set_up_echo_message_command();
     void set_up_ui_widescreen_override() noexcept;
@@ -21,10 +23,13 @@ namespace Balltze::Features {
     void set_up_extended_decriptions_fix();
     void set_up_set_console_key_binding_command() noexcept;
     void set_up_hud_meters_shader();
+    void dispatch_completed_jobs() noexcept;
+    void stop_job_workers() noexcept;
 
     inline void set_up_features() {
         try {
             set_up_echo_message_command();
+            set_up_object_spatial_index();
 
             switch(get_balltze_side()) {
                 case BALLTZE_SIDE_CLIENT: {
@@ -37,6 +42,7 @@ namespace Balltze::Features {
                     set_up_tag_data_importing();
                     set_up_loading_screen();
                     set_up_map_textures_preloading();
+                    set_up_tag_data_prefetch();
                     set_up_shader_transparent_generic_impl();
                     set_up_extended_decriptions_fix();
                     set_up_set_console_key_binding_command();
@@ -1,7 +1,9 @@
 // SPDX-License-Identifier: GPL-3.0-only
 
 #include <chrono>
+#include <map>
 #include <optional>
+#include <tuple>
 #include <balltze/config.hpp>
 #include <balltze/memory.hpp>
 #include <balltze/utils.hpp>
@@ -32,18 +34,35 @@ namespace Balltze::Features {
 
     static std::optional<Engine::GamepadButton> get_icon(HudHoldToActionMessageButton &button) {
         static auto gamepad_config = Config::get_gamepad_config();
+        static std::map<std::tuple<HudHoldToActionMessageButton::Type, std::uint16_t, HudHoldToActionMessageButton::AxisDirection>, Config::ConfigKey<int>> icon_keys;
         if(gamepad_config) {
-            if(button.type == HudHoldToActionMessageButton::BUTTON) {
-                auto button_icon = gamepad_config->get<int>("icons.button_" + std::to_string(button.index));
-                if(button_icon) {
-                    return static_cast<Engine::GamepadButton>(*button_icon);
-                }
+            static bool change_callback_added = false;
+            if(!change_callback_added) {
+                gamepad_config->add_change_callback("icons", [] {
+                    button_icons.clear();
+                });
+                change_callback_added = true;
             }
-            else if(button.type == HudHoldToActionMessageButton::AXIS) {
-                auto button_icon = gamepad_config->get<int>("icons.axis_" + std::to_string(button.index) + (button.axis_direction == HudHoldToActionMessageButton::POSITIVE ? "+" : "-"));
-                if(button_icon) {
-                    return static_cast<Engine::GamepadButton>(*button_icon);
+
+            auto key_id = std::make_tuple(button.type, button.index, button.axis_direction);
+            auto icon_key = icon_keys.find(key_id);
+            if(icon_key == icon_keys.end()) {
+                std::string key;
+                if(button.type == HudHoldToActionMessageButton::BUTTON) {
+                    key = "icons.button_" + std::to_string(button.index);
+                }
+                else if(button.type == HudHoldToActionMessageButton::AXIS) {
+                    key = "icons.axis_" + std::to_string(button.index) + (button.axis_direction == HudHoldToActionMessageButton::POSITIVE ? "+" : "-");
                 }
+                else {
+                    return std::nullopt;
+                }
+                icon_key = icon_keys.emplace(key_id, Config::ConfigKey<int>(*gamepad_config, key)).first;
+            }
+
+            auto &button_icon = icon_key->second.get();
+            if(button_icon) {
+                return static_cast<Engine::GamepadButton>(*button_icon);
             }
         }
         return std::nullopt;
@@ -0,0 +1,306 @@
+// SPDX-License-Identifier: GPL-3.0-only
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include <balltze/features/job_system.hpp>
+#include "../logger.hpp"
+
+namespace Balltze::Features {
+    enum JobState {
+        JOB_STATE_PENDING,
+        JOB_STATE_RUNNING,
+        JOB_STATE_COMPLETED,
+        JOB_STATE_CANCELLED
+    };
+
+    struct Job {
+        JobHandle handle;
+        std::function<void()> work;
+        std::function<void()> on_complete;
+        std::atomic<JobState> state = JOB_STATE_PENDING;
+    };
+
+    struct JobWorker {
+        std::mutex mutex;
+        std::deque<std::shared_ptr<Job>> jobs;
+        std::thread thread;
+
+        ~JobWorker() {
+            // Workers which were not stopped are left sleeping when the DLL is unloaded or the game exits,
+            // as destroying a joinable thread terminates the process
+            if(thread.joinable()) {
+                thread.detach();
+            }
+        }
+    };
+
+    static constexpr std::size_t MAX_JOB_WORKERS = 4;
+
+    static std::vector<std::unique_ptr<JobWorker>> job_workers;
+    static std::mutex job_workers_start_mutex;
+    static std::atomic<bool> job_workers_started = false;
+    // Workers left running at exit sleep on these, so they are never destroyed
+    static auto &job_workers_sleep_mutex = *new std::mutex();
+    static auto &job_workers_sleep_condition = *new std::condition_variable();
+    static std::size_t queued_jobs = 0;
+    static bool job_workers_stopping = false;
+    static std::atomic<std::size_t> next_job_worker = 0;
+    static thread_local std::optional<std::size_t> current_job_worker;
+
+    static std::mutex jobs_mutex;
+    static std::unordered_map<JobHandle, std::shared_ptr<Job>> jobs;
+    static std::vector<std::shared_ptr<Job>> completed_jobs;
+    static JobHandle next_job_handle = 1;
+
+    /**
+     * Take a job from the back of the queue of a worker, or from the front when stealing
+     */
+    static std::shared_ptr<Job> take_job(JobWorker &worker, bool steal) noexcept {
+        std::lock_guard lock(worker.mutex);
+        if(worker.jobs.empty()) {
+            return nullptr;
+        }
+        std::shared_ptr<Job> job;
+        if(steal) {
+            job = std::move(worker.jobs.front());
+            worker.jobs.pop_front();
+        }
+        else {
+            job = std::move(worker.jobs.back());
+            worker.jobs.pop_back();
+        }
+        return job;
+    }
+
+    static std::shared_ptr<Job> find_job(std::size_t worker_index) noexcept {
+        if(auto job = take_job(*job_workers[worker_index], false)) {
+            return job;
+        }
+        for(std::size_t i = 1; i < job_workers.size(); i++) {
+            if(auto job = take_job(*job_workers[(worker_index + i) % job_workers.size()], true)) {
+                return job;
+            }
+        }
+        return nullptr;
+    }
+
+    static void run_job(std::shared_ptr<Job> job) noexcept {
+        auto expected = JOB_STATE_PENDING;
+        if(!job->state.compare_exchange_strong(expected, JOB_STATE_RUNNING)) {
+            return;
+        }
+
+        try {
+            job->work();
+        }
+        catch(std::exception &e) {
+            logger.error("Unhandled exception in job {}: {}", job->handle, e.what());
+        }
+        catch(...) {
+            logger.error("Unhandled exception in job {}", job->handle);
+        }
+        job->work = nullptr;
+
+        std::lock_guard lock(jobs_mutex);
+        job->state = JOB_STATE_COMPLETED;
+        completed_jobs.push_back(std::move(job));
+    }
+
+    /**
+     * Cancel a job if it has not started, dropping it from the job list
+     */
+    static void drop_pending_job(std::shared_ptr<Job> const &job) noexcept {
+        auto expected = JOB_STATE_PENDING;
+        if(job->state.compare_exchange_strong(expected, JOB_STATE_CANCELLED)) {
+            std::lock_guard lock(jobs_mutex);
+            jobs.erase(job->handle);
+        }
+    }
+
+    static void job_worker(std::size_t index) noexcept {
+        current_job_worker = index;
+        while(true) {
+            auto job = find_job(index);
+            if(!job) {
+                std::unique_lock lock(job_workers_sleep_mutex);
+                job_workers_sleep_condition.wait(lock, [] { return queued_jobs > 0 || job_workers_stopping; });
+                if(job_workers_stopping) {
+                    return;
+                }
+                continue;
+            }
+            {
+                std::lock_guard lock(job_workers_sleep_mutex);
+                queued_jobs--;
+                if(job_workers_stopping) {
+                    drop_pending_job(job);
+                    return;
+                }
+            }
+            run_job(std::move(job));
+        }
+    }
+
+    static void start_job_workers() {
+        if(job_workers_started.load(std::memory_order_acquire)) {
+            return;
+        }
+        std::lock_guard lock(job_workers_start_mutex);
+        if(job_workers_started.load(std::memory_order_relaxed)) {
+            return;
+        }
+        auto worker_count = std::clamp<std::size_t>(std::thread::hardware_concurrency(), 2, MAX_JOB_WORKERS + 1) - 1;
+        for(std::size_t i = 0; i < worker_count; i++) {
+            job_workers.push_back(std::make_unique<JobWorker>());
+        }
+        for(std::size_t i = 0; i < worker_count; i++) {
+            job_workers[i]->thread = std::thread(job_worker, i);
+        }
+        job_workers_started.store(true, std::memory_order_release);
+    }
+
+    /**
+     * Stop the workers and wait for the jobs they are running; jobs which have not started are cancelled
+     * and never complete. Workers start again with the next job. This joins threads, so it must not be
+     * called from DllMain, where the loader lock is held.
+     */
+    void stop_job_workers() noexcept {
+        std::lock_guard start_lock(job_workers_start_mutex);
+        if(!job_workers_started.load(std::memory_order_relaxed)) {
+            return;
+        }
+
+        {
+            std::lock_guard lock(job_workers_sleep_mutex);
+            job_workers_stopping = true;
+        }
+        job_workers_sleep_condition.notify_all();
+
+        // Drop the jobs which have not started, so the workers only finish the ones they are running
+        for(auto &worker : job_workers) {
+            std::lock_guard lock(worker->mutex);
+            for(auto &job : worker->jobs) {
+                drop_pending_job(job);
+            }
+        }
+        for(auto &worker : job_workers) {
+            worker->thread.join();
+        }
+
+        // Jobs submitted by the last running jobs never start either
+        for(auto &worker : job_workers) {
+            for(auto &job : worker->jobs) {
+                drop_pending_job(job);
+            }
+        }
+        job_workers.clear();
+        {
+            std::lock_guard lock(job_workers_sleep_mutex);
+            queued_jobs = 0;
+            job_workers_stopping = false;
+        }
+        job_workers_started.store(false, std::memory_order_release);
+    }
+
+    JobHandle submit_job(std::function<void()> work, std::function<void()> on_complete) {
+        start_job_workers();
+
+        auto job = std::make_shared<Job>();
+        job->work = std::move(work);
+        job->on_complete = std::move(on_complete);
+        {
+            std::lock_guard lock(jobs_mutex);
+            job->handle = next_job_handle++;
+            jobs.emplace(job->handle, job);
+        }
+        auto handle = job->handle;
+
+        auto worker_index = current_job_worker.value_or(next_job_worker++ % job_workers.size());
+        auto &worker = *job_workers[worker_index];
+        {
+            std::lock_guard lock(worker.mutex);
+            worker.jobs.push_back(std::move(job));
+        }
+        {
+            std::lock_guard lock(job_workers_sleep_mutex);
+            queued_jobs++;
+        }
+        job_workers_sleep_condition.notify_one();
+        return handle;
+    }
+
+    bool cancel_job(JobHandle handle) noexcept {
+        std::lock_guard lock(jobs_mutex);
+        auto it = jobs.find(handle);
+        if(it == jobs.end()) {
+            return false;
+        }
+        auto expected = JOB_STATE_PENDING;
+        if(!it->second->state.compare_exchange_strong(expected, JOB_STATE_CANCELLED)) {
+            return false;
+        }
+        // The job stays in the queue of its worker, which drops it when it comes up
+        jobs.erase(it);
+        return true;
+    }
+
+    std::optional<JobStatus> get_job_status(JobHandle handle) noexcept {
+        std::lock_guard lock(jobs_mutex);
+        auto it = jobs.find(handle);
+        if(it == jobs.end()) {
+            return std::nullopt;
+        }
+        switch(it->second->state.load()) {
+            case JOB_STATE_PENDING:
+                return JOB_STATUS_PENDING;
+            case JOB_STATE_RUNNING:
+                return JOB_STATUS_RUNNING;
+            case JOB_STATE_COMPLETED:
+                return JOB_STATUS_COMPLETED;
+            default:
+                return std::nullopt;
+        }
+    }
+
+    std::size_t get_job_worker_count() noexcept {
+        start_job_workers();
+        return job_workers.size();
+    }
+
+    void dispatch_completed_jobs() noexcept {
+        std::vector<std::shared_ptr<Job>> finished_jobs;
+        {
+            std::lock_guard lock(jobs_mutex);
+            if(completed_jobs.empty()) {
+                return;
+            }
+            finished_jobs.swap(completed_jobs);
+            for(auto &job : finished_jobs) {
+                jobs.erase(job->handle);
+            }
+        }
+
+        // Completion functions are called in the order the jobs finished
+        for(auto &job : finished_jobs) {
+            if(!job->on_complete) {
+                continue;
+            }
+            try {
+                job->on_complete();
+            }
+            catch(std::exception &e) {
+                logger.error("Unhandled exception in completion function of job {}: {}", job->handle, e.what());
+            }
+            catch(...) {
+                logger.error("Unhandled exception in completion function of job {}", job->handle);
+            }
+        }
+    }
+}
@@ -1,24 +1,51 @@
 // SPDX-License-Identifier: GPL-3.0-only
 
+#include <algorithm>
 #include <chrono>
+#include <string_view>
+#include <balltze/events/frame.hpp>
 #include <balltze/events/map_load.hpp>
 #include <balltze/engine/tag.hpp>
+#include <balltze/engine/tag_definitions.hpp>
 #include <balltze/engine/rasterizer.hpp>
 #include <balltze/memory.hpp>
 #include "../config/config.hpp"
 #include "../logger.hpp"
+#include "map_textures_preloading.hpp"
 
 namespace Balltze::Features {
     using namespace Engine;
 
     static bool preload_map_textures = false;
     static std::size_t min_map_size;
+    static std::chrono::microseconds frame_budget;
+    static std::chrono::steady_clock::time_point preload_start;
+    static TexturePreloadScheduler scheduler([](TagDefinitions::BitmapData *bitmap_data) {
+        load_bitmap_data_texture(bitmap_data, true, true);
+    });
+
+    static TexturePreloadPriority get_bitmap_priority(std::string_view tag_path, std::string_view scenario_directory) noexcept {
+        // HUD and first person bitmaps are on screen as soon as the player spawns
+        for(auto keyword : {"\\hud\\", "ui\\hud", "\\fp\\", "first person", "first_person"}) {
+            if(tag_path.find(keyword) != std::string_view::npos) {
+                return TEXTURE_PRELOAD_PRIORITY_HUD;
+            }
+        }
+
+        // Bitmaps stored next to the scenario are usually the level ones, which are visible around the spawn
+        if(!scenario_directory.empty() && tag_path.substr(0, scenario_directory.size()) == scenario_directory) {
+            return TEXTURE_PRELOAD_PRIORITY_SCENARIO;
+        }
+
+        return TEXTURE_PRELOAD_PRIORITY_OTHER;
+    }
 
     static void on_map_file_load(Event::MapFileLoadEvent &event) {
         if(event.time == Event::EVENT_TIME_BEFORE) {
+            scheduler.clear();
             if(event.context.map_name != "ui") {
                 auto map_size = std::filesystem::file_size(event.context.map_path);
-                preload_map_textures = map_size > MIB_SIZE * 384;
+                preload_map_textures = map_size > MIB_SIZE * min_map_size;
             }
             else {
                 preload_map_textures = false;
@@ -28,27 +55,41 @@ namespace Balltze::Features {
 
     static void on_map_load(Event::MapLoadEvent &event) {
         if(event.time == Event::EVENT_TIME_AFTER && preload_map_textures) {
-            logger.info("Preloading map textures...");
-            auto start = std::chrono::steady_clock::now();
-            std::size_t count = 0;
-            auto &tag_data_address = get_tag_data_header();
-            for(std::size_t i = 0; i < tag_data_address.tag_count; i++) {
-                auto &tag = tag_data_address.tag_array[i];
+            auto &tag_data_header = get_tag_data_header();
+
+            std::string_view scenario_directory;
+            auto *scenario_tag = get_tag(tag_data_header.scenario_tag);
+            if(scenario_tag && scenario_tag->path) {
+                scenario_directory = scenario_tag->path;
+                scenario_directory = scenario_directory.substr(0, scenario_directory.rfind('\\') + 1);
+            }
+
+            for(std::size_t i = 0; i < tag_data_header.tag_count; i++) {
+                auto &tag = tag_data_header.tag_array[i];
                 if(tag.indexed) {
                     continue;
                 }
                 if(tag.primary_class == TAG_CLASS_BITMAP) {
+                    auto priority = get_bitmap_priority(tag.path ? tag.path : "", scenario_directory);
                     auto *bitmap = reinterpret_cast<TagDefinitions::Bitmap *>(tag.data);
                     for(std::size_t j = 0; j < bitmap->bitmap_data.count; j++) {
-                        auto &bitmap_data = bitmap->bitmap_data.elements[j];
-                        load_bitmap_data_texture(&bitmap_data, true, true);
-                        count++;
+                        scheduler.enqueue(&bitmap->bitmap_data.elements[j], priority);
                     }
                 }
             }
-            auto end = std::chrono::steady_clock::now();
-            auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(end - start);
-            logger.debug("Loaded {} textures in {} ms", count, duration.count());
+
+            logger.info("Preloading {} map textures...", scheduler.pending());
+            preload_start = std::chrono::steady_clock::now();
+        }
+    }
+
+    static void on_frame(Event::FrameEvent &event) {
+        if(event.time == Event::EVENT_TIME_BEFORE && scheduler.pending() > 0) {
+            scheduler.run(frame_budget);
+            if(scheduler.pending() == 0) {
+                auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - preload_start);
+                logger.debug("Loaded {} textures in {} ms", scheduler.loaded(), duration.count());
+            }
         }
     }
 
@@ -60,8 +101,11 @@ namespace Balltze::Features {
             auto enable = config.get<bool>("preload_map_textures.enable").value_or(false);
             if(enable) {
                 min_map_size = config.get<std::size_t>("preload_map_textures.min_map_size").value_or(384);
+                auto frame_budget_ms = config.get<float>("preload_map_textures.frame_budget").value_or(4.0f);
+                frame_budget = std::chrono::microseconds(static_cast<std::int64_t>(frame_budget_ms * 1000.0f));
                 Event::MapLoadEvent::subscribe(on_map_load, Event::EVENT_PRIORITY_LOWEST);
                 Event::MapFileLoadEvent::subscribe(on_map_file_load, Event::EVENT_PRIORITY_LOWEST);
+                Event::FrameEvent::subscribe(on_frame);
             }
             map_textures_preloading_listener.remove();
         });
@@ -0,0 +1,80 @@
+// SPDX-License-Identifier: GPL-3.0-only
+
+#ifndef BALLTZE__FEATURES__MAP_TEXTURES_PRELOADING_HPP
+#define BALLTZE__FEATURES__MAP_TEXTURES_PRELOADING_HPP
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+namespace Balltze::Engine::TagDefinitions {
+    struct BitmapData;
+}
+
+namespace Balltze::Features {
+    enum TexturePreloadPriority : std::uint8_t {
+        TEXTURE_PRELOAD_PRIORITY_HUD = 0,
+        TEXTURE_PRELOAD_PRIORITY_SCENARIO,
+        TEXTURE_PRELOAD_PRIORITY_OTHER
+    };
+
+    /**
+     * Queue of bitmaps to be uploaded a few at a time, within a time budget per call.
+     * The loader and the clock are injected, so the scheduling does not depend on the engine.
+     */
+    class TexturePreloadScheduler {
+    public:
+        using Loader = std::function<void(Engine::TagDefinitions::BitmapData *)>;
+        using Clock = std::function<std::chrono::steady_clock::time_point()>;
+
+        TexturePreloadScheduler(Loader loader, Clock clock = std::chrono::steady_clock::now);
+
+        /**
+         * Add a bitmap to the queue
+         * @param bitmap_data   Bitmap to load
+         * @param priority      Lower values are loaded first
+         */
+        void enqueue(Engine::TagDefinitions::BitmapData *bitmap_data, TexturePreloadPriority priority);
+
+        /**
+         * Load queued bitmaps in priority order until the budget runs out.
+         * At least one bitmap is loaded per call, so the queue always makes progress.
+         * @param budget    Time available for this call
+         * @return          Number of bitmaps loaded
+         */
+        std::size_t run(std::chrono::microseconds budget);
+
+        /**
+         * Drop every queued bitmap
+         */
+        void clear() noexcept;
+
+        /**
+         * Get the number of bitmaps waiting to be loaded
+         */
+        std::size_t pending() const noexcept;
+
+        /**
+         * Get the number of bitmaps loaded since the last clear
+         */
+        std::size_t loaded() const noexcept;
+
+    private:
+        struct Entry {
+            Engine::TagDefinitions::BitmapData *bitmap_data;
+            TexturePreloadPriority priority;
+            std::size_t sequence;
+        };
+
+        Loader m_loader;
+        Clock m_clock;
+        std::vector<Entry> m_queue;
+        std::size_t m_next_sequence = 0;
+        std::size_t m_loaded = 0;
+        bool m_sorted = true;
+    };
+}
+
+#endif
@@ -0,0 +1,61 @@
+// SPDX-License-Identifier: GPL-3.0-only
+
+#include <algorithm>
+#include <utility>
+#include "map_textures_preloading.hpp"
+
+namespace Balltze::Features {
+    using namespace Engine;
+
+    TexturePreloadScheduler::TexturePreloadScheduler(Loader loader, Clock clock) : m_loader(std::move(loader)), m_clock(std::move(clock)) {}
+
+    void TexturePreloadScheduler::enqueue(TagDefinitions::BitmapData *bitmap_data, TexturePreloadPriority priority) {
+        m_queue.push_back({bitmap_data, priority, m_next_sequence++});
+        m_sorted = false;
+    }
+
+    std::size_t TexturePreloadScheduler::run(std::chrono::microseconds budget) {
+        if(m_queue.empty()) {
+            return 0;
+        }
+
+        // Keep the next bitmap to load at the back of the queue
+        if(!m_sorted) {
+            std::sort(m_queue.begin(), m_queue.end(), [](Entry const &a, Entry const &b) {
+                if(a.priority != b.priority) {
+                    return a.priority > b.priority;
+                }
+                return a.sequence > b.sequence;
+            });
+            m_sorted = true;
+        }
+
+        auto deadline = m_clock() + budget;
+        std::size_t count = 0;
+        do {
+            auto entry = m_queue.back();
+            m_queue.pop_back();
+            m_loader(entry.bitmap_data);
+            count++;
+        }
+        while(!m_queue.empty() && m_clock() < deadline);
+
+        m_loaded += count;
+        return count;
+    }
+
+    void TexturePreloadScheduler::clear() noexcept {
+        m_queue.clear();
+        m_next_sequence = 0;
+        m_loaded = 0;
+        m_sorted = true;
+    }
+
+    std::size_t TexturePreloadScheduler::pending() const noexcept {
+        return m_queue.size();
+    }
+
+    std::size_t TexturePreloadScheduler::loaded() const noexcept {
+        return m_loaded;
+    }
+}
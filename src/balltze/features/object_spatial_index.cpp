@@ -0,0 +1,254 @@
+// SPDX-License-Identifier: GPL-3.0-only
+
+#include <algorithm>
+#include <cmath>
+#include <optional>
+#include <unordered_map>
+#include <balltze/engine/core.hpp>
+#include <balltze/engine/game_state.hpp>
+#include <balltze/events/map_load.hpp>
+#include <balltze/features/object_spatial_index.hpp>
+#include <balltze/math.hpp>
+
+namespace Balltze::Features {
+    using namespace Engine;
+
+    /** Size of the grid cells in world units */
+    static constexpr float CELL_SIZE = 4.0f;
+
+    /** Cost of looking up a grid cell, in objects checked */
+    static constexpr std::uint64_t CELL_LOOKUP_COST = 8;
+
+    /** Cell coordinates are packed in 21 bits per axis */
+    static constexpr std::int32_t CELL_COORDINATE_LIMIT = (1 << 20) - 1;
+
+    struct IndexedObject {
+        std::uint64_t cell;
+        ObjectHandle handle;
+        Point3D position;
+    };
+
+    struct CellCoordinates {
+        std::int32_t x;
+        std::int32_t y;
+        std::int32_t z;
+    };
+
+    static std::vector<IndexedObject> indexed_objects;
+    static std::unordered_map<std::uint64_t, std::pair<std::size_t, std::size_t>> grid_cells;
+    static CellCoordinates min_cell;
+    static CellCoordinates max_cell;
+    static Point3D min_position;
+    static Point3D max_position;
+    static std::optional<std::size_t> indexed_tick;
+
+    static std::int32_t get_cell_coordinate(float value) noexcept {
+        auto coordinate = std::floor(value / CELL_SIZE);
+        if(!std::isfinite(coordinate)) {
+            // NaN is rejected by the queries; infinite bounds reach the edge of the grid
+            return std::signbit(coordinate) ? -CELL_COORDINATE_LIMIT : CELL_COORDINATE_LIMIT;
+        }
+        return static_cast<std::int32_t>(std::clamp(coordinate, static_cast<float>(-CELL_COORDINATE_LIMIT), static_cast<float>(CELL_COORDINATE_LIMIT)));
+    }
+
+    static bool has_nan(Point3D const &point) noexcept {
+        return std::isnan(point.x) || std::isnan(point.y) || std::isnan(point.z);
+    }
+
+    static CellCoordinates get_cell(Point3D const &point) noexcept {
+        return {get_cell_coordinate(point.x), get_cell_coordinate(point.y), get_cell_coordinate(point.z)};
+    }
+
+    static std::uint64_t get_cell_key(std::int32_t x, std::int32_t y, std::int32_t z) noexcept {
+        constexpr std::uint64_t mask = (1 << 21) - 1;
+        return (static_cast<std::uint64_t>(x) & mask) | ((static_cast<std::uint64_t>(y) & mask) << 21) | ((static_cast<std::uint64_t>(z) & mask) << 42);
+    }
+
+    /**
+     * Rebuild the grid from the object table if it has not been built during the current tick
+     */
+    static void update_index() {
+        auto tick = get_tick_count();
+        if(indexed_tick == tick) {
+            return;
+        }
+        indexed_tick = tick;
+
+        indexed_objects.clear();
+        grid_cells.clear();
+
+        auto &object_table = get_object_table();
+        for(std::size_t i = 0; i < object_table.current_size; i++) {
+            auto &entry = object_table.first_element[i];
+            if(entry.id == 0 || !entry.object) {
+                continue;
+            }
+            auto &position = entry.object->center_position;
+            if(!std::isfinite(position.x) || !std::isfinite(position.y) || !std::isfinite(position.z)) {
+                continue;
+            }
+            auto cell = get_cell(position);
+            ObjectHandle handle;
+            handle.index = i;
+            handle.id = entry.id;
+            indexed_objects.push_back({get_cell_key(cell.x, cell.y, cell.z), handle, position});
+
+            if(indexed_objects.size() == 1) {
+                min_cell = max_cell = cell;
+                min_position = max_position = position;
+            }
+            else {
+                min_cell = {std::min(min_cell.x, cell.x), std::min(min_cell.y, cell.y), std::min(min_cell.z, cell.z)};
+                max_cell = {std::max(max_cell.x, cell.x), std::max(max_cell.y, cell.y), std::max(max_cell.z, cell.z)};
+                min_position = {std::min(min_position.x, position.x), std::min(min_position.y, position.y), std::min(min_position.z, position.z)};
+                max_position = {std::max(max_position.x, position.x), std::max(max_position.y, position.y), std::max(max_position.z, position.z)};
+            }
+        }
+
+        // Objects of the same cell are stored next to each other, so a cell is just a range of the array
+        std::sort(indexed_objects.begin(), indexed_objects.end(), [](IndexedObject const &a, IndexedObject const &b) {
+            return a.cell < b.cell;
+        });
+        for(std::size_t begin = 0; begin < indexed_objects.size();) {
+            auto end = begin + 1;
+            while(end < indexed_objects.size() && indexed_objects[end].cell == indexed_objects[begin].cell) {
+                end++;
+            }
+            grid_cells.emplace(indexed_objects[begin].cell, std::make_pair(begin, end));
+            begin = end;
+        }
+    }
+
+    /**
+     * Call a function for every indexed object in the cells overlapping a box
+     */
+    template<typename Visitor>
+    static void visit_cells(Point3D const &min, Point3D const &max, Visitor visit) {
+        update_index();
+        if(indexed_objects.empty()) {
+            return;
+        }
+
+        auto first = get_cell(min);
+        auto last = get_cell(max);
+        first = {std::max(first.x, min_cell.x), std::max(first.y, min_cell.y), std::max(first.z, min_cell.z)};
+        last = {std::min(last.x, max_cell.x), std::min(last.y, max_cell.y), std::min(last.z, max_cell.z)};
+        if(first.x > last.x || first.y > last.y || first.z > last.z) {
+            return;
+        }
+
+        // Looking up a cell costs about as much as checking a handful of objects, so past a few cells
+        // per object walking every object is cheaper
+        auto cell_count = static_cast<std::uint64_t>(last.x - first.x + 1) * (last.y - first.y + 1) * (last.z - first.z + 1);
+        if(cell_count * CELL_LOOKUP_COST > indexed_objects.size()) {
+            for(auto &object : indexed_objects) {
+                visit(object);
+            }
+            return;
+        }
+
+        for(auto x = first.x; x <= last.x; x++) {
+            for(auto y = first.y; y <= last.y; y++) {
+                for(auto z = first.z; z <= last.z; z++) {
+                    auto cell = grid_cells.find(get_cell_key(x, y, z));
+                    if(cell == grid_cells.end()) {
+                        continue;
+                    }
+                    for(auto i = cell->second.first; i < cell->second.second; i++) {
+                        visit(indexed_objects[i]);
+                    }
+                }
+            }
+        }
+    }
+
+    std::vector<ObjectHandle> find_objects_in_radius(Point3D const &center, float radius) {
+        std::vector<ObjectHandle> objects;
+        if(!(radius >= 0.0f) || has_nan(center)) {
+            return objects;
+        }
+        auto radius_squared = radius * radius;
+        Point3D min = {center.x - radius, center.y - radius, center.z - radius};
+        Point3D max = {center.x + radius, center.y + radius, center.z + radius};
+        visit_cells(min, max, [&](IndexedObject const &object) {
+            if(Math::distance_squared(object.position, center) <= radius_squared) {
+                objects.push_back(object.handle);
+            }
+        });
+        return objects;
+    }
+
+    std::vector<ObjectHandle> find_objects_in_box(Point3D const &min, Point3D const &max) {
+        std::vector<ObjectHandle> objects;
+        if(has_nan(min) || has_nan(max)) {
+            return objects;
+        }
+        visit_cells(min, max, [&](IndexedObject const &object) {
+            auto &position = object.position;
+            if(position.x >= min.x && position.x <= max.x && position.y >= min.y && position.y <= max.y && position.z >= min.z && position.z <= max.z) {
+                objects.push_back(object.handle);
+            }
+        });
+        return objects;
+    }
+
+    std::vector<ObjectHandle> find_nearest_objects(Point3D const &point, std::size_t count, float max_distance) {
+        std::vector<ObjectHandle> objects;
+        update_index();
+        if(count == 0 || indexed_objects.empty() || !(max_distance >= 0.0f) || has_nan(point)) {
+            return objects;
+        }
+
+        // Distance from the point to the furthest corner of the indexed objects bounds; no object is further than this
+        auto reach_x = std::max(std::abs(point.x - min_position.x), std::abs(point.x - max_position.x));
+        auto reach_y = std::max(std::abs(point.y - min_position.y), std::abs(point.y - max_position.y));
+        auto reach_z = std::max(std::abs(point.z - min_position.z), std::abs(point.z - max_position.z));
+        auto reach = std::sqrt(reach_x * reach_x + reach_y * reach_y + reach_z * reach_z);
+
+        // Start with the radius that would hold the objects asked for if they were spread evenly
+        // over the indexed bounds, so sparse maps do not take a pass for every doubling
+        auto size_x = std::max(max_position.x - min_position.x, CELL_SIZE);
+        auto size_y = std::max(max_position.y - min_position.y, CELL_SIZE);
+        auto size_z = std::max(max_position.z - min_position.z, CELL_SIZE);
+        auto volume_per_object = size_x * size_y * size_z / indexed_objects.size();
+        auto radius = std::max(CELL_SIZE, std::cbrt(volume_per_object * count * 3.0f / (4.0f * static_cast<float>(PI))));
+
+        // Grow the search radius until it holds enough objects. Every object outside the radius
+        // is further than every object inside, so the closest ones are always among the candidates.
+        std::vector<std::pair<float, ObjectHandle>> candidates;
+        while(true) {
+            radius = std::min(radius, max_distance);
+            candidates.clear();
+            auto radius_squared = radius * radius;
+            Point3D min = {point.x - radius, point.y - radius, point.z - radius};
+            Point3D max = {point.x + radius, point.y + radius, point.z + radius};
+            visit_cells(min, max, [&](IndexedObject const &object) {
+                auto distance_squared = Math::distance_squared(object.position, point);
+                if(distance_squared <= radius_squared) {
+                    candidates.emplace_back(distance_squared, object.handle);
+                }
+            });
+            if(candidates.size() >= count || radius >= max_distance || radius >= reach) {
+                break;
+            }
+            radius *= 2.0f;
+        }
+
+        count = std::min(count, candidates.size());
+        std::partial_sort(candidates.begin(), candidates.begin() + count, candidates.end(), [](auto const &a, auto const &b) {
+            return a.first < b.first;
+        });
+        objects.reserve(count);
+        for(std::size_t i = 0; i < count; i++) {
+            objects.push_back(candidates[i].second);
+        }
+        return objects;
+    }
+
+    void set_up_object_spatial_index() noexcept {
+        // The tick count starts over with every map
+        Event::MapLoadEvent::subscribe_const([](Event::MapLoadEvent const &event) {
+            indexed_tick = std::nullopt;
+        });
+    }
+}
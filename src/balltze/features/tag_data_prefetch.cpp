@@ -0,0 +1,130 @@
+// SPDX-License-Identifier: GPL-3.0-only
+
+#include <windows.h>
+#include <filesystem>
+#include <string>
+#include <balltze/command.hpp>
+#include <balltze/engine/tag.hpp>
+#include <balltze/engine/tag_definitions.hpp>
+#include <balltze/events/map_load.hpp>
+#include <balltze/features/tag_data_prefetch.hpp>
+#include "../config/config.hpp"
+#include "../logger.hpp"
+#include "tags_handling/tags_handling.hpp"
+#include "tag_data_prefetch_cache.hpp"
+
+namespace Balltze::Features {
+    namespace fs = std::filesystem;
+    using namespace Engine;
+
+    static std::string current_map_file_name;
+
+    // The worker can be reading into the cache when the game exits, so the cache is never destroyed
+    static TagDataPrefetchCache &prefetch_cache() noexcept {
+        static auto *cache = new TagDataPrefetchCache(64 * MIB_SIZE);
+        return *cache;
+    }
+
+    std::size_t prefetch_tag_data(std::vector<TagHandle> const &tag_handles) {
+        auto &cache = prefetch_cache();
+        cache.start_worker();
+
+        std::size_t scheduled = 0;
+        for(auto &tag_handle : tag_handles) {
+            auto *tag = get_tag(tag_handle);
+            if(!tag || tag->indexed) {
+                continue;
+            }
+            switch(tag->primary_class) {
+                case TAG_CLASS_BITMAP: {
+                    auto *bitmap = tag->get_data<TagDefinitions::Bitmap>();
+                    for(std::size_t i = 0; i < bitmap->bitmap_data.count; i++) {
+                        auto &bitmap_data = bitmap->bitmap_data.elements[i];
+                        if(!bitmap_data.flags.external && cache.request(bitmap_data.pixel_data_offset, bitmap_data.pixel_data_size, get_map_data_location)) {
+                            scheduled++;
+                        }
+                    }
+                    break;
+                }
+                case TAG_CLASS_SOUND: {
+                    auto *sound = tag->get_data<TagDefinitions::Sound>();
+                    for(std::size_t i = 0; i < sound->pitch_ranges.count; i++) {
+                        auto &pitch_range = sound->pitch_ranges.elements[i];
+                        for(std::size_t j = 0; j < pitch_range.permutations.count; j++) {
+                            auto &samples = pitch_range.permutations.elements[j].samples;
+                            if(!(samples.external & 1) && cache.request(samples.file_offset, samples.size, get_map_data_location)) {
+                                scheduled++;
+                            }
+                        }
+                    }
+                    break;
+                }
+                default:
+                    break;
+            }
+        }
+        cache.notify_worker();
+        return scheduled;
+    }
+
+    TagDataPrefetchStats get_tag_data_prefetch_stats() noexcept {
+        auto cache_stats = prefetch_cache().stats();
+        TagDataPrefetchStats stats;
+        stats.hits = cache_stats.hits;
+        stats.misses = cache_stats.misses;
+        stats.bytes_prefetched = cache_stats.bytes_prefetched;
+        stats.cached_bytes = cache_stats.cached_bytes;
+        stats.cache_size = cache_stats.cache_size;
+        stats.pending_requests = cache_stats.pending_requests;
+        return stats;
+    }
+
+    static void on_map_file_load(Event::MapFileLoadEvent const &event) {
+        if(event.time == Event::EVENT_TIME_BEFORE) {
+            prefetch_cache().reset();
+            current_map_file_name = fs::path(event.context.map_path).stem().string();
+        }
+    }
+
+    static void on_read_map_file_data(Event::MapFileDataReadEvent &event) {
+        if(event.time != Event::EVENT_TIME_BEFORE || event.context.size == 0) {
+            return;
+        }
+
+        auto &cache = prefetch_cache();
+        if(cache.empty()) {
+            return;
+        }
+
+        // Only reads from the loaded map are cached; reads from the resource maps are neither hits nor misses
+        char file_path_chars[MAX_PATH + 1] = {};
+        GetFinalPathNameByHandle(event.context.file_handle, file_path_chars, sizeof(file_path_chars) - 1, VOLUME_NAME_NONE);
+        if(fs::path(file_path_chars).stem().string() != current_map_file_name) {
+            return;
+        }
+
+        if(cache.read(event.context.overlapped->Offset, event.context.size, event.context.output_buffer)) {
+            event.context.size = 0;
+        }
+    }
+
+    void set_up_tag_data_prefetch() noexcept {
+        auto cache_size = Config::get_config().get<std::size_t>("tag_data_prefetch.cache_size");
+        if(cache_size) {
+            prefetch_cache().set_cache_size(*cache_size * MIB_SIZE);
+        }
+
+        Event::MapFileLoadEvent::subscribe_const(on_map_file_load, Event::EVENT_PRIORITY_HIGHEST);
+        Event::MapFileDataReadEvent::subscribe(on_read_map_file_data, Event::EVENT_PRIORITY_ABOVE_DEFAULT);
+
+        register_command("tag_data_prefetch_info", "debug", "Prints the statistics of the tag data prefetch cache.", std::nullopt, [](int arg_count, const char **args) -> bool {
+            auto stats = get_tag_data_prefetch_stats();
+            Engine::console_print("Tag data prefetch summary");
+            Engine::console_printf("Hits: %zu, misses: %zu (%.1f%% hit rate)", stats.hits, stats.misses, stats.hit_rate() * 100.0f);
+            Engine::console_printf("Prefetched data: %.2f MiB", static_cast<float>(stats.bytes_prefetched) / MIB_SIZE);
+            Engine::console_printf("Cache usage: %.2f MiB / %.2f MiB", static_cast<float>(stats.cached_bytes) / MIB_SIZE, static_cast<float>(stats.cache_size) / MIB_SIZE);
+            Engine::console_printf("Pending reads: %zu", stats.pending_requests);
+            return true;
+        }, false, 0, 0);
+    }
+}
@@ -0,0 +1,174 @@
+// SPDX-License-Identifier: GPL-3.0-only
+
+#include <cstdio>
+#include <cstring>
+#include "tag_data_prefetch_cache.hpp"
+
+namespace Balltze::Features {
+    TagDataPrefetchCache::TagDataPrefetchCache(std::size_t cache_size, Reader reader) : m_reader(std::move(reader)), m_cache_size(cache_size) {}
+
+    TagDataPrefetchCache::~TagDataPrefetchCache() {
+        stop_worker();
+    }
+
+    void TagDataPrefetchCache::set_cache_size(std::size_t cache_size) noexcept {
+        std::lock_guard lock(m_mutex);
+        m_cache_size = cache_size;
+    }
+
+    bool TagDataPrefetchCache::request(std::size_t map_offset, std::size_t size, Locator const &locate) {
+        std::lock_guard lock(m_mutex);
+        if(size == 0 || size > m_cache_size) {
+            return false;
+        }
+        if(m_cache.find(map_offset) != m_cache.end() || m_pending_offsets.find(map_offset) != m_pending_offsets.end()) {
+            return false;
+        }
+        auto location = locate(map_offset);
+        if(!location) {
+            return false;
+        }
+        m_queue.push_back({map_offset, size, location->first, location->second, m_generation});
+        m_pending_offsets.insert(map_offset);
+        return true;
+    }
+
+    void TagDataPrefetchCache::start_worker() {
+        std::lock_guard lock(m_mutex);
+        if(!m_worker.joinable()) {
+            m_stopping = false;
+            m_worker = std::thread(&TagDataPrefetchCache::worker, this);
+        }
+    }
+
+    void TagDataPrefetchCache::stop_worker() noexcept {
+        {
+            std::lock_guard lock(m_mutex);
+            if(!m_worker.joinable()) {
+                return;
+            }
+            m_stopping = true;
+        }
+        m_condition.notify_all();
+        m_worker.join();
+    }
+
+    void TagDataPrefetchCache::notify_worker() noexcept {
+        m_condition.notify_one();
+    }
+
+    void TagDataPrefetchCache::worker() noexcept {
+        while(true) {
+            TagDataPrefetchRequest request;
+            {
+                std::unique_lock lock(m_mutex);
+                m_condition.wait(lock, [this] { return !m_queue.empty() || m_stopping; });
+                if(m_stopping) {
+                    return;
+                }
+                request = std::move(m_queue.front());
+                m_queue.pop_front();
+            }
+
+            std::unique_ptr<std::byte[]> data;
+            try {
+                data = std::make_unique<std::byte[]>(request.size);
+                if(!m_reader(request, data.get())) {
+                    data.reset();
+                }
+            }
+            catch(...) {
+                data.reset();
+            }
+            complete_request(request, std::move(data));
+        }
+    }
+
+    std::optional<TagDataPrefetchRequest> TagDataPrefetchCache::take_request() noexcept {
+        std::lock_guard lock(m_mutex);
+        if(m_queue.empty()) {
+            return std::nullopt;
+        }
+        auto request = std::move(m_queue.front());
+        m_queue.pop_front();
+        return request;
+    }
+
+    void TagDataPrefetchCache::complete_request(TagDataPrefetchRequest const &request, std::unique_ptr<std::byte[]> data) noexcept {
+        std::lock_guard lock(m_mutex);
+
+        // The map was reloaded while this was read, and the offset may be requested again for the new one
+        if(request.generation != m_generation) {
+            return;
+        }
+        m_pending_offsets.erase(request.map_offset);
+        if(!data || request.size > m_cache_size) {
+            return;
+        }
+
+        while(m_cached_bytes + request.size > m_cache_size && !m_lru.empty()) {
+            auto oldest = m_cache.find(m_lru.back());
+            m_lru.pop_back();
+            m_cached_bytes -= oldest->second.size;
+            m_cache.erase(oldest);
+        }
+        m_lru.push_front(request.map_offset);
+        m_cache.emplace(request.map_offset, Entry{request.size, std::move(data), m_lru.begin()});
+        m_cached_bytes += request.size;
+        m_bytes_prefetched += request.size;
+    }
+
+    bool TagDataPrefetchCache::read(std::size_t map_offset, std::size_t size, std::byte *output) noexcept {
+        std::lock_guard lock(m_mutex);
+
+        // Find the entry holding the requested range, if any
+        auto it = m_cache.upper_bound(map_offset);
+        if(it == m_cache.begin()) {
+            m_misses++;
+            return false;
+        }
+        auto &[entry_offset, entry] = *std::prev(it);
+        if(map_offset + size > entry_offset + entry.size) {
+            m_misses++;
+            return false;
+        }
+
+        std::memcpy(output, entry.data.get() + (map_offset - entry_offset), size);
+        m_lru.splice(m_lru.begin(), m_lru, entry.lru_position);
+        m_hits++;
+        return true;
+    }
+
+    bool TagDataPrefetchCache::empty() const noexcept {
+        std::lock_guard lock(m_mutex);
+        return m_cache.empty();
+    }
+
+    void TagDataPrefetchCache::reset() noexcept {
+        std::lock_guard lock(m_mutex);
+        m_generation++;
+        m_queue.clear();
+        m_pending_offsets.clear();
+        m_cache.clear();
+        m_lru.clear();
+        m_cached_bytes = 0;
+        m_hits = 0;
+        m_misses = 0;
+        m_bytes_prefetched = 0;
+    }
+
+    TagDataPrefetchCache::Stats TagDataPrefetchCache::stats() const noexcept {
+        std::lock_guard lock(m_mutex);
+        return {m_hits, m_misses, m_bytes_prefetched, m_cached_bytes, m_cache_size, m_queue.size()};
+    }
+
+    bool TagDataPrefetchCache::read_request_from_file(TagDataPrefetchRequest const &request, std::byte *data) {
+        std::FILE *file = std::fopen(request.file_path.string().c_str(), "rb");
+        if(!file) {
+            return false;
+        }
+        bool success = std::fseek(file, request.file_offset, SEEK_SET) == 0 && std::fread(data, 1, request.size, file) == request.size;
+        std::fclose(file);
+        return success;
+    }
+}
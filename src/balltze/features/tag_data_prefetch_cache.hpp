@@ -0,0 +1,159 @@
+// SPDX-License-Identifier: GPL-3.0-only
+
+#ifndef BALLTZE__FEATURES__TAG_DATA_PREFETCH_CACHE_HPP
+#define BALLTZE__FEATURES__TAG_DATA_PREFETCH_CACHE_HPP
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <filesystem>
+#include <functional>
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <set>
+#include <thread>
+#include <utility>
+
+namespace Balltze::Features {
+    struct TagDataPrefetchRequest {
+        /** Offset of the data as the engine reads it from the loaded map file */
+        std::size_t map_offset;
+
+        /** Size of the data */
+        std::size_t size;
+
+        /** File which holds the data */
+        std::filesystem::path file_path;
+
+        /** Offset of the data in that file */
+        std::size_t file_offset;
+
+        /** Map load the request was made for */
+        std::size_t generation;
+    };
+
+    /**
+     * Map data read in the background, in an LRU cache bounded by size, which map data reads are served from.
+     * The file reader and the lookup of where map data is stored are injected, so the cache does not depend on the engine.
+     */
+    class TagDataPrefetchCache {
+    public:
+        using Reader = std::function<bool(TagDataPrefetchRequest const &request, std::byte *data)>;
+        using Locator = std::function<std::optional<std::pair<std::filesystem::path, std::size_t>>(std::size_t map_offset)>;
+
+        struct Stats {
+            std::size_t hits;
+            std::size_t misses;
+            std::size_t bytes_prefetched;
+            std::size_t cached_bytes;
+            std::size_t cache_size;
+            std::size_t pending_requests;
+        };
+
+        /**
+         * @param cache_size    Maximum number of bytes held by the cache
+         * @param reader        Function reading the data of a request; reads the file by default
+         */
+        TagDataPrefetchCache(std::size_t cache_size, Reader reader = read_request_from_file);
+
+        /**
+         * Stop the worker, waiting for the read it is doing
+         */
+        ~TagDataPrefetchCache();
+
+        void set_cache_size(std::size_t cache_size) noexcept;
+
+        /**
+         * Queue a read of map data, unless it is cached, queued already or larger than the cache
+         * @param map_offset    Offset of the data in the loaded map file
+         * @param size          Size of the data
+         * @param locate        Function finding the file and offset the data is stored at
+         * @return              True if a read was queued
+         */
+        bool request(std::size_t map_offset, std::size_t size, Locator const &locate);
+
+        /**
+         * Start the worker thread which reads the queued requests, if it is not running
+         */
+        void start_worker();
+
+        /**
+         * Stop the worker thread and wait for the read it is doing; queued requests are kept
+         */
+        void stop_worker() noexcept;
+
+        /**
+         * Wake the worker up after queueing requests
+         */
+        void notify_worker() noexcept;
+
+        /**
+         * Take the oldest queued request, without waiting for one
+         */
+        std::optional<TagDataPrefetchRequest> take_request() noexcept;
+
+        /**
+         * Put the data of a request in the cache, evicting the least recently used data to make room.
+         * Data of requests made before the last reset is dropped.
+         * @param request   Request which was read
+         * @param data      Data that was read, or nullptr if the read failed
+         */
+        void complete_request(TagDataPrefetchRequest const &request, std::unique_ptr<std::byte[]> data) noexcept;
+
+        /**
+         * Copy a range of map data from the cache. Reads which are not in the cache count as misses.
+         * @param map_offset    Offset of the data in the loaded map file
+         * @param size          Size of the data
+         * @param output        Where to copy the data to
+         * @return              True if the whole range was in one cache entry and was copied
+         */
+        bool read(std::size_t map_offset, std::size_t size, std::byte *output) noexcept;
+
+        /**
+         * Check if nothing is cached, so reads can skip looking at the file they come from
+         */
+        bool empty() const noexcept;
+
+        /**
+         * Drop the cached data, the queued requests and the statistics, when another map is loaded
+         */
+        void reset() noexcept;
+
+        Stats stats() const noexcept;
+
+        /**
+         * Read the data of a request from its file
+         */
+        static bool read_request_from_file(TagDataPrefetchRequest const &request, std::byte *data);
+
+    private:
+        struct Entry {
+            std::size_t size;
+            std::unique_ptr<std::byte[]> data;
+            std::list<std::size_t>::iterator lru_position;
+        };
+
+        Reader m_reader;
+        mutable std::mutex m_mutex;
+        std::condition_variable m_condition;
+        std::deque<TagDataPrefetchRequest> m_queue;
+        std::set<std::size_t> m_pending_offsets;
+        std::map<std::size_t, Entry> m_cache;
+        std::list<std::size_t> m_lru;
+        std::size_t m_cache_size;
+        std::size_t m_cached_bytes = 0;
+        std::size_t m_generation = 0;
+        std::size_t m_hits = 0;
+        std::size_t m_misses = 0;
+        std::size_t m_bytes_prefetched = 0;
+        std::thread m_worker;
+        bool m_stopping = false;
+
+        void worker() noexcept;
+    };
+}
+
+#endif
@@ -3,6 +3,7 @@
 #include <cstring>
 #include <balltze/config.hpp>
 #include <balltze/engine.hpp>
+#include "../../config/config.hpp"
 #include "map.hpp"
 
 namespace Balltze::Features {
@@ -21,7 +22,7 @@ namespace Balltze::Features {
     }
 
     const std::filesystem::path get_map_path() noexcept {
-        static auto chimera_ini = Config::Ini("chimera.ini");
+        auto &chimera_ini = Config::get_chimera_ini();
         static std::optional<std::filesystem::path> path;
 
         if(!path.has_value()) {
@@ -38,7 +39,7 @@ namespace Balltze::Features {
     }
 
     const std::filesystem::path get_download_map_path() noexcept {
-        static auto chimera_ini = Config::Ini("chimera.ini");
+        auto &chimera_ini = Config::get_chimera_ini();
         static std::optional<std::filesystem::path> path;
 
         if(!path.has_value()) {
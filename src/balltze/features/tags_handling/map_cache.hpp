@@ -0,0 +1,275 @@
+// SPDX-License-Identifier: GPL-3.0-only
+
+#ifndef BALLTZE__TAG_DATA_IMPORTING__MAP_CACHE_HPP
+#define BALLTZE__TAG_DATA_IMPORTING__MAP_CACHE_HPP
+
+#include <cstdio>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+#include <balltze/engine/tag.hpp>
+#include <balltze/engine/map.hpp>
+#include "../../logger.hpp"
+
+namespace Balltze::Features {
+    namespace fs = std::filesystem;
+    using namespace Engine;
+
+    /**
+     * Tag array and tag data buffer which hold the tags imported from other maps
+     */
+    class VirtualTagData {
+    private:
+        std::vector<Tag> m_tag_array;
+        std::unique_ptr<std::byte[]> m_tag_data;
+        std::size_t m_tag_data_buffer_size;
+        std::size_t m_tag_data_cursor = 0;
+        std::size_t m_tag_data_allocations = 0;
+        TagHandle m_next_handle;
+
+    public:
+        VirtualTagData(std::size_t buffer_size) : m_tag_data_buffer_size(buffer_size) {
+            m_tag_data = std::make_unique<std::byte[]>(m_tag_data_buffer_size);
+            m_next_handle.index = 0;
+            m_next_handle.id = 0xE174;
+        }
+
+        VirtualTagData(VirtualTagData &&other) {
+            m_tag_array = std::move(other.m_tag_array);
+            m_tag_data = std::move(other.m_tag_data);
+            m_tag_data_buffer_size = other.m_tag_data_buffer_size;
+            m_tag_data_cursor = other.m_tag_data_cursor;
+            m_tag_data_allocations = other.m_tag_data_allocations;
+            m_next_handle = other.m_next_handle;
+
+            other.m_tag_data_cursor = 0;
+            other.m_tag_data_allocations = 0;
+            other.m_next_handle.index = 0;
+            other.m_next_handle.id = 0xE174;
+        }
+
+        std::size_t tag_data_buffer_size() const noexcept {
+            return m_tag_data_buffer_size;
+        }
+
+        std::size_t tag_data_size() const noexcept {
+            return m_tag_data_cursor;
+        }
+
+        std::size_t tag_count() const noexcept {
+            return m_tag_array.size();
+        }
+
+        std::size_t tag_data_allocations() const noexcept {
+            return m_tag_data_allocations;
+        }
+
+        std::byte *reserve_tag_data_space(std::size_t size) noexcept {
+            if(m_tag_data_cursor + size > m_tag_data_buffer_size) {
+                logger.fatal("Tag data buffer overflow");
+                std::exit(EXIT_FAILURE);
+            }
+            auto *data = m_tag_data.get() + m_tag_data_cursor;
+            m_tag_data_cursor += size;
+            m_tag_data_allocations++;
+            return data;
+        }
+
+        Tag &insert_tag_entry(Tag const &entry) noexcept {
+            auto &new_entry = m_tag_array.emplace_back(entry);
+            new_entry.handle.index = m_next_handle.index++;
+            new_entry.handle.id = m_next_handle.id++;
+            return new_entry;
+        }
+
+        void insert_tags_entries_front(Tag *tags, std::size_t count) noexcept {
+            m_tag_array.insert(m_tag_array.begin(), tags, tags + count);
+
+            auto last_handle = m_tag_array[count - 1].handle;
+            auto it = m_tag_array.begin() + count;
+            while(it != m_tag_array.end()) {
+                it->handle.index = ++last_handle.index;
+                it->handle.id = ++last_handle.id;
+                it++;
+            }
+            m_next_handle.index = ++last_handle.index;
+            m_next_handle.id = ++last_handle.id;
+        }
+
+        void reserve_tag_entries(std::size_t count) noexcept {
+            m_tag_array.reserve(m_tag_array.size() + count);
+        }
+
+        void update_tag_data_header() {
+            auto &tag_data_header = get_tag_data_header();
+            m_tag_array.shrink_to_fit();
+            tag_data_header.tag_count = m_tag_array.size();
+            tag_data_header.tag_array = m_tag_array.data();
+        }
+    };
+
+    /**
+     * Header and raw tag data of a map file, as they are read from the file
+     */
+    class MapCache {
+    protected:
+        std::string m_name;
+        fs::path m_path;
+        MapHeader m_header;
+        std::unique_ptr<std::byte[]> m_raw_tag_data;
+        TagDataHeader *m_tag_data_header = nullptr;
+        Tag *m_tag_array = nullptr;
+        std::map<TagHandle, std::vector<TagHandle>> m_tags_copies;
+        std::map<void *, void *> m_address_translations;
+
+    public:
+        void read_tag_data_from_file() {
+            m_raw_tag_data = std::make_unique<std::byte[]>(m_header.tag_data_size);
+
+            std::FILE *file = std::fopen(m_path.string().c_str(), "rb");
+            std::fseek(file, m_header.tag_data_offset, SEEK_SET);
+            std::fread(m_raw_tag_data.get(), 1, m_header.tag_data_size, file);
+            std::fclose(file);
+
+            m_tag_data_header = reinterpret_cast<TagDataHeader *>(m_raw_tag_data.get());
+            m_tag_array = reinterpret_cast<Tag *>(m_raw_tag_data.get() + sizeof(TagDataHeader));
+        }
+
+        void read_tag_data_from_buffer(std::byte *data) noexcept {
+            m_raw_tag_data = std::make_unique<std::byte[]>(m_header.tag_data_size);
+            std::memcpy(m_raw_tag_data.get(), data, m_header.tag_data_size);
+
+            m_tag_data_header = reinterpret_cast<TagDataHeader *>(m_raw_tag_data.get());
+            m_tag_array = reinterpret_cast<Tag *>(m_raw_tag_data.get() + sizeof(TagDataHeader));
+        }
+
+        void read_header_from_file() {
+            std::FILE *file = std::fopen(m_path.string().c_str(), "rb");
+            std::fread(&m_header, sizeof(MapHeader), 1, file);
+            std::fclose(file);
+        }
+
+        void read_header_from_current_map() noexcept {
+            m_header = get_map_header();
+        }
+
+        MapCache(fs::path map_path) : m_path(map_path) {
+            m_name = m_path.stem().string();
+            if(!fs::exists(m_path)) {
+                throw std::runtime_error("Map file does not exist");
+            }
+        }
+
+        MapCache(MapCache &&other) {
+            m_raw_tag_data = std::move(other.m_raw_tag_data);
+            m_tags_copies = std::move(other.m_tags_copies);
+        }
+
+        std::string name() const noexcept {
+            return m_name;
+        }
+
+        void name(std::string map_name) {
+            m_name = map_name;
+        }
+
+        fs::path path() const noexcept {
+            return m_path;
+        }
+
+        void path(fs::path map_path) {
+            m_path = map_path;
+        }
+
+        MapHeader const &header() {
+            return m_header;
+        }
+
+        TagDataHeader const &tag_data_header() const noexcept {
+            return *m_tag_data_header;
+        }
+
+        std::byte *tag_data() noexcept {
+            return m_raw_tag_data.get();
+        }
+
+        auto &tag_copies() noexcept {
+            return m_tags_copies;
+        }
+
+        /**
+         * Translate an address from the address where the tag data is supposed to be loaded to the address where the tag data is actually loaded.
+         */
+        template<typename T>
+        T translate_address(T address) {
+            if(address != 0) {
+                for(auto &[original_address, translated_address] : m_address_translations) {
+                    if(reinterpret_cast<void *>(address) == original_address || reinterpret_cast<void *>(address) == translated_address) {
+                        return reinterpret_cast<T>(translated_address);
+                    }
+                }
+                auto base_address_disp = reinterpret_cast<std::uintptr_t>(get_tag_data_address()) - reinterpret_cast<std::uintptr_t>(m_raw_tag_data.get());
+                auto new_address = reinterpret_cast<T>(reinterpret_cast<std::uintptr_t>(address) - base_address_disp);
+                m_address_translations.insert_or_assign(reinterpret_cast<void *>(address), reinterpret_cast<void *>(new_address));
+                return new_address;
+            }
+            return address;
+        }
+
+        /**
+         * Get tag entry from the raw tag data of the map
+         */
+        Tag *get_raw_tag(TagHandle tag_handle) {
+            for(std::size_t i = 0; i < m_tag_data_header->tag_count; i++) {
+                if(m_tag_array[i].handle == tag_handle) {
+                    return &m_tag_array[i];
+                }
+            }
+            return nullptr;
+        }
+
+        /**
+         * Get tag entry of the original tag for a tag copy
+         */
+        Tag *get_original_tag_for_copy(TagHandle tag_copy_handle) {
+            auto *tag_copy = Engine::get_tag(tag_copy_handle);
+            for(auto &[original_tag_handle, copies] : m_tags_copies) {
+                for(auto &copy : copies) {
+                    if(copy == tag_copy_handle) {
+                        return Engine::get_tag(original_tag_handle);
+                    }
+                }
+            }
+            return nullptr;
+        }
+
+        /**
+         * Get tag entry of a tag copy
+         * @param original_tag_handle   Handle of the original tag
+         * @param name                  Name of the tag copy
+         * @return                      Tag entry of the tag copy
+         */
+        Tag *get_tag_copy(TagHandle original_tag_handle, std::string const &name) {
+            for(auto &[original_tag_handle, copies] : m_tags_copies) {
+                if(original_tag_handle == original_tag_handle) {
+                    for(auto &copy : copies) {
+                        auto *original_tag = Engine::get_tag(original_tag_handle);
+                        auto copy_path = std::string(original_tag->path) + "\\" + name;
+                        auto *tag = Engine::get_tag(copy);
+                        if(tag->path == copy_path) {
+                            return tag;
+                        }
+                    }
+                    break;
+                }
+            }
+            return nullptr;
+        }
+    };
+}
+
+#endif
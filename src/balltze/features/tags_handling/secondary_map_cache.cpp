@@ -0,0 +1,242 @@
+// SPDX-License-Identifier: GPL-3.0-only
+
+#include <cstdlib>
+#include <cstring>
+#include <stdexcept>
+#include <balltze/engine/tag_definitions/bitmap.hpp>
+#include <balltze/engine/tag_definitions/gbxmodel.hpp>
+#include <balltze/engine/tag_definitions/sound.hpp>
+#include "../../logger.hpp"
+#include "tags_handling.hpp"
+#include "secondary_map_cache.hpp"
+
+namespace Balltze::Features {
+    using namespace Engine::TagDefinitions;
+
+    char *SecondaryMapCache::translate_tag_path(char *path) noexcept {
+        if(path == nullptr) {
+            return nullptr;
+        }
+
+        // Check if path is already translated
+        if(m_tag_path_translations.find(path) != m_tag_path_translations.end()) {
+            return m_tag_path_translations[path];
+        }
+
+        // Copy path to tag data buffer
+        auto *buffer = m_virtual_tag_data->reserve_tag_data_space(std::strlen(path) + 1);
+        auto *new_path = std::strcpy(reinterpret_cast<char *>(buffer), path);
+
+        m_tag_path_translations.insert_or_assign(path, new_path);
+        return new_path;
+    }
+
+    bool SecondaryMapCache::tag_class_is_supported(TagClassInt tag_class) noexcept {
+        static TagClassInt unsupportedTags[] = {
+            TAG_CLASS_GLOBALS,
+            TAG_CLASS_HUD_GLOBALS,
+            TAG_CLASS_METER,
+            TAG_CLASS_SCENARIO_STRUCTURE_BSP,
+            TAG_CLASS_SCENARIO,
+        };
+
+        for(auto &i : unsupportedTags) {
+            if(i == tag_class) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    TagHandle SecondaryMapCache::load_tag(Tag *tag, bool required) {
+        // Check if current tag class is supported
+        if(!tag_class_is_supported(tag->primary_class)) {
+            if(required) {
+                throw std::runtime_error("Unsupported tag class " + std::string(reinterpret_cast<const char *>(&tag->primary_class), 4));
+            }
+            return TagHandle::null();
+        }
+
+        auto tag_handle_resolver = [this](TagHandle tag_handle) -> TagHandle {
+            auto *broken_tag = this->get_raw_tag(tag_handle);
+            if(broken_tag) {
+                auto new_tag_handle = this->load_tag(broken_tag, true);
+                return new_tag_handle;
+            }
+            else {
+                if(tag_handle != TagHandle::null()) {
+                    logger.debug("Cannot resolve tag {} in map {}", tag_handle.value, m_name);
+                }
+                return tag_handle;
+            }
+        };
+
+        // Check if we've already loaded this tag
+        if(m_tag_handles_translations.find(tag->handle) != m_tag_handles_translations.end()) {
+            return m_tag_handles_translations.find(tag->handle)->second;
+        }
+
+        // Fix entry path and data pointers
+        tag->path = translate_address(tag->path);
+        if(!tag->indexed || tag->primary_class == TAG_CLASS_SOUND) {
+            tag->data = translate_address(tag->data);
+        }
+
+        // Set up new tag entry
+        auto &new_tag_entry = m_virtual_tag_data->insert_tag_entry(*tag);
+        new_tag_entry.path = translate_tag_path(new_tag_entry.path);
+        m_tag_handles_translations.insert_or_assign(tag->handle, new_tag_entry.handle);
+
+        // if current tag are indexed or if tags are already fixed, we can continue
+        if(tag->indexed) {
+            if(tag->primary_class == TAG_CLASS_SOUND) {
+                auto *sound_base_struct = reinterpret_cast<Sound *>(new_tag_entry.data);
+                sound_base_struct->promotion_sound.tag_handle = tag_handle_resolver(sound_base_struct->promotion_sound.tag_handle);
+            }
+
+            return new_tag_entry.handle;
+        }
+
+        // There's no data loaded to fix... yet
+        if(tag->primary_class == TAG_CLASS_SCENARIO_STRUCTURE_BSP) {
+            return new_tag_entry.handle;
+        }
+
+        rebase_tag_data_offsets(&new_tag_entry, m_raw_tag_data.get(), [&](std::uint32_t offset) -> std::uint32_t {
+            return new_tag_entry.indexed ? offset : offset + m_data_base_offset;
+        });
+
+        resolve_tag_dependencies(&new_tag_entry, tag_handle_resolver);
+
+        switch(new_tag_entry.primary_class) {
+            case TAG_CLASS_BITMAP: {
+                Bitmap *bitmap = reinterpret_cast<Bitmap *>(new_tag_entry.data);
+                if(bitmap->bitmap_data.count > 0) {
+                    for(std::size_t j = 0; j < bitmap->bitmap_data.count; j++) {
+                        bitmap->bitmap_data.elements[j].pixel_data_offset += m_data_base_offset;
+                    }
+                }
+                break;
+            }
+
+            case TAG_CLASS_GBXMODEL: {
+                auto *gbxmodel = reinterpret_cast<Gbxmodel *>(new_tag_entry.data);
+                for(std::size_t i = 0; i < gbxmodel->geometries.count; i++) {
+                    for(std::size_t j = 0; j < gbxmodel->geometries.elements[i].parts.count; j++) {
+                        gbxmodel->geometries.elements[i].parts.elements[j].vertex_offset += m_model_data_base_offset;
+                        gbxmodel->geometries.elements[i].parts.elements[j].triangle_offset += m_model_data_base_offset - m_loaded_map_vertex_size + m_tag_data_header->vertex_size;
+                        gbxmodel->geometries.elements[i].parts.elements[j].triangle_offset_2 += m_model_data_base_offset - m_loaded_map_vertex_size + m_tag_data_header->vertex_size;
+                    }
+                }
+                break;
+            }
+
+            default: {
+                break;
+            }
+        }
+
+        new_tag_entry.data = copy_tag_data(&new_tag_entry, [this](std::byte *data, std::size_t size) -> std::byte * {
+            auto *new_data = m_virtual_tag_data->reserve_tag_data_space(size);
+            std::memcpy(new_data, data, size);
+            return new_data;
+        });
+
+        if(!new_tag_entry.data) {
+            logger.fatal("Failed to copy data for tag \"{}\" of class {}", new_tag_entry.path, tag_class_to_string(new_tag_entry.primary_class));
+            std::exit(EXIT_FAILURE);
+        }
+
+        return new_tag_entry.handle;
+    }
+
+    SecondaryMapCache::SecondaryMapCache(fs::path map_path) : MapCache(map_path) {
+        read_header_from_file();
+
+        if(m_header.engine_type == CACHE_FILE_CUSTOM_EDITION_COMPRESSED) {
+            throw std::runtime_error("Map file is compressed");
+        }
+
+        if(m_header.engine_type != CACHE_FILE_CUSTOM_EDITION) {
+            throw std::runtime_error("Map file is not a Halo Custom Edition map");
+        }
+
+        read_tag_data_from_file();
+    }
+
+    void SecondaryMapCache::add_tag_import(std::string tag_path, TagClassInt tag_class) {
+        for(auto &tag : m_tags_to_load) {
+            if(tag.first == tag_path && tag.second == tag_class) {
+                return;
+            }
+        }
+        m_tags_to_load.emplace_back(tag_path, tag_class);
+    }
+
+    void SecondaryMapCache::import_all_tags() noexcept {
+        m_load_all_tags = true;
+    }
+
+    std::optional<TagHandle> SecondaryMapCache::get_origin_tag_handle(TagHandle handle) {
+        auto *tag = Engine::get_tag(handle);
+        for(auto &[origin_handle, virtual_handle] : m_tag_handles_translations) {
+            if(handle == virtual_handle) {
+                auto *origin_tag = this->get_raw_tag(origin_handle);
+                if(tag->primary_class == origin_tag->primary_class && std::strcmp(tag->path, origin_tag->path) == 0) {
+                    return origin_handle;
+                }
+            }
+        }
+        return std::nullopt;
+    }
+
+    Tag *SecondaryMapCache::get_tag(std::string const &tag_path, TagClassInt tag_class) {
+        for(auto &[origin_handle, tag_handle] : m_tag_handles_translations) {
+            auto *tag = Engine::get_tag(tag_handle);
+            if(std::strcmp(tag->path, tag_path.c_str()) == 0 && tag->primary_class == tag_class) {
+                return tag;
+            }
+        }
+        return nullptr;
+    }
+
+    std::optional<TagHandle> SecondaryMapCache::translate_tag_handle(TagHandle handle) {
+        if(m_tag_handles_translations.find(handle) != m_tag_handles_translations.end()) {
+            return m_tag_handles_translations[handle];
+        }
+        return std::nullopt;
+    }
+
+    void SecondaryMapCache::load_tag_data(VirtualTagData &virtual_tag_data, std::uint32_t data_base_offset, std::uint32_t model_data_base_offset, std::uint32_t loaded_map_vertex_size) {
+        m_virtual_tag_data = &virtual_tag_data;
+        m_data_base_offset = data_base_offset;
+        m_model_data_base_offset = model_data_base_offset;
+        m_loaded_map_vertex_size = loaded_map_vertex_size;
+
+        // Reserve space for tags to AVOID REALLOCATIONS during the process (!!!)
+        virtual_tag_data.reserve_tag_entries(m_tag_data_header->tag_count);
+
+        if(m_load_all_tags) {
+            for(std::size_t i = 0; i < m_tag_data_header->tag_count; i++) {
+                load_tag(m_tag_array + i, false);
+            }
+        }
+        else {
+            for(auto &tag : m_tags_to_load) {
+                bool tag_found = false;
+                for(std::size_t i = 0; i < m_tag_data_header->tag_count; i++) {
+                    std::string path = translate_address(m_tag_array[i].path);
+                    if(path == tag.first && (m_tag_array[i].primary_class == tag.second || tag.second == TAG_CLASS_NULL)) {
+                        if(load_tag(m_tag_array + i, false) != TagHandle::null()) {
+                            tag_found = true;
+                        }
+                        break;
+                    }
+                }
+                if(!tag_found) {
+                    logger.warning("Tag {} of class {} not found in map {}", tag.first, tag_class_to_string(tag.second), m_name);
+                }
+            }
+        }
+    }
+}
@@ -0,0 +1,76 @@
+// SPDX-License-Identifier: GPL-3.0-only
+
+#ifndef BALLTZE__TAG_DATA_IMPORTING__SECONDARY_MAP_CACHE_HPP
+#define BALLTZE__TAG_DATA_IMPORTING__SECONDARY_MAP_CACHE_HPP
+
+#include <cstdint>
+#include <filesystem>
+#include <map>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+#include <balltze/engine/tag.hpp>
+#include "map_cache.hpp"
+
+namespace Balltze::Features {
+    /**
+     * Map file which tags are imported from into the virtual tag data. The virtual tag data and where the data
+     * of the map goes are given when the tags are imported, so importing does not depend on the engine.
+     */
+    class SecondaryMapCache : public MapCache {
+    private:
+        std::vector<std::pair<std::string, TagClassInt>> m_tags_to_load;
+        std::map<char *, char *> m_tag_path_translations;
+        std::map<TagHandle, TagHandle> m_tag_handles_translations;
+        bool m_load_all_tags = false;
+
+        VirtualTagData *m_virtual_tag_data = nullptr;
+        std::uint32_t m_data_base_offset = 0;
+        std::uint32_t m_model_data_base_offset = 0;
+        std::uint32_t m_loaded_map_vertex_size = 0;
+
+        char *translate_tag_path(char *path) noexcept;
+
+        static bool tag_class_is_supported(TagClassInt tag_class) noexcept;
+
+        TagHandle load_tag(Tag *tag, bool required);
+
+    public:
+        /**
+         * Read the header and the tag data of a map file
+         * @param map_path  Path to the map file
+         * @throws std::runtime_error if the map does not exist, is compressed or is not a Custom Edition map
+         */
+        SecondaryMapCache(fs::path map_path);
+
+        void add_tag_import(std::string tag_path, TagClassInt tag_class);
+
+        void import_all_tags() noexcept;
+
+        std::optional<TagHandle> get_origin_tag_handle(TagHandle handle);
+
+        /**
+         * Get the a tag entry from the virtual tag data that belongs to the map
+         * @param tag_path  Path to the tag
+         * @param tag_class Tag class of the tag
+         * @return          Pointer to the tag entry
+         */
+        Tag *get_tag(std::string const &tag_path, TagClassInt tag_class);
+
+        std::optional<TagHandle> translate_tag_handle(TagHandle handle);
+
+        /**
+         * Import the tags of the map, and the tags they depend on, into the virtual tag data
+         * @param virtual_tag_data          Virtual tag data to import the tags into
+         * @param data_base_offset          Offset of the data of this map in the map file as the engine reads it:
+         *                                  the size of the loaded map and of the secondary maps before this one
+         * @param model_data_base_offset    Offset of the model data of this map in the model data buffer
+         * @param loaded_map_vertex_size    Size of the vertices in the model data of the loaded map
+         * @throws std::runtime_error if a tag which an imported tag depends on cannot be imported
+         */
+        void load_tag_data(VirtualTagData &virtual_tag_data, std::uint32_t data_base_offset, std::uint32_t model_data_base_offset, std::uint32_t loaded_map_vertex_size);
+    };
+}
+
+#endif
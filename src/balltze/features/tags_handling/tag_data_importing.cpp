@@ -1,6 +1,7 @@
 // SPDX-License-Identifier: GPL-3.0-only
 
 #include <windows.h>
+#include <chrono>
 #include <filesystem>
 #include <vector>
 #include <map>
@@ -21,6 +22,8 @@
 #include "../../plugins/loader.hpp"
 #include "../../logger.hpp"
 #include "map.hpp"
+#include "map_cache.hpp"
+#include "secondary_map_cache.hpp"
 #include "tags_handling.hpp"
 
 namespace Balltze::Features {
@@ -28,536 +31,15 @@ namespace Balltze::Features {
     using namespace Engine;
     using namespace Engine::TagDefinitions;
 
-    class VirtualTagData;
-    class MapCache;
-    class SecondaryMapCache;
-
     static fs::path map_file_path;
     static std::unique_ptr<MapCache> map_cache;
     static std::vector<std::shared_ptr<SecondaryMapCache>> secondary_maps_cache;
     static std::vector<std::shared_ptr<SecondaryMapCache>> preloaded_secondary_maps_cache;
     static std::unique_ptr<VirtualTagData> virtual_tag_data;
+    static std::chrono::microseconds tag_data_import_duration = std::chrono::microseconds(0);
 
     constexpr std::size_t virtual_tag_data_buffer_size = 64 * MIB_SIZE;
 
-    class VirtualTagData {
-    private:
-        std::vector<Tag> m_tag_array;
-        std::unique_ptr<std::byte[]> m_tag_data;
-        std::size_t m_tag_data_cursor = 0;
-        TagHandle m_next_handle;
-
-    public:
-        VirtualTagData() {
-            m_tag_data = std::make_unique<std::byte[]>(virtual_tag_data_buffer_size);
-            m_next_handle.index = 0;
-            m_next_handle.id = 0xE174;
-        }
-
-        VirtualTagData(VirtualTagData &&other) {
-            m_tag_array = std::move(other.m_tag_array);
-            m_tag_data = std::move(other.m_tag_data);
-            m_tag_data_cursor = other.m_tag_data_cursor;
-            m_next_handle = other.m_next_handle;
-
-            other.m_tag_data_cursor = 0;
-            other.m_next_handle.index = 0;
-            other.m_next_handle.id = 0xE174;
-        }
-
-        std::size_t tag_data_size() const noexcept {
-            return m_tag_data_cursor;
-        }
-
-        std::size_t tag_count() const noexcept {
-            return m_tag_array.size();
-        }
-
-        std::byte *reserve_tag_data_space(std::size_t size) noexcept {
-            if(m_tag_data_cursor + size > virtual_tag_data_buffer_size) {
-                logger.fatal("Tag data buffer overflow");
-                std::exit(EXIT_FAILURE);
-            }
-            auto *data = m_tag_data.get() + m_tag_data_cursor;
-            m_tag_data_cursor += size;
-            return data;
-        }
-
-        Tag &insert_tag_entry(Tag const &entry) noexcept {
-            auto &new_entry = m_tag_array.emplace_back(entry);
-            new_entry.handle.index = m_next_handle.index++;
-            new_entry.handle.id = m_next_handle.id++;
-            return new_entry;
-        }
-
-        void insert_tags_entries_front(Tag *tags, std::size_t count) noexcept {
-            m_tag_array.insert(m_tag_array.begin(), tags, tags + count);
-
-            auto last_handle = m_tag_array[count - 1].handle;
-            auto it = m_tag_array.begin() + count;
-            while(it != m_tag_array.end()) {
-                it->handle.index = ++last_handle.index;
-                it->handle.id = ++last_handle.id;
-                it++;
-            }
-            m_next_handle.index = ++last_handle.index;
-            m_next_handle.id = ++last_handle.id;
-        }
-
-        void reserve_tag_entries(std::size_t count) noexcept {
-            m_tag_array.reserve(m_tag_array.size() + count);
-        }
-
-        void update_tag_data_header() {
-            auto &tag_data_header = get_tag_data_header();
-            m_tag_array.shrink_to_fit();
-            tag_data_header.tag_count = m_tag_array.size();
-            tag_data_header.tag_array = m_tag_array.data();
-        }
-    };
-
-    class MapCache {
-    protected:
-        std::string m_name;
-        fs::path m_path;
-        MapHeader m_header;
-        std::unique_ptr<std::byte[]> m_raw_tag_data;
-        TagDataHeader *m_tag_data_header = nullptr;
-        Tag *m_tag_array = nullptr;
-        std::map<TagHandle, std::vector<TagHandle>> m_tags_copies;
-        std::map<void *, void *> m_address_translations;
-
-    public:
-        void read_tag_data_from_file() {
-            m_raw_tag_data = std::make_unique<std::byte[]>(m_header.tag_data_size);
-
-            std::FILE *file = std::fopen(m_path.string().c_str(), "rb");
-            std::fseek(file, m_header.tag_data_offset, SEEK_SET);
-            std::fread(m_raw_tag_data.get(), 1, m_header.tag_data_size, file);
-            std::fclose(file);
-
-            m_tag_data_header = reinterpret_cast<TagDataHeader *>(m_raw_tag_data.get());
-            m_tag_array = reinterpret_cast<Tag *>(m_raw_tag_data.get() + sizeof(TagDataHeader));
-        }
-
-        void read_tag_data_from_buffer(std::byte *data) noexcept {
-            m_raw_tag_data = std::make_unique<std::byte[]>(m_header.tag_data_size);
-            std::memcpy(m_raw_tag_data.get(), data, m_header.tag_data_size);
-
-            m_tag_data_header = reinterpret_cast<TagDataHeader *>(m_raw_tag_data.get());
-            m_tag_array = reinterpret_cast<Tag *>(m_raw_tag_data.get() + sizeof(TagDataHeader));
-        }
-
-        void read_header_from_file() {
-            std::FILE *file = std::fopen(m_path.string().c_str(), "rb");
-            std::fread(&m_header, sizeof(MapHeader), 1, file);
-            std::fclose(file);
-        }
-
-        void read_header_from_current_map() noexcept {
-            m_header = get_map_header();
-        }
-
-        MapCache(std::string map_name) : m_name(map_name) {
-            try {
-                m_path = path_for_map_local(m_name.c_str());
-            }
-            catch (std::runtime_error &e) {
-                throw;
-            }
-        }
-
-        MapCache(fs::path map_path) : m_path(map_path) {
-            m_name = m_path.stem().string();
-            if(!fs::exists(m_path)) {
-                throw std::runtime_error("Map file does not exist");
-            }
-        }
-
-        MapCache(MapCache &&other) {
-            m_raw_tag_data = std::move(other.m_raw_tag_data);
-            m_tags_copies = std::move(other.m_tags_copies);
-        }
-
-        std::string name() const noexcept {
-            return m_name;
-        }
-
-        void name(std::string map_name) {
-            m_name = map_name;
-        }
-
-        fs::path path() const noexcept {
-            return m_path;
-        }
-
-        void path(fs::path map_path) {
-            m_path = map_path;
-        }
-
-        MapHeader const &header() {
-            return m_header;
-        }
-
-        TagDataHeader const &tag_data_header() const noexcept {
-            return *m_tag_data_header;
-        }
-
-        std::byte *tag_data() noexcept {
-            return m_raw_tag_data.get();
-        }
-
-        auto &tag_copies() noexcept {
-            return m_tags_copies;
-        }
-
-        /**
-         * Translate an address from the address where the tag data is supposed to be loaded to the address where the tag data is actually loaded.
-         */
-        template<typename T>
-        T translate_address(T address) {
-            if(address != 0) {
-                for(auto &[original_address, translated_address] : m_address_translations) {
-                    if(reinterpret_cast<void *>(address) == original_address || reinterpret_cast<void *>(address) == translated_address) {
-                        return reinterpret_cast<T>(translated_address);
-                    }
-                }
-                auto base_address_disp = reinterpret_cast<std::uint32_t>(get_tag_data_address()) - reinterpret_cast<std::uint32_t>(m_raw_tag_data.get());
-                auto new_address = reinterpret_cast<T>(reinterpret_cast<std::uint32_t>(address) - base_address_disp);
-                m_address_translations.insert_or_assign(reinterpret_cast<void *>(address), reinterpret_cast<void *>(new_address));
-                return new_address;
-            }
-            return address;
-        }
-
-        /**
-         * Get tag entry from the raw tag data of the map
-         */
-        Tag *get_raw_tag(TagHandle tag_handle) {
-            for(std::size_t i = 0; i < m_tag_data_header->tag_count; i++) {
-                if(m_tag_array[i].handle == tag_handle) {
-                    return &m_tag_array[i];
-                }
-            }
-            return nullptr;
-        }
-
-        /**
-         * Get tag entry of the original tag for a tag copy
-         */
-        Tag *get_original_tag_for_copy(TagHandle tag_copy_handle) {
-            auto *tag_copy = Engine::get_tag(tag_copy_handle);
-            for(auto &[original_tag_handle, copies] : m_tags_copies) {
-                for(auto &copy : copies) {
-                    if(copy == tag_copy_handle) {
-                        return Engine::get_tag(original_tag_handle);
-                    }
-                }
-            }
-            return nullptr;
-        }
-
-        /**
-         * Get tag entry of a tag copy
-         * @param original_tag_handle   Handle of the original tag
-         * @param name                  Name of the tag copy
-         * @return                      Tag entry of the tag copy
-         */
-        Tag *get_tag_copy(TagHandle original_tag_handle, std::string const &name) {
-            for(auto &[original_tag_handle, copies] : m_tags_copies) {
-                if(original_tag_handle == original_tag_handle) {
-                    for(auto &copy : copies) {
-                        auto *original_tag = Engine::get_tag(original_tag_handle);
-                        auto copy_path = std::string(original_tag->path) + "\\" + name;
-                        auto *tag = Engine::get_tag(copy);
-                        if(tag->path == copy_path) {
-                            return tag;
-                        }
-                    }
-                    break;
-                }
-            }
-            return nullptr;
-        }
-    };
-
-    class SecondaryMapCache : public MapCache {
-    private:
-        std::vector<std::pair<std::string, TagClassInt>> m_tags_to_load;
-        std::map<char *, char *> m_tag_path_translations;
-        std::map<TagHandle, TagHandle> m_tag_handles_translations;
-        bool m_load_all_tags = false;
-
-        char *translate_tag_path(char *path) noexcept {
-            if(path == nullptr) {
-                return nullptr;
-            }
-
-            // Check if path is already translated
-            if(m_tag_path_translations.find(path) != m_tag_path_translations.end()) {
-                return m_tag_path_translations[path];
-            }
-
-            // Copy path to tag data buffer
-            auto *buffer = virtual_tag_data->reserve_tag_data_space(std::strlen(path) + 1);
-            auto *new_path = std::strcpy(reinterpret_cast<char *>(buffer), path);
-
-            m_tag_path_translations.insert_or_assign(path, new_path);
-            return new_path;
-        }
-
-        std::uint32_t get_data_base_offset() {
-            std::uint32_t offset = map_cache->header().file_size;
-            for(auto &map : secondary_maps_cache) {
-                if(this == map.get()) {
-                    break;
-                }
-                offset += map->header().file_size;
-            }
-            return offset;
-        }
-
-        std::uint32_t get_model_data_base_offset() {
-            std::uint32_t offset = map_cache->tag_data_header().model_data_size;
-            for(auto &map : secondary_maps_cache) {
-                if(this == map.get()) {
-                    break;
-                }
-                offset += map->tag_data_header().model_data_size;
-            }
-            return offset;
-        }
-
-        static bool tag_class_is_supported(TagClassInt tag_class) noexcept {
-            static TagClassInt unsupportedTags[] = {
-                TAG_CLASS_GLOBALS,
-                TAG_CLASS_HUD_GLOBALS,
-                TAG_CLASS_METER,
-                TAG_CLASS_SCENARIO_STRUCTURE_BSP,
-                TAG_CLASS_SCENARIO,
-            };
-
-            for(auto &i : unsupportedTags) {
-                if(i == tag_class) {
-                    return false;
-                }
-            }
-            return true;
-        }
-
-        TagHandle load_tag(Tag *tag, bool required) {
-            // Check if current tag class is supported
-            if(!tag_class_is_supported(tag->primary_class)) {
-                if(required) {
-                    show_error_box("Unsupported tag class %.*s", 4, reinterpret_cast<const char *>(&tag->primary_class));
-                    std::exit(EXIT_FAILURE);
-                }
-                return TagHandle::null();
-            }
-
-            auto tag_handle_resolver = [this](TagHandle tag_handle) -> TagHandle {
-                auto *broken_tag = this->get_raw_tag(tag_handle);
-                if(broken_tag) {
-                    auto new_tag_handle = this->load_tag(broken_tag, true);
-                    return new_tag_handle;
-                }
-                else {
-                    if(tag_handle != TagHandle::null()) {
-                        logger.debug("Cannot resolve tag {} in map {}", tag_handle.value, m_name);
-                    }
-                    return tag_handle;
-                }
-            };
-
-            auto data_base_offset = get_data_base_offset();
-            auto model_data_base_offset = get_model_data_base_offset();
-
-            // Check if we've already loaded this tag
-            if(m_tag_handles_translations.find(tag->handle) != m_tag_handles_translations.end()) {
-                return m_tag_handles_translations.find(tag->handle)->second;
-            }
-
-            // Fix entry path and data pointers
-            tag->path = translate_address(tag->path);
-            if(!tag->indexed || tag->primary_class == TAG_CLASS_SOUND) {
-                tag->data = translate_address(tag->data);
-            }
-
-            // Set up new tag entry
-            auto &new_tag_entry = virtual_tag_data->insert_tag_entry(*tag);
-            new_tag_entry.path = translate_tag_path(new_tag_entry.path);
-            m_tag_handles_translations.insert_or_assign(tag->handle, new_tag_entry.handle);
-
-            // if current tag are indexed or if tags are already fixed, we can continue
-            if(tag->indexed) {
-                if(tag->primary_class == TAG_CLASS_SOUND) {
-                    auto *sound_base_struct = reinterpret_cast<Sound *>(new_tag_entry.data);
-                    sound_base_struct->promotion_sound.tag_handle = tag_handle_resolver(sound_base_struct->promotion_sound.tag_handle);
-                }
-
-                return new_tag_entry.handle;
-            }
-
-            // There's no data loaded to fix... yet
-            if(tag->primary_class == TAG_CLASS_SCENARIO_STRUCTURE_BSP) {
-                return new_tag_entry.handle;
-            }
-
-            rebase_tag_data_offsets(&new_tag_entry, m_raw_tag_data.get(), [&](std::uint32_t offset) -> std::uint32_t {
-                return new_tag_entry.indexed ? offset : offset + data_base_offset;
-            });
-
-            resolve_tag_dependencies(&new_tag_entry, tag_handle_resolver);
-
-            switch(new_tag_entry.primary_class) {
-                case TAG_CLASS_BITMAP: {
-                    Bitmap *bitmap = reinterpret_cast<Bitmap *>(new_tag_entry.data);
-                    if(bitmap->bitmap_data.count > 0) {
-                        for(std::size_t j = 0; j < bitmap->bitmap_data.count; j++) {
-                            bitmap->bitmap_data.elements[j].pixel_data_offset += data_base_offset; 
-                        }
-                    }
-                    break;
-                }
-
-                case TAG_CLASS_GBXMODEL: {
-                    auto *gbxmodel = reinterpret_cast<Gbxmodel *>(new_tag_entry.data);
-                    for(std::size_t i = 0; i < gbxmodel->geometries.count; i++) {
-                        for(std::size_t j = 0; j < gbxmodel->geometries.elements[i].parts.count; j++) {
-                            gbxmodel->geometries.elements[i].parts.elements[j].vertex_offset += model_data_base_offset;
-                            gbxmodel->geometries.elements[i].parts.elements[j].triangle_offset += model_data_base_offset - map_cache->tag_data_header().vertex_size + m_tag_data_header->vertex_size;
-                            gbxmodel->geometries.elements[i].parts.elements[j].triangle_offset_2 += model_data_base_offset - map_cache->tag_data_header().vertex_size + m_tag_data_header->vertex_size;
-                        }                               
-                    }
-                    break;
-                }
-
-                default: {
-                    break;
-                }
-            }
-
-            new_tag_entry.data = copy_tag_data(&new_tag_entry, [](std::byte *data, std::size_t size) -> std::byte * {
-                auto *new_data = virtual_tag_data->reserve_tag_data_space(size);
-                std::memcpy(new_data, data, size);
-                return new_data;
-            });
-
-            if(!new_tag_entry.data) {
-                logger.fatal("Failed to copy data for tag \"{}\" of class {}", new_tag_entry.path, tag_class_to_string(new_tag_entry.primary_class));
-                std::exit(EXIT_FAILURE);
-            }
-
-            return new_tag_entry.handle;
-        }
-
-    public:
-        SecondaryMapCache(std::string map_name) : MapCache(map_name) {
-            read_header_from_file();
-
-            if(m_header.engine_type == CACHE_FILE_CUSTOM_EDITION_COMPRESSED) {
-                throw std::runtime_error("Map file is compressed");
-            } 
-
-            if(m_header.engine_type != CACHE_FILE_CUSTOM_EDITION) {
-                throw std::runtime_error("Map file is not a Halo Custom Edition map");
-            }
-
-            read_tag_data_from_file();
-        }
-
-        SecondaryMapCache(fs::path map_path) : MapCache(map_path) {
-            read_header_from_file();
-
-            if(m_header.engine_type == CACHE_FILE_CUSTOM_EDITION_COMPRESSED) {
-                throw std::runtime_error("Map file is compressed");
-            }
-
-            if(m_header.engine_type != CACHE_FILE_CUSTOM_EDITION) {
-                throw std::runtime_error("Map file is not a Halo Custom Edition map");
-            }
-
-            read_tag_data_from_file();
-        }
-
-        void add_tag_import(std::string tag_path, TagClassInt tag_class) {
-            for(auto &tag : m_tags_to_load) {
-                if(tag.first == tag_path && tag.second == tag_class) {
-                    return;
-                }
-            }
-            m_tags_to_load.emplace_back(tag_path, tag_class);
-        }
-
-        void import_all_tags() {
-            m_load_all_tags = true;
-        }
-
-        std::optional<TagHandle> get_origin_tag_handle(TagHandle handle) {
-            auto *tag = Engine::get_tag(handle);
-            for(auto &[origin_handle, virtual_handle] : m_tag_handles_translations) {
-                if(handle == virtual_handle) {
-                    auto *origin_tag = this->get_raw_tag(origin_handle);
-                    if(tag->primary_class == origin_tag->primary_class && std::strcmp(tag->path, origin_tag->path) == 0) {
-                        return origin_handle;
-                    }
-                }
-            }
-            return std::nullopt;
-        }
-
-        /**
-         * Get the a tag entry from the virtual tag data that belongs to the map
-         * @param tag_path  Path to the tag
-         * @param tag_class Tag class of the tag
-         * @return          Pointer to the tag entry
-         */
-        Tag *get_tag(std::string const &tag_path, TagClassInt tag_class) {
-            for(auto &[origin_handle, tag_handle] : m_tag_handles_translations) {
-                auto *tag = Engine::get_tag(tag_handle);
-                if(std::strcmp(tag->path, tag_path.c_str()) == 0 && tag->primary_class == tag_class) {
-                    return tag;
-                }
-            }
-            return nullptr;
-        }
-
-        std::optional<TagHandle> translate_tag_handle(TagHandle handle) {
-            if(m_tag_handles_translations.find(handle) != m_tag_handles_translations.end()) {
-                return m_tag_handles_translations[handle];
-            }
-            return std::nullopt;
-        }
-
-        void load_tag_data() {
-            // Reserve space for tags to AVOID REALLOCATIONS during the process (!!!)
-            virtual_tag_data->reserve_tag_entries(m_tag_data_header->tag_count);
-
-            if(m_load_all_tags) {
-                for(std::size_t i = 0; i < m_tag_data_header->tag_count; i++) {
-                    load_tag(m_tag_array + i, false);
-                }
-            }
-            else {
-                for(auto &tag : m_tags_to_load) {
-                    bool tag_found = false;
-                    for(std::size_t i = 0; i < m_tag_data_header->tag_count; i++) {
-                        std::string path = translate_address(m_tag_array[i].path);
-                        if(path == tag.first && (m_tag_array[i].primary_class == tag.second || tag.second == TAG_CLASS_NULL)) {
-                            if(load_tag(m_tag_array + i, false) != TagHandle::null()) {
-                                tag_found = true;
-                            }
-                            break;
-                        }
-                    }
-                    if(!tag_found) {
-                        logger.warning("Tag {} of class {} not found in map {}", tag.first, tag_class_to_string(tag.second), m_name);
-                    }
-                }
-            }
-        }
-    };
-
     static bool tag_is_copy(TagHandle handle) {
         if(map_cache->get_raw_tag(handle)) {
             return false;
@@ -571,6 +53,7 @@ namespace Balltze::Features {
     }
 
     static void import_tag_data() {
+        auto import_start = std::chrono::steady_clock::now();
         auto &tag_data_header = get_tag_data_header();
         auto *tag_data_address = get_tag_data_address();
 
@@ -583,16 +66,29 @@ namespace Balltze::Features {
         // Initialize our stuff
         logger.info("Initializing virtual tag data...");
         secondary_maps_cache = preloaded_secondary_maps_cache;
-        virtual_tag_data = std::make_unique<VirtualTagData>();
+        virtual_tag_data = std::make_unique<VirtualTagData>(virtual_tag_data_buffer_size);
         virtual_tag_data->insert_tags_entries_front(tag_data_header.tag_array, tag_data_header.tag_count);
         
         logger.info("Importing tag data from other maps...");
+        std::uint32_t data_base_offset = map_cache->header().file_size;
+        std::uint32_t model_data_base_offset = map_cache->tag_data_header().model_data_size;
         for(auto &map : secondary_maps_cache) {
-            map->load_tag_data();
+            try {
+                map->load_tag_data(*virtual_tag_data, data_base_offset, model_data_base_offset, map_cache->tag_data_header().vertex_size);
+            }
+            catch(std::runtime_error &e) {
+                show_error_box("%s", e.what());
+                std::exit(EXIT_FAILURE);
+            }
+            data_base_offset += map->header().file_size;
+            model_data_base_offset += map->tag_data_header().model_data_size;
         }
         
         logger.debug("Updating tag data header...");
         virtual_tag_data->update_tag_data_header();
+
+        tag_data_import_duration = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - import_start);
+        logger.debug("Tag data imported in {} ms", tag_data_import_duration.count() / 1000.0f);
     }
 
     void on_map_file_load(Event::MapFileLoadEvent const &event) {
@@ -669,6 +165,28 @@ namespace Balltze::Features {
         }
     }
 
+    std::optional<std::pair<fs::path, std::size_t>> get_map_data_location(std::size_t file_offset) noexcept {
+        if(map_file_path.empty()) {
+            return std::nullopt;
+        }
+        if(!map_cache) {
+            return std::make_pair(map_file_path, file_offset);
+        }
+
+        auto offset_acc = map_cache->header().file_size;
+        if(file_offset > offset_acc) {
+            for(auto &map : secondary_maps_cache) {
+                auto map_file_size = map->header().file_size;
+                if(file_offset <= offset_acc + map_file_size) {
+                    return std::make_pair(map->path(), file_offset - offset_acc);
+                }
+                offset_acc += map_file_size;
+            }
+            return std::nullopt;
+        }
+        return std::make_pair(map_cache->path(), file_offset);
+    }
+
     void import_tag_from_map(std::string map_name, std::string tag_path, TagClassInt tag_class) {
         try {
             if(map_name == map_file_path.stem()) {
@@ -681,7 +199,8 @@ namespace Balltze::Features {
                 }
             }
             logger.debug("Creating map cache for {}", map_name);
-            auto &map = preloaded_secondary_maps_cache.emplace_back(std::make_shared<SecondaryMapCache>(map_name));
+            auto &map = preloaded_secondary_maps_cache.emplace_back(std::make_shared<SecondaryMapCache>(path_for_map_local(map_name.c_str())));
+            map->name(map_name);
             map->add_tag_import(tag_path, tag_class);
         }
         catch(std::exception &e) {
@@ -729,7 +248,7 @@ namespace Balltze::Features {
         }
     }
 
-    void reload_tag_data(TagHandle tag_handle) {
+    TagDataPatchSummary reload_tag_data(TagHandle tag_handle) {
         auto *target_tag = get_tag(tag_handle);
         if(!target_tag) {
             throw std::runtime_error("Tag not found");
@@ -754,40 +273,44 @@ namespace Balltze::Features {
             original_tag = target_tag;
         }
 
-        // If tag is from the loaded map, create a copy of it in the virtual tag data
+        Tag *raw_tag = nullptr;
+
+        // If tag is from the loaded map, take the data from the map cache
         if(original_tag->handle.index < map_cache->tag_data_header().tag_count) {
             auto *tag_data_address = get_tag_data_address();
-            auto *raw_tag = map_cache->get_raw_tag(original_tag->handle);
+            raw_tag = map_cache->get_raw_tag(original_tag->handle);
             if(raw_tag->data >= tag_data_address && raw_tag->data < tag_data_address + map_cache->header().tag_data_size) {
                 raw_tag->data = map_cache->translate_address(raw_tag->data);
                 rebase_tag_data_offsets(raw_tag, map_cache->tag_data());
             }
-
-            auto *tag_data = target_tag->data;
-            target_tag->data = copy_tag_data(raw_tag, [&tag_data](std::byte *data, std::size_t size) -> std::byte * {
-                auto *new_data = tag_data;
-                std::memcpy(new_data, data, size);
-                tag_data += size;
-                return new_data;
-            });
         }
         else {
             for(auto &map : secondary_maps_cache) {
                 auto origin_handle = map->get_origin_tag_handle(original_tag->handle);
                 if(origin_handle) {
-                    auto *raw_tag = map->get_raw_tag(*origin_handle);
-                    auto *tag_data = target_tag->data;
-                    target_tag->data = copy_tag_data(raw_tag, [&tag_data](std::byte *data, std::size_t size) -> std::byte * {
-                        auto *new_data = tag_data;
-                        std::memcpy(new_data, data, size);
-                        tag_data += size;
-                        return new_data;
-                    });
-                    return;
+                    raw_tag = map->get_raw_tag(*origin_handle);
+                    break;
                 }
             }
-            throw std::runtime_error("Tag not found. This should not happen, it may be a bug.");
+            if(!raw_tag) {
+                throw std::runtime_error("Tag not found. This should not happen, it may be a bug.");
+            }
         }
+
+        // Only reflexives and data blocks which size changed get new space in the virtual tag data
+        TagDataPatchSummary summary;
+        bool patched = patch_tag_data(target_tag, raw_tag, [](std::byte *data, std::size_t size) -> std::byte * {
+            auto *new_data = virtual_tag_data->reserve_tag_data_space(size);
+            std::memcpy(new_data, data, size);
+            return new_data;
+        }, summary);
+
+        if(!patched) {
+            throw std::runtime_error("Unsupported tag class");
+        }
+
+        logger.debug("Reloaded tag {}: {} fields patched ({} bytes), {} reflexives and {} data blocks reallocated", target_tag->path, summary.fields_patched, summary.bytes_patched, summary.blocks_reallocated, summary.data_reallocated);
+        return summary;
     }
 
     TagHandle clone_tag(TagHandle tag_handle, std::string copy_name) {
@@ -946,6 +469,13 @@ namespace Balltze::Features {
             Engine::console_printf("Tags imported: %zu", virtual_tag_data->tag_count() - map_cache->tag_data_header().tag_count);
             Engine::console_printf("Imported tag data size: %.2fMiB / %.2fMiB", static_cast<float>(virtual_tag_data->tag_data_size()) / MIB_SIZE, static_cast<float>(virtual_tag_data_buffer_size) / MIB_SIZE);
             Engine::console_printf("Cached tag data size: %.2f MiB", static_cast<float>(cached_data) / MIB_SIZE);
+
+            float import_seconds = static_cast<float>(tag_data_import_duration.count()) / 1000000.0f;
+            auto imported_tags = virtual_tag_data->tag_count() - map_cache->tag_data_header().tag_count;
+            Engine::console_printf("Import time: %.2f ms (%zu tag data allocations)", import_seconds * 1000.0f, virtual_tag_data->tag_data_allocations());
+            if(import_seconds > 0.0f) {
+                Engine::console_printf("Import throughput: %.0f tags/s, %.2f MiB/s", imported_tags / import_seconds, static_cast<float>(virtual_tag_data->tag_data_size()) / MIB_SIZE / import_seconds);
+            }
             return true;
         }, false, 0, 0);
     }
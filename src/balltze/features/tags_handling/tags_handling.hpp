@@ -5,6 +5,8 @@
 
 #include <optional>
 #include <functional>
+#include <filesystem>
+#include <utility>
 #include <cstdint>
 #include <balltze/engine/tag.hpp>
 #include <balltze/features/tags_handling.hpp>
@@ -36,6 +38,23 @@ namespace Balltze::Features {
      * @return                  Pointer to copied data
      */
     std::byte *copy_tag_data(Engine::Tag *tag, allocate_tag_data_t data_allocator);
+
+    /**
+     * Patch tag data with the data of another tag of the same class, field by field
+     * @param  tag              Tag to patch
+     * @param  source_tag       Tag to take the new data from
+     * @param  data_allocator   A function that allocates memory for reflexives and data blocks which size changed
+     * @param  summary          Summary of the applied changes
+     * @return                  True if the tag was patched, false if its class is not supported
+     */
+    bool patch_tag_data(Engine::Tag *tag, Engine::Tag *source_tag, allocate_tag_data_t data_allocator, TagDataPatchSummary &summary);
+
+    /**
+     * Find where a map data read offset points to, taking imported tag data from secondary maps into account
+     * @param file_offset   Offset as it is read by the engine from the loaded map file
+     * @return              Path of the map file which holds the data and the offset within it
+     */
+    std::optional<std::pair<std::filesystem::path, std::size_t>> get_map_data_location(std::size_t file_offset) noexcept;
 }
 
 #endif
@@ -4,6 +4,7 @@
 #define BALLTZE__LOGGER_HPP
 
 #include <balltze/logger.hpp>
+#include "output/log_file_queue.hpp"
 
 namespace Balltze {
     extern Logger logger;
@@ -374,7 +374,7 @@ namespace Balltze::Memory {
                     logger.debug("Signature {}: {}", args[0], buffer);
                 }
                 else {
-                    logger.debug("Signature %s not found", args[0]);
+                    logger.debug("Signature {} not found", args[0]);
                 }
             }
             else {
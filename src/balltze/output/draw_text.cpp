@@ -3,16 +3,20 @@
 
 #include <variant>
 #include <filesystem>
+#include <optional>
+#include <string_view>
 #include <fmt/format.h>
 #include <balltze/engine/rasterizer.hpp>
 #include <balltze/engine/tag.hpp>
 #include <balltze/events/d3d9.hpp>
 #include <balltze/events/frame.hpp>
+#include <balltze/events/map_load.hpp>
 #include <balltze/hook.hpp>
 #include <balltze/utils.hpp>
 #include "../config/config.hpp"
 #include "../logger.hpp"
 #include "draw_text.hpp"
+#include "text_command_buffer.hpp"
 
 #include <d3d9.h>
 #include <d3dx9.h>
@@ -24,6 +28,8 @@ namespace Balltze {
     static std::pair<int, int> system_font_shadow, console_font_shadow, small_font_shadow, large_font_shadow, smaller_font_shadow, ticker_font_shadow;
     static std::pair<int, int> system_font_offset, console_font_offset, small_font_offset, large_font_offset, smaller_font_offset, ticker_font_offset;
     static LPDIRECT3DDEVICE9 dev = nullptr;
+    static LPD3DXSPRITE text_sprite = nullptr;
+    static HRESULT (FAR WINAPI * D3DXCreateSpriteFN)(LPDIRECT3DDEVICE9, LPD3DXSPRITE *) = nullptr;
     static bool font_override_enabled = false;
 
     struct CustomFontOverride {
@@ -76,7 +82,7 @@ namespace Balltze {
         }
     }
 
-    const TagHandle &get_generic_font(GenericFont font) noexcept {
+    static TagHandle find_generic_font(GenericFont font) noexcept {
         if(font == GenericFont::FONT_SMALLER) {
             auto *tag = get_tag("ui\\gamespy", TagClassInt::TAG_CLASS_FONT);
             if(tag) {
@@ -120,6 +126,20 @@ namespace Balltze {
         }
     }
 
+    /** Generic fonts found in the tags of the current map */
+    static std::optional<TagHandle> generic_fonts[FONT_TICKER + 1];
+
+    const TagHandle &get_generic_font(GenericFont font) noexcept {
+        if(font < 0 || font > FONT_TICKER) {
+            font = FONT_SMALL;
+        }
+        auto &cached = generic_fonts[font];
+        if(!cached) {
+            cached = find_generic_font(font);
+        }
+        return *cached;
+    }
+
     static const TagHandle &get_generic_font_if_generic(const std::variant<TagHandle, GenericFont> &font) noexcept {
         auto *generic = std::get_if<1>(&font);
         if(generic) {
@@ -152,49 +172,13 @@ namespace Balltze {
         return GenericFont::FONT_CONSOLE;
     }
 
-    struct Text {
-        // Text to display
-        std::variant<std::string, std::wstring> text;
-
-        // X coordinate
-        std::int16_t x;
-
-        // Y coordinate
-        std::int16_t y;
-
-        // Width of the box
-        std::int16_t width;
-
-        // Height of the box
-        std::int16_t height;
-
-        // Color of the text
-        ColorARGB color;
-
-        // Font to use
-        TagHandle font;
-
-        // Alignment of the font
-        FontAlignment alignment;
-
-        // Are we overriding this bad boy?
-        LPD3DXFONT override;
-    };
-
-    template<typename String> struct TextRect {
-        String text;
-        std::int16_t x;
-        std::int16_t y;
-        std::int16_t width;
-        std::int16_t height;
-        FontAlignment align;
-    };
-
-    template<typename String> static std::vector<TextRect<String>> handle_formatting(String text, std::int16_t x, std::int16_t y, std::int16_t width, std::int16_t height, FontAlignment align, const std::variant<TagHandle, GenericFont> &font) {
+    /**
+     * Split a string at its formatting codes and pass each piece to a function along with its box and alignment
+     */
+    template<typename T, typename Visitor> static void handle_formatting(std::basic_string_view<T> text, std::int16_t x, std::int16_t y, std::int16_t width, std::int16_t height, FontAlignment align, const std::variant<TagHandle, GenericFont> &font, Visitor &&visit) {
         auto size = text.size();
-        std::vector<TextRect<String>> fmt;
         if(size == 0) {
-            return fmt;
+            return;
         }
 
         std::size_t start = 0;
@@ -206,35 +190,23 @@ namespace Balltze {
         auto original_x = x;
         x += font_data.xy_offset >> 16;
 
-        auto append_thing = [&fmt, &x, &y, &width, &height, &align, &text, &tabs, &start, &font_data](std::size_t end) {
+        auto append_thing = [&visit, &x, &y, &width, &height, &align, &text, &tabs, &start, &font_data](std::size_t end) {
             auto substr_size = end - start;
             if(substr_size == 0) {
                 return;
             }
-            auto &new_fmt = fmt.emplace_back();
-            new_fmt.x = x;
-            new_fmt.width = width;
+            std::int16_t piece_x = x;
+            std::int16_t piece_width = width;
 
-            if(tabs == 0) {
-                new_fmt.x = x;
-                new_fmt.width = width;
-            }
-            else {
+            if(tabs != 0) {
                 // int end_x = font_data.tabs[tabs + 1];
                 int start_x = font_data.tabs[tabs];
 
-                new_fmt.x = x + start_x;
-                //new_fmt.width = end_x - start_x;
-
-                if(new_fmt.width > width) {
-                    new_fmt.width = width;
-                }
+                piece_x = x + start_x;
+                //piece_width = end_x - start_x;
             }
 
-            new_fmt.y = y;
-            new_fmt.height = height;
-            new_fmt.text = text.substr(start, substr_size);
-            new_fmt.align = align;
+            visit(text.substr(start, substr_size), piece_x, y, piece_width, height, align);
         };
 
         for(std::size_t i = 0; i < size - 1 && height > 0; i++) {
@@ -301,10 +273,13 @@ namespace Balltze {
         }
 
         append_thing(size);
-        return fmt;
     }
 
-    static std::vector<Text> text_list;
+    /** Text to draw when the game draws its text this frame */
+    static TextCommandBuffer text_buffer;
+
+    /** Text being drawn right away */
+    static TextCommandBuffer immediate_text_buffer;
 
     static FontData *font_data;
     FontData &get_current_font_data() noexcept {
@@ -316,7 +291,7 @@ namespace Balltze {
     static void *draw_text_8_bit = nullptr;
     static void *draw_text_16_bit = nullptr;
 
-    static void draw_text_now(const Text &text) {
+    static void draw_text_now(const TextCommand &text, const void *string, LPD3DXSPRITE sprite) {
         auto old_font_data = *font_data;
         if(text.override) {
             auto res = get_resolution();
@@ -361,9 +336,9 @@ namespace Balltze {
             // Get our rects up
             RECT rect;
             rect.left = (text.x) * scale + offset.first;
-            rect.right = (text.width) * scale + offset.first;
+            rect.right = (text.right) * scale + offset.first;
             rect.top = (text.y) * scale + offset.second;
-            rect.bottom = (text.height) * scale + offset.second;
+            rect.bottom = (text.bottom) * scale + offset.second;
 
             bool draw_shadow = shadow_offset.first != 0 || shadow_offset.second != 0;
             RECT rshadow = rect;
@@ -402,22 +377,21 @@ namespace Balltze {
                     break;
             }
 
-            auto *u8 = std::get_if<std::string>(&text.text);
-            auto *u16 = std::get_if<std::wstring>(&text.text);
-
             auto *override_font = text.override;
 
-            if(u8) {
+            if(!text.wide) {
+                auto *u8 = static_cast<const char *>(string);
                 if(draw_shadow) {
-                    override_font->DrawText(NULL, u8->data(), -1, &rshadow, align, color_shadow);
+                    override_font->DrawText(sprite, u8, -1, &rshadow, align, color_shadow);
                 }
-                override_font->DrawText(NULL, u8->data(), -1, &rect, align, color);
+                override_font->DrawText(sprite, u8, -1, &rect, align, color);
             }
             else {
+                auto *u16 = static_cast<const wchar_t *>(string);
                 if(draw_shadow) {
-                    override_font->DrawTextW(NULL, u16->data(), -1, &rshadow, align, color_shadow);
+                    override_font->DrawTextW(sprite, u16, -1, &rshadow, align, color_shadow);
                 }
-                override_font->DrawTextW(NULL, u16->data(), -1, &rect, align, color);
+                override_font->DrawTextW(sprite, u16, -1, &rect, align, color);
             }
         }
         else {
@@ -426,34 +400,50 @@ namespace Balltze {
             font_data->font = text.font;
 
             // Depending on if we're using 8-bit or 16-bit, draw stuff
-            auto *u8 = std::get_if<std::string>(&text.text);
-            auto *u16 = std::get_if<std::wstring>(&text.text);
+            display_text(string, text.x * 0x10000 + text.y, text.right * 0x10000 + text.bottom, text.wide ? draw_text_16_bit : draw_text_8_bit);
+        }
+        *font_data = old_font_data;
+    }
+
+    /**
+     * Draws the groups of a text command buffer. The strings of an override font are drawn through one sprite,
+     * so Direct3DX batches them instead of setting up the device for every string.
+     */
+    struct TextDrawBackend {
+        LPD3DXSPRITE sprite = nullptr;
 
-            if(u8) {
-                display_text(u8->data(), text.x * 0x10000 + text.y, text.width * 0x10000 + text.height, draw_text_8_bit);
+        void begin_group(const TextCommand &first) {
+            if(first.override && text_sprite && SUCCEEDED(text_sprite->Begin(D3DXSPRITE_ALPHABLEND))) {
+                sprite = text_sprite;
             }
-            else {
-                display_text(u16->data(), text.x * 0x10000 + text.y, text.width * 0x10000 + text.height, draw_text_16_bit);
+        }
+
+        void draw(const TextCommand &command, const void *text) {
+            draw_text_now(command, text, sprite);
+        }
+
+        void end_group() {
+            if(sprite) {
+                sprite->End();
+                sprite = nullptr;
             }
         }
-        *font_data = old_font_data;
-    }
+    };
 
     // This is called every frame, giving us a chance to add text
     static void on_text() {
-        if(text_list.size() == 0) {
+        if(text_buffer.empty()) {
             return;
         }
 
         // TODO: SIGNATURE FOR FONT DATA
         auto old_font_data = *font_data;
 
-        for(auto &text : text_list) {
-            draw_text_now(text);
-        }
+        TextDrawBackend backend;
+        text_buffer.submit(backend);
 
         *font_data = old_font_data;
-        text_list.clear();
+        text_buffer.clear();
     }
 
     std::int16_t get_font_pixel_height(const std::variant<TagHandle, GenericFont> &font) noexcept {
@@ -473,6 +463,39 @@ namespace Balltze {
         return *reinterpret_cast<std::uint16_t *>(tag_data + 0x4) + *reinterpret_cast<std::uint16_t *>(tag_data + 0x6);
     }
 
+    static std::unordered_map<std::uint32_t, FontGlyphAdvances> font_glyph_advances;
+
+    FontGlyphAdvances const *get_font_glyph_advances(const std::variant<TagHandle, GenericFont> &font) noexcept {
+        if(get_override_font(font)) {
+            return nullptr;
+        }
+
+        TagHandle font_tag = get_generic_font_if_generic(font);
+        auto cached = font_glyph_advances.find(font_tag.value);
+        if(cached != font_glyph_advances.end()) {
+            return &cached->second;
+        }
+
+        // Get the tag
+        auto *tag = get_tag(font_tag);
+
+        // If it's not loaded, don't cache it; it may be loaded later
+        if(!tag || (tag->indexed && reinterpret_cast<std::uintptr_t>(tag->data) < 65536)) {
+            return nullptr;
+        }
+
+        auto tag_chars_count = *reinterpret_cast<std::uint32_t *>(tag->data + 0x7C);
+        auto *tag_chars = *reinterpret_cast<FontCharacter **>(tag->data + 0x7C + 4);
+
+        try {
+            FontGlyphAdvances advances(tag_chars, tag_chars_count);
+            return &font_glyph_advances.insert_or_assign(font_tag.value, std::move(advances)).first->second;
+        }
+        catch(...) {
+            return nullptr;
+        }
+    }
+
     template<typename T> std::int16_t text_pixel_length_t(const T *text, const std::variant<TagHandle, GenericFont> &font) {
         // Find the font
         TagHandle font_tag = get_generic_font_if_generic(font);
@@ -518,43 +541,18 @@ namespace Balltze {
             return static_cast<int>((rect.right - rect.left - added_width) * 480 + 240) / res.height;
         }
 
-        struct Character {
-            std::uint16_t character;
-            std::uint16_t character_width;
-            char i_stopped_caring[16];
-        };
-        static_assert(sizeof(Character) == 0x14);
-
-        // Get the tag
-        auto *tag = get_tag(font_tag);
+        auto *advances = get_font_glyph_advances(font);
 
         // If it's not loaded, don't care
-        if(tag->indexed && reinterpret_cast<std::uintptr_t>(tag->data) < 65536) {
+        if(!advances) {
             return 0;
         }
         std::int16_t length = 0;
 
-        auto tag_chars_count = *reinterpret_cast<std::uint32_t *>(tag->data + 0x7C);
-        auto *tag_chars = *reinterpret_cast<Character **>(tag->data + 0x7C + 4);
-
         while(*text != 0) {
             auto old_length = length;
 
-            int char_length = 0;
-            for(std::size_t i = 0; i < tag_chars_count; i++) {
-                bool same = false;
-                if(sizeof(T) == 1) {
-                    same = *reinterpret_cast<const std::uint8_t *>(text) == tag_chars[i].character;
-                }
-                else {
-                    same = *text == tag_chars[i].character;
-                }
-                if(same) {
-                    char_length = tag_chars[i].character_width;
-                    break;
-                }
-            }
-
+            int char_length = advances->get(static_cast<std::make_unsigned_t<T>>(*text));
             if(char_length > 0) {
                 length += char_length;
 
@@ -605,36 +603,28 @@ namespace Balltze {
                 break;
         }
 
-        auto *u8 = std::get_if<0>(&text);
-        auto *u16 = std::get_if<1>(&text);
-
-        #define handle_formatting_call(what) handle_formatting(*what, x, y, width, height, alignment, font)
+        auto &buffer = immediate ? immediate_text_buffer : text_buffer;
+        auto record = [&](auto piece, std::int16_t piece_x, std::int16_t piece_y, std::int16_t piece_width, std::int16_t piece_height, FontAlignment piece_align) {
+            buffer.add(piece, TextCommand { 0, false, piece_x, piece_y, static_cast<std::int16_t>(piece_x + piece_width), static_cast<std::int16_t>(piece_y + piece_height), color, font_tag, piece_align, override_font });
+        };
 
-        if(u8) {
-            for(auto &i : handle_formatting_call(u8)) {
-                auto text = Text { i.text, i.x, i.y, static_cast<std::int16_t>(i.x + i.width), static_cast<std::int16_t>(i.y + i.height), color, font_tag, i.align, override_font };
-                if(immediate) {
-                    draw_text_now(text);
-                }
-                else {
-                    text_list.emplace_back(text);
-                }
+        try {
+            if(auto *u8 = std::get_if<0>(&text)) {
+                handle_formatting(std::string_view(*u8), x, y, width, height, alignment, font, record);
             }
-        }
-
-        if(u16) {
-            for(auto &i : handle_formatting_call(u16)) {
-                auto text = Text { i.text, i.x, i.y, static_cast<std::int16_t>(i.x + i.width), static_cast<std::int16_t>(i.y + i.height), color, font_tag, i.align, override_font };
-                if(immediate) {
-                    draw_text_now(text);
-                }
-                else {
-                    text_list.emplace_back(text);
-                }
+            else if(auto *u16 = std::get_if<1>(&text)) {
+                handle_formatting(std::wstring_view(*u16), x, y, width, height, alignment, font, record);
             }
         }
+        catch(std::bad_alloc &) {
+            logger.warning("Out of memory while adding text to draw");
+        }
 
-        #undef handle_formatting_call
+        if(immediate) {
+            TextDrawBackend backend;
+            immediate_text_buffer.submit(backend);
+            immediate_text_buffer.clear();
+        }
     }
 
     void override_custom_font(TagHandle font_tag, std::string family, int size, int weight, std::pair<int, int> offset, std::pair<int, int> shadow) {
@@ -661,7 +651,7 @@ namespace Balltze {
         if(dev) {
             D3DXCreateFontA(dev, font.scaled_size, 0, font.weight, 1, FALSE, DEFAULT_CHARSET, OUT_DEFAULT_PRECIS, ANTIALIASED_QUALITY, DEFAULT_PITCH | FF_DONTCARE, font.family.c_str(), &font.override);
 
-            for(auto &text : text_list) {
+            for(auto &text : text_buffer.commands()) {
                 if(font.tag_handle == text.font) {
                     text.override = font.override;
                 }
@@ -672,7 +662,7 @@ namespace Balltze {
     void clear_custom_font_overrides() noexcept {
         if(dev) {
             for(auto &font : map_custom_overrides) {
-                for(auto &text : text_list) {
+                for(auto &text : text_buffer.commands()) {
                     if(font.tag_handle == text.font) {
                         text.override = NULL;
                     }
@@ -687,7 +677,7 @@ namespace Balltze {
         if(!dev) {
             dev = device;
 
-            auto ini = Config::get_chimera_ini();
+            auto &ini = Config::get_chimera_ini();
             auto scale = get_resolution().height / 480.0;
 
             #define generate_font(override_var, override_name, shadow, offset) \
@@ -718,11 +708,20 @@ namespace Balltze {
             for(auto &font : map_custom_overrides) {
                 D3DXCreateFontA(dev, font.scaled_size, 0, font.weight, 1, FALSE, DEFAULT_CHARSET, OUT_DEFAULT_PRECIS, ANTIALIASED_QUALITY, DEFAULT_PITCH | FF_DONTCARE, font.family.c_str(), &font.override);
             }
+
+            // Override font text is batched through this; without it, every string is drawn on its own
+            if(D3DXCreateSpriteFN && FAILED(D3DXCreateSpriteFN(device, &text_sprite))) {
+                text_sprite = nullptr;
+            }
         }
     }
 
     static void on_reset(LPDIRECT3DDEVICE9, D3DPRESENT_PARAMETERS *) {
-        text_list.clear();
+        text_buffer.clear();
+        if(text_sprite) {
+            text_sprite->Release();
+            text_sprite = nullptr;
+        }
         if(small_font_override) {
             small_font_override->Release();
             small_font_override = nullptr;
@@ -763,6 +762,14 @@ namespace Balltze {
     }
 
     void set_up_text_hook() noexcept {
+        // Tag handles are reused by every map
+        Event::MapLoadEvent::subscribe_const(+[](Event::MapLoadEvent const &event) {
+            font_glyph_advances.clear();
+            for(auto &font : generic_fonts) {
+                font = std::nullopt;
+            }
+        });
+
         auto *text_hook_sig = Memory::get_signature("text_hook");
         auto *draw_text_8_bit_sig = Memory::get_signature("draw_8_bit_text");
         auto *draw_text_16_bit_sig = Memory::get_signature("draw_16_bit_text");
@@ -778,7 +785,7 @@ namespace Balltze {
         
         Event::FrameEvent::subscribe(+[](Event::FrameEvent &event) -> void {
             if(event.time == Event::EVENT_TIME_BEFORE) {
-                text_list.clear();
+                text_buffer.clear();
             }
         });
 
@@ -786,7 +793,7 @@ namespace Balltze {
         draw_text_16_bit = draw_text_16_bit_sig->data();
         font_data = *reinterpret_cast<FontData **>(font_data_sig->data());
 
-        auto chimera_ini = Config::get_chimera_ini();
+        auto &chimera_ini = Config::get_chimera_ini();
         if(chimera_ini.get_value_bool("font_override.enabled").value_or(false)) {
             font_override_enabled = true;
 
@@ -797,6 +804,7 @@ namespace Balltze {
 
             if(d3dx9_43) {
                 D3DXCreateFontFN = reinterpret_cast<decltype(D3DXCreateFontFN)>(reinterpret_cast<std::uint32_t>(GetProcAddress(d3dx9_43, "D3DXCreateFontA")));
+                D3DXCreateSpriteFN = reinterpret_cast<decltype(D3DXCreateSpriteFN)>(reinterpret_cast<std::uint32_t>(GetProcAddress(d3dx9_43, "D3DXCreateSprite")));
 
                 auto fonts_dir = std::filesystem::path("fonts");
                 if(std::filesystem::is_directory(fonts_dir)) {
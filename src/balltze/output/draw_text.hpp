@@ -3,10 +3,12 @@
 #ifndef BALLTZE__OUTPUT__DRAW_TEXT_HPP
 #define BALLTZE__OUTPUT__DRAW_TEXT_HPP
 
+#include <cstdint>
 #include <string>
 #include <variant>
 #include <balltze/output.hpp>
 #include <balltze/engine/tag.hpp>
+#include "font_glyph_advances.hpp"
 
 namespace Balltze {
     struct FontData {
@@ -39,6 +41,13 @@ namespace Balltze {
      */
     FontData &get_current_font_data() noexcept;
 
+    /**
+     * Get the character widths of a font. They are read from the font tag the first time and kept until a map is loaded.
+     * @param font  Font to get the character widths of
+     * @return      Character widths, or nullptr if the font is drawn with an override font or its tag is not loaded
+     */
+    FontGlyphAdvances const *get_font_glyph_advances(const std::variant<Engine::TagHandle, GenericFont> &font) noexcept;
+
     /**
      * Set up the text hook for showing text.
      */
@@ -0,0 +1,66 @@
+// SPDX-License-Identifier: GPL-3.0-only
+
+#ifndef BALLTZE__OUTPUT__FONT_GLYPH_ADVANCES_HPP
+#define BALLTZE__OUTPUT__FONT_GLYPH_ADVANCES_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+
+namespace Balltze {
+    /**
+     * Character of a font tag
+     */
+    struct FontCharacter {
+        std::uint16_t character;
+        std::uint16_t character_width;
+        char i_stopped_caring[16];
+    };
+    static_assert(sizeof(FontCharacter) == 0x14);
+
+    /**
+     * Widths of the characters of a font tag
+     */
+    struct FontGlyphAdvances {
+        /** Widths of the characters below 256, which covers every 8-bit string */
+        std::uint16_t byte_advances[256] = {};
+
+        /** Widths of the remaining characters */
+        std::unordered_map<std::uint32_t, std::uint16_t> other_advances;
+
+        FontGlyphAdvances() = default;
+
+        /**
+         * Read the widths of the characters of a font tag. If a character is in the table more than
+         * once, its first entry wins, like when searching the table.
+         * @param characters        Characters of the font tag
+         * @param character_count   Number of characters
+         */
+        FontGlyphAdvances(FontCharacter const *characters, std::size_t character_count) {
+            for(std::size_t i = character_count; i > 0; i--) {
+                auto &character = characters[i - 1];
+                if(character.character < 256) {
+                    byte_advances[character.character] = character.character_width;
+                }
+                else {
+                    other_advances[character.character] = character.character_width;
+                }
+            }
+        }
+
+        /**
+         * Get the width of a character
+         * @param character     Character code
+         * @return              Width of the character, or 0 if the font does not have it
+         */
+        std::uint16_t get(std::uint32_t character) const noexcept {
+            if(character < 256) {
+                return byte_advances[character];
+            }
+            auto it = other_advances.find(character);
+            return it != other_advances.end() ? it->second : 0;
+        }
+    };
+}
+
+#endif
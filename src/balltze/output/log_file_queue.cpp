@@ -0,0 +1,177 @@
+// SPDX-License-Identifier: GPL-3.0-only
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <fmt/chrono.h>
+#include <fmt/format.h>
+#include "log_file_queue.hpp"
+
+namespace Balltze {
+    struct LogQueueSlot {
+        std::atomic<std::size_t> sequence;
+        LogFileRecord record;
+    };
+
+    /** Number of records the queue can hold; must be a power of two */
+    static constexpr std::size_t LOG_QUEUE_SIZE = 8192;
+
+    /** How often the writer wakes up to empty the queue */
+    static constexpr auto LOG_WRITER_INTERVAL = std::chrono::milliseconds(50);
+
+    /** How often the log files are flushed when no error is logged */
+    static constexpr auto LOG_FLUSH_INTERVAL = std::chrono::seconds(1);
+
+    static std::unique_ptr<LogQueueSlot[]> log_queue;
+    static std::atomic<std::size_t> log_queue_enqueue_position = 0;
+    static std::size_t log_queue_dequeue_position = 0;
+    static std::atomic<bool> log_queue_ready = false;
+    static std::atomic_flag log_queue_consumer = ATOMIC_FLAG_INIT;
+    static std::atomic<bool> log_queue_drop_on_overflow = false;
+    static std::atomic<std::size_t> dropped_log_records = 0;
+    static std::vector<std::shared_ptr<std::ofstream>> unflushed_log_files;
+    static std::mutex log_writer_mutex;
+    static std::condition_variable log_writer_condition;
+    static std::once_flag log_writer_started;
+
+    /**
+     * Write the records waiting in the queue to their files.
+     * Only one thread can do this at a time; returns false if another one is already doing it.
+     */
+    static bool write_queued_log_records(bool flush) noexcept {
+        if(log_queue_consumer.test_and_set(std::memory_order_acquire)) {
+            return false;
+        }
+
+        static std::time_t last_time = 0;
+        static std::string last_time_text;
+
+        while(true) {
+            auto &slot = log_queue[log_queue_dequeue_position % LOG_QUEUE_SIZE];
+            if(slot.sequence.load(std::memory_order_acquire) != log_queue_dequeue_position + 1) {
+                break;
+            }
+            auto record = std::move(slot.record);
+            slot.sequence.store(log_queue_dequeue_position + LOG_QUEUE_SIZE, std::memory_order_release);
+            log_queue_dequeue_position++;
+
+            try {
+                if(record.time != last_time) {
+                    last_time = record.time;
+                    last_time_text = fmt::format("{:%Y-%m-%d %H:%M:%S}", fmt::localtime(record.time));
+                }
+                auto dropped = dropped_log_records.exchange(0, std::memory_order_relaxed);
+                if(dropped > 0) {
+                    *record.file << fmt::format("{} {} log records were dropped because the log queue was full\n", last_time_text, dropped);
+                }
+                *record.file << last_time_text << ' ' << record.text;
+                if(std::find(unflushed_log_files.begin(), unflushed_log_files.end(), record.file) == unflushed_log_files.end()) {
+                    unflushed_log_files.push_back(std::move(record.file));
+                }
+            }
+            catch(...) {
+                // Nothing we can do about it; the record is lost
+            }
+            flush = flush || record.flush;
+        }
+
+        if(flush) {
+            for(auto &file : unflushed_log_files) {
+                file->flush();
+            }
+            unflushed_log_files.clear();
+        }
+
+        log_queue_consumer.clear(std::memory_order_release);
+        return true;
+    }
+
+    static void log_writer() {
+        auto last_flush = std::chrono::steady_clock::now();
+        while(true) {
+            {
+                std::unique_lock lock(log_writer_mutex);
+                log_writer_condition.wait_for(lock, LOG_WRITER_INTERVAL);
+            }
+            auto now = std::chrono::steady_clock::now();
+            bool flush = now - last_flush >= LOG_FLUSH_INTERVAL;
+            if(write_queued_log_records(flush) && flush) {
+                last_flush = now;
+            }
+        }
+    }
+
+    static void start_log_writer() {
+        std::call_once(log_writer_started, [] {
+            log_queue = std::make_unique<LogQueueSlot[]>(LOG_QUEUE_SIZE);
+            for(std::size_t i = 0; i < LOG_QUEUE_SIZE; i++) {
+                log_queue[i].sequence.store(i, std::memory_order_relaxed);
+            }
+            log_queue_ready.store(true, std::memory_order_release);
+            std::thread(log_writer).detach();
+        });
+    }
+
+    // The queue is a bounded ring where each slot carries a sequence number, so producers only contend
+    // on the enqueue position
+    void enqueue_log_record(LogFileRecord &&record) {
+        start_log_writer();
+
+        bool wake_writer = record.flush;
+        auto position = log_queue_enqueue_position.load(std::memory_order_relaxed);
+        while(true) {
+            auto &slot = log_queue[position % LOG_QUEUE_SIZE];
+            auto sequence = slot.sequence.load(std::memory_order_acquire);
+            auto difference = static_cast<std::ptrdiff_t>(sequence - position);
+            if(difference == 0) {
+                if(log_queue_enqueue_position.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+                    slot.record = std::move(record);
+                    slot.sequence.store(position + 1, std::memory_order_release);
+                    break;
+                }
+            }
+            else if(difference < 0) {
+                // The queue is full
+                if(log_queue_drop_on_overflow.load(std::memory_order_relaxed)) {
+                    dropped_log_records.fetch_add(1, std::memory_order_relaxed);
+                    return;
+                }
+
+                // Empty it ourselves if the writer is not running (e.g. while the loader lock is held)
+                log_writer_condition.notify_one();
+                if(!write_queued_log_records(false)) {
+                    std::this_thread::yield();
+                }
+                position = log_queue_enqueue_position.load(std::memory_order_relaxed);
+            }
+            else {
+                position = log_queue_enqueue_position.load(std::memory_order_relaxed);
+            }
+        }
+
+        if(wake_writer) {
+            log_writer_condition.notify_one();
+        }
+    }
+
+    void flush_log_files() noexcept {
+        // Nothing was ever queued
+        if(!log_queue_ready.load(std::memory_order_acquire)) {
+            return;
+        }
+
+        // Wait for the writer if it is in the middle of a batch, but do not hang if it is gone
+        auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(1);
+        while(!write_queued_log_records(true) && std::chrono::steady_clock::now() < deadline) {
+            std::this_thread::yield();
+        }
+    }
+
+    void set_log_queue_drop_on_overflow(bool setting) noexcept {
+        log_queue_drop_on_overflow = setting;
+    }
+}
@@ -0,0 +1,37 @@
+// SPDX-License-Identifier: GPL-3.0-only
+
+#ifndef BALLTZE__OUTPUT__LOG_FILE_QUEUE_HPP
+#define BALLTZE__OUTPUT__LOG_FILE_QUEUE_HPP
+
+#include <ctime>
+#include <fstream>
+#include <memory>
+#include <string>
+
+namespace Balltze {
+    struct LogFileRecord {
+        std::shared_ptr<std::ofstream> file;
+        std::time_t time;
+        std::string text;
+        bool flush;
+    };
+
+    /**
+     * Queue a record to be written to its file by the log writer thread.
+     * Records are written in the order they were queued; the time is prepended to the text.
+     */
+    void enqueue_log_record(LogFileRecord &&record);
+
+    /**
+     * Write the log records waiting in the queue and flush the log files.
+     * File output is done by a background thread; this makes sure nothing is left behind.
+     */
+    void flush_log_files() noexcept;
+
+    /**
+     * Set whether log records are dropped or the caller waits when the log queue is full
+     */
+    void set_log_queue_drop_on_overflow(bool setting) noexcept;
+}
+
+#endif
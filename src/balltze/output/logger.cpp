@@ -1,6 +1,9 @@
 // SPDX-License-Identifier: GPL-3.0-only
 
 #include <windows.h>
+#include <memory>
+#include <shared_mutex>
+#include <unordered_map>
 #include <balltze/api.hpp>
 #include <balltze/logger.hpp>
 #include <balltze/engine/core.hpp>
@@ -9,6 +12,7 @@
 #include <fmt/os.h>
 #include <fmt/printf.h>
 #include "../plugins/loader.hpp"
+#include "../logger.hpp"
 
 namespace Balltze {
     static std::string name_for_log_level(Logger::LogLevel level) noexcept {
@@ -62,6 +66,39 @@ namespace Balltze {
         }
     }
 
+    /**
+     * Files of the loggers. They are kept out of the loggers, whose layout is part of the API; records
+     * in the log queue hold a reference, so a file stays open until its records are written.
+     */
+    struct LoggerFiles {
+        std::shared_mutex mutex;
+        std::unordered_map<Logger const *, std::shared_ptr<std::ofstream>> files;
+    };
+
+    static LoggerFiles &logger_files() noexcept {
+        // Never destroyed, since loggers may be used while static objects are being destroyed
+        static auto *files = new LoggerFiles();
+        return *files;
+    }
+
+    static std::shared_ptr<std::ofstream> get_logger_file(Logger const *logger) noexcept {
+        auto &files = logger_files();
+        std::shared_lock lock(files.mutex);
+        auto it = files.files.find(logger);
+        return it != files.files.end() ? it->second : nullptr;
+    }
+
+    static void set_logger_file(Logger const *logger, std::shared_ptr<std::ofstream> file) {
+        auto &files = logger_files();
+        std::unique_lock lock(files.mutex);
+        if(file) {
+            files.files[logger] = std::move(file);
+        }
+        else {
+            files.files.erase(logger);
+        }
+    }
+
     Logger::LoggerStream::LoggerStream(Logger *logger, LogLevel level, std::string prefix, std::string console_format, std::string file_format, std::string ingame_format, fmt::text_style console_style) noexcept
         : m_logger(logger), m_level(level), m_prefix(prefix), m_console_format(console_format), m_file_format(file_format), m_ingame_format(ingame_format), m_console_style(console_style) {
     }
@@ -100,7 +137,7 @@ namespace Balltze {
 
     Logger::Logger(std::string name) noexcept : m_name(name) {
         #define CREATE_LOGGER_STREAM(name, level) \
-            name = LoggerStream(this, Logger::level, name_for_log_level(Logger::level), "\r{} {} [{}] {}\n", "{} {} [{}] {}\n", "[{}] {}\n", style_for_log_level(Logger::level))
+            name = LoggerStream(this, Logger::level, name_for_log_level(Logger::level), "\r{} {} [{}] {}\n", "{} [{}] {}\n", "[{}] {}\n", style_for_log_level(Logger::level))
 
         CREATE_LOGGER_STREAM(debug, LOG_LEVEL_DEBUG);
         CREATE_LOGGER_STREAM(info, LOG_LEVEL_INFO);
@@ -109,6 +146,9 @@ namespace Balltze {
         CREATE_LOGGER_STREAM(fatal, LOG_LEVEL_FATAL);
 
         #undef CREATE_LOGGER_STREAM
+
+        // Loggers are destroyed by inline code, so a file left behind by a previous logger at this address is dropped here
+        set_logger_file(this, nullptr);
     }
 
     void Logger::set_file_impl(HMODULE module, std::filesystem::path file_path, bool append) {
@@ -138,10 +178,12 @@ namespace Balltze {
         }
         m_append = append;
 
-        m_file.open(*m_file_path, std::ios::out | (m_append ? std::ios::app : std::ios::trunc));
-        if(!m_file.is_open()) {
+        // Records already queued keep the previous file alive until they are written
+        auto file = std::make_shared<std::ofstream>(*m_file_path, std::ios::out | (m_append ? std::ios::app : std::ios::trunc));
+        if(!file->is_open()) {
             throw std::runtime_error("Failed to create/open file");
         }
+        set_logger_file(this, std::move(file));
     }
 
     static inline bool current_exe_is_cui() noexcept {
@@ -152,33 +194,40 @@ namespace Balltze {
     }
 
     void Logger::endl_impl(HMODULE module, LoggerStream &stream) {
-        if(!(stream.m_level == LOG_LEVEL_DEBUG && stream.m_logger->m_mute_debug)) {
-            if(get_balltze_side() == BALLTZE_SIDE_CLIENT) {
-                print_ingame(stream);
-            }
-
-            // For some reason, it crash the game when the subsystem is GUI
-            static bool is_cui = current_exe_is_cui();
-            if(is_cui) {
-                print_console(stream);
-            }
-
-            print_file(stream);
+        if(stream.enabled()) {
+            write_impl(module, stream, stream.m_stream.str());
         }
 
+        // Plugins built against older headers fill the stream of muted levels too
         stream.m_stream.str("");
         stream.m_stream.clear();
     }
 
-    void Logger::print_console(LoggerStream &stream) {
-        auto name = stream.m_logger->m_name;
-        auto content = stream.m_stream.str();
+    void Logger::write_impl(HMODULE module, LoggerStream &stream, std::string_view message) {
+        if(!stream.enabled()) {
+            return;
+        }
+
+        if(get_balltze_side() == BALLTZE_SIDE_CLIENT) {
+            print_ingame(stream, message);
+        }
+
+        // For some reason, it crash the game when the subsystem is GUI
+        static bool is_cui = current_exe_is_cui();
+        if(is_cui) {
+            print_console(stream, message);
+        }
+
+        print_file(stream, message);
+    }
+
+    void Logger::print_console(LoggerStream &stream, std::string_view content) {
+        auto &name = stream.m_logger->m_name;
         constexpr const char *time_format = "{:%H:%M:%S}";
         auto time = fmt::format(time_format, fmt::localtime(std::time(nullptr)));
 
-        auto apply_format = [&](fmt::text_style style, std::string text) {
+        auto apply_format = [&](fmt::text_style style, std::string_view format) {
             fmt::basic_memory_buffer<char> buffer;
-            auto format = fmt::detail::to_string_view(text.c_str());
             bool formatted = false;
 
             if(style.has_emphasis()) {
@@ -215,28 +264,32 @@ namespace Balltze {
         }
     }
 
-    void Logger::print_file(LoggerStream &stream) {
+    void Logger::print_file(LoggerStream &stream, std::string_view content) {
         auto *logger = stream.m_logger;
 
-        if(logger->m_file.is_open()) {
-            auto name = logger->m_name;
-            auto content = stream.m_stream.str();
-            auto time = fmt::format("{:%Y-%m-%d %H:%M:%S}", fmt::localtime(std::time(nullptr)));
+        // Removing the file of a logger only clears its path
+        if(!logger->m_file_path || content.empty()) {
+            return;
+        }
+        auto file = get_logger_file(logger);
+        if(!file) {
+            return;
+        }
+        auto text = fmt::format(fmt::runtime(stream.m_file_format), stream.m_prefix, logger->m_name, content);
+        enqueue_log_record({std::move(file), std::time(nullptr), std::move(text), stream.m_level >= LOG_LEVEL_ERROR});
 
-            if(!content.empty()) {
-                logger->m_file << fmt::format(fmt::runtime(stream.m_file_format), time, stream.m_prefix, name, content);
-                logger->m_file.flush();
-            }
+        // The process is likely about to go down; do not leave the record in the queue
+        if(stream.m_level == LOG_LEVEL_FATAL) {
+            flush_log_files();
         }
     }
 
-    void Logger::print_ingame(LoggerStream &stream) {
+    void Logger::print_ingame(LoggerStream &stream, std::string_view content) {
         if(stream.m_logger->m_mute_ingame) {
             return;
         }
 
-        auto name = stream.m_logger->m_name;
-        auto content = stream.m_stream.str();
+        auto &name = stream.m_logger->m_name;
 
         if(!content.empty()) {
             auto color = color_for_log_level(stream.m_level);
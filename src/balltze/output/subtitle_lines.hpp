@@ -0,0 +1,85 @@
+// SPDX-License-Identifier: GPL-3.0-only
+
+#ifndef BALLTZE__OUTPUT__SUBTITLE_LINES_HPP
+#define BALLTZE__OUTPUT__SUBTITLE_LINES_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <type_traits>
+#include <vector>
+#include "font_glyph_advances.hpp"
+
+namespace Balltze {
+    /**
+     * Split a text into lines that fit a width. A word is added to the current line as long as the line
+     * is narrower than the width before adding it.
+     * @param text          Text to split
+     * @param width         Width of the lines
+     * @param advances      Character widths of the font, or nullptr if lines have to be measured
+     * @param measure_line  Function returning the width of a line, like get_text_pixel_length
+     * @return              Lines of the text
+     */
+    template<typename T, typename MeasureLine>
+    std::vector<std::basic_string<T>> split_subtitle_lines(std::basic_string<T> const &text, std::size_t width, FontGlyphAdvances const *advances, MeasureLine const &measure_line) {
+        std::basic_string<T> line;
+        std::basic_string<T> word;
+        std::vector<std::basic_string<T>> lines;
+        line.reserve(text.size());
+
+        // Tag fonts are measured by adding up character widths, so the line width is kept as words are added.
+        // Override fonts are measured by Direct3D, so the line has to be measured every time.
+        std::size_t line_width = 0;
+        std::size_t word_width = 0;
+        std::size_t space_width = advances ? advances->get(' ') : 0;
+
+        auto line_fits = [&]() {
+            // Past INT16_MAX, get_text_pixel_length stops at the last width that did not overflow
+            if(advances && line_width <= INT16_MAX) {
+                return line_width < width;
+            }
+            return static_cast<std::size_t>(measure_line(line.c_str())) < width;
+        };
+
+        for(auto c : text) {
+            if(c == ' ') {
+                if(line_fits()) {
+                    if(!line.empty()) {
+                        line += ' ';
+                        line_width += space_width;
+                    }
+                    line += word;
+                    line_width += word_width;
+                }
+                else {
+                    lines.push_back(line);
+                    line = word;
+                    line_width = word_width;
+                }
+                word.clear();
+                word_width = 0;
+            }
+            else {
+                word += c;
+                if(advances) {
+                    word_width += advances->get(static_cast<std::make_unsigned_t<T>>(c));
+                }
+            }
+        }
+
+        if(!word.empty()) {
+            if(!line.empty()) {
+                line += ' ';
+            }
+            line += word;
+        }
+
+        if(!line.empty()) {
+            lines.push_back(line);
+        }
+
+        return lines;
+    }
+}
+
+#endif
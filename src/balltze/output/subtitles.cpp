@@ -12,6 +12,7 @@
 #include <balltze/engine/rasterizer.hpp>
 #include <balltze/events/frame.hpp>
 #include "../output/draw_text.hpp"
+#include "subtitle_lines.hpp"
 #include "../logger.hpp"
 
 namespace Balltze {
@@ -28,86 +29,11 @@ namespace Balltze {
     static auto fade_in_duration_ms = std::chrono::milliseconds(120);
     static auto fade_out_duration_ms = std::chrono::milliseconds(250);
 
-    static std::vector<std::string> split_string(std::string text) {
-        std::string buffer(text);
-        std::string line;
-        std::string word;
-        std::vector<std::string> lines;
-        line.reserve(buffer.size());
-
-        for(auto c : text) {
-            if (c == ' ') {
-                if(get_text_pixel_length(line.c_str(), subtitle_font) < subtitle_width) {
-                    if(!line.empty()) {
-                        line += ' ';
-                    }
-                    line += word;
-                    word.clear();
-                } 
-                else {
-                    lines.push_back(line);
-                    line = word;
-                    word.clear();
-                }
-            } 
-            else {
-                word += c;
-            }
-        }
-
-        if(!word.empty()) {
-            if(!line.empty()) {
-                line += ' ';
-            }
-            line += word;
-        }
-
-        if(!line.empty()) {
-            lines.push_back(line);
-        }
-
-        return std::move(lines);
-    }
-
-    static std::vector<std::wstring> split_string(std::wstring text) {
-        std::wstring buffer(text);
-        std::wstring line;
-        std::wstring word;
-        std::vector<std::wstring> lines;
-        line.reserve(buffer.size());
-
-        for(auto c : text) {
-            if (c == L' ') {
-                if(get_text_pixel_length(line.c_str(), subtitle_font) < subtitle_width) {
-                    if(!line.empty()) {
-                        line += L' ';
-                    }
-                    line += word;
-                    word.clear();
-                } 
-                else {
-                    lines.push_back(line);
-                    line = word;
-                    word.clear();
-                }
-            } 
-            else {
-                word += c;
-            }
-        }
-
-        if(!word.empty()) {
-            if(!line.empty()) {
-                line += L' ';
-            }
-            line += word;
-        }
-
-        if(!line.empty()) {
-            lines.push_back(line);
-        }
-
-        return std::move(lines);
+    template<typename T>
+    static std::vector<std::basic_string<T>> split_string(std::basic_string<T> const &text) {
+        return split_subtitle_lines(text, subtitle_width, get_font_glyph_advances(subtitle_font), [](const T *line) {
+            return get_text_pixel_length(line, subtitle_font);
+        });
     }
 
     struct Subtitle {
@@ -0,0 +1,152 @@
+// SPDX-License-Identifier: GPL-3.0-only
+
+#ifndef BALLTZE__OUTPUT__TEXT_COMMAND_BUFFER_HPP
+#define BALLTZE__OUTPUT__TEXT_COMMAND_BUFFER_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string_view>
+#include <tuple>
+#include <vector>
+#include <balltze/engine/data_types.hpp>
+#include <balltze/engine/tag.hpp>
+#include <balltze/output.hpp>
+
+struct ID3DXFont;
+
+namespace Balltze {
+    /**
+     * A string recorded in a text command buffer
+     */
+    struct TextCommand {
+        // Offset of the text in the buffer
+        std::size_t text_offset;
+
+        // Is the text made of 16-bit characters?
+        bool wide;
+
+        // Left edge of the box
+        std::int16_t x;
+
+        // Top edge of the box
+        std::int16_t y;
+
+        // Right edge of the box
+        std::int16_t right;
+
+        // Bottom edge of the box
+        std::int16_t bottom;
+
+        // Color of the text
+        Engine::ColorARGB color;
+
+        // Font to use
+        Engine::TagHandle font;
+
+        // Alignment of the font
+        FontAlignment alignment;
+
+        // Are we overriding this bad boy?
+        ID3DXFont *override;
+    };
+
+    /**
+     * Text drawn during a frame. Strings are copied into one buffer that keeps its capacity from frame to frame,
+     * and commands are submitted grouped by font.
+     */
+    class TextCommandBuffer {
+    public:
+        /**
+         * Record a string
+         * @param text      Text to draw; it does not have to be null-terminated
+         * @param command   Everything else; text_offset and wide are filled in
+         */
+        template<typename T>
+        void add(std::basic_string_view<T> text, TextCommand command) {
+            auto offset = (m_text.size() + alignof(T) - 1) / alignof(T) * alignof(T);
+            m_text.resize(offset + (text.size() + 1) * sizeof(T));
+            std::memcpy(m_text.data() + offset, text.data(), text.size() * sizeof(T));
+            std::memset(m_text.data() + offset + text.size() * sizeof(T), 0, sizeof(T));
+            command.text_offset = offset;
+            command.wide = sizeof(T) != sizeof(char);
+            m_commands.push_back(command);
+        }
+
+        /**
+         * Get the null-terminated text of a command
+         */
+        template<typename T>
+        T const *text(TextCommand const &command) const noexcept {
+            return reinterpret_cast<T const *>(m_text.data() + command.text_offset);
+        }
+
+        /**
+         * Get the recorded commands, in the order they were added
+         */
+        std::vector<TextCommand> &commands() noexcept {
+            return m_commands;
+        }
+
+        bool empty() const noexcept {
+            return m_commands.empty();
+        }
+
+        /**
+         * Drop every command, keeping the memory for the next frame
+         */
+        void clear() noexcept {
+            m_text.clear();
+            m_commands.clear();
+        }
+
+        /**
+         * Submit the commands to a backend, grouped by font. Commands of the same font keep the order they
+         * were added in, and tag fonts come before override fonts. The backend must have these members:
+         *
+         *     void begin_group(TextCommand const &first);
+         *     void draw(TextCommand const &command, void const *text);
+         *     void end_group();
+         */
+        template<typename Backend>
+        void submit(Backend &backend) {
+            m_order.resize(m_commands.size());
+            for(std::size_t i = 0; i < m_order.size(); i++) {
+                m_order[i] = i;
+            }
+
+            // The index breaks ties, which keeps the sort stable without the buffer std::stable_sort allocates
+            auto key = [this](std::size_t index) {
+                auto &command = m_commands[index];
+                return std::make_tuple(reinterpret_cast<std::uintptr_t>(command.override), command.font.value, index);
+            };
+            std::sort(m_order.begin(), m_order.end(), [&key](std::size_t a, std::size_t b) {
+                return key(a) < key(b);
+            });
+
+            TextCommand const *group = nullptr;
+            for(auto index : m_order) {
+                auto &command = m_commands[index];
+                if(!group || group->override != command.override || group->font.value != command.font.value) {
+                    if(group) {
+                        backend.end_group();
+                    }
+                    group = &command;
+                    backend.begin_group(command);
+                }
+                backend.draw(command, m_text.data() + command.text_offset);
+            }
+            if(group) {
+                backend.end_group();
+            }
+        }
+
+    private:
+        std::vector<std::byte> m_text;
+        std::vector<TextCommand> m_commands;
+        std::vector<std::size_t> m_order;
+    };
+}
+
+#endif
@@ -0,0 +1,347 @@
+// SPDX-License-Identifier: GPL-3.0-only
+
+#include <windows.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <ctime>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <vector>
+#include <balltze/command.hpp>
+#include <balltze/engine/core.hpp>
+#include <balltze/trace.hpp>
+#include "../config/config.hpp"
+#include "../logger.hpp"
+#include "trace.hpp"
+
+namespace Balltze::Trace {
+    /** Size of the trace buffer of each thread */
+    static constexpr std::size_t TRACE_BUFFER_SIZE = 64 * 1024;
+
+    /** Maximum number of events that can be registered */
+    static constexpr std::size_t TRACE_MAX_EVENTS = 1024;
+
+    /** Records start with the counter value and the event identifier */
+    static constexpr std::size_t TRACE_RECORD_HEADER_SIZE = sizeof(std::uint64_t) + sizeof(TraceEventId);
+
+    static constexpr char TRACE_FILE_MAGIC[8] = {'B', 'L', 'T', 'Z', 'T', 'R', 'C', 'E'};
+    static constexpr std::uint32_t TRACE_FILE_VERSION = 1;
+
+    enum TraceChunkType : std::uint32_t {
+        TRACE_CHUNK_EVENT_DESCRIPTOR = 1,
+        TRACE_CHUNK_RECORDS = 2
+    };
+
+    struct TraceEventDescriptor {
+        std::string name;
+        std::vector<std::string> field_names;
+        std::vector<TraceFieldType> field_types;
+    };
+
+    struct TraceBuffer {
+        std::atomic_flag lock = ATOMIC_FLAG_INIT;
+        std::uint32_t thread_id;
+        std::size_t size = 0;
+        std::byte data[TRACE_BUFFER_SIZE];
+
+        TraceBuffer() noexcept;
+        ~TraceBuffer() noexcept;
+    };
+
+    static std::timed_mutex trace_mutex;
+    static std::FILE *trace_file = nullptr;
+    static std::optional<std::filesystem::path> trace_file_path;
+    static std::atomic<bool> tracing = false;
+    static std::vector<TraceEventDescriptor> trace_events;
+    static std::uint16_t trace_event_payload_sizes[TRACE_MAX_EVENTS];
+    static std::vector<TraceBuffer *> trace_buffers;
+
+    static std::size_t trace_field_size(TraceFieldType type) noexcept {
+        switch(type) {
+            case TRACE_FIELD_BOOL:
+            case TRACE_FIELD_INT8:
+            case TRACE_FIELD_UINT8:
+                return 1;
+            case TRACE_FIELD_INT16:
+            case TRACE_FIELD_UINT16:
+                return 2;
+            case TRACE_FIELD_INT32:
+            case TRACE_FIELD_UINT32:
+            case TRACE_FIELD_FLOAT:
+                return 4;
+            case TRACE_FIELD_INT64:
+            case TRACE_FIELD_UINT64:
+            case TRACE_FIELD_DOUBLE:
+                return 8;
+            default:
+                return 0;
+        }
+    }
+
+    template<typename T>
+    static void append_value(std::vector<std::byte> &data, T value) {
+        auto *bytes = reinterpret_cast<std::byte const *>(&value);
+        data.insert(data.end(), bytes, bytes + sizeof(T));
+    }
+
+    static void append_string(std::vector<std::byte> &data, std::string const &string) {
+        append_value<std::uint16_t>(data, string.size());
+        auto *bytes = reinterpret_cast<std::byte const *>(string.data());
+        data.insert(data.end(), bytes, bytes + string.size());
+    }
+
+    /**
+     * Write a chunk to the trace file. Caller must hold trace_mutex.
+     */
+    static void write_chunk(TraceChunkType type, void const *data, std::size_t size, void const *extra = nullptr, std::size_t extra_size = 0) noexcept {
+        if(!trace_file) {
+            return;
+        }
+        std::uint32_t header[2] = {type, static_cast<std::uint32_t>(size + extra_size)};
+        std::fwrite(header, sizeof(header), 1, trace_file);
+        std::fwrite(data, size, 1, trace_file);
+        if(extra_size > 0) {
+            std::fwrite(extra, extra_size, 1, trace_file);
+        }
+    }
+
+    /**
+     * Write the descriptor of an event to the trace file. Caller must hold trace_mutex.
+     */
+    static void write_event_descriptor(TraceEventId id) noexcept {
+        try {
+            auto &event = trace_events[id - 1];
+            std::vector<std::byte> data;
+            append_value<TraceEventId>(data, id);
+            append_value<std::uint8_t>(data, event.field_types.size());
+            append_string(data, event.name);
+            for(std::size_t i = 0; i < event.field_types.size(); i++) {
+                append_value<std::uint8_t>(data, event.field_types[i]);
+                append_string(data, event.field_names[i]);
+            }
+            write_chunk(TRACE_CHUNK_EVENT_DESCRIPTOR, data.data(), data.size());
+        }
+        catch(...) {
+            logger.warning("Failed to write descriptor of trace event {}", id);
+        }
+    }
+
+    /**
+     * Write the records of a buffer to the trace file and empty it.
+     * Caller must hold trace_mutex and the buffer lock.
+     */
+    static void flush_buffer(TraceBuffer &buffer) noexcept {
+        if(buffer.size > 0) {
+            write_chunk(TRACE_CHUNK_RECORDS, &buffer.thread_id, sizeof(buffer.thread_id), buffer.data, buffer.size);
+            buffer.size = 0;
+        }
+    }
+
+    static void lock_buffer(TraceBuffer &buffer) noexcept {
+        while(buffer.lock.test_and_set(std::memory_order_acquire)) {
+            SwitchToThread();
+        }
+    }
+
+    static void unlock_buffer(TraceBuffer &buffer) noexcept {
+        buffer.lock.clear(std::memory_order_release);
+    }
+
+    TraceBuffer::TraceBuffer() noexcept : thread_id(GetCurrentThreadId()) {
+        std::lock_guard lock(trace_mutex);
+        trace_buffers.push_back(this);
+    }
+
+    TraceBuffer::~TraceBuffer() noexcept {
+        std::lock_guard lock(trace_mutex);
+        lock_buffer(*this);
+        flush_buffer(*this);
+        unlock_buffer(*this);
+        std::erase(trace_buffers, this);
+    }
+
+    static TraceBuffer *get_thread_buffer() noexcept {
+        static thread_local std::unique_ptr<TraceBuffer> buffer;
+        if(!buffer) {
+            try {
+                buffer = std::make_unique<TraceBuffer>();
+            }
+            catch(...) {
+                return nullptr;
+            }
+        }
+        return buffer.get();
+    }
+
+    TraceEventId register_trace_event(const char *name, const char *const *field_names, TraceFieldType const *field_types, std::size_t field_count) noexcept {
+        std::lock_guard lock(trace_mutex);
+        if(trace_events.size() >= TRACE_MAX_EVENTS || field_count > TRACE_EVENT_MAX_FIELDS) {
+            logger.warning("Could not register trace event {}", name);
+            return 0;
+        }
+
+        try {
+            TraceEventDescriptor event;
+            event.name = name;
+            std::size_t payload_size = 0;
+            for(std::size_t i = 0; i < field_count; i++) {
+                event.field_names.emplace_back(field_names[i]);
+                event.field_types.push_back(field_types[i]);
+                payload_size += trace_field_size(field_types[i]);
+            }
+            trace_events.push_back(std::move(event));
+            trace_event_payload_sizes[trace_events.size() - 1] = payload_size;
+        }
+        catch(...) {
+            logger.warning("Could not register trace event {}", name);
+            return 0;
+        }
+
+        TraceEventId id = trace_events.size();
+        write_event_descriptor(id);
+        return id;
+    }
+
+    bool trace_enabled() noexcept {
+        return tracing.load(std::memory_order_relaxed);
+    }
+
+    void write_trace_record(TraceEventId event, void const *payload, std::size_t size) noexcept {
+        if(!tracing.load(std::memory_order_relaxed) || event == 0 || event > TRACE_MAX_EVENTS || trace_event_payload_sizes[event - 1] != size) {
+            return;
+        }
+
+        auto *buffer = get_thread_buffer();
+        if(!buffer) {
+            return;
+        }
+
+        LARGE_INTEGER counter;
+        QueryPerformanceCounter(&counter);
+        std::uint64_t timestamp = counter.QuadPart;
+
+        lock_buffer(*buffer);
+        if(buffer->size + TRACE_RECORD_HEADER_SIZE + size > TRACE_BUFFER_SIZE) {
+            // trace_mutex is always taken before the buffer lock
+            unlock_buffer(*buffer);
+            std::lock_guard lock(trace_mutex);
+            lock_buffer(*buffer);
+            flush_buffer(*buffer);
+        }
+        auto *record = buffer->data + buffer->size;
+        std::memcpy(record, &timestamp, sizeof(timestamp));
+        std::memcpy(record + sizeof(timestamp), &event, sizeof(event));
+        std::memcpy(record + TRACE_RECORD_HEADER_SIZE, payload, size);
+        buffer->size += TRACE_RECORD_HEADER_SIZE + size;
+        unlock_buffer(*buffer);
+    }
+
+    std::optional<std::filesystem::path> start_trace() noexcept {
+        std::lock_guard lock(trace_mutex);
+        if(trace_file) {
+            return trace_file_path;
+        }
+
+        try {
+            auto traces_directory = Config::get_balltze_directory() / "traces";
+            std::filesystem::create_directories(traces_directory);
+            char timestamp[32];
+            auto now = std::time(nullptr);
+            std::strftime(timestamp, sizeof(timestamp), "%Y%m%d_%H%M%S", std::localtime(&now));
+            trace_file_path = traces_directory / (std::string("trace_") + timestamp + ".btrace");
+        }
+        catch(std::exception &e) {
+            logger.error("Failed to create trace directory: {}", e.what());
+            return std::nullopt;
+        }
+
+        trace_file = std::fopen(trace_file_path->string().c_str(), "wb");
+        if(!trace_file) {
+            logger.error("Failed to open trace file {}", trace_file_path->string());
+            trace_file_path = std::nullopt;
+            return std::nullopt;
+        }
+
+        LARGE_INTEGER frequency;
+        LARGE_INTEGER counter;
+        QueryPerformanceFrequency(&frequency);
+        QueryPerformanceCounter(&counter);
+        std::uint64_t header_values[2] = {static_cast<std::uint64_t>(frequency.QuadPart), static_cast<std::uint64_t>(counter.QuadPart)};
+        std::fwrite(TRACE_FILE_MAGIC, sizeof(TRACE_FILE_MAGIC), 1, trace_file);
+        std::fwrite(&TRACE_FILE_VERSION, sizeof(TRACE_FILE_VERSION), 1, trace_file);
+        std::fwrite(header_values, sizeof(header_values), 1, trace_file);
+
+        for(std::size_t i = 1; i <= trace_events.size(); i++) {
+            write_event_descriptor(i);
+        }
+
+        // Drop records left behind by a previous trace
+        for(auto *buffer : trace_buffers) {
+            lock_buffer(*buffer);
+            buffer->size = 0;
+            unlock_buffer(*buffer);
+        }
+
+        tracing = true;
+        return trace_file_path;
+    }
+
+    std::optional<std::filesystem::path> stop_trace() noexcept {
+        tracing = false;
+
+        // Threads may have been killed while holding a lock if the process is exiting; do not hang on them
+        std::unique_lock lock(trace_mutex, std::chrono::seconds(1));
+        if(!lock.owns_lock() || !trace_file) {
+            return std::nullopt;
+        }
+
+        for(auto *buffer : trace_buffers) {
+            bool locked = false;
+            for(std::size_t i = 0; i < 1000 && !(locked = !buffer->lock.test_and_set(std::memory_order_acquire)); i++) {
+                SwitchToThread();
+            }
+            if(locked) {
+                flush_buffer(*buffer);
+                unlock_buffer(*buffer);
+            }
+        }
+
+        std::fclose(trace_file);
+        trace_file = nullptr;
+        auto path = trace_file_path;
+        trace_file_path = std::nullopt;
+        return path;
+    }
+
+    void set_up_trace() noexcept {
+        if(Config::get_config().get<bool>("trace.enabled").value_or(false)) {
+            auto path = start_trace();
+            if(path) {
+                logger.info("Writing trace to {}", path->string());
+            }
+        }
+
+        register_command("trace", "debug", "Starts or stops writing trace records to a file in the traces folder.", std::nullopt, [](int arg_count, const char **args) -> bool {
+            if(trace_enabled()) {
+                auto path = stop_trace();
+                if(path) {
+                    Engine::console_printf("Trace written to %s", path->string().c_str());
+                }
+            }
+            else {
+                auto path = start_trace();
+                if(!path) {
+                    Engine::console_printf("Failed to start the trace.");
+                    return false;
+                }
+                Engine::console_printf("Writing trace to %s", path->string().c_str());
+            }
+            return true;
+        }, false, 0, 0);
+    }
+}
@@ -0,0 +1,26 @@
+// SPDX-License-Identifier: GPL-3.0-only
+
+#ifndef BALLTZE__OUTPUT__TRACE_HPP
+#define BALLTZE__OUTPUT__TRACE_HPP
+
+#include <filesystem>
+#include <optional>
+#include <balltze/trace.hpp>
+
+namespace Balltze::Trace {
+    /**
+     * Open a new trace file and start writing records to it
+     * @return  Path of the trace file, or nothing if it could not be opened
+     */
+    std::optional<std::filesystem::path> start_trace() noexcept;
+
+    /**
+     * Write the buffers of every thread and close the trace file
+     * @return  Path of the trace file, or nothing if no trace was being written
+     */
+    std::optional<std::filesystem::path> stop_trace() noexcept;
+
+    void set_up_trace() noexcept;
+}
+
+#endif
@@ -5,14 +5,21 @@
 #include <filesystem>
 #include <memory>
 #include <balltze/command.hpp>
+#include <balltze/engine/core.hpp>
 #include <balltze/event.hpp>
+#include <balltze/memory.hpp>
+#include "../config/config.hpp"
+#include "../features/features.hpp"
 #include "../logger.hpp"
+#include "lua/helpers/luacstruct.hpp"
+#include "lua/profiler.hpp"
 #include "loader.hpp"
 
 namespace Balltze::Plugins {
     using namespace Event;
 
     static std::vector<std::unique_ptr<Plugin>> plugins;
+    static std::vector<LuaPlugin *> lua_plugins;
     static bool reinit_plugins_on_next_tick;
     static std::optional<std::string> last_map;
 
@@ -67,7 +74,8 @@ namespace Balltze::Plugins {
                     continue;
                 }
                 try {
-                    plugins.emplace_back(std::make_unique<LuaPlugin>(plugin_file.path()));
+                    auto &plugin = plugins.emplace_back(std::make_unique<LuaPlugin>(plugin_file.path()));
+                    lua_plugins.push_back(static_cast<LuaPlugin *>(plugin.get()));
                 }
                 catch(std::runtime_error &) {
                     logger.error("Failed to initialize plugin {}", plugin_file.path().filename().string());
@@ -126,6 +134,7 @@ namespace Balltze::Plugins {
                 if(plugin->loaded()) {
                     plugin->unload();
                 }
+                std::erase(lua_plugins, plugin);
                 it = plugins.erase(it);
             }
             else {
@@ -155,17 +164,24 @@ namespace Balltze::Plugins {
             reinit_plugins_on_next_tick = false;
         }
 
+        Features::dispatch_completed_jobs();
+
         for(auto &plugin : plugins) {
             if(plugin->loaded()) {
                 plugin->first_tick();
             }
         }
+
+        for(auto *plugin : get_lua_plugins()) {
+            if(auto *allocator = plugin->allocator()) {
+                allocator->sample_allocation_rate();
+            }
+        }
     }
 
     static void plugins_frame(FrameEvent const &context) noexcept {
         if(context.time == EVENT_TIME_AFTER) {
-            auto lua_plugins = get_lua_plugins();
-            for(auto &plugin : lua_plugins) {
+            for(auto *plugin : lua_plugins) {
                 if(plugin->loaded()) {
                     auto *state = plugin->state();
                     lua_gc(state, LUA_GCCOLLECT, 0);
@@ -183,32 +199,32 @@ namespace Balltze::Plugins {
             }
             else {
                 unload_map_plugins();
+                invalidate_lua_object_proxies();
             }
             load_map_plugins(ev.context.name);
             last_map = ev.context.name;
         }
     }
 
-    std::vector<LuaPlugin *> get_lua_plugins() noexcept {
-        std::vector<LuaPlugin *> lua_plugins;
-        for(auto &plugin : plugins) {
-            if(auto lua_plugin = dynamic_cast<LuaPlugin *>(plugin.get())) {
-                lua_plugins.push_back(lua_plugin);
-            }
-        }
+    std::vector<LuaPlugin *> const &get_lua_plugins() noexcept {
         return lua_plugins;
     }
 
     LuaPlugin *get_lua_plugin(lua_State *state) noexcept {
-        void *upvalue_state = reinterpret_cast<lua_State *>(lua_touserdata(state, lua_upvalueindex(1)));
-        for(auto &plugin : plugins) {
-            if(auto lua_plugin = dynamic_cast<LuaPlugin *>(plugin.get())) {
-                if(lua_plugin->state() == upvalue_state) {
-                    return lua_plugin;
-                }
+        // The upvalue is the main state of the plugin, which is not necessarily the calling thread
+        auto *upvalue_state = reinterpret_cast<lua_State *>(lua_touserdata(state, lua_upvalueindex(1)));
+        if(!upvalue_state) {
+            return nullptr;
+        }
+        return *reinterpret_cast<LuaPlugin **>(lua_getextraspace(upvalue_state));
+    }
+
+    void invalidate_lua_object_proxies(void *address, std::size_t size) noexcept {
+        for(auto *plugin : get_lua_plugins()) {
+            if(plugin->loaded()) {
+                luacs_invalidate_objects(plugin->state(), address, size);
             }
         }
-        return nullptr;
     }
 
     NativePlugin *get_dll_plugin(HMODULE handle) noexcept {
@@ -234,6 +250,50 @@ namespace Balltze::Plugins {
             reinit_plugins_on_next_tick = true;
             return true;
         }, false, 0, 0);
+
+        register_command("lua_plugins_memory", "plugins", "Prints the memory usage of the loaded Lua plugins.", std::nullopt, [](int arg_count, const char **args) -> bool {
+            std::size_t total_live_bytes = 0;
+            for(auto *plugin : get_lua_plugins()) {
+                auto *allocator = plugin->allocator();
+                if(!plugin->loaded() || !allocator) {
+                    continue;
+                }
+                auto stats = allocator->stats();
+                total_live_bytes += stats.live_bytes;
+                Engine::console_printf("%s: %.1f KiB (peak %.1f KiB, pools %.1f KiB), %.0f allocations/s", plugin->filename().c_str(), stats.live_bytes / 1024.0f, stats.peak_bytes / 1024.0f, stats.pooled_bytes / 1024.0f, stats.allocation_rate);
+                if(stats.limit) {
+                    Engine::console_printf("  limit: %.2f MiB, %zu allocations refused", static_cast<float>(*stats.limit) / MIB_SIZE, stats.refused_allocations);
+                }
+            }
+            Engine::console_printf("Total: %.2f MiB", static_cast<float>(total_live_bytes) / MIB_SIZE);
+            return true;
+        }, false, 0, 0);
+
+        register_command("lua_profiler", "plugins", "Starts or stops sampling the Lua stack of a plugin, or of every Lua plugin if no plugin is given. Profiles are written to the profiles folder as collapsed stacks.", "[plugin file name]", [](int arg_count, const char **args) -> bool {
+            auto sample_interval = Config::get_config().get<std::size_t>("plugins.profiler_sample_interval").value_or(1000);
+            bool found = false;
+            for(auto *plugin : get_lua_plugins()) {
+                if(!plugin->loaded() || (arg_count == 1 && plugin->filename() != args[0])) {
+                    continue;
+                }
+                found = true;
+                if(Lua::lua_profiler_running(plugin)) {
+                    auto path = Lua::stop_lua_profiler(plugin);
+                    if(path) {
+                        Engine::console_printf("Stopped profiling %s, profile written to %s", plugin->filename().c_str(), path->string().c_str());
+                    }
+                }
+                else {
+                    Lua::start_lua_profiler(plugin, sample_interval);
+                    Engine::console_printf("Profiling %s every %zu instructions", plugin->filename().c_str(), sample_interval);
+                }
+            }
+            if(!found) {
+                Engine::console_printf("No loaded Lua plugin found.");
+                return false;
+            }
+            return true;
+        }, false, 0, 1);
     }
 }
 
@@ -7,9 +7,26 @@
 #include "plugin.hpp"
 
 namespace Balltze::Plugins {
-    std::vector<LuaPlugin *> get_lua_plugins() noexcept;
+    /**
+     * Get the Lua plugins, loaded or not. The list is kept up to date when plugins are added
+     * or removed, so it must not be held across a plugin reload.
+     */
+    std::vector<LuaPlugin *> const &get_lua_plugins() noexcept;
+
+    /**
+     * Get the plugin owning a Balltze API function from inside the function.
+     * The plugin is stored in the extra space of its main state, so this is a constant time lookup.
+     */
     LuaPlugin *get_lua_plugin(lua_State *state) noexcept;
     NativePlugin *get_dll_plugin(HMODULE handle) noexcept;
+
+    /**
+     * Drop the cached struct proxies of every Lua plugin pointing to the given memory range,
+     * so they are not handed out again after the memory has been freed or reused.
+     * @param address   Start of the range; if null, every cached proxy is dropped
+     * @param size      Size of the range
+     */
+    void invalidate_lua_object_proxies(void *address = nullptr, std::size_t size = 0) noexcept;
     void set_up_plugins() noexcept;
 }
 
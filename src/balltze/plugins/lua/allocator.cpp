@@ -0,0 +1,189 @@
+// SPDX-License-Identifier: GPL-3.0-only
+
+#include <cstdlib>
+#include <cstring>
+#include <thread>
+#include "allocator.hpp"
+
+namespace Balltze::Plugins::Lua {
+    std::size_t LuaAllocator::get_size_class(std::size_t size) noexcept {
+        for(std::size_t i = 0; i < SIZE_CLASS_COUNT; i++) {
+            if(size <= SIZE_CLASSES[i]) {
+                return i;
+            }
+        }
+        return SIZE_CLASS_COUNT;
+    }
+
+    void LuaAllocator::lock() noexcept {
+        while(m_lock.test_and_set(std::memory_order_acquire)) {
+            std::this_thread::yield();
+        }
+    }
+
+    void LuaAllocator::unlock() noexcept {
+        m_lock.clear(std::memory_order_release);
+    }
+
+    void *LuaAllocator::pool_allocate(std::size_t size_class) noexcept {
+        auto *&free_list = m_free_lists[size_class];
+        if(!free_list) {
+            auto *chunk = static_cast<std::byte *>(std::malloc(CHUNK_SIZE));
+            if(!chunk) {
+                return nullptr;
+            }
+            try {
+                m_chunks.push_back(chunk);
+            }
+            catch(...) {
+                std::free(chunk);
+                return nullptr;
+            }
+            m_pooled_bytes += CHUNK_SIZE;
+
+            // Thread the whole chunk into the free list of the class
+            auto block_size = SIZE_CLASSES[size_class];
+            auto block_count = CHUNK_SIZE / block_size;
+            for(std::size_t i = block_count; i > 0; i--) {
+                auto *block = reinterpret_cast<FreeBlock *>(chunk + (i - 1) * block_size);
+                block->next = free_list;
+                free_list = block;
+            }
+        }
+        auto *block = free_list;
+        free_list = block->next;
+        return block;
+    }
+
+    void LuaAllocator::pool_free(void *block, std::size_t size_class) noexcept {
+        auto *free_block = static_cast<FreeBlock *>(block);
+        free_block->next = m_free_lists[size_class];
+        m_free_lists[size_class] = free_block;
+    }
+
+    void *LuaAllocator::reallocate(void *ptr, std::size_t osize, std::size_t nsize) noexcept {
+        auto old_class = get_size_class(osize);
+        auto new_class = get_size_class(nsize);
+
+        if(nsize == 0) {
+            if(!ptr) {
+                return nullptr;
+            }
+            if(old_class < SIZE_CLASS_COUNT) {
+                pool_free(ptr, old_class);
+            }
+            else {
+                std::free(ptr);
+            }
+            return nullptr;
+        }
+
+        if(ptr && old_class == new_class) {
+            if(new_class < SIZE_CLASS_COUNT) {
+                return ptr;
+            }
+            return std::realloc(ptr, nsize);
+        }
+
+        void *new_block = new_class < SIZE_CLASS_COUNT ? pool_allocate(new_class) : std::malloc(nsize);
+        if(!new_block) {
+            // Lua assumes shrinking never fails; a block fits any smaller class, so keep it.
+            // Blocks from malloc that end up in a pool are released with the chunks.
+            if(ptr && nsize < osize) {
+                if(old_class == SIZE_CLASS_COUNT) {
+                    try {
+                        m_chunks.push_back(ptr);
+                    }
+                    catch(...) {}
+                }
+                return ptr;
+            }
+            return nullptr;
+        }
+
+        if(ptr) {
+            std::memcpy(new_block, ptr, osize < nsize ? osize : nsize);
+            if(old_class < SIZE_CLASS_COUNT) {
+                pool_free(ptr, old_class);
+            }
+            else {
+                std::free(ptr);
+            }
+        }
+        return new_block;
+    }
+
+    void *LuaAllocator::allocate(void *ud, void *ptr, std::size_t osize, std::size_t nsize) noexcept {
+        auto *allocator = static_cast<LuaAllocator *>(ud);
+
+        // When allocating a new block, osize holds the type of the object instead of a size
+        if(!ptr) {
+            osize = 0;
+        }
+
+        allocator->lock();
+        if(nsize > osize && allocator->m_limit && allocator->m_live_bytes - osize + nsize > *allocator->m_limit) {
+            // Lua runs a full collection and retries before raising the memory error
+            allocator->m_refused_allocations++;
+            allocator->unlock();
+            return nullptr;
+        }
+
+        auto *block = allocator->reallocate(ptr, osize, nsize);
+        if(block || nsize == 0) {
+            allocator->m_live_bytes = allocator->m_live_bytes - osize + nsize;
+            if(allocator->m_live_bytes > allocator->m_peak_bytes) {
+                allocator->m_peak_bytes = allocator->m_live_bytes;
+            }
+            if(nsize > 0) {
+                allocator->m_allocations++;
+            }
+        }
+        allocator->unlock();
+        return block;
+    }
+
+    LuaAllocatorStats LuaAllocator::stats() noexcept {
+        lock();
+        LuaAllocatorStats stats;
+        stats.live_bytes = m_live_bytes;
+        stats.peak_bytes = m_peak_bytes;
+        stats.pooled_bytes = m_pooled_bytes;
+        stats.allocations = m_allocations;
+        stats.refused_allocations = m_refused_allocations;
+        stats.allocation_rate = m_allocation_rate;
+        stats.limit = m_limit;
+        unlock();
+        return stats;
+    }
+
+    void LuaAllocator::sample_allocation_rate() noexcept {
+        auto now = std::chrono::steady_clock::now();
+        auto elapsed = std::chrono::duration<float>(now - m_rate_sample_time).count();
+        if(elapsed < 1.0f) {
+            return;
+        }
+        lock();
+        m_allocation_rate = (m_allocations - m_rate_sample_allocations) / elapsed;
+        m_rate_sample_allocations = m_allocations;
+        m_rate_sample_time = now;
+        unlock();
+    }
+
+    void LuaAllocator::set_limit(std::optional<std::size_t> limit) noexcept {
+        lock();
+        m_limit = limit;
+        unlock();
+    }
+
+    LuaAllocator::LuaAllocator(std::optional<std::size_t> limit) noexcept {
+        m_limit = limit;
+        m_rate_sample_time = std::chrono::steady_clock::now();
+    }
+
+    LuaAllocator::~LuaAllocator() {
+        for(auto *chunk : m_chunks) {
+            std::free(chunk);
+        }
+    }
+}
@@ -0,0 +1,103 @@
+// SPDX-License-Identifier: GPL-3.0-only
+
+#ifndef BALLTZE__PLUGINS__LUA__ALLOCATOR_HPP
+#define BALLTZE__PLUGINS__LUA__ALLOCATOR_HPP
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <optional>
+#include <vector>
+
+namespace Balltze::Plugins::Lua {
+    struct LuaAllocatorStats {
+        /** Bytes currently allocated by the state */
+        std::size_t live_bytes;
+
+        /** Highest value reached by live_bytes */
+        std::size_t peak_bytes;
+
+        /** Bytes held by the small block pools, in use or not */
+        std::size_t pooled_bytes;
+
+        /** Number of allocations and reallocations since the state was created */
+        std::size_t allocations;
+
+        /** Allocations refused because of the memory limit */
+        std::size_t refused_allocations;
+
+        /** Allocations per second, measured over the last second */
+        float allocation_rate;
+
+        /** Memory limit in bytes, if any */
+        std::optional<std::size_t> limit;
+    };
+
+    /**
+     * Allocator for the Lua states of a plugin.
+     * Small blocks are served from size-class pools; Lua always tells the size of the block it
+     * frees or resizes, so blocks carry no header. Pool chunks are kept until the allocator is
+     * destroyed. Lanes creates its states with the allocator
+     * of the state that loaded it, so every operation is guarded by a lock.
+     */
+    class LuaAllocator {
+    public:
+        /**
+         * Allocation function for lua_newstate; the user data must be a LuaAllocator
+         */
+        static void *allocate(void *ud, void *ptr, std::size_t osize, std::size_t nsize) noexcept;
+
+        /**
+         * Get the memory statistics of the allocator
+         */
+        LuaAllocatorStats stats() noexcept;
+
+        /**
+         * Update the allocation rate; meant to be called periodically
+         */
+        void sample_allocation_rate() noexcept;
+
+        /**
+         * Set the maximum number of bytes the states can hold; growing past it fails with a memory error
+         */
+        void set_limit(std::optional<std::size_t> limit) noexcept;
+
+        LuaAllocator(std::optional<std::size_t> limit = std::nullopt) noexcept;
+        LuaAllocator(LuaAllocator const &) = delete;
+        LuaAllocator &operator=(LuaAllocator const &) = delete;
+        ~LuaAllocator();
+
+    private:
+        static constexpr std::size_t SIZE_CLASSES[] = { 16, 32, 48, 64, 96, 128, 192, 256 };
+        static constexpr std::size_t SIZE_CLASS_COUNT = sizeof(SIZE_CLASSES) / sizeof(SIZE_CLASSES[0]);
+        static constexpr std::size_t MAX_POOLED_SIZE = SIZE_CLASSES[SIZE_CLASS_COUNT - 1];
+        static constexpr std::size_t CHUNK_SIZE = 16 * 1024;
+
+        struct FreeBlock {
+            FreeBlock *next;
+        };
+
+        std::atomic_flag m_lock = ATOMIC_FLAG_INIT;
+        std::array<FreeBlock *, SIZE_CLASS_COUNT> m_free_lists = {};
+        std::vector<void *> m_chunks;
+        std::size_t m_pooled_bytes = 0;
+        std::size_t m_live_bytes = 0;
+        std::size_t m_peak_bytes = 0;
+        std::size_t m_allocations = 0;
+        std::size_t m_refused_allocations = 0;
+        std::optional<std::size_t> m_limit;
+        std::size_t m_rate_sample_allocations = 0;
+        std::chrono::steady_clock::time_point m_rate_sample_time;
+        float m_allocation_rate = 0.0f;
+
+        static std::size_t get_size_class(std::size_t size) noexcept;
+        void lock() noexcept;
+        void unlock() noexcept;
+        void *pool_allocate(std::size_t size_class) noexcept;
+        void pool_free(void *block, std::size_t size_class) noexcept;
+        void *reallocate(void *ptr, std::size_t osize, std::size_t nsize) noexcept;
+    };
+}
+
+#endif
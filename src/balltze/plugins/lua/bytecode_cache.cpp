@@ -0,0 +1,257 @@
+// SPDX-License-Identifier: GPL-3.0-only
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include "../../config/config.hpp"
+#include "../../logger.hpp"
+#include "bytecode_cache.hpp"
+
+namespace Balltze::Plugins::Lua {
+    namespace fs = std::filesystem;
+
+    struct CachedChunk {
+        std::uint64_t source_hash;
+        std::string bytecode;
+    };
+
+    struct BytecodeFileHeader {
+        char magic[8];
+        std::uint32_t lua_version;
+        std::uint32_t header_size;
+        std::uint64_t source_hash;
+        std::uint64_t bytecode_hash;
+        std::uint64_t bytecode_size;
+    };
+
+    static constexpr char BYTECODE_FILE_MAGIC[8] = { 'B', 'L', 'T', 'Z', 'L', 'U', 'A', 'C' };
+
+    static std::mutex cache_mutex;
+    static std::unordered_map<std::string, CachedChunk> cached_chunks;
+
+    static std::uint64_t fnv1a_hash(const void *data, std::size_t size, std::uint64_t hash = 0xCBF29CE484222325) noexcept {
+        auto *bytes = static_cast<const std::uint8_t *>(data);
+        for(std::size_t i = 0; i < size; i++) {
+            hash = (hash ^ bytes[i]) * 0x100000001B3;
+        }
+        return hash;
+    }
+
+    /**
+     * Hash of a chunk; the Lua release and the chunk name are part of it, since both end up in the bytecode
+     */
+    static std::uint64_t get_source_hash(const char *source, std::size_t size, const char *chunk_name) noexcept {
+        auto hash = fnv1a_hash(LUA_RELEASE, sizeof(LUA_RELEASE));
+        hash = fnv1a_hash(chunk_name, std::strlen(chunk_name) + 1, hash);
+        return fnv1a_hash(source, size, hash);
+    }
+
+    /**
+     * Skip the UTF-8 byte order mark some editors put at the start of files. luaL_loadfile skips it,
+     * but luaL_loadbuffer does not, and it must not be part of the source hash either.
+     */
+    static void skip_utf8_bom(const char *&source, std::size_t &size) noexcept {
+        if(size >= 3 && std::memcmp(source, "\xEF\xBB\xBF", 3) == 0) {
+            source += 3;
+            size -= 3;
+        }
+    }
+
+    static bool is_precompiled_or_script(const char *source, std::size_t size) noexcept {
+        // Chunks which are already bytecode or start with a shebang line are left to Lua
+        return size > 0 && (source[0] == LUA_SIGNATURE[0] || source[0] == '#');
+    }
+
+    static int bytecode_writer(lua_State *state, const void *data, std::size_t size, void *bytecode) noexcept {
+        try {
+            static_cast<std::string *>(bytecode)->append(static_cast<const char *>(data), size);
+            return 0;
+        }
+        catch(...) {
+            return 1;
+        }
+    }
+
+    /**
+     * Load bytecode from the memory cache if it was compiled from the same source
+     */
+    static std::optional<int> load_from_memory_cache(lua_State *state, std::uint64_t source_hash, const char *chunk_name) noexcept {
+        std::lock_guard lock(cache_mutex);
+        auto it = cached_chunks.find(chunk_name);
+        if(it == cached_chunks.end() || it->second.source_hash != source_hash) {
+            return std::nullopt;
+        }
+        auto &bytecode = it->second.bytecode;
+        auto result = luaL_loadbufferx(state, bytecode.data(), bytecode.size(), chunk_name, "b");
+        if(result == LUA_OK) {
+            return result;
+        }
+        logger.debug("Discarding cached bytecode of Lua chunk {}: {}", chunk_name, lua_tostring(state, -1));
+        lua_pop(state, 1);
+        cached_chunks.erase(it);
+        return std::nullopt;
+    }
+
+    static void add_to_memory_cache(std::uint64_t source_hash, const char *chunk_name, std::string bytecode) noexcept {
+        try {
+            std::lock_guard lock(cache_mutex);
+            cached_chunks.insert_or_assign(chunk_name, CachedChunk{source_hash, std::move(bytecode)});
+        }
+        catch(...) {}
+    }
+
+    /**
+     * Compile a chunk from source and dump its bytecode. The function or an error message is left on the stack.
+     */
+    static int compile_chunk(lua_State *state, const char *source, std::size_t size, const char *chunk_name, std::string &bytecode) noexcept {
+        auto result = luaL_loadbufferx(state, source, size, chunk_name, "t");
+        if(result == LUA_OK) {
+            // Keep debug information so tracebacks still show line numbers
+            if(lua_dump(state, bytecode_writer, &bytecode, 0) != 0) {
+                bytecode.clear();
+            }
+        }
+        return result;
+    }
+
+    int load_cached_buffer(lua_State *state, const char *source, std::size_t size, const char *chunk_name) noexcept {
+        skip_utf8_bom(source, size);
+        if(is_precompiled_or_script(source, size)) {
+            return luaL_loadbufferx(state, source, size, chunk_name, nullptr);
+        }
+
+        auto source_hash = get_source_hash(source, size, chunk_name);
+        if(auto result = load_from_memory_cache(state, source_hash, chunk_name)) {
+            return *result;
+        }
+
+        std::string bytecode;
+        auto result = compile_chunk(state, source, size, chunk_name, bytecode);
+        if(result == LUA_OK && !bytecode.empty()) {
+            add_to_memory_cache(source_hash, chunk_name, std::move(bytecode));
+        }
+        return result;
+    }
+
+    static std::optional<fs::path> get_bytecode_file_path(const char *chunk_name) noexcept {
+        try {
+            auto cache_directory = Config::get_balltze_directory() / "cache" / "lua";
+            fs::create_directories(cache_directory);
+            char file_name[32];
+            std::snprintf(file_name, sizeof(file_name), "%016llx.luac", static_cast<unsigned long long>(fnv1a_hash(chunk_name, std::strlen(chunk_name))));
+            return cache_directory / file_name;
+        }
+        catch(...) {
+            return std::nullopt;
+        }
+    }
+
+    static std::optional<std::string> read_bytecode_file(fs::path const &path, std::uint64_t source_hash) noexcept {
+        try {
+            std::ifstream file(path, std::ios::binary);
+            if(!file) {
+                return std::nullopt;
+            }
+            BytecodeFileHeader header;
+            if(!file.read(reinterpret_cast<char *>(&header), sizeof(header))) {
+                return std::nullopt;
+            }
+            if(std::memcmp(header.magic, BYTECODE_FILE_MAGIC, sizeof(header.magic)) != 0 || header.header_size != sizeof(header) || header.lua_version != LUA_VERSION_NUM || header.source_hash != source_hash) {
+                return std::nullopt;
+            }
+            std::string bytecode(header.bytecode_size, '\0');
+            if(!file.read(bytecode.data(), bytecode.size()) || fnv1a_hash(bytecode.data(), bytecode.size()) != header.bytecode_hash) {
+                return std::nullopt;
+            }
+            return bytecode;
+        }
+        catch(...) {
+            return std::nullopt;
+        }
+    }
+
+    static void write_bytecode_file(fs::path const &path, std::uint64_t source_hash, std::string const &bytecode) noexcept {
+        try {
+            BytecodeFileHeader header;
+            std::memcpy(header.magic, BYTECODE_FILE_MAGIC, sizeof(header.magic));
+            header.lua_version = LUA_VERSION_NUM;
+            header.header_size = sizeof(header);
+            header.source_hash = source_hash;
+            header.bytecode_hash = fnv1a_hash(bytecode.data(), bytecode.size());
+            header.bytecode_size = bytecode.size();
+
+            // Write to a temporary file first so a crash never leaves a truncated entry behind
+            auto temporary_path = path;
+            temporary_path += ".tmp";
+            {
+                std::ofstream file(temporary_path, std::ios::binary | std::ios::trunc);
+                file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+                file.write(bytecode.data(), bytecode.size());
+                if(!file) {
+                    throw std::runtime_error("write failed");
+                }
+            }
+            fs::rename(temporary_path, path);
+        }
+        catch(std::exception &e) {
+            logger.debug("Could not write bytecode cache file {}: {}", path.string(), e.what());
+        }
+    }
+
+    int load_cached_file(lua_State *state, fs::path const &path) noexcept {
+        std::string source;
+        std::string chunk_name;
+        try {
+            std::ifstream file(path, std::ios::binary);
+            if(!file) {
+                return luaL_loadfile(state, path.string().c_str());
+            }
+            source.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+            chunk_name = "@" + path.string();
+        }
+        catch(...) {
+            return luaL_loadfile(state, path.string().c_str());
+        }
+
+        const char *source_data = source.data();
+        std::size_t source_size = source.size();
+        skip_utf8_bom(source_data, source_size);
+        if(is_precompiled_or_script(source_data, source_size)) {
+            return luaL_loadfile(state, path.string().c_str());
+        }
+
+        auto source_hash = get_source_hash(source_data, source_size, chunk_name.c_str());
+        if(auto result = load_from_memory_cache(state, source_hash, chunk_name.c_str())) {
+            return *result;
+        }
+
+        auto bytecode_file_path = get_bytecode_file_path(chunk_name.c_str());
+        if(bytecode_file_path) {
+            auto bytecode = read_bytecode_file(*bytecode_file_path, source_hash);
+            if(bytecode) {
+                if(luaL_loadbufferx(state, bytecode->data(), bytecode->size(), chunk_name.c_str(), "b") == LUA_OK) {
+                    add_to_memory_cache(source_hash, chunk_name.c_str(), std::move(*bytecode));
+                    return LUA_OK;
+                }
+                logger.debug("Discarding bytecode cache file of {}: {}", path.string(), lua_tostring(state, -1));
+                lua_pop(state, 1);
+            }
+        }
+
+        std::string bytecode;
+        auto result = compile_chunk(state, source_data, source_size, chunk_name.c_str(), bytecode);
+        if(result == LUA_OK && !bytecode.empty()) {
+            if(bytecode_file_path) {
+                write_bytecode_file(*bytecode_file_path, source_hash, bytecode);
+            }
+            add_to_memory_cache(source_hash, chunk_name.c_str(), std::move(bytecode));
+        }
+        return result;
+    }
+}
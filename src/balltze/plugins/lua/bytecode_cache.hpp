@@ -0,0 +1,34 @@
+// SPDX-License-Identifier: GPL-3.0-only
+
+#ifndef BALLTZE__PLUGINS__LUA__BYTECODE_CACHE_HPP
+#define BALLTZE__PLUGINS__LUA__BYTECODE_CACHE_HPP
+
+#include <cstddef>
+#include <filesystem>
+#include <lua.hpp>
+
+namespace Balltze::Plugins::Lua {
+    /**
+     * Load a Lua chunk from source in memory. The bytecode compiled for it is shared by every
+     * state that loads the same chunk, so it is parsed only once.
+     * Like luaL_loadbuffer, the function or an error message is pushed on top of the stack.
+     * @param state         Lua state
+     * @param source        Lua source code
+     * @param size          Size of the source code
+     * @param chunk_name    Name of the chunk
+     * @return              Lua status code
+     */
+    int load_cached_buffer(lua_State *state, const char *source, std::size_t size, const char *chunk_name) noexcept;
+
+    /**
+     * Load a Lua source file. Compiled bytecode is kept in memory and in the cache directory
+     * of Balltze, and it is used for as long as the file content and the Lua version do not change.
+     * Like luaL_loadfile, the function or an error message is pushed on top of the stack.
+     * @param state     Lua state
+     * @param path      Path of the file
+     * @return          Lua status code
+     */
+    int load_cached_file(lua_State *state, std::filesystem::path const &path) noexcept;
+}
+
+#endif
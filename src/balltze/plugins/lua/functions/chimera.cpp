@@ -133,8 +133,8 @@ namespace Balltze::Plugins::Lua {
 
     int populate_chimera_table(lua_State *state) noexcept {
         if(LuaLibrary::balltze_chimera_script) {
-            auto plugins = get_lua_plugins();
-            for(auto *&plugin : plugins) {
+            auto &plugins = get_lua_plugins();
+            for(auto *plugin : plugins) {
                 if(plugin->initialized()) {
                     auto *plugin_state = plugin->state();
                     logger.debug("Populating chimera table on Lua plugin {}...", plugin->name());
@@ -7,10 +7,6 @@
 #include "../helpers/function_table.hpp"
 #include "command.hpp"
 
-namespace Balltze {
-    extern std::vector<std::shared_ptr<Command>> commands;
-}
-
 namespace Balltze::Plugins::Lua {
     static int lua_get_commands_table(lua_State *state) noexcept {
         auto balltze_module = Balltze::get_current_module();
@@ -80,14 +76,9 @@ namespace Balltze::Plugins::Lua {
         lua_pushvalue(state, -2);
         lua_setfield(state, -2, m_name.c_str());
 
-        for(const auto &command : commands) {
-            if(std::strcmp(command->name(), this->name()) == 0 && command->plugin() == reinterpret_cast<PluginHandle>(plugin)) {
-                throw std::runtime_error("Command " + std::string(this->name()) + " already registered!");
-            }
-        }
         m_plugin = reinterpret_cast<PluginHandle>(plugin);
         m_full_name = get_full_name();
-        commands.emplace_back(std::make_shared<Command>(*this));
+        add_command(std::make_shared<Command>(*this));
     }
 
     static int register_command(lua_State *state) noexcept {
@@ -163,44 +154,40 @@ namespace Balltze::Plugins::Lua {
             return luaL_error(state, "Invalid number of arguments in function Balltze.command.executeCommand.");
         }
 
-        auto *command = luaL_checkstring(state, 1);
-        std::vector<std::string> arguments = split_arguments(command);
-        std::size_t arg_count = arguments.size() - 1;
-        std::string command_name = arguments[0];
-        arguments.erase(arguments.begin());
-
-        auto arguments_alloc(std::make_unique<const char *[]>(arg_count));
-        for(std::size_t i = 0; i < arg_count; i++) {
-            arguments_alloc[i] = arguments[i].data();
+        std::string input = luaL_checkstring(state, 1);
+        std::vector<const char *> arguments;
+        split_arguments_in_place(input, arguments);
+        if(arguments.empty()) {
+            return 0;
         }
-        
-        CommandResult res = COMMAND_RESULT_FAILED_ERROR_NOT_FOUND;
-        for(const auto command : commands) {
-            if(command->full_name() == command_name) {
-                Plugins::Plugin *command_plugin = reinterpret_cast<Plugins::Plugin *>(*command->plugin());
-                if(command->is_public() || plugin == command_plugin || plugin->filename() == "balltze_devkit_server.lua") {
-                    res = command->call(arg_count, arguments_alloc.get());
-
-                    // Save if autosave is enabled
-                    if(command->autosave() && res == COMMAND_RESULT_SUCCESS) {
-                        bool is_balltze_command = command_plugin == nullptr;
-                        if(is_balltze_command) {
-                            auto &config = Config::get_config();
-                            config.set(std::string("commands.") + command->name(), unsplit_arguments(arguments));
-                            config.save();
-                        }
-                        else {
-                            auto directory = command_plugin->directory();
-                            auto config = Config::Config(directory / "settings.json");
-                            config.set(std::string("commands.") + command->name(), unsplit_arguments(arguments));
-                            config.save();
-                        }
+        std::size_t arg_count = arguments.size() - 1;
+        const char **command_args = arguments.data() + 1;
+
+        auto command = find_command(arguments[0]);
+        if(command) {
+            Plugins::Plugin *command_plugin = reinterpret_cast<Plugins::Plugin *>(*command->plugin());
+            if(command->is_public() || plugin == command_plugin || plugin->filename() == "balltze_devkit_server.lua") {
+                auto res = command->call(arg_count, command_args);
+
+                // Save if autosave is enabled
+                if(command->autosave() && res == COMMAND_RESULT_SUCCESS) {
+                    auto value = unsplit_arguments(std::vector<std::string>(command_args, command_args + arg_count));
+                    bool is_balltze_command = command_plugin == nullptr;
+                    if(is_balltze_command) {
+                        auto &config = Config::get_config();
+                        config.set(std::string("commands.") + command->name(), value);
+                        config.save();
+                    }
+                    else {
+                        auto directory = command_plugin->directory();
+                        auto config = Config::Config(directory / "settings.json");
+                        config.set(std::string("commands.") + command->name(), value);
+                        config.save();
                     }
                 }
-                else {
-                    return luaL_error(state, "Command is not public.");
-                }              
-                break;
+            }
+            else {
+                return luaL_error(state, "Command is not public.");
             }
         }
         return 0;
@@ -213,7 +200,7 @@ namespace Balltze::Plugins::Lua {
         }
         auto directory = plugin->directory();
         auto config = Config::Config(directory / "settings.json");
-        for(auto &command : commands) {
+        for(auto &command : get_commands()) {
             auto command_key = std::string("commands.") + command->name();
             if(command->plugin() && command->plugin() == reinterpret_cast<void *>(plugin)) {
                 if(config.exists(command_key)) {
@@ -248,13 +235,6 @@ namespace Balltze::Plugins::Lua {
 
     void remove_plugin_commands(LuaPlugin *plugin) noexcept {
         logger.debug("Removing commands from plugin {}", plugin->name());
-        for(auto it = commands.begin(); it != commands.end();) {
-            if((*it)->plugin() == reinterpret_cast<PluginHandle>(plugin)) {
-                it = commands.erase(it);
-            }
-            else {
-                it++;
-            }
-        }   
+        remove_commands_from_plugin(reinterpret_cast<PluginHandle>(plugin));
     }
 }
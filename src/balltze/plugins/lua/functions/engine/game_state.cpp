@@ -1,5 +1,6 @@
 // SPDX-License-Identifier: GPL-3.0-only
 
+#include <vector>
 #include <lua.hpp>
 #include <balltze/engine.hpp>
 #include <balltze/helpers/string_literal.hpp>
@@ -9,6 +10,7 @@
 #include "../../libraries.hpp"
 #include "../../types.hpp"
 #include "../../helpers/function_table.hpp"
+#include "object_query.hpp"
 
 namespace Balltze::Plugins::Lua {
     static int engine_get_object(lua_State *state) noexcept {
@@ -99,6 +101,87 @@ namespace Balltze::Plugins::Lua {
         }
     }
 
+    static int engine_query_objects(lua_State *state) noexcept {
+        int args = lua_gettop(state);
+        if(args > 1) {
+            return luaL_error(state, "Invalid number of arguments in function Engine.gameState.queryObjects.");
+        }
+
+        ObjectQuery query;
+        std::vector<ObjectQueryField> fields;
+
+        if(args == 1) {
+            luaL_checktype(state, 1, LUA_TTABLE);
+
+            lua_getfield(state, 1, "types");
+            if(!lua_isnil(state, -1)) {
+                luaL_checktype(state, -1, LUA_TTABLE);
+                query.type_mask = 0;
+                auto count = lua_rawlen(state, -1);
+                for(std::size_t i = 1; i <= count; i++) {
+                    lua_rawgeti(state, -1, i);
+                    query.type_mask |= 1 << get_object_type(state, -1);
+                    lua_pop(state, 1);
+                }
+            }
+            lua_pop(state, 1);
+
+            lua_getfield(state, 1, "team");
+            if(!lua_isnil(state, -1)) {
+                query.team = luaL_checkinteger(state, -1);
+            }
+            lua_pop(state, 1);
+
+            lua_getfield(state, 1, "origin");
+            if(!lua_isnil(state, -1)) {
+                query.origin = get_point3_d(state, -1);
+                if(!query.origin) {
+                    return luaL_error(state, "Invalid origin in function Engine.gameState.queryObjects.");
+                }
+            }
+            lua_pop(state, 1);
+
+            lua_getfield(state, 1, "radius");
+            if(!lua_isnil(state, -1)) {
+                if(!query.origin) {
+                    return luaL_error(state, "Radius given without an origin in function Engine.gameState.queryObjects.");
+                }
+                query.radius = luaL_checknumber(state, -1);
+            }
+            else if(query.origin) {
+                return luaL_error(state, "Origin given without a radius in function Engine.gameState.queryObjects.");
+            }
+            lua_pop(state, 1);
+
+            lua_getfield(state, 1, "fields");
+            if(!lua_isnil(state, -1)) {
+                luaL_checktype(state, -1, LUA_TTABLE);
+                auto count = lua_rawlen(state, -1);
+                for(std::size_t i = 1; i <= count; i++) {
+                    lua_rawgeti(state, -1, i);
+                    auto *name = luaL_checkstring(state, -1);
+                    auto field = object_query_field_from_name(name);
+                    if(!field) {
+                        return luaL_error(state, "Unknown field %s in function Engine.gameState.queryObjects.", name);
+                    }
+                    fields.push_back(*field);
+                    lua_pop(state, 1);
+                }
+            }
+            lua_pop(state, 1);
+        }
+
+        if(fields.empty()) {
+            fields.push_back(OBJECT_QUERY_FIELD_HANDLE);
+        }
+
+        // Filter the objects first, so every array can be allocated with its final size
+        static ObjectQueryResult objects;
+        query_objects(query, objects);
+        push_object_query_result(state, fields, objects);
+        return 1;
+    }
+
     static int engine_create_object(lua_State *state) noexcept {
         int args = lua_gettop(state);
 
@@ -150,6 +233,11 @@ namespace Balltze::Plugins::Lua {
             if(!object_handle || object_handle->is_null()) {
                 return luaL_error(state, "Invalid object handle in function Engine.gameState.deleteObject.");
             }
+            auto *object = object_handle->id != 0 ? object_table.get_object(*object_handle) : object_table.get_object(object_handle->index);
+            if(object) {
+                // Vehicles are the largest objects, so this covers every nested struct of the object
+                invalidate_lua_object_proxies(object, sizeof(Engine::VehicleObject));
+            }
             if(object_handle->id != 0) {
                 object_table.delete_object(*object_handle);
             }
@@ -390,6 +478,7 @@ namespace Balltze::Plugins::Lua {
 
     static const luaL_Reg engine_game_state_functions[] = {
         {"getObject", engine_get_object},
+        {"queryObjects", engine_query_objects},
         {"createObject", engine_create_object},
         {"deleteObject", engine_delete_object},
         {"unitEnterVehicle", engine_unit_enter_vehicle},
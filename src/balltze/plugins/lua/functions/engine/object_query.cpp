@@ -0,0 +1,136 @@
+// SPDX-License-Identifier: GPL-3.0-only
+
+#include <type_traits>
+#include "object_query.hpp"
+
+namespace Balltze::Plugins::Lua {
+    static const char *object_query_field_names[] = {
+        "handle",
+        "tagHandle",
+        "type",
+        "team",
+        "player",
+        "position",
+        "centerPosition",
+        "velocity",
+        "health",
+        "shield"
+    };
+
+    const char *object_query_field_name(ObjectQueryField field) noexcept {
+        return object_query_field_names[field];
+    }
+
+    std::optional<ObjectQueryField> object_query_field_from_name(std::string_view name) noexcept {
+        auto field_count = sizeof(object_query_field_names) / sizeof(object_query_field_names[0]);
+        for(std::size_t i = 0; i < field_count; i++) {
+            if(name == object_query_field_names[i]) {
+                return static_cast<ObjectQueryField>(i);
+            }
+        }
+        return std::nullopt;
+    }
+
+    void query_objects(ObjectQuery const &query, ObjectQueryResult &result) noexcept {
+        result.clear();
+        auto &object_table = Engine::get_object_table();
+        auto radius_squared = query.radius * query.radius;
+        for(std::size_t i = 0; i < object_table.current_size; i++) {
+            auto &entry = object_table.first_element[i];
+            auto *object = entry.object;
+            if(entry.id == 0 || !object) {
+                continue;
+            }
+            if((query.type_mask & (1 << object->type)) == 0) {
+                continue;
+            }
+            if(query.team && static_cast<int>(object->team_owner) != *query.team) {
+                continue;
+            }
+            if(query.origin) {
+                auto dx = object->center_position.x - query.origin->x;
+                auto dy = object->center_position.y - query.origin->y;
+                auto dz = object->center_position.z - query.origin->z;
+                if(dx * dx + dy * dy + dz * dz > radius_squared) {
+                    continue;
+                }
+            }
+            Engine::ObjectHandle handle;
+            handle.index = i;
+            handle.id = entry.id;
+            result.emplace_back(handle, object);
+        }
+    }
+
+    static void push_object_query_field(lua_State *state, ObjectQueryField field, ObjectQueryResult const &objects) noexcept {
+        auto push_points = [&](Engine::Point3D Engine::BaseObject::*member) {
+            lua_createtable(state, objects.size() * 3, 0);
+            for(std::size_t i = 0; i < objects.size(); i++) {
+                auto &point = objects[i].second->*member;
+                lua_pushnumber(state, point.x);
+                lua_rawseti(state, -2, i * 3 + 1);
+                lua_pushnumber(state, point.y);
+                lua_rawseti(state, -2, i * 3 + 2);
+                lua_pushnumber(state, point.z);
+                lua_rawseti(state, -2, i * 3 + 3);
+            }
+        };
+
+        auto push_values = [&](auto get_value) {
+            lua_createtable(state, objects.size(), 0);
+            for(std::size_t i = 0; i < objects.size(); i++) {
+                auto value = get_value(objects[i].first, objects[i].second);
+                if constexpr(std::is_floating_point_v<decltype(value)>) {
+                    lua_pushnumber(state, value);
+                }
+                else {
+                    lua_pushinteger(state, value);
+                }
+                lua_rawseti(state, -2, i + 1);
+            }
+        };
+
+        switch(field) {
+            case OBJECT_QUERY_FIELD_HANDLE:
+                push_values([](Engine::ObjectHandle handle, Engine::BaseObject *object) { return handle.value; });
+                break;
+            case OBJECT_QUERY_FIELD_TAG_HANDLE:
+                push_values([](Engine::ObjectHandle handle, Engine::BaseObject *object) { return object->tag_handle.value; });
+                break;
+            case OBJECT_QUERY_FIELD_TYPE:
+                push_values([](Engine::ObjectHandle handle, Engine::BaseObject *object) { return static_cast<int>(object->type); });
+                break;
+            case OBJECT_QUERY_FIELD_TEAM:
+                push_values([](Engine::ObjectHandle handle, Engine::BaseObject *object) { return static_cast<int>(object->team_owner); });
+                break;
+            case OBJECT_QUERY_FIELD_PLAYER:
+                push_values([](Engine::ObjectHandle handle, Engine::BaseObject *object) { return object->player.value; });
+                break;
+            case OBJECT_QUERY_FIELD_POSITION:
+                push_points(&Engine::BaseObject::position);
+                break;
+            case OBJECT_QUERY_FIELD_CENTER_POSITION:
+                push_points(&Engine::BaseObject::center_position);
+                break;
+            case OBJECT_QUERY_FIELD_VELOCITY:
+                push_points(&Engine::BaseObject::velocity);
+                break;
+            case OBJECT_QUERY_FIELD_HEALTH:
+                push_values([](Engine::ObjectHandle handle, Engine::BaseObject *object) { return object->vitals.health; });
+                break;
+            case OBJECT_QUERY_FIELD_SHIELD:
+                push_values([](Engine::ObjectHandle handle, Engine::BaseObject *object) { return object->vitals.shield; });
+                break;
+        }
+    }
+
+    void push_object_query_result(lua_State *state, std::vector<ObjectQueryField> const &fields, ObjectQueryResult const &objects) noexcept {
+        lua_createtable(state, 0, fields.size() + 1);
+        lua_pushinteger(state, objects.size());
+        lua_setfield(state, -2, "count");
+        for(auto field : fields) {
+            push_object_query_field(state, field, objects);
+            lua_setfield(state, -2, object_query_field_name(field));
+        }
+    }
+}
@@ -0,0 +1,78 @@
+// SPDX-License-Identifier: GPL-3.0-only
+
+#ifndef BALLTZE__PLUGINS__LUA__FUNCTIONS__ENGINE__OBJECT_QUERY_HPP
+#define BALLTZE__PLUGINS__LUA__FUNCTIONS__ENGINE__OBJECT_QUERY_HPP
+
+#include <cstdint>
+#include <optional>
+#include <string_view>
+#include <utility>
+#include <vector>
+#include <lua.hpp>
+#include <balltze/engine/game_state.hpp>
+
+namespace Balltze::Plugins::Lua {
+    enum ObjectQueryField {
+        OBJECT_QUERY_FIELD_HANDLE,
+        OBJECT_QUERY_FIELD_TAG_HANDLE,
+        OBJECT_QUERY_FIELD_TYPE,
+        OBJECT_QUERY_FIELD_TEAM,
+        OBJECT_QUERY_FIELD_PLAYER,
+        OBJECT_QUERY_FIELD_POSITION,
+        OBJECT_QUERY_FIELD_CENTER_POSITION,
+        OBJECT_QUERY_FIELD_VELOCITY,
+        OBJECT_QUERY_FIELD_HEALTH,
+        OBJECT_QUERY_FIELD_SHIELD
+    };
+
+    /**
+     * Filters of an Engine.gameState.queryObjects call
+     */
+    struct ObjectQuery {
+        /** Bit of each object type to include */
+        std::uint32_t type_mask = 0xFFFFFFFF;
+
+        /** Team the objects must belong to */
+        std::optional<int> team;
+
+        /** Center of the sphere the objects must be in */
+        std::optional<Engine::Point3D> origin;
+
+        /** Radius of the sphere the objects must be in */
+        float radius = 0.0f;
+    };
+
+    using ObjectQueryResult = std::vector<std::pair<Engine::ObjectHandle, Engine::BaseObject *>>;
+
+    /**
+     * Get the Lua name of a query field
+     * @param field     Field
+     * @return          Name of the field
+     */
+    const char *object_query_field_name(ObjectQueryField field) noexcept;
+
+    /**
+     * Get a query field by its Lua name
+     * @param name      Name of the field
+     * @return          Field, or nothing if the name is unknown
+     */
+    std::optional<ObjectQueryField> object_query_field_from_name(std::string_view name) noexcept;
+
+    /**
+     * Walk the object table and collect the objects that pass the filters of a query
+     * @param query     Filters
+     * @param result    Vector the objects are written to; it is cleared first
+     */
+    void query_objects(ObjectQuery const &query, ObjectQueryResult &result) noexcept;
+
+    /**
+     * Push a table with the count of objects and an array of values for every field; vectors
+     * are packed as x, y, z triples
+     * @param state     Lua state
+     * @param fields    Fields to push
+     * @param objects   Objects returned by query_objects
+     */
+    void push_object_query_result(lua_State *state, std::vector<ObjectQueryField> const &fields, ObjectQueryResult const &objects) noexcept;
+}
+
+#endif
@@ -267,8 +267,8 @@ namespace Balltze::Plugins::Lua {
 
     #define SET_POPULATE_EVENT_FUNCTION(eventClass, eventName, eventTable) \
         static void populate_##eventName##_events(eventClass &event, EventPriority priority) noexcept { \
-            auto plugins = get_lua_plugins(); \
-            for(auto *&plugin : plugins) { \
+            auto &plugins = get_lua_plugins(); \
+            for(auto *plugin : plugins) { \
                 if(plugin->loaded()) { \
                     auto *state = plugin->state(); \
                     call_events_by_priority(state, eventTable, priority, [&](lua_State *state) { \
@@ -282,8 +282,8 @@ namespace Balltze::Plugins::Lua {
 
     #define SET_POPULATE_EVENT_NO_ARGS_FUNCTION(eventClass, eventName, eventTable) \
         static void populate_##eventName##_events(eventClass &event, EventPriority priority) noexcept { \
-            auto plugins = get_lua_plugins(); \
-            for(auto *&plugin : plugins) { \
+            auto &plugins = get_lua_plugins(); \
+            for(auto *plugin : plugins) { \
                 if(plugin->loaded()) { \
                     auto *state = plugin->state(); \
                     call_events_by_priority(state, eventTable, priority, [&](lua_State *state) { \
@@ -138,7 +138,17 @@ namespace Balltze::Plugins::Lua {
                 }
             }
             try {
-                Features::reload_tag_data(tag_handle);
+                auto summary = Features::reload_tag_data(tag_handle);
+                invalidate_lua_object_proxies();
+                lua_newtable(state);
+                lua_pushinteger(state, summary.fields_patched);
+                lua_setfield(state, -2, "fieldsPatched");
+                lua_pushinteger(state, summary.bytes_patched);
+                lua_setfield(state, -2, "bytesPatched");
+                lua_pushinteger(state, summary.blocks_reallocated);
+                lua_setfield(state, -2, "reflexivesReallocated");
+                lua_pushinteger(state, summary.data_reallocated);
+                lua_setfield(state, -2, "dataReallocated");
             }
             catch(std::runtime_error &e) {
                 return luaL_error(state, e.what());
@@ -147,7 +157,7 @@ namespace Balltze::Plugins::Lua {
         else {
             return luaL_error(state, "Invalid number of arguments in function Balltze.features.reloadTagData.");
         }
-        return 0;
+        return 1;
     }
 
     static int lua_replace_tag_references(lua_State *state) {
@@ -247,7 +257,7 @@ namespace Balltze::Plugins::Lua {
         if(event.time == Event::EVENT_TIME_AFTER) {
             return;
         }
-        auto plugins = get_lua_plugins();
+        auto &plugins = get_lua_plugins();
         for(auto &plugin : plugins) {
             auto map_imports = plugin->imported_tags();
             for(auto &[path, tags] : map_imports) {
@@ -292,6 +302,110 @@ namespace Balltze::Plugins::Lua {
         return 0;
     }
 
+    static int lua_prefetch_tag_data(lua_State *state) noexcept {
+        int args = lua_gettop(state);
+        if(args == 1) {
+            luaL_checktype(state, 1, LUA_TTABLE);
+            std::vector<Engine::TagHandle> tag_handles;
+            auto length = luaL_len(state, 1);
+            for(lua_Integer i = 1; i <= length; i++) {
+                lua_geti(state, 1, i);
+                auto tag_handle = get_engine_resource_handle(state, -1);
+                lua_pop(state, 1);
+                if(!tag_handle || tag_handle->is_null()) {
+                    return luaL_error(state, "Invalid tag handle in function Balltze.features.prefetchTagData.");
+                }
+                tag_handles.push_back(*tag_handle);
+            }
+            auto scheduled = Features::prefetch_tag_data(tag_handles);
+            lua_pushinteger(state, scheduled);
+            return 1;
+        }
+        else {
+            return luaL_error(state, "Invalid number of arguments in function Balltze.features.prefetchTagData.");
+        }
+    }
+
+    static int lua_get_tag_data_prefetch_stats(lua_State *state) noexcept {
+        auto stats = Features::get_tag_data_prefetch_stats();
+        lua_newtable(state);
+        lua_pushinteger(state, stats.hits);
+        lua_setfield(state, -2, "hits");
+        lua_pushinteger(state, stats.misses);
+        lua_setfield(state, -2, "misses");
+        lua_pushnumber(state, stats.hit_rate());
+        lua_setfield(state, -2, "hitRate");
+        lua_pushinteger(state, stats.bytes_prefetched);
+        lua_setfield(state, -2, "bytesPrefetched");
+        lua_pushinteger(state, stats.cached_bytes);
+        lua_setfield(state, -2, "cachedBytes");
+        lua_pushinteger(state, stats.cache_size);
+        lua_setfield(state, -2, "cacheSize");
+        lua_pushinteger(state, stats.pending_requests);
+        lua_setfield(state, -2, "pendingRequests");
+        return 1;
+    }
+
+    static void push_object_handle_values(lua_State *state, std::vector<Engine::ObjectHandle> const &handles) noexcept {
+        lua_createtable(state, handles.size(), 0);
+        for(std::size_t i = 0; i < handles.size(); i++) {
+            lua_pushinteger(state, handles[i].value);
+            lua_rawseti(state, -2, i + 1);
+        }
+    }
+
+    static int lua_find_objects_in_radius(lua_State *state) noexcept {
+        int args = lua_gettop(state);
+        if(args == 2) {
+            auto center = get_point3_d(state, 1);
+            if(!center) {
+                return luaL_error(state, "Invalid center in function Balltze.features.findObjectsInRadius.");
+            }
+            auto radius = luaL_checknumber(state, 2);
+            push_object_handle_values(state, Features::find_objects_in_radius(*center, radius));
+            return 1;
+        }
+        else {
+            return luaL_error(state, "Invalid number of arguments in function Balltze.features.findObjectsInRadius.");
+        }
+    }
+
+    static int lua_find_objects_in_box(lua_State *state) noexcept {
+        int args = lua_gettop(state);
+        if(args == 2) {
+            auto min = get_point3_d(state, 1);
+            auto max = get_point3_d(state, 2);
+            if(!min || !max) {
+                return luaL_error(state, "Invalid box corners in function Balltze.features.findObjectsInBox.");
+            }
+            push_object_handle_values(state, Features::find_objects_in_box(*min, *max));
+            return 1;
+        }
+        else {
+            return luaL_error(state, "Invalid number of arguments in function Balltze.features.findObjectsInBox.");
+        }
+    }
+
+    static int lua_find_nearest_objects(lua_State *state) noexcept {
+        int args = lua_gettop(state);
+        if(args == 2 || args == 3) {
+            auto point = get_point3_d(state, 1);
+            if(!point) {
+                return luaL_error(state, "Invalid point in function Balltze.features.findNearestObjects.");
+            }
+            auto count = luaL_checkinteger(state, 2);
+            if(count < 0) {
+                return luaL_error(state, "Invalid count in function Balltze.features.findNearestObjects.");
+            }
+            auto max_distance = luaL_optnumber(state, 3, std::numeric_limits<float>::infinity());
+            push_object_handle_values(state, Features::find_nearest_objects(*point, count, max_distance));
+            return 1;
+        }
+        else {
+            return luaL_error(state, "Invalid number of arguments in function Balltze.features.findNearestObjects.");
+        }
+    }
+
     static const luaL_Reg features_functions[] = {
         {"importTagFromMap", lua_import_tag_from_map},
         {"importTagsFromMap", lua_import_tags_from_map},
@@ -301,6 +415,11 @@ namespace Balltze::Plugins::Lua {
         {"cloneTag", lua_clone_tag},
         {"getTagCopy", lua_get_tag_copy},
         {"getImportedTag", lua_get_imported_tag},
+        {"prefetchTagData", lua_prefetch_tag_data},
+        {"getTagDataPrefetchStats", lua_get_tag_data_prefetch_stats},
+        {"findObjectsInRadius", lua_find_objects_in_radius},
+        {"findObjectsInBox", lua_find_objects_in_box},
+        {"findNearestObjects", lua_find_nearest_objects},
         {"setUIAspectRatio", lua_set_ui_aspect_ratio},
         {"resetUIAspectRatio", lua_reset_ui_aspect_ratio},
         {nullptr, nullptr}
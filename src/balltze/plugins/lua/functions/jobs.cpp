@@ -0,0 +1,385 @@
+// SPDX-License-Identifier: GPL-3.0-only
+
+#include <algorithm>
+#include <array>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include <lua.hpp>
+#include <nlohmann/json.hpp>
+#include <balltze/features/job_system.hpp>
+#include "../../../logger.hpp"
+#include "../../loader.hpp"
+#include "../helpers/function_table.hpp"
+#include "jobs.hpp"
+
+namespace Balltze::Plugins::Lua {
+    using namespace Features;
+    namespace fs = std::filesystem;
+
+    struct LuaJobResult {
+        std::function<void(lua_State *)> push_value;
+        std::string error;
+    };
+
+    struct LuaJob {
+        LuaPlugin *plugin;
+        int callback_reference;
+    };
+
+    static std::unordered_map<JobHandle, LuaJob> lua_jobs;
+
+    /**
+     * Push the result of a job and call its callback; called in protected mode with the callback and the
+     * result as a light userdata, since pushing a large result may raise a memory error
+     */
+    static int call_job_callback(lua_State *state) noexcept {
+        auto *result = static_cast<LuaJobResult *>(lua_touserdata(state, 2));
+        lua_settop(state, 1);
+        int args = 1;
+        if(result->push_value) {
+            result->push_value(state);
+        }
+        else {
+            lua_pushnil(state);
+            lua_pushstring(state, result->error.c_str());
+            args = 2;
+        }
+        lua_call(state, args, 0);
+        return 0;
+    }
+
+    /**
+     * Call the callback of a finished job with its result, or with nil and the error message
+     */
+    static void deliver_job_result(JobHandle handle, std::shared_ptr<LuaJobResult> result) noexcept {
+        auto it = lua_jobs.find(handle);
+        if(it == lua_jobs.end()) {
+            return;
+        }
+        auto job = it->second;
+        lua_jobs.erase(it);
+
+        auto *state = job.plugin->state();
+        lua_pushcfunction(state, call_job_callback);
+        lua_rawgeti(state, LUA_REGISTRYINDEX, job.callback_reference);
+        luaL_unref(state, LUA_REGISTRYINDEX, job.callback_reference);
+        lua_pushlightuserdata(state, result.get());
+        if(lua_pcall(state, 2, 0, 0) != LUA_OK) {
+            logger.error("Error in job callback of plugin {}: {}.", job.plugin->name(), lua_tostring(state, -1));
+            lua_pop(state, 1);
+        }
+    }
+
+    /**
+     * Submit a job whose work produces a value to be pushed to the callback at the given stack index
+     */
+    static JobHandle submit_lua_job(LuaPlugin *plugin, lua_State *state, int callback_index, std::function<void(LuaJobResult &)> work) {
+        auto result = std::make_shared<LuaJobResult>();
+        lua_pushvalue(state, callback_index);
+        int callback_reference = luaL_ref(state, LUA_REGISTRYINDEX);
+
+        // Completion functions run on the game thread after this returns, so the handle is set by then
+        auto job_handle = std::make_shared<JobHandle>(0);
+        auto handle = submit_job([result, work = std::move(work)]() {
+            try {
+                work(*result);
+            }
+            catch(std::exception &e) {
+                result->push_value = nullptr;
+                result->error = e.what();
+            }
+        }, [result, job_handle]() {
+            deliver_job_result(*job_handle, result);
+        });
+        *job_handle = handle;
+        lua_jobs.emplace(handle, LuaJob{plugin, callback_reference});
+        return handle;
+    }
+
+    static void push_json_value(lua_State *state, nlohmann::json const &value) {
+        luaL_checkstack(state, 3, "JSON document is too deep");
+        switch(value.type()) {
+            case nlohmann::json::value_t::object: {
+                lua_createtable(state, 0, value.size());
+                for(auto &[key, element] : value.items()) {
+                    push_json_value(state, element);
+                    lua_setfield(state, -2, key.c_str());
+                }
+                break;
+            }
+            case nlohmann::json::value_t::array: {
+                lua_createtable(state, value.size(), 0);
+                for(std::size_t i = 0; i < value.size(); i++) {
+                    push_json_value(state, value[i]);
+                    lua_rawseti(state, -2, i + 1);
+                }
+                break;
+            }
+            case nlohmann::json::value_t::string:
+                lua_pushstring(state, value.get_ref<std::string const &>().c_str());
+                break;
+            case nlohmann::json::value_t::boolean:
+                lua_pushboolean(state, value.get<bool>());
+                break;
+            case nlohmann::json::value_t::number_integer:
+            case nlohmann::json::value_t::number_unsigned:
+                lua_pushinteger(state, value.get<lua_Integer>());
+                break;
+            case nlohmann::json::value_t::number_float:
+                lua_pushnumber(state, value.get<lua_Number>());
+                break;
+            default:
+                lua_pushnil(state);
+                break;
+        }
+    }
+
+    static std::uint32_t crc32_hash(std::string const &data) noexcept {
+        static auto table = [] {
+            std::array<std::uint32_t, 256> table;
+            for(std::uint32_t i = 0; i < 256; i++) {
+                auto value = i;
+                for(int bit = 0; bit < 8; bit++) {
+                    value = (value & 1) ? (value >> 1) ^ 0xEDB88320 : value >> 1;
+                }
+                table[i] = value;
+            }
+            return table;
+        }();
+        std::uint32_t crc = 0xFFFFFFFF;
+        for(auto c : data) {
+            crc = table[(crc ^ static_cast<std::uint8_t>(c)) & 0xFF] ^ (crc >> 8);
+        }
+        return crc ^ 0xFFFFFFFF;
+    }
+
+    static std::uint64_t fnv1a_hash(std::string const &data) noexcept {
+        std::uint64_t hash = 0xCBF29CE484222325;
+        for(auto c : data) {
+            hash = (hash ^ static_cast<std::uint8_t>(c)) * 0x100000001B3;
+        }
+        return hash;
+    }
+
+    static int lua_jobs_read_file(lua_State *state) noexcept {
+        auto *plugin = get_lua_plugin(state);
+        if(!plugin) {
+            return luaL_error(state, "Missing plugin upvalue in function Balltze.jobs.readFile.");
+        }
+        int args = lua_gettop(state);
+        if(args < 2 || args > 3) {
+            return luaL_error(state, "Invalid number of arguments in function Balltze.jobs.readFile.");
+        }
+        const char *path = luaL_checkstring(state, 1);
+        luaL_checktype(state, 2, LUA_TFUNCTION);
+        const char *format_name = luaL_optstring(state, 3, "text");
+        if(std::strcmp(format_name, "text") != 0 && std::strcmp(format_name, "lines") != 0 && std::strcmp(format_name, "json") != 0) {
+            return luaL_error(state, "Invalid format in function Balltze.jobs.readFile.");
+        }
+        if(!plugin->path_is_valid(plugin->directory() / path)) {
+            return luaL_error(state, "Invalid path in function Balltze.jobs.readFile.");
+        }
+        auto file_path = plugin->directory() / path;
+        std::string format = format_name;
+
+        auto handle = submit_lua_job(plugin, state, 2, [file_path, format](LuaJobResult &result) {
+            std::ifstream file(file_path, std::ios::binary);
+            if(!file) {
+                result.error = "could not open file " + file_path.filename().string();
+                return;
+            }
+            auto content = std::make_shared<std::string>(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+            if(format == "json") {
+                auto document = std::make_shared<nlohmann::json>(nlohmann::json::parse(*content));
+                result.push_value = [document](lua_State *state) {
+                    push_json_value(state, *document);
+                };
+            }
+            else if(format == "lines") {
+                auto lines = std::make_shared<std::vector<std::string>>();
+                std::size_t begin = 0;
+                while(begin < content->size()) {
+                    auto end = content->find('\n', begin);
+                    if(end == std::string::npos) {
+                        end = content->size();
+                    }
+                    auto length = end - begin;
+                    if(length > 0 && (*content)[end - 1] == '\r') {
+                        length--;
+                    }
+                    lines->emplace_back(*content, begin, length);
+                    begin = end + 1;
+                }
+                result.push_value = [lines](lua_State *state) {
+                    lua_createtable(state, lines->size(), 0);
+                    for(std::size_t i = 0; i < lines->size(); i++) {
+                        lua_pushlstring(state, (*lines)[i].data(), (*lines)[i].size());
+                        lua_rawseti(state, -2, i + 1);
+                    }
+                };
+            }
+            else {
+                result.push_value = [content](lua_State *state) {
+                    lua_pushlstring(state, content->data(), content->size());
+                };
+            }
+        });
+        lua_pushinteger(state, handle);
+        return 1;
+    }
+
+    static int lua_jobs_hash(lua_State *state) noexcept {
+        auto *plugin = get_lua_plugin(state);
+        if(!plugin) {
+            return luaL_error(state, "Missing plugin upvalue in function Balltze.jobs.hash.");
+        }
+        int args = lua_gettop(state);
+        if(args < 2 || args > 3) {
+            return luaL_error(state, "Invalid number of arguments in function Balltze.jobs.hash.");
+        }
+        std::size_t size;
+        const char *data_chars = luaL_checklstring(state, 1, &size);
+        luaL_checktype(state, 2, LUA_TFUNCTION);
+        const char *algorithm_name = luaL_optstring(state, 3, "fnv1a");
+        if(std::strcmp(algorithm_name, "fnv1a") != 0 && std::strcmp(algorithm_name, "crc32") != 0) {
+            return luaL_error(state, "Invalid algorithm in function Balltze.jobs.hash.");
+        }
+        std::string algorithm = algorithm_name;
+
+        auto handle = submit_lua_job(plugin, state, 2, [data = std::string(data_chars, size), algorithm](LuaJobResult &result) {
+            char digest[17];
+            if(algorithm == "crc32") {
+                std::snprintf(digest, sizeof(digest), "%08x", static_cast<unsigned int>(crc32_hash(data)));
+            }
+            else {
+                std::snprintf(digest, sizeof(digest), "%016llx", static_cast<unsigned long long>(fnv1a_hash(data)));
+            }
+            result.push_value = [digest = std::string(digest)](lua_State *state) {
+                lua_pushstring(state, digest.c_str());
+            };
+        });
+        lua_pushinteger(state, handle);
+        return 1;
+    }
+
+    static int lua_jobs_sort(lua_State *state) noexcept {
+        auto *plugin = get_lua_plugin(state);
+        if(!plugin) {
+            return luaL_error(state, "Missing plugin upvalue in function Balltze.jobs.sort.");
+        }
+        int args = lua_gettop(state);
+        if(args < 2 || args > 3) {
+            return luaL_error(state, "Invalid number of arguments in function Balltze.jobs.sort.");
+        }
+        luaL_checktype(state, 1, LUA_TTABLE);
+        luaL_checktype(state, 2, LUA_TFUNCTION);
+        bool descending = lua_toboolean(state, 3);
+
+        // Check the elements first; luaL_error would skip the destructor of the vector
+        auto count = lua_rawlen(state, 1);
+        for(std::size_t i = 1; i <= count; i++) {
+            if(lua_rawgeti(state, 1, i) != LUA_TNUMBER) {
+                return luaL_error(state, "Invalid array element in function Balltze.jobs.sort: expected number.");
+            }
+            lua_pop(state, 1);
+        }
+        std::vector<lua_Number> numbers(count);
+        for(std::size_t i = 0; i < count; i++) {
+            lua_rawgeti(state, 1, i + 1);
+            numbers[i] = lua_tonumber(state, -1);
+            lua_pop(state, 1);
+        }
+
+        auto handle = submit_lua_job(plugin, state, 2, [numbers = std::move(numbers), descending](LuaJobResult &result) mutable {
+            if(descending) {
+                std::sort(numbers.begin(), numbers.end(), std::greater<lua_Number>());
+            }
+            else {
+                std::sort(numbers.begin(), numbers.end());
+            }
+            result.push_value = [numbers = std::move(numbers)](lua_State *state) {
+                lua_createtable(state, numbers.size(), 0);
+                for(std::size_t i = 0; i < numbers.size(); i++) {
+                    lua_pushnumber(state, numbers[i]);
+                    lua_rawseti(state, -2, i + 1);
+                }
+            };
+        });
+        lua_pushinteger(state, handle);
+        return 1;
+    }
+
+    static int lua_jobs_cancel(lua_State *state) noexcept {
+        int args = lua_gettop(state);
+        if(args != 1) {
+            return luaL_error(state, "Invalid number of arguments in function Balltze.jobs.cancel.");
+        }
+        auto handle = static_cast<JobHandle>(luaL_checkinteger(state, 1));
+        auto it = lua_jobs.find(handle);
+        if(it == lua_jobs.end() || !cancel_job(handle)) {
+            lua_pushboolean(state, false);
+            return 1;
+        }
+        luaL_unref(state, LUA_REGISTRYINDEX, it->second.callback_reference);
+        lua_jobs.erase(it);
+        lua_pushboolean(state, true);
+        return 1;
+    }
+
+    static int lua_jobs_get_status(lua_State *state) noexcept {
+        int args = lua_gettop(state);
+        if(args != 1) {
+            return luaL_error(state, "Invalid number of arguments in function Balltze.jobs.getStatus.");
+        }
+        auto handle = static_cast<JobHandle>(luaL_checkinteger(state, 1));
+        auto status = lua_jobs.find(handle) != lua_jobs.end() ? get_job_status(handle) : std::nullopt;
+        if(!status) {
+            lua_pushnil(state);
+            return 1;
+        }
+        switch(*status) {
+            case JOB_STATUS_PENDING:
+                lua_pushstring(state, "pending");
+                break;
+            case JOB_STATUS_RUNNING:
+                lua_pushstring(state, "running");
+                break;
+            case JOB_STATUS_COMPLETED:
+                lua_pushstring(state, "completed");
+                break;
+        }
+        return 1;
+    }
+
+    void cancel_plugin_jobs(LuaPlugin *plugin) noexcept {
+        for(auto it = lua_jobs.begin(); it != lua_jobs.end();) {
+            if(it->second.plugin == plugin) {
+                cancel_job(it->first);
+                it = lua_jobs.erase(it);
+            }
+            else {
+                it++;
+            }
+        }
+    }
+
+    static const luaL_Reg jobs_functions[] = {
+        {"readFile", lua_jobs_read_file},
+        {"hash", lua_jobs_hash},
+        {"sort", lua_jobs_sort},
+        {"cancel", lua_jobs_cancel},
+        {"getStatus", lua_jobs_get_status},
+        {nullptr, nullptr}
+    };
+
+    void set_jobs_table(lua_State *state) noexcept {
+        create_functions_table(state, "jobs", jobs_functions);
+    }
+}
@@ -0,0 +1,15 @@
+// SPDX-License-Identifier: GPL-3.0-only
+
+#ifndef BALLTZE__PLUGINS__LUA__JOBS_HPP
+#define BALLTZE__PLUGINS__LUA__JOBS_HPP
+
+#include "../../plugin.hpp"
+
+namespace Balltze::Plugins::Lua {
+    /**
+     * Cancel the pending jobs of a plugin and drop the results of the running ones
+     */
+    void cancel_plugin_jobs(LuaPlugin *plugin) noexcept;
+}
+
+#endif
@@ -19,6 +19,15 @@ namespace Balltze::Plugins::Lua {
                     std::string logger_name = luaL_checkstring(state, -1); \
                     lua_pop(state, 1); \
                     \
+                    Logger *llogger = plugin->get_logger(logger_name); \
+                    if(!llogger) { \
+                        logger.warning("Could not get logger {} for plugin {}", logger_name, plugin->filename()); \
+                        return luaL_error(state, "Unknown logger."); \
+                    } \
+                    if(!llogger->name.enabled()) { \
+                        return 0; \
+                    } \
+                    \
                     /* Format the message using lfmt */ \
                     std::string message; \
                     if(args > 2) { \
@@ -31,14 +40,7 @@ namespace Balltze::Plugins::Lua {
                     else { \
                         message = luaL_checkstring(state, 2); \
                     } \
-                    Logger *llogger = plugin->get_logger(logger_name); \
-                    if(llogger) { \
-                        llogger->name(message); \
-                    } \
-                    else { \
-                        logger.warning("Could not get logger {} for plugin {}", logger_name, plugin->filename()); \
-                        return luaL_error(state, "Unknown logger."); \
-                    } \
+                    llogger->name(message); \
                 } \
                 else { \
                     logger.warning("Invalid number of arguments for Balltze.logger." #name "."); \
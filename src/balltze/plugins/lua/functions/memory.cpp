@@ -1,7 +1,11 @@
 // SPDX-License-Identifier: GPL-3.0-only
 
+#include <algorithm>
+#include <cctype>
 #include <cstring>
 #include <cstdint>
+#include <optional>
+#include <type_traits>
 #include <windows.h>
 #include <lua.hpp>
 #include "../helpers/function_table.hpp"
@@ -136,6 +140,400 @@ namespace Balltze::Plugins::Lua {
         }
     }
 
+    enum StructFieldType {
+        STRUCT_FIELD_INT8,
+        STRUCT_FIELD_UINT8,
+        STRUCT_FIELD_INT16,
+        STRUCT_FIELD_UINT16,
+        STRUCT_FIELD_INT32,
+        STRUCT_FIELD_UINT32,
+        STRUCT_FIELD_INT64,
+        STRUCT_FIELD_UINT64,
+        STRUCT_FIELD_FLOAT,
+        STRUCT_FIELD_DOUBLE
+    };
+
+    struct StructField {
+        StructFieldType type;
+        std::size_t offset;
+    };
+
+    /** Maximum number of fields of a struct format */
+    static constexpr std::size_t STRUCT_FORMAT_MAX_FIELDS = 256;
+
+    /**
+     * Fields of a format, in a fixed array: Lua errors longjmp out of the functions using it, which skips destructors
+     */
+    struct StructFormat {
+        StructField fields[STRUCT_FORMAT_MAX_FIELDS];
+        std::size_t field_count = 0;
+        std::size_t size = 0;
+    };
+    static_assert(std::is_trivially_destructible_v<StructFormat>);
+
+    /**
+     * Parse a string.pack-like format: b/B, h/H, i[n]/I[n], j/J, f, d and x for a padding byte.
+     * Fields are packed, and spaces are ignored.
+     */
+    static void parse_struct_format(lua_State *state, const char *format, const char *function_name, StructFormat &result) noexcept {
+        result.field_count = 0;
+        result.size = 0;
+        for(const char *c = format; *c != '\0'; c++) {
+            StructFieldType type;
+            std::size_t size;
+            switch(*c) {
+                case ' ':
+                    continue;
+                case 'x':
+                    result.size++;
+                    continue;
+                case 'b':
+                    type = STRUCT_FIELD_INT8;
+                    size = 1;
+                    break;
+                case 'B':
+                    type = STRUCT_FIELD_UINT8;
+                    size = 1;
+                    break;
+                case 'h':
+                    type = STRUCT_FIELD_INT16;
+                    size = 2;
+                    break;
+                case 'H':
+                    type = STRUCT_FIELD_UINT16;
+                    size = 2;
+                    break;
+                case 'i':
+                case 'I': {
+                    bool is_signed = *c == 'i';
+                    size = 4;
+                    if(std::isdigit(static_cast<unsigned char>(c[1]))) {
+                        size = c[1] - '0';
+                        c++;
+                    }
+                    switch(size) {
+                        case 1:
+                            type = is_signed ? STRUCT_FIELD_INT8 : STRUCT_FIELD_UINT8;
+                            break;
+                        case 2:
+                            type = is_signed ? STRUCT_FIELD_INT16 : STRUCT_FIELD_UINT16;
+                            break;
+                        case 4:
+                            type = is_signed ? STRUCT_FIELD_INT32 : STRUCT_FIELD_UINT32;
+                            break;
+                        case 8:
+                            type = is_signed ? STRUCT_FIELD_INT64 : STRUCT_FIELD_UINT64;
+                            break;
+                        default:
+                            luaL_error(state, "invalid integer size %d in format of Balltze.memory.%s function", static_cast<int>(size), function_name);
+                            return;
+                    }
+                    break;
+                }
+                case 'j':
+                    type = STRUCT_FIELD_INT64;
+                    size = 8;
+                    break;
+                case 'J':
+                    type = STRUCT_FIELD_UINT64;
+                    size = 8;
+                    break;
+                case 'f':
+                    type = STRUCT_FIELD_FLOAT;
+                    size = 4;
+                    break;
+                case 'd':
+                    type = STRUCT_FIELD_DOUBLE;
+                    size = 8;
+                    break;
+                default:
+                    luaL_error(state, "invalid option '%c' in format of Balltze.memory.%s function", *c, function_name);
+                    return;
+            }
+            if(result.field_count == STRUCT_FORMAT_MAX_FIELDS) {
+                luaL_error(state, "too many fields in format of Balltze.memory.%s function", function_name);
+                return;
+            }
+            result.fields[result.field_count++] = {type, result.size};
+            result.size += size;
+        }
+    }
+
+    /**
+     * Check that a whole range of memory is committed and can be read or written
+     */
+    static bool memory_range_is_accessible(std::uintptr_t address, std::size_t size, bool write) noexcept {
+        if(address == 0 || address + size < address) {
+            return false;
+        }
+        constexpr DWORD readable = PAGE_READONLY | PAGE_READWRITE | PAGE_WRITECOPY | PAGE_EXECUTE_READ | PAGE_EXECUTE_READWRITE | PAGE_EXECUTE_WRITECOPY;
+        constexpr DWORD writable = PAGE_READWRITE | PAGE_WRITECOPY | PAGE_EXECUTE_READWRITE | PAGE_EXECUTE_WRITECOPY;
+        auto end = address + size;
+        while(address < end) {
+            MEMORY_BASIC_INFORMATION info;
+            if(VirtualQuery(reinterpret_cast<void *>(address), &info, sizeof(info)) == 0) {
+                return false;
+            }
+            if(info.State != MEM_COMMIT || (info.Protect & (PAGE_GUARD | PAGE_NOACCESS)) || !(info.Protect & (write ? writable : readable))) {
+                return false;
+            }
+            address = reinterpret_cast<std::uintptr_t>(info.BaseAddress) + info.RegionSize;
+        }
+        return true;
+    }
+
+    /** Maximum number of values read or written at once by the struct array functions */
+    static constexpr std::size_t STRUCT_ARRAY_MAX_VALUES = 1 << 24;
+
+    /**
+     * Get the size of the memory covered by an array of structs
+     * @param count     Number of elements
+     * @param stride    Distance between the elements
+     * @param format    Format of the elements
+     * @return          Size in bytes, or nothing if the count or the stride are invalid or the array does not fit in the address space
+     */
+    static std::optional<std::size_t> get_struct_array_size(lua_Integer count, lua_Integer stride, StructFormat const &format) noexcept {
+        if(count < 0 || stride < 0 || (stride == 0 && count > 1)) {
+            return std::nullopt;
+        }
+        if(count == 0) {
+            return 0;
+        }
+        if(static_cast<std::uint64_t>(count) > STRUCT_ARRAY_MAX_VALUES / std::max<std::size_t>(format.field_count, 1)) {
+            return std::nullopt;
+        }
+        auto last_element = static_cast<std::uint64_t>(count - 1);
+        auto element_stride = static_cast<std::uint64_t>(stride);
+        if(element_stride != 0 && last_element > (UINT64_MAX - format.size) / element_stride) {
+            return std::nullopt;
+        }
+        auto size = last_element * element_stride + format.size;
+        if(size > SIZE_MAX) {
+            return std::nullopt;
+        }
+        return static_cast<std::size_t>(size);
+    }
+
+    template <typename T>
+    static T read_unaligned(std::uintptr_t address) noexcept {
+        T value;
+        std::memcpy(&value, reinterpret_cast<const void *>(address), sizeof(T));
+        return value;
+    }
+
+    template <typename T>
+    static void write_unaligned(std::uintptr_t address, T value) noexcept {
+        std::memcpy(reinterpret_cast<void *>(address), &value, sizeof(T));
+    }
+
+    static void push_struct_field(lua_State *state, StructField const &field, std::uintptr_t base) noexcept {
+        auto address = base + field.offset;
+        switch(field.type) {
+            case STRUCT_FIELD_INT8:
+                lua_pushinteger(state, read_unaligned<std::int8_t>(address));
+                break;
+            case STRUCT_FIELD_UINT8:
+                lua_pushinteger(state, read_unaligned<std::uint8_t>(address));
+                break;
+            case STRUCT_FIELD_INT16:
+                lua_pushinteger(state, read_unaligned<std::int16_t>(address));
+                break;
+            case STRUCT_FIELD_UINT16:
+                lua_pushinteger(state, read_unaligned<std::uint16_t>(address));
+                break;
+            case STRUCT_FIELD_INT32:
+                lua_pushinteger(state, read_unaligned<std::int32_t>(address));
+                break;
+            case STRUCT_FIELD_UINT32:
+                lua_pushinteger(state, read_unaligned<std::uint32_t>(address));
+                break;
+            case STRUCT_FIELD_INT64:
+                lua_pushinteger(state, read_unaligned<std::int64_t>(address));
+                break;
+            case STRUCT_FIELD_UINT64:
+                lua_pushinteger(state, static_cast<lua_Integer>(read_unaligned<std::uint64_t>(address)));
+                break;
+            case STRUCT_FIELD_FLOAT:
+                lua_pushnumber(state, read_unaligned<float>(address));
+                break;
+            case STRUCT_FIELD_DOUBLE:
+                lua_pushnumber(state, read_unaligned<double>(address));
+                break;
+        }
+    }
+
+    /**
+     * Check that a value can be written to a field, so every value of a write is checked before memory is changed
+     */
+    static bool struct_field_value_is_valid(lua_State *state, int index, StructField const &field) noexcept {
+        int is_valid;
+        if(field.type == STRUCT_FIELD_FLOAT || field.type == STRUCT_FIELD_DOUBLE) {
+            lua_tonumberx(state, index, &is_valid);
+        }
+        else {
+            lua_tointegerx(state, index, &is_valid);
+        }
+        return is_valid;
+    }
+
+    /**
+     * Write a value to a field; the value must have been checked with struct_field_value_is_valid
+     */
+    static void write_struct_field(lua_State *state, int index, StructField const &field, std::uintptr_t base) noexcept {
+        auto address = base + field.offset;
+        switch(field.type) {
+            case STRUCT_FIELD_INT8:
+            case STRUCT_FIELD_UINT8:
+                write_unaligned(address, static_cast<std::uint8_t>(lua_tointeger(state, index)));
+                break;
+            case STRUCT_FIELD_INT16:
+            case STRUCT_FIELD_UINT16:
+                write_unaligned(address, static_cast<std::uint16_t>(lua_tointeger(state, index)));
+                break;
+            case STRUCT_FIELD_INT32:
+            case STRUCT_FIELD_UINT32:
+                write_unaligned(address, static_cast<std::uint32_t>(lua_tointeger(state, index)));
+                break;
+            case STRUCT_FIELD_INT64:
+            case STRUCT_FIELD_UINT64:
+                write_unaligned(address, static_cast<std::uint64_t>(lua_tointeger(state, index)));
+                break;
+            case STRUCT_FIELD_FLOAT:
+                write_unaligned(address, static_cast<float>(lua_tonumber(state, index)));
+                break;
+            case STRUCT_FIELD_DOUBLE:
+                write_unaligned(address, static_cast<double>(lua_tonumber(state, index)));
+                break;
+        }
+    }
+
+    static int read_struct(lua_State *state) noexcept {
+        int args = lua_gettop(state);
+        if(args == 2) {
+            std::uintptr_t address = luaL_checkinteger(state, 1);
+            StructFormat format;
+            parse_struct_format(state, luaL_checkstring(state, 2), "readStruct", format);
+            if(!memory_range_is_accessible(address, format.size, false)) {
+                return luaL_error(state, "invalid memory range in Balltze.memory.readStruct function");
+            }
+            luaL_checkstack(state, format.field_count, "too many fields in Balltze.memory.readStruct function");
+            for(std::size_t i = 0; i < format.field_count; i++) {
+                push_struct_field(state, format.fields[i], address);
+            }
+            return format.field_count;
+        }
+        else {
+            return luaL_error(state, "invalid number of arguments in Balltze.memory.readStruct function");
+        }
+    }
+
+    static int write_struct(lua_State *state) noexcept {
+        int args = lua_gettop(state);
+        if(args >= 2) {
+            std::uintptr_t address = luaL_checkinteger(state, 1);
+            StructFormat format;
+            parse_struct_format(state, luaL_checkstring(state, 2), "writeStruct", format);
+            if(static_cast<std::size_t>(args - 2) != format.field_count) {
+                return luaL_error(state, "number of values does not match the format in Balltze.memory.writeStruct function");
+            }
+            if(!memory_range_is_accessible(address, format.size, true)) {
+                return luaL_error(state, "invalid memory range in Balltze.memory.writeStruct function");
+            }
+
+            // Nothing is written unless every value can be
+            for(std::size_t i = 0; i < format.field_count; i++) {
+                if(!struct_field_value_is_valid(state, i + 3, format.fields[i])) {
+                    return luaL_error(state, "invalid value %d in Balltze.memory.writeStruct function", static_cast<int>(i + 1));
+                }
+            }
+            for(std::size_t i = 0; i < format.field_count; i++) {
+                write_struct_field(state, i + 3, format.fields[i], address);
+            }
+            return 0;
+        }
+        else {
+            return luaL_error(state, "invalid number of arguments in Balltze.memory.writeStruct function");
+        }
+    }
+
+    static int read_struct_array(lua_State *state) noexcept {
+        int args = lua_gettop(state);
+        if(args == 3 || args == 4) {
+            std::uintptr_t address = luaL_checkinteger(state, 1);
+            StructFormat format;
+            parse_struct_format(state, luaL_checkstring(state, 2), "readStructArray", format);
+            auto count = luaL_checkinteger(state, 3);
+            auto stride = luaL_optinteger(state, 4, format.size);
+            auto size = get_struct_array_size(count, stride, format);
+            if(!size) {
+                return luaL_error(state, "invalid count or stride in Balltze.memory.readStructArray function");
+            }
+            if(count > 0 && !memory_range_is_accessible(address, *size, false)) {
+                return luaL_error(state, "invalid memory range in Balltze.memory.readStructArray function");
+            }
+            lua_createtable(state, count * format.field_count, 0);
+            lua_Integer index = 1;
+            for(lua_Integer i = 0; i < count; i++) {
+                for(std::size_t j = 0; j < format.field_count; j++) {
+                    push_struct_field(state, format.fields[j], address + i * stride);
+                    lua_rawseti(state, -2, index++);
+                }
+            }
+            return 1;
+        }
+        else {
+            return luaL_error(state, "invalid number of arguments in Balltze.memory.readStructArray function");
+        }
+    }
+
+    static int write_struct_array(lua_State *state) noexcept {
+        int args = lua_gettop(state);
+        if(args == 3 || args == 4) {
+            std::uintptr_t address = luaL_checkinteger(state, 1);
+            StructFormat format;
+            parse_struct_format(state, luaL_checkstring(state, 2), "writeStructArray", format);
+            luaL_checktype(state, 3, LUA_TTABLE);
+            auto stride = luaL_optinteger(state, 4, format.size);
+            auto values = lua_rawlen(state, 3);
+            if(format.field_count == 0 || values % format.field_count != 0) {
+                return luaL_error(state, "number of values does not match the format in Balltze.memory.writeStructArray function");
+            }
+            auto count = static_cast<lua_Integer>(values / format.field_count);
+            auto size = get_struct_array_size(count, stride, format);
+            if(!size) {
+                return luaL_error(state, "invalid count or stride in Balltze.memory.writeStructArray function");
+            }
+            if(count > 0 && !memory_range_is_accessible(address, *size, true)) {
+                return luaL_error(state, "invalid memory range in Balltze.memory.writeStructArray function");
+            }
+
+            // Nothing is written unless every value can be
+            lua_Integer index = 1;
+            for(lua_Integer i = 0; i < count; i++) {
+                for(std::size_t j = 0; j < format.field_count; j++, index++) {
+                    lua_rawgeti(state, 3, index);
+                    bool is_valid = struct_field_value_is_valid(state, -1, format.fields[j]);
+                    lua_pop(state, 1);
+                    if(!is_valid) {
+                        return luaL_error(state, "invalid value %d in Balltze.memory.writeStructArray function", static_cast<int>(index));
+                    }
+                }
+            }
+            index = 1;
+            for(lua_Integer i = 0; i < count; i++) {
+                for(std::size_t j = 0; j < format.field_count; j++) {
+                    lua_rawgeti(state, 3, index++);
+                    write_struct_field(state, -1, format.fields[j], address + i * stride);
+                    lua_pop(state, 1);
+                }
+            }
+            return 0;
+        }
+        else {
+            return luaL_error(state, "invalid number of arguments in Balltze.memory.writeStructArray function");
+        }
+    }
+
     static const luaL_Reg memory_functions[] = {
         {"readInt8", read_int<std::int8_t>},
         {"readInt16", read_int<std::int16_t>},
@@ -153,6 +551,10 @@ namespace Balltze::Plugins::Lua {
         {"writeString8", write_string8},
         {"readBit", read_bit},
         {"writeBit", write_bit},
+        {"readStruct", read_struct},
+        {"writeStruct", write_struct},
+        {"readStructArray", read_struct_array},
+        {"writeStructArray", write_struct_array},
         {nullptr, nullptr}
     };
 
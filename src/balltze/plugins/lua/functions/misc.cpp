@@ -231,7 +231,7 @@ namespace Balltze::Plugins::Lua {
 
         static auto tickHandler = Event::TickEvent::subscribe_const([](const Event::TickEvent &event) {
             if(event.time == Event::EVENT_TIME_BEFORE) {
-                auto plugins = get_lua_plugins();
+                auto &plugins = get_lua_plugins();
                 for(auto *plugin : plugins) {
                     check_timers(plugin);
                 }
@@ -240,7 +240,7 @@ namespace Balltze::Plugins::Lua {
 
         static auto frameHandler = Event::FrameEvent::subscribe_const([](const Event::FrameEvent &event) {
             if(event.time == Event::EVENT_TIME_AFTER) {
-                auto plugins = get_lua_plugins();
+                auto &plugins = get_lua_plugins();
                 for(auto *plugin : plugins) {
                     check_timers(plugin);
                 }
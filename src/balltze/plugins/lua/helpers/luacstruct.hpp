@@ -60,6 +60,7 @@ extern "C" {
     int luacs_delstruct(lua_State *, const char *);
     int luacs_declare_field(lua_State *, enum luacstruct_type, const char *, const char *, size_t, int, int, unsigned);
     int luacs_newobject0(lua_State *, const char *, void *);
+    int luacs_invalidate_objects(lua_State *, void *, size_t);
     void *luacs_object_pointer(lua_State *, int, const char *);
     int luacs_object_typename(lua_State *);
     void *luacs_checkobject(lua_State *, int, const char *);
@@ -4,6 +4,7 @@
 #include <balltze/helpers/resources.hpp>
 #include <balltze/utils.hpp>
 #include "../../../resources.hpp"
+#include "../bytecode_cache.hpp"
 #include "../libraries.hpp"
 #include "lanes.hpp"
 
@@ -19,48 +20,36 @@ namespace Balltze::Plugins {
         return 1;
     }
 
-    static int lua_open_json(lua_State *state) noexcept {
-        auto json_module_data = load_resource_data(get_current_module(), MAKEINTRESOURCEW(ID_LUA_JSON_MODULE), L"LUA");
-        if(json_module_data) {
-            if(luaL_loadbufferx(state, reinterpret_cast<const char *>(json_module_data->data()), json_module_data->size(), "json", "t") == LUA_OK) {
+    /**
+     * Run a Lua module embedded in the resources of the DLL. The bytecode of the module is shared
+     * between states, so it is only parsed the first time a state requires it.
+     */
+    static int load_embedded_module(lua_State *state, int resource_id, const char *name) noexcept {
+        auto module_data = load_resource_data(get_current_module(), MAKEINTRESOURCEW(resource_id), L"LUA");
+        if(module_data) {
+            if(Lua::load_cached_buffer(state, reinterpret_cast<const char *>(module_data->data()), module_data->size(), name) == LUA_OK) {
                 lua_call(state, 0, 1);
                 return 1;
             }
+            lua_pop(state, 1);
         }
         return 0;
     }
 
+    static int lua_open_json(lua_State *state) noexcept {
+        return load_embedded_module(state, ID_LUA_JSON_MODULE, "json");
+    }
+
     static int lua_open_luna(lua_State *state) noexcept {
-        auto luna_module_data = load_resource_data(get_current_module(), MAKEINTRESOURCEW(ID_LUA_LUNA_MODULE), L"LUA");
-        if(luna_module_data) {
-            if(luaL_loadbufferx(state, reinterpret_cast<const char *>(luna_module_data->data()), luna_module_data->size(), "luna", "t") == LUA_OK) {
-                lua_call(state, 0, 1);
-                return 1;
-            }
-        }
-        return 0;
+        return load_embedded_module(state, ID_LUA_LUNA_MODULE, "luna");
     }
 
     static int lua_open_inspect(lua_State *state) noexcept {
-        auto inspect_module_data = load_resource_data(get_current_module(), MAKEINTRESOURCEW(ID_LUA_INSPECT_MODULE), L"LUA");
-        if(inspect_module_data) {
-            if(luaL_loadbufferx(state, reinterpret_cast<const char *>(inspect_module_data->data()), inspect_module_data->size(), "inspect", "t") == LUA_OK) {
-                lua_call(state, 0, 1);
-                return 1;
-            }
-        }
-        return 0;
+        return load_embedded_module(state, ID_LUA_INSPECT_MODULE, "inspect");
     }
 
     int lua_open_lanes(lua_State *state) noexcept {
-        auto lanes_module_data = load_resource_data(get_current_module(), MAKEINTRESOURCEW(ID_LUA_LANES_MODULE), L"LUA");
-        if(lanes_module_data) {
-            if(luaL_loadbufferx(state, reinterpret_cast<const char *>(lanes_module_data->data()), lanes_module_data->size(), "lanes", "t") == LUA_OK) {
-                lua_call(state, 0, 1);
-                return 1;
-            }
-        }
-        return 0;
+        return load_embedded_module(state, ID_LUA_LANES_MODULE, "lanes");
     }
 
     void set_preloaded_libraries(lua_State *state) noexcept {
@@ -0,0 +1,86 @@
+// SPDX-License-Identifier: GPL-3.0-only
+
+#include <ctime>
+#include <fstream>
+#include <map>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <lua.hpp>
+#include "../../config/config.hpp"
+#include "../../logger.hpp"
+#include "profiler_sampler.hpp"
+#include "profiler.hpp"
+
+namespace Balltze::Plugins::Lua {
+    struct LuaProfiler {
+        LuaPlugin *plugin;
+        LuaProfilerSampler sampler;
+    };
+
+    static std::unordered_map<LuaPlugin *, std::unique_ptr<LuaProfiler>> profilers;
+
+    bool start_lua_profiler(LuaPlugin *plugin, std::size_t instruction_interval) {
+        if(profilers.find(plugin) != profilers.end()) {
+            return false;
+        }
+
+        auto profiler = std::make_unique<LuaProfiler>();
+        profiler->plugin = plugin;
+        profiler->sampler.attach(plugin->state(), instruction_interval);
+
+        profilers.emplace(plugin, std::move(profiler));
+        return true;
+    }
+
+    static std::filesystem::path write_profile(LuaProfiler const &profiler) {
+        auto stacks = profiler.sampler.collapsed_stacks();
+
+        auto profiles_directory = Config::get_balltze_directory() / "profiles";
+        std::filesystem::create_directories(profiles_directory);
+        char timestamp[32];
+        auto now = std::time(nullptr);
+        std::strftime(timestamp, sizeof(timestamp), "%Y%m%d_%H%M%S", std::localtime(&now));
+        auto path = profiles_directory / (std::filesystem::path(profiler.plugin->filename()).stem().string() + "_" + timestamp + ".folded");
+
+        std::ofstream file(path, std::ios::trunc);
+        for(auto &[stack, count] : stacks) {
+            file << stack << ' ' << count << '\n';
+        }
+        if(!file) {
+            throw std::runtime_error("could not write " + path.string());
+        }
+        return path;
+    }
+
+    std::optional<std::filesystem::path> stop_lua_profiler(LuaPlugin *plugin) noexcept {
+        auto it = profilers.find(plugin);
+        if(it == profilers.end()) {
+            return std::nullopt;
+        }
+        auto profiler = std::move(it->second);
+        profilers.erase(it);
+
+        // Coroutines keep the hook, but it does nothing once the registry entry is gone
+        if(plugin->initialized()) {
+            LuaProfilerSampler::detach(plugin->state());
+        }
+
+        auto dropped_samples = profiler->sampler.dropped_samples();
+        if(dropped_samples > 0) {
+            logger.warning("Lua profiler buffer of plugin {} was full; {} samples were dropped.", plugin->filename(), dropped_samples);
+        }
+
+        try {
+            return write_profile(*profiler);
+        }
+        catch(std::exception &e) {
+            logger.error("Could not write Lua profile of plugin {}: {}", plugin->filename(), e.what());
+            return std::nullopt;
+        }
+    }
+
+    bool lua_profiler_running(LuaPlugin *plugin) noexcept {
+        return profilers.find(plugin) != profilers.end();
+    }
+}
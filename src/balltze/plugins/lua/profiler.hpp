@@ -0,0 +1,35 @@
+// SPDX-License-Identifier: GPL-3.0-only
+
+#ifndef BALLTZE__PLUGINS__LUA__PROFILER_HPP
+#define BALLTZE__PLUGINS__LUA__PROFILER_HPP
+
+#include <cstddef>
+#include <filesystem>
+#include <optional>
+#include "../plugin.hpp"
+
+namespace Balltze::Plugins::Lua {
+    /**
+     * Start sampling the Lua stack of a plugin every given number of VM instructions.
+     * Coroutines created before the profiler was started are not sampled.
+     * @param plugin                Plugin to profile
+     * @param instruction_interval  Number of instructions between samples
+     * @return                      False if the plugin is already being profiled
+     */
+    bool start_lua_profiler(LuaPlugin *plugin, std::size_t instruction_interval);
+
+    /**
+     * Stop profiling a plugin and write the samples as collapsed stacks, one line per unique
+     * stack with its sample count, as expected by flamegraph tools
+     * @param plugin    Plugin being profiled
+     * @return          Path of the profile file, or nothing if the plugin was not being profiled or the file could not be written
+     */
+    std::optional<std::filesystem::path> stop_lua_profiler(LuaPlugin *plugin) noexcept;
+
+    /**
+     * Check if a plugin is being profiled
+     */
+    bool lua_profiler_running(LuaPlugin *plugin) noexcept;
+}
+
+#endif
@@ -0,0 +1,101 @@
+// SPDX-License-Identifier: GPL-3.0-only
+
+#include <algorithm>
+#include "profiler_sampler.hpp"
+
+namespace Balltze::Plugins::Lua {
+    /** Its address is the registry key of the sampler of a state */
+    static const char sampler_registry_key = 0;
+
+    static std::string get_frame_label(lua_Debug const &ar) {
+        // Semicolons separate the frames in collapsed stacks
+        std::string source = ar.short_src;
+        std::replace(source.begin(), source.end(), ';', ':');
+        std::string name = ar.name ? ar.name : "?";
+        std::replace(name.begin(), name.end(), ';', ':');
+
+        if(*ar.what == 'C') {
+            return "[C] " + name;
+        }
+        if(*ar.what == 'm') {
+            return "main chunk (" + source + ":" + std::to_string(ar.currentline) + ")";
+        }
+        return name + " (" + source + ":" + std::to_string(ar.currentline) + ")";
+    }
+
+    void LuaProfilerSampler::take_sample(lua_State *state) noexcept {
+        if(m_samples.capacity() - m_samples.size() < MAX_SAMPLE_DEPTH + 1) {
+            m_dropped_samples++;
+            return;
+        }
+
+        auto depth_index = m_samples.size();
+        m_samples.push_back(0);
+        lua_Debug ar;
+        for(int level = 0; level < static_cast<int>(MAX_SAMPLE_DEPTH) && lua_getstack(state, level, &ar); level++) {
+            lua_getinfo(state, "Sl", &ar);
+            Frame frame = { ar.source, ar.linedefined, ar.currentline };
+            auto it = m_frame_ids.find(frame);
+            if(it == m_frame_ids.end()) {
+                // Looking up the name of a function is slow, so it is only done the first time a frame is seen
+                lua_getinfo(state, "n", &ar);
+                try {
+                    m_frame_labels.push_back(get_frame_label(ar));
+                    it = m_frame_ids.emplace(frame, m_frame_labels.size() - 1).first;
+                }
+                catch(...) {
+                    break;
+                }
+            }
+            m_samples.push_back(it->second);
+            m_samples[depth_index]++;
+        }
+        m_sample_count++;
+    }
+
+    void LuaProfilerSampler::hook(lua_State *state, lua_Debug *) noexcept {
+        lua_rawgetp(state, LUA_REGISTRYINDEX, &sampler_registry_key);
+        auto *sampler = static_cast<LuaProfilerSampler *>(lua_touserdata(state, -1));
+        lua_pop(state, 1);
+        if(sampler) {
+            sampler->take_sample(state);
+        }
+    }
+
+    void LuaProfilerSampler::attach(lua_State *state, std::size_t instruction_interval) noexcept {
+        lua_pushlightuserdata(state, this);
+        lua_rawsetp(state, LUA_REGISTRYINDEX, &sampler_registry_key);
+        lua_sethook(state, hook, LUA_MASKCOUNT, static_cast<int>(std::max<std::size_t>(instruction_interval, 1)));
+    }
+
+    void LuaProfilerSampler::detach(lua_State *state) noexcept {
+        lua_sethook(state, nullptr, 0, 0);
+        lua_pushnil(state);
+        lua_rawsetp(state, LUA_REGISTRYINDEX, &sampler_registry_key);
+    }
+
+    std::map<std::string, std::size_t> LuaProfilerSampler::collapsed_stacks() const {
+        // Frames are recorded from the innermost one
+        std::map<std::string, std::size_t> stacks;
+        std::size_t offset = 0;
+        while(offset < m_samples.size()) {
+            auto depth = m_samples[offset];
+            std::string stack;
+            for(std::size_t i = depth; i > 0; i--) {
+                if(!stack.empty()) {
+                    stack += ';';
+                }
+                stack += m_frame_labels[m_samples[offset + i]];
+            }
+            if(!stack.empty()) {
+                stacks[stack]++;
+            }
+            offset += depth + 1;
+        }
+        return stacks;
+    }
+
+    LuaProfilerSampler::LuaProfilerSampler(std::size_t buffer_size) {
+        m_samples.reserve(buffer_size);
+    }
+}
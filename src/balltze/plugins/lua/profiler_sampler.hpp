@@ -0,0 +1,98 @@
+// SPDX-License-Identifier: GPL-3.0-only
+
+#ifndef BALLTZE__PLUGINS__LUA__PROFILER_SAMPLER_HPP
+#define BALLTZE__PLUGINS__LUA__PROFILER_SAMPLER_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include <lua.hpp>
+
+namespace Balltze::Plugins::Lua {
+    /**
+     * Samples of the Lua stack of a state, taken from a count hook. It does not depend on the plugin
+     * the state belongs to, so it can be run on its own.
+     */
+    class LuaProfilerSampler {
+    public:
+        /** Frames deeper than this are left out of the samples */
+        static constexpr std::size_t MAX_SAMPLE_DEPTH = 64;
+
+        /** Default size of the sample buffer; every sample takes its depth plus one entries */
+        static constexpr std::size_t SAMPLE_BUFFER_SIZE = 1024 * 1024;
+
+    private:
+        struct Frame {
+            const char *source;
+            int line_defined;
+            int current_line;
+
+            bool operator==(Frame const &other) const noexcept {
+                return source == other.source && line_defined == other.line_defined && current_line == other.current_line;
+            }
+        };
+
+        struct FrameHash {
+            std::size_t operator()(Frame const &frame) const noexcept {
+                auto hash = std::hash<const void *>()(frame.source);
+                hash = hash * 31 + std::hash<int>()(frame.line_defined);
+                return hash * 31 + std::hash<int>()(frame.current_line);
+            }
+        };
+
+        std::vector<std::uint32_t> m_samples;
+        std::unordered_map<Frame, std::uint32_t, FrameHash> m_frame_ids;
+        std::vector<std::string> m_frame_labels;
+        std::size_t m_sample_count = 0;
+        std::size_t m_dropped_samples = 0;
+
+        static void hook(lua_State *state, lua_Debug *ar) noexcept;
+
+    public:
+        /**
+         * Start sampling the stack of a state every given number of VM instructions.
+         * Coroutines created before the sampler was attached are not sampled.
+         * @param state                 State to sample
+         * @param instruction_interval  Number of instructions between samples
+         */
+        void attach(lua_State *state, std::size_t instruction_interval) noexcept;
+
+        /**
+         * Stop sampling a state. Coroutines keep the hook, but it does nothing once the sampler is detached.
+         */
+        static void detach(lua_State *state) noexcept;
+
+        /**
+         * Record the current stack of a state
+         */
+        void take_sample(lua_State *state) noexcept;
+
+        /**
+         * Count the samples of every unique stack, as collapsed stacks: the frames from the outermost one,
+         * separated by semicolons
+         */
+        std::map<std::string, std::size_t> collapsed_stacks() const;
+
+        std::size_t sample_count() const noexcept {
+            return m_sample_count;
+        }
+
+        /**
+         * Number of samples which did not fit in the buffer
+         */
+        std::size_t dropped_samples() const noexcept {
+            return m_dropped_samples;
+        }
+
+        /**
+         * @param buffer_size   Number of entries of the sample buffer
+         */
+        LuaProfilerSampler(std::size_t buffer_size = SAMPLE_BUFFER_SIZE);
+    };
+}
+
+#endif
@@ -1,10 +1,14 @@
 // SPDX-License-Identifier: GPL-3.0-only
 
+#include <balltze/memory.hpp>
 #include "lua/api.hpp"
+#include "lua/bytecode_cache.hpp"
 #include "../config/config.hpp"
 #include "../logger.hpp"
 #include "../version.hpp"
 #include "lua/functions/command.hpp"
+#include "lua/functions/jobs.hpp"
+#include "lua/profiler.hpp"
 #include "plugin.hpp"
 
 namespace Balltze::Plugins {
@@ -312,6 +316,10 @@ namespace Balltze::Plugins {
         return m_state;
     }
 
+    Lua::LuaAllocator *LuaPlugin::allocator() noexcept {
+        return m_allocator.get();
+    }
+
     void LuaPlugin::add_logger(std::string name) {
         if(get_logger(name)) {
             throw std::runtime_error("Logger already exists.");
@@ -384,8 +392,24 @@ namespace Balltze::Plugins {
         if(m_state) {
             throw std::runtime_error("plugin already initialized");
         }
-        m_state = luaL_newstate();
+        std::optional<std::size_t> memory_limit;
+        auto memory_limit_mib = Config::get_config().get<std::size_t>("plugins.lua_memory_limit");
+        if(memory_limit_mib && *memory_limit_mib > 0) {
+            memory_limit = *memory_limit_mib * MIB_SIZE;
+        }
+        m_allocator = std::make_unique<Lua::LuaAllocator>(memory_limit);
+        m_state = lua_newstate(Lua::LuaAllocator::allocate, m_allocator.get());
         if(m_state) {
+            // Used by get_lua_plugin; coroutines copy it from the main state
+            *reinterpret_cast<LuaPlugin **>(lua_getextraspace(m_state)) = this;
+
+            // lua_newstate does not set the panic function luaL_newstate used to set
+            lua_atpanic(m_state, [](lua_State *state) -> int {
+                auto *message = lua_tostring(state, -1);
+                logger.fatal("Unprotected error in Lua plugin: {}", message ? message : "unknown error");
+                return 0;
+            });
+
             // Open standard libraries and Balltze API
             luaL_openlibs(m_state);
             Lua::open_balltze_api(m_state);
@@ -412,22 +436,27 @@ namespace Balltze::Plugins {
             lua_setfield(m_state, -2, "cpath");
             lua_pop(m_state, 1);
 
-            if(luaL_loadfile(m_state, m_filepath.string().c_str()) == LUA_OK) {
+            if(Lua::load_cached_file(m_state, m_filepath) == LUA_OK) {
                 int res = lua_pcall(m_state, 0, 0, 0);
                 if(res != LUA_OK) {
                     logger.error("Could not execute Lua plugin '{}': {}", m_filename, get_error_message());
                     print_traceback();
                     lua_close(m_state);
+                    m_state = nullptr;
+                    m_allocator.reset();
                     throw std::runtime_error("Could not execute Lua plugin '" + m_filename + "'.");
                 }
                 update_metadata();
             }
             else {
                 lua_close(m_state);
+                m_state = nullptr;
+                m_allocator.reset();
                 throw std::runtime_error("could not read Lua plugin '" + m_filename + "'.");
             }
         }
         else {
+            m_allocator.reset();
             throw std::runtime_error("could not create Lua state for plugin '" + m_filename + "'.");
         }
     }
@@ -508,8 +537,11 @@ namespace Balltze::Plugins {
             throw std::runtime_error("plugin already disposed");
         }
         logger.debug("Disposing Lua plugin '{}'...", m_filename);
+        Lua::cancel_plugin_jobs(this);
+        Lua::stop_lua_profiler(this);
         lua_close(m_state);
         m_state = nullptr;
+        m_allocator.reset();
     }
 
     void LuaPlugin::first_tick() {
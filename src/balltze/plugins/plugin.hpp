@@ -7,12 +7,14 @@
 #include <filesystem>
 #include <vector>
 #include <map>
+#include <memory>
 #include <utility>
 #include <windows.h>
 #include <lua.hpp>
 #include <balltze/engine/tag.hpp>
 #include <balltze/logger.hpp>
 #include <balltze/plugin.hpp>
+#include "lua/allocator.hpp"
 
 namespace Balltze::Plugins {
     enum PluginLoadResult {
@@ -79,6 +81,7 @@ namespace Balltze::Plugins {
     class LuaPlugin : public Plugin {
     private:
         lua_State *m_state;
+        std::unique_ptr<Lua::LuaAllocator> m_allocator;
         std::vector<std::unique_ptr<Logger>> m_loggers;
         std::map<std::string, std::vector<std::pair<std::string, Engine::TagClassInt>>> m_tag_imports;
 
@@ -89,6 +92,7 @@ namespace Balltze::Plugins {
 
     public:
         lua_State *state() noexcept;
+        Lua::LuaAllocator *allocator() noexcept;
         void add_logger(std::string name);
         void remove_logger(std::string name);
         Logger *get_logger(std::string name) noexcept;
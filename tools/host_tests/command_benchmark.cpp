@@ -0,0 +1,118 @@
+// SPDX-License-Identifier: GPL-3.0-only
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <vector>
+#include <command/command.hpp>
+#include "command_stand_in.hpp"
+#include "host_test.hpp"
+
+using namespace Balltze;
+using HscFunctionEntry = Engine::HscFunctionEntry;
+
+/**
+ * Splitting console commands, finding commands by name and building the script function list of the
+ * console, with a number of plugin commands; usage:
+ *   command_benchmark [--quick] [--commands N]
+ */
+int main(int argc, const char **argv) {
+    bool quick = HostTest::quick_run(argc, argv);
+    std::size_t command_count = 200;
+    for(int i = 1; i + 1 < argc; i++) {
+        if(std::strcmp(argv[i], "--commands") == 0) {
+            command_count = std::strtoull(argv[i + 1], nullptr, 10);
+        }
+    }
+    std::size_t iterations = quick ? 10 : 100000;
+
+    // Commands of a few plugins
+    std::vector<std::string> full_names;
+    for(std::size_t i = 0; i < command_count; i++) {
+        auto plugin = reinterpret_cast<PluginHandle>(0x1000 + i % 8);
+        auto plugin_name = "plugin_" + std::to_string(i % 8);
+        auto command = std::make_shared<HostTest::TestCommand>(plugin, plugin_name, "command_" + std::to_string(i));
+        full_names.emplace_back(command->full_name());
+        add_command(std::move(command));
+    }
+    std::printf("%zu commands\n", command_count);
+
+    std::vector<std::string> inputs = {
+        "balltze_version",
+        "plugin_3_command_42 70",
+        "sv_name \"My Server\" # rename the server",
+        "plugin_1_command_7 \"maps\\\\custom map\" 1 0.5 true",
+    };
+    HostTest::benchmark("split_arguments", iterations, inputs.size(), [&]() {
+        for(auto &input : inputs) {
+            HostTest::do_not_optimize(split_arguments(input));
+        }
+    });
+    std::vector<const char *> arguments;
+    HostTest::benchmark("split_arguments_in_place", iterations, inputs.size(), [&]() {
+        for(auto &input : inputs) {
+            std::string command = input;
+            arguments.clear();
+            split_arguments_in_place(command, arguments);
+            HostTest::do_not_optimize(arguments);
+        }
+    });
+
+    // Every command, from the last registered ones, which a scan gets to last
+    std::vector<std::string> lookups;
+    for(std::size_t i = 0; i < 16; i++) {
+        lookups.push_back(full_names[command_count - 1 - (i * 7) % command_count]);
+    }
+    lookups.push_back("plugin_0_missing");
+    HostTest::benchmark("scan of the commands", iterations, lookups.size(), [&]() {
+        for(auto &name : lookups) {
+            std::shared_ptr<Command> found;
+            for(auto &command : get_commands()) {
+                if(name == command->full_name()) {
+                    found = command;
+                    break;
+                }
+            }
+            HostTest::do_not_optimize(found);
+        }
+    });
+    HostTest::benchmark("find_command", iterations, lookups.size(), [&]() {
+        for(auto &name : lookups) {
+            HostTest::do_not_optimize(find_command(name));
+        }
+    });
+
+    // The console of the game has about 500 script functions
+    std::vector<HscFunctionEntry> game_functions(500);
+    std::vector<HscFunctionEntry *> game_list;
+    for(auto &function : game_functions) {
+        game_list.push_back(&function);
+    }
+    std::vector<HscFunctionEntry *> other_game_list = game_list;
+    CommandsFunctionList list;
+    std::size_t calls = 0;
+    HostTest::benchmark("function list, built on every call", iterations, 1, [&]() {
+        auto &game_entries = calls++ % 2 ? game_list : other_game_list;
+        HostTest::do_not_optimize(list.get(game_entries.data(), game_entries.size()).data());
+    });
+    HostTest::benchmark("function list, unchanged", iterations, 1, [&]() {
+        HostTest::do_not_optimize(list.get(game_list.data(), game_list.size()).data());
+    });
+
+    // Both lookups have to find the same commands
+    int result = EXIT_SUCCESS;
+    for(auto &name : full_names) {
+        auto command = find_command(name);
+        if(!command || name != command->full_name()) {
+            std::fprintf(stderr, "%s was not found\n", name.c_str());
+            result = EXIT_FAILURE;
+        }
+    }
+    if(list.get(game_list.data(), game_list.size()).size() != game_list.size() + command_count) {
+        std::fprintf(stderr, "the function list does not have every command\n");
+        result = EXIT_FAILURE;
+    }
+    return result;
+}
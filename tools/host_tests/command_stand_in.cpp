@@ -0,0 +1,27 @@
+// SPDX-License-Identifier: GPL-3.0-only
+
+#include <balltze/command.hpp>
+#include "command_stand_in.hpp"
+
+// The constructors and the function calls of commands are in command.cpp, with the game hooks; these
+// stand-ins only keep what the registry reads.
+namespace Balltze {
+    Command::Command(std::string name, std::string category, std::string help, std::optional<std::string> params_help, bool autosave, std::size_t min_args, std::size_t max_args, bool can_call_from_console, bool is_public) :
+        m_name(name), m_category(category), m_help(help), m_params_help(params_help), m_function(nullptr), m_autosave(autosave), m_min_args(min_args), m_max_args(max_args), m_can_call_from_console(can_call_from_console), m_public(is_public) {}
+
+    CommandResult Command::call(std::size_t, const char **) const noexcept {
+        return COMMAND_RESULT_FAILED_ERROR;
+    }
+}
+
+namespace HostTest {
+    TestCommand::TestCommand(PluginHandle plugin, std::string const &plugin_name, std::string const &name) :
+        Command(name, "test", "Help of " + name, "<value>", false, 0, 1, true, false) {
+        m_plugin = plugin;
+        m_full_name = plugin_name + "_" + name;
+    }
+
+    Balltze::CommandResult TestCommand::call(std::size_t, const char **) const noexcept {
+        return Balltze::COMMAND_RESULT_SUCCESS;
+    }
+}
@@ -0,0 +1,27 @@
+// SPDX-License-Identifier: GPL-3.0-only
+
+#ifndef BALLTZE_HOST_TESTS__COMMAND_STAND_IN_HPP
+#define BALLTZE_HOST_TESTS__COMMAND_STAND_IN_HPP
+
+#include <string>
+#include <balltze/command.hpp>
+
+namespace HostTest {
+    /**
+     * Command as the registry gets it from the command functions, with its full name already set.
+     * Registering commands needs the plugin loader, so the tests add them to the registry directly.
+     */
+    class TestCommand : public Balltze::Command {
+    public:
+        /**
+         * @param plugin        Handle of the plugin of the command
+         * @param plugin_name   Name of the plugin, or "balltze", for the full name
+         * @param name          Name of the command
+         */
+        TestCommand(PluginHandle plugin, std::string const &plugin_name, std::string const &name);
+
+        Balltze::CommandResult call(std::size_t arg_count, const char **args) const noexcept override;
+    };
+}
+
+#endif
@@ -0,0 +1,218 @@
+// SPDX-License-Identifier: GPL-3.0-only
+
+#include <cstdint>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <command/command.hpp>
+#include "command_stand_in.hpp"
+#include "host_test.hpp"
+
+using namespace Balltze;
+using HostTest::TestCommand;
+using HscFunctionEntry = Engine::HscFunctionEntry;
+
+static std::vector<std::string> split(std::string command) {
+    std::vector<const char *> arguments;
+    split_arguments_in_place(command, arguments);
+
+    // Every argument points into the buffer of the command
+    for(auto *argument : arguments) {
+        CHECK(argument >= command.data() && argument <= command.data() + command.size());
+    }
+    return std::vector<std::string>(arguments.begin(), arguments.end());
+}
+
+static PluginHandle plugin_handle(std::uintptr_t id) {
+    return reinterpret_cast<PluginHandle>(id);
+}
+
+static std::shared_ptr<TestCommand> add_test_command(PluginHandle plugin, std::string const &plugin_name, std::string const &name) {
+    auto command = std::make_shared<TestCommand>(plugin, plugin_name, name);
+    add_command(command);
+    return command;
+}
+
+TEST_CASE("arguments are split at spaces and line breaks") {
+    CHECK(split("").empty());
+    CHECK(split("   ").empty());
+    CHECK((split("balltze_version") == std::vector<std::string>{"balltze_version"}));
+    CHECK((split("  a   b  ") == std::vector<std::string>{"a", "b"}));
+    CHECK((split("a\r\nb\nc\rd") == std::vector<std::string>{"a", "b", "c", "d"}));
+    CHECK((split("a\tb") == std::vector<std::string>{"a\tb"}));
+}
+
+TEST_CASE("quotes keep spaces and octothorpes in an argument and can make empty arguments") {
+    CHECK((split("sv_name \"My Server\" 2") == std::vector<std::string>{"sv_name", "My Server", "2"}));
+    CHECK((split("say \"#1 player\"") == std::vector<std::string>{"say", "#1 player"}));
+    CHECK((split("a\"b c\"d") == std::vector<std::string>{"ab cd"}));
+    CHECK((split("a \"\" b") == std::vector<std::string>{"a", "", "b"}));
+    CHECK((split("\"\"") == std::vector<std::string>{""}));
+    CHECK((split("a \"\"") == std::vector<std::string>{"a", ""}));
+
+    // A quote left open runs to the end of the command
+    CHECK((split("a \"b c") == std::vector<std::string>{"a", "b c"}));
+}
+
+TEST_CASE("backslashes escape the next character") {
+    CHECK((split("say \\\"hi\\\"") == std::vector<std::string>{"say", "\"hi\""}));
+    CHECK((split("path C:\\\\Halo\\\\maps") == std::vector<std::string>{"path", "C:\\Halo\\maps"}));
+    CHECK((split("a\\ b c") == std::vector<std::string>{"a b", "c"}));
+    CHECK((split("a\\#b") == std::vector<std::string>{"a#b"}));
+    CHECK((split("\"a\\\"b\"") == std::vector<std::string>{"a\"b"}));
+    CHECK((split("a\\") == std::vector<std::string>{"a"}));
+}
+
+TEST_CASE("an octothorpe starts a comment") {
+    CHECK((split("a b # comment \"c\"") == std::vector<std::string>{"a", "b"}));
+    CHECK((split("a#b c") == std::vector<std::string>{"a"}));
+    CHECK(split("# comment").empty());
+    CHECK((split("\"\"# comment") == std::vector<std::string>{""}));
+}
+
+TEST_CASE("arguments are appended and split_arguments reads the same ones") {
+    std::string command = "b \"c d\"";
+    std::vector<const char *> arguments = {"a"};
+    split_arguments_in_place(command, arguments);
+    CHECK(arguments.size() == 3);
+    CHECK(std::string_view(arguments[0]) == "a");
+    CHECK(std::string_view(arguments[2]) == "c d");
+
+    for(auto const *input : {"", "a b", "sv_name \"My Server\" # comment", "a \"\" \\\"b\\\" c\\ d"}) {
+        CHECK(split_arguments(input) == split(input));
+    }
+}
+
+TEST_CASE("unsplit arguments are split back to the same arguments") {
+    std::vector<std::vector<std::string>> cases = {
+        {"balltze_fov", "70"},
+        {"sv_name", "My Server"},
+        {"say", "#1", "\"quoted\"", "back\\slash"},
+        {"path", "C:\\Halo\\My Maps"},
+    };
+    for(auto &arguments : cases) {
+        CHECK(split(unsplit_arguments(arguments)) == arguments);
+    }
+}
+
+TEST_CASE("commands are registered by full name") {
+    auto plugin = plugin_handle(0x1000);
+    auto generation = get_commands_generation();
+    auto version = add_test_command(nullptr, "balltze", "version");
+    auto fov = add_test_command(plugin, "chimera", "fov");
+    auto fps = add_test_command(plugin, "chimera", "fps");
+    CHECK(get_commands_generation() != generation);
+
+    CHECK(find_command("balltze_version") == version);
+    CHECK(find_command(std::string("chimera_fov")) == fov);
+    CHECK(find_command("chimera_fps") == fps);
+    CHECK(find_command("fov") == nullptr);
+    CHECK(find_command("chimera_fo") == nullptr);
+    CHECK(find_command("") == nullptr);
+
+    // Registration order
+    auto &commands = get_commands();
+    CHECK(commands.size() == 3);
+    CHECK(commands[0] == version && commands[1] == fov && commands[2] == fps);
+
+    // Only the full name has to be unique
+    generation = get_commands_generation();
+    bool threw = false;
+    try {
+        add_test_command(plugin_handle(0x2000), "chimera", "fov");
+    }
+    catch(std::runtime_error &) {
+        threw = true;
+    }
+    CHECK(threw);
+    CHECK(get_commands_generation() == generation);
+    CHECK(get_commands().size() == 3);
+    auto other_fov = add_test_command(plugin_handle(0x2000), "other", "fov");
+    CHECK(find_command("other_fov") == other_fov);
+    CHECK(find_command("chimera_fov") == fov);
+
+    remove_commands_from_plugin(nullptr);
+    remove_commands_from_plugin(plugin);
+    remove_commands_from_plugin(plugin_handle(0x2000));
+    CHECK(get_commands().empty());
+    CHECK(get_commands_function_entries().empty());
+}
+
+TEST_CASE("script function entries are sorted by name and removed with their commands") {
+    auto plugin = plugin_handle(0x1000);
+    auto other_plugin = plugin_handle(0x2000);
+    add_test_command(plugin, "zeta", "b");
+    add_test_command(other_plugin, "alpha", "a");
+    auto kept = add_test_command(other_plugin, "alpha", "c");
+    add_test_command(plugin, "zeta", "a");
+
+    auto &entries = get_commands_function_entries();
+    std::vector<std::string> names;
+    for(auto &entry : entries) {
+        names.emplace_back(entry->name);
+    }
+    CHECK((names == std::vector<std::string>{"alpha_a", "alpha_c", "zeta_a", "zeta_b"}));
+    CHECK(entries[1]->name == kept->full_name());
+    CHECK(std::string_view(entries[1]->help_message) == "Help of c");
+    CHECK(std::string_view(entries[1]->help_parameters) == "<value>");
+    CHECK(entries[1]->return_type == Engine::HSC_DATA_TYPE_VOID);
+
+    // Removing the commands of a plugin which has none changes nothing
+    auto generation = get_commands_generation();
+    remove_commands_from_plugin(plugin_handle(0x3000));
+    CHECK(get_commands_generation() == generation);
+
+    remove_commands_from_plugin(plugin);
+    CHECK(get_commands_generation() != generation);
+    CHECK(entries.size() == 2);
+    CHECK(std::string_view(entries[0]->name) == "alpha_a");
+    CHECK(std::string_view(entries[1]->name) == "alpha_c");
+    CHECK(find_command("zeta_a") == nullptr);
+    CHECK(find_command("alpha_c") == kept);
+    CHECK(get_commands().size() == 2);
+
+    remove_commands_from_plugin(other_plugin);
+    CHECK(entries.empty());
+}
+
+TEST_CASE("the merged function list follows the list of the game and the commands") {
+    HscFunctionEntry game_functions[4] = {};
+    HscFunctionEntry *game_list[4] = {&game_functions[0], &game_functions[1], &game_functions[2], &game_functions[3]};
+    HscFunctionEntry *other_game_list[2] = {&game_functions[3], &game_functions[2]};
+    auto plugin = plugin_handle(0x1000);
+    add_test_command(plugin, "plugin", "b");
+
+    CommandsFunctionList list;
+    auto expect = [&](HscFunctionEntry **game_entries, std::size_t game_entry_count) {
+        std::vector<HscFunctionEntry *> expected(game_entries, game_entries + game_entry_count);
+        for(auto &entry : get_commands_function_entries()) {
+            expected.push_back(entry.get());
+        }
+        return list.get(game_entries, game_entry_count) == expected;
+    };
+    CHECK(expect(game_list, 3));
+    CHECK(expect(game_list, 3));
+
+    // A command was added or removed
+    add_test_command(plugin, "plugin", "a");
+    CHECK(list.get(game_list, 3).size() == 5);
+    CHECK(expect(game_list, 3));
+    remove_commands_from_plugin(plugin);
+    CHECK(expect(game_list, 3));
+    add_test_command(plugin, "plugin", "c");
+
+    // The game has another list, or more functions in the same one
+    CHECK(expect(other_game_list, 2));
+    CHECK(expect(game_list, 4));
+    CHECK(expect(game_list, 0));
+
+    // The list is kept while nothing changes, so the game can keep pointing to it
+    auto *data = list.get(game_list, 4).data();
+    CHECK(list.get(game_list, 4).data() == data);
+
+    remove_commands_from_plugin(plugin);
+}
+
+TEST_MAIN()
@@ -0,0 +1,100 @@
+// SPDX-License-Identifier: GPL-3.0-only
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <balltze/config.hpp>
+#include "config_stand_in.hpp"
+#include "host_test.hpp"
+
+using namespace Balltze::Config;
+
+// Plugins are built against the layout of the class; new state must stay out of it
+static_assert(sizeof(Config) == sizeof(std::filesystem::path) + sizeof(nlohmann::json));
+
+/**
+ * Lookups of config values by dotted key and with key handles, on a config shaped like the gamepad
+ * configs; usage:
+ *   config_key_benchmark [--quick] [--sections N]
+ */
+int main(int argc, const char **argv) {
+    bool quick = HostTest::quick_run(argc, argv);
+    std::size_t section_count = 16;
+    for(int i = 1; i + 1 < argc; i++) {
+        if(std::strcmp(argv[i], "--sections") == 0) {
+            section_count = std::strtoull(argv[i + 1], nullptr, 10);
+        }
+    }
+    std::size_t iterations = quick ? 10 : 100000;
+    constexpr std::size_t key_count = 32;
+
+    HostTest::TemporaryDirectory directory("config-key-benchmark");
+    auto path = directory.path / "gamepad.json";
+    {
+        nlohmann::json json;
+        for(std::size_t i = 0; i < key_count; i++) {
+            json["icons"]["button_" + std::to_string(i)] = static_cast<int>(i * 3);
+        }
+        for(std::size_t s = 0; s < section_count; s++) {
+            for(std::size_t i = 0; i < key_count; i++) {
+                json["section_" + std::to_string(s)]["value_" + std::to_string(i)] = static_cast<int>(s + i);
+            }
+        }
+        std::ofstream(path) << json.dump(4);
+    }
+
+    Config config(path, false);
+    std::vector<std::string> keys;
+    std::vector<ConfigKey<int>> handles;
+    for(std::size_t i = 0; i < key_count; i++) {
+        keys.push_back("icons.button_" + std::to_string(i));
+        handles.emplace_back(config, keys.back());
+    }
+
+    // Both have to read the same values, also after a change
+    int result = EXIT_SUCCESS;
+    auto check = [&]() {
+        for(std::size_t i = 0; i < key_count; i++) {
+            if(config.get<int>(keys[i]) != handles[i].get()) {
+                std::fprintf(stderr, "%s: the key handle does not read the value of the config\n", keys[i].c_str());
+                result = EXIT_FAILURE;
+            }
+        }
+    };
+    std::size_t icon_changes = 0;
+    auto callback = config.add_change_callback("icons", [&]() { icon_changes++; });
+    check();
+    config.set("icons.button_5", 1000);
+    config.remove("icons.button_6");
+    config.set("section_0.value_0", 1);
+    check();
+    config.remove_change_callback(callback);
+    config.set("icons.button_6", 18);
+    if(icon_changes != 2) {
+        std::fprintf(stderr, "the change callback was called %zu times instead of 2\n", icon_changes);
+        result = EXIT_FAILURE;
+    }
+
+    std::printf("%zu sections of %zu values, %zu keys per call\n", section_count + 1, key_count, key_count);
+    HostTest::benchmark("get<int> with a dotted key", iterations, key_count, [&]() {
+        for(auto &key : keys) {
+            HostTest::do_not_optimize(config.get<int>(key));
+        }
+    });
+    HostTest::benchmark("key handle", iterations, key_count, [&]() {
+        for(auto &handle : handles) {
+            HostTest::do_not_optimize(handle.get());
+        }
+    });
+    int value = 0;
+    HostTest::benchmark("key handle, config changed before each call", iterations, key_count, [&]() {
+        config.set("section_0.value_0", value++);
+        for(auto &handle : handles) {
+            HostTest::do_not_optimize(handle.get());
+        }
+    });
+    return result;
+}
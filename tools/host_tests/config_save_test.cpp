@@ -0,0 +1,180 @@
+// SPDX-License-Identifier: GPL-3.0-only
+
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <thread>
+#include <sys/stat.h>
+#include <config/config.hpp>
+#include "config_stand_in.hpp"
+#include "host_test.hpp"
+
+using namespace Balltze::Config;
+using namespace std::chrono_literals;
+using Clock = std::chrono::steady_clock;
+
+/**
+ * Count the writes of a config file. Files are written to a temporary file which is renamed over the
+ * old one, so each write gives the file a new inode.
+ */
+class WriteCounter {
+private:
+    std::filesystem::path path;
+    std::atomic<bool> stop = false;
+    std::atomic<std::size_t> writes = 0;
+    std::thread thread;
+
+    static ino_t inode(std::filesystem::path const &path) {
+        struct stat status;
+        return stat(path.c_str(), &status) == 0 ? status.st_ino : 0;
+    }
+
+public:
+    std::atomic<Clock::time_point> last_write = Clock::time_point();
+
+    WriteCounter(std::filesystem::path const &path) : path(path) {
+        thread = std::thread([this]() {
+            auto last_inode = inode(this->path);
+            while(!stop) {
+                auto current_inode = inode(this->path);
+                if(current_inode != last_inode) {
+                    last_inode = current_inode;
+                    last_write = Clock::now();
+                    writes++;
+                }
+                std::this_thread::sleep_for(200us);
+            }
+        });
+    }
+
+    ~WriteCounter() {
+        stop = true;
+        thread.join();
+    }
+
+    std::size_t count() const {
+        return writes;
+    }
+
+    /**
+     * Wait until the writes made so far are counted; the file is only polled every now and then
+     */
+    void catch_up() const {
+        std::this_thread::sleep_for(20ms);
+    }
+};
+
+static std::string read_file(std::filesystem::path const &path) {
+    std::ifstream file(path);
+    return std::string(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+}
+
+static nlohmann::json read_json(std::filesystem::path const &path) {
+    return nlohmann::json::parse(read_file(path));
+}
+
+TEST_CASE("a burst of saves is written once, after the changes stop") {
+    HostTest::TemporaryDirectory directory("config-save-burst");
+    auto path = directory.path / "settings.json";
+    Config config(path);
+    WriteCounter counter(path);
+
+    auto start = Clock::now();
+    for(int i = 1; i <= 1000; i++) {
+        config.set("counter", i);
+        config.set("section.value", std::to_string(i));
+        config.save();
+    }
+    auto burst_end = Clock::now();
+
+    // Nothing is written while the saves come in, nor right after them
+    CHECK(counter.count() == 0);
+    CHECK(read_json(path).empty());
+
+    std::this_thread::sleep_for(1s);
+    CHECK(counter.count() == 1);
+    auto json = read_json(path);
+    CHECK(json["counter"] == 1000);
+    CHECK(json["section"]["value"] == "1000");
+    auto last_write = counter.last_write.load();
+    CHECK(last_write - burst_end >= 450ms);
+    CHECK(last_write - start < 1s);
+    CHECK(!std::filesystem::exists(path.string() + ".tmp"));
+}
+
+TEST_CASE("unwritten saves are seen when the file is loaded again") {
+    HostTest::TemporaryDirectory directory("config-save-load");
+    auto path = directory.path / "settings.json";
+    Config config(path);
+    config.set("name", std::string("pending"));
+    config.save();
+
+    // Like the temporary configs the command autosave builds for plugin settings
+    Config other(path);
+    CHECK(other.get("name") == "pending");
+    CHECK(read_json(path).empty());
+
+    other.set("other", 1);
+    other.save();
+    config.load();
+    CHECK(config.get<int>("other") == 1);
+    config.flush();
+}
+
+TEST_CASE("flushing writes a pending save right away") {
+    HostTest::TemporaryDirectory directory("config-save-flush");
+    auto path = directory.path / "settings.json";
+    auto other_path = directory.path / "other.json";
+    Config config(path);
+    Config other(other_path);
+    WriteCounter counter(path);
+
+    config.set("value", 1);
+    config.save();
+    config.flush();
+    CHECK(read_json(path)["value"] == 1);
+    counter.catch_up();
+    CHECK(counter.count() == 1);
+
+    // Nothing is left to write
+    std::this_thread::sleep_for(700ms);
+    CHECK(counter.count() == 1);
+    config.flush();
+    counter.catch_up();
+    CHECK(counter.count() == 1);
+
+    // Every pending file is written at exit
+    config.set("value", 2);
+    config.save();
+    other.set("value", 3);
+    other.save();
+    flush_config_files();
+    CHECK(read_json(path)["value"] == 2);
+    CHECK(read_json(other_path)["value"] == 3);
+}
+
+TEST_CASE("a steady stream of saves is still written within the longest delay") {
+    HostTest::TemporaryDirectory directory("config-save-stream");
+    auto path = directory.path / "settings.json";
+    Config config(path);
+    WriteCounter counter(path);
+
+    // A save every 100 ms keeps pushing the short delay back
+    auto start = Clock::now();
+    int i = 0;
+    while(Clock::now() - start < 3s) {
+        config.set("counter", ++i);
+        config.save();
+        std::this_thread::sleep_for(100ms);
+    }
+    CHECK(counter.count() == 1);
+    auto first_write = counter.last_write.load() - start;
+    CHECK(first_write >= 1900ms && first_write < 2500ms);
+    CHECK(read_json(path)["counter"] > 0);
+    config.flush();
+    CHECK(read_json(path)["counter"] == i);
+}
+
+TEST_MAIN()
@@ -0,0 +1,38 @@
+// SPDX-License-Identifier: GPL-3.0-only
+
+#include <balltze/engine/core.hpp>
+#include <balltze/logger.hpp>
+#include <balltze/utils.hpp>
+#include "config_stand_in.hpp"
+
+namespace Balltze {
+    Logger logger;
+
+    void show_message_box_raw(unsigned int, const char *message) noexcept {
+        HostTest::last_message_box() = message;
+    }
+}
+
+namespace Balltze::Engine {
+    std::filesystem::path get_path() {
+        return std::filesystem::temp_directory_path() / "balltze-host-tests";
+    }
+}
+
+namespace HostTest {
+    TemporaryDirectory::TemporaryDirectory(std::string const &name) {
+        path = std::filesystem::temp_directory_path() / ("balltze-host-tests-" + name);
+        std::filesystem::remove_all(path);
+        std::filesystem::create_directories(path);
+    }
+
+    TemporaryDirectory::~TemporaryDirectory() {
+        std::error_code error;
+        std::filesystem::remove_all(path, error);
+    }
+
+    std::string &last_message_box() {
+        static std::string message;
+        return message;
+    }
+}
@@ -0,0 +1,27 @@
+// SPDX-License-Identifier: GPL-3.0-only
+
+#ifndef BALLTZE_HOST_TESTS__CONFIG_STAND_IN_HPP
+#define BALLTZE_HOST_TESTS__CONFIG_STAND_IN_HPP
+
+#include <filesystem>
+#include <string>
+
+namespace HostTest {
+    /**
+     * Empty directory for the config files of a test, removed when the object is destroyed
+     */
+    class TemporaryDirectory {
+    public:
+        std::filesystem::path path;
+
+        TemporaryDirectory(std::string const &name);
+        ~TemporaryDirectory();
+    };
+
+    /**
+     * Message of the last error box Balltze showed, if any
+     */
+    std::string &last_message_box();
+}
+
+#endif
@@ -0,0 +1,50 @@
+// SPDX-License-Identifier: GPL-3.0-only
+
+#include <cstring>
+#include <balltze/engine/tag.hpp>
+#include <balltze/engine/map.hpp>
+#include <balltze/logger.hpp>
+#include "engine_stand_in.hpp"
+
+namespace Balltze {
+    Logger logger;
+}
+
+namespace Balltze::Engine {
+    alignas(16) static std::byte loaded_tag_data[sizeof(TagDataHeader)];
+    static MapHeader loaded_map_header;
+
+    std::byte *get_tag_data_address() noexcept {
+        return loaded_tag_data;
+    }
+
+    MapHeader &get_map_header() noexcept {
+        return loaded_map_header;
+    }
+
+    std::string tag_class_to_string(TagClassInt tag_class) {
+        // Class integers are four characters, the first one in the high byte
+        std::string name;
+        for(int shift = 24; shift >= 0; shift -= 8) {
+            name += static_cast<char>((tag_class >> shift) & 0xFF);
+        }
+        return name;
+    }
+
+    Tag *get_tag(TagHandle tag_handle) noexcept {
+        auto &tag_data_header = get_tag_data_header();
+        for(std::size_t i = 0; i < tag_data_header.tag_count; i++) {
+            if(tag_data_header.tag_array[i].handle == tag_handle) {
+                return &tag_data_header.tag_array[i];
+            }
+        }
+        return nullptr;
+    }
+}
+
+namespace HostTest {
+    void reset_engine_stand_in() noexcept {
+        std::memset(Balltze::Engine::loaded_tag_data, 0, sizeof(Balltze::Engine::loaded_tag_data));
+        std::memset(&Balltze::Engine::loaded_map_header, 0, sizeof(Balltze::Engine::loaded_map_header));
+    }
+}
@@ -0,0 +1,17 @@
+// SPDX-License-Identifier: GPL-3.0-only
+
+#ifndef BALLTZE_HOST_TESTS__ENGINE_STAND_IN_HPP
+#define BALLTZE_HOST_TESTS__ENGINE_STAND_IN_HPP
+
+/**
+ * In-memory stand-in for the parts of the engine the tag import code uses: the tag data header
+ * of the loaded map at get_tag_data_address(), the loaded map header and tag lookups.
+ */
+namespace HostTest {
+    /**
+     * Clear the tag data header and the map header, as if no map was loaded
+     */
+    void reset_engine_stand_in() noexcept;
+}
+
+#endif
@@ -0,0 +1,108 @@
+// SPDX-License-Identifier: GPL-3.0-only
+
+#ifndef BALLTZE_HOST_TESTS__HOST_TEST_HPP
+#define BALLTZE_HOST_TESTS__HOST_TEST_HPP
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace HostTest {
+    struct TestCase {
+        const char *name;
+        std::function<void()> function;
+    };
+
+    inline std::vector<TestCase> &test_cases() {
+        static std::vector<TestCase> cases;
+        return cases;
+    }
+
+    inline int &failed_checks() {
+        static int count = 0;
+        return count;
+    }
+
+    struct TestRegistration {
+        TestRegistration(const char *name, std::function<void()> function) {
+            test_cases().push_back({name, std::move(function)});
+        }
+    };
+
+    inline void check_failed(const char *file, int line, const char *expression) {
+        std::fprintf(stderr, "%s:%d: check failed: %s\n", file, line, expression);
+        failed_checks()++;
+    }
+
+    /**
+     * Run every registered test; returns the exit code of the test program
+     */
+    inline int run_tests() {
+        for(auto &test : test_cases()) {
+            auto failed_before = failed_checks();
+            test.function();
+            std::printf("%s %s\n", failed_checks() == failed_before ? "PASS" : "FAIL", test.name);
+        }
+        return failed_checks() == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+
+    /**
+     * Check if a benchmark was asked to do a short run, e.g. when it is run by ctest
+     */
+    inline bool quick_run(int argc, const char **argv) {
+        return argc > 1 && std::strcmp(argv[1], "--quick") == 0;
+    }
+
+    /**
+     * Time a function over a number of iterations and print the time per iteration
+     * @param name          Name of the measurement
+     * @param iterations    Number of times the function is called
+     * @param items         Number of items each call processes, to print the throughput
+     * @return              Nanoseconds per call
+     */
+    inline double benchmark(const char *name, std::size_t iterations, std::size_t items, std::function<void()> const &function) {
+        function();
+        auto start = std::chrono::steady_clock::now();
+        for(std::size_t i = 0; i < iterations; i++) {
+            function();
+        }
+        auto elapsed = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+        auto per_call = elapsed / iterations;
+        std::printf("%-48s %12.1f ns/call %14.1f items/s\n", name, per_call, items * 1e9 / per_call);
+        return per_call;
+    }
+
+    /**
+     * Keep the compiler from optimizing a value away
+     */
+    template<typename T>
+    inline void do_not_optimize(T const &value) {
+        asm volatile("" : : "r,m"(value) : "memory");
+    }
+}
+
+#define HOST_TEST_CONCAT_IMPL(a, b) a##b
+#define HOST_TEST_CONCAT(a, b) HOST_TEST_CONCAT_IMPL(a, b)
+
+#define TEST_CASE(name) \
+    static void HOST_TEST_CONCAT(test_case_, __LINE__)(); \
+    static HostTest::TestRegistration HOST_TEST_CONCAT(test_registration_, __LINE__)(name, HOST_TEST_CONCAT(test_case_, __LINE__)); \
+    static void HOST_TEST_CONCAT(test_case_, __LINE__)()
+
+#define CHECK(expression) \
+    do { \
+        if(!(expression)) { \
+            HostTest::check_failed(__FILE__, __LINE__, #expression); \
+        } \
+    } while(false)
+
+#define TEST_MAIN() \
+    int main() { \
+        return HostTest::run_tests(); \
+    }
+
+#endif
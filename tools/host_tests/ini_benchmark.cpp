@@ -0,0 +1,97 @@
+// SPDX-License-Identifier: GPL-3.0-only
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <balltze/config.hpp>
+#include "config_stand_in.hpp"
+#include "host_test.hpp"
+
+using namespace Balltze::Config;
+
+/**
+ * Build a chimera.ini with the given number of groups, each with comments and a mix of values
+ */
+static std::string build_ini(std::size_t group_count, std::size_t keys_per_group) {
+    std::string data = "\xEF\xBB\xBF; chimera.ini \xE2\x80\x94 generated for the benchmark\r\n";
+    for(std::size_t g = 0; g < group_count; g++) {
+        data += "\r\n; Settings of group " + std::to_string(g) + " \xFF\r\n";
+        data += "[group_" + std::to_string(g) + "]\r\n";
+        for(std::size_t k = 0; k < keys_per_group; k++) {
+            auto key = "key_" + std::to_string(k);
+            switch(k % 3) {
+                case 0:
+                    data += key + "=" + std::to_string(g * keys_per_group + k) + "\r\n";
+                    break;
+                case 1:
+                    data += key + "=maps\\custom\\map_" + std::to_string(g) + ".map\r\n";
+                    break;
+                default:
+                    data += key + "=Caf\xC3\xA9 " + std::to_string(k) + "\r\n";
+                    break;
+            }
+        }
+    }
+    return data;
+}
+
+/**
+ * Parsing of a large chimera.ini and lookups of its values; usage:
+ *   ini_benchmark [--quick] [--groups N]
+ */
+int main(int argc, const char **argv) {
+    bool quick = HostTest::quick_run(argc, argv);
+    std::size_t group_count = 2000;
+    constexpr std::size_t keys_per_group = 12;
+    for(int i = 1; i + 1 < argc; i++) {
+        if(std::strcmp(argv[i], "--groups") == 0) {
+            group_count = std::strtoull(argv[i + 1], nullptr, 10);
+        }
+    }
+    std::size_t parse_iterations = quick ? 1 : 20;
+    std::size_t lookup_iterations = quick ? 10 : 10000;
+
+    auto data = build_ini(group_count, keys_per_group);
+    std::printf("%zu groups of %zu values, %zu bytes\n", group_count, keys_per_group, data.size());
+
+    HostTest::benchmark("parse", parse_iterations, group_count * keys_per_group, [&]() {
+        std::istringstream stream(data);
+        Ini ini(stream);
+        HostTest::do_not_optimize(ini);
+    });
+
+    std::istringstream stream(data);
+    Ini ini(stream);
+    std::vector<std::string> keys;
+    for(std::size_t i = 0; i < 64; i++) {
+        auto group = (i * 7919) % group_count;
+        keys.push_back("group_" + std::to_string(group) + ".key_" + std::to_string(i % keys_per_group));
+    }
+    keys.push_back("group_0.missing");
+    HostTest::benchmark("get_value", lookup_iterations, keys.size(), [&]() {
+        for(auto &key : keys) {
+            HostTest::do_not_optimize(ini.get_value(key.c_str()));
+        }
+    });
+
+    // Every value has to be read back as it was written
+    int result = EXIT_SUCCESS;
+    for(std::size_t g = 0; g < group_count && result == EXIT_SUCCESS; g++) {
+        auto prefix = "group_" + std::to_string(g) + ".key_";
+        auto number = ini.get_value_size((prefix + "0").c_str());
+        auto path = ini.get_value_string((prefix + "1").c_str());
+        auto text = ini.get_value_string((prefix + "2").c_str());
+        if(number != g * keys_per_group || path != "maps\\custom\\map_" + std::to_string(g) + ".map" || text != "Caf\xE9 2") {
+            std::fprintf(stderr, "group_%zu was not read back as it was written\n", g);
+            result = EXIT_FAILURE;
+        }
+    }
+    if(ini.get_value("group_0.missing")) {
+        std::fprintf(stderr, "a missing key was found\n");
+        result = EXIT_FAILURE;
+    }
+    return result;
+}
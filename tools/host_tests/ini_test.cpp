@@ -0,0 +1,124 @@
+// SPDX-License-Identifier: GPL-3.0-only
+
+#include <cstdio>
+#include <functional>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <balltze/config.hpp>
+#include "config_stand_in.hpp"
+#include "host_test.hpp"
+
+using namespace Balltze::Config;
+
+// Plugins are built against the layout of the class
+static_assert(sizeof(Ini) == sizeof(std::vector<std::pair<std::string, std::string>>));
+
+static Ini parse(std::string const &data) {
+    std::istringstream stream(data);
+    return Ini(stream);
+}
+
+/**
+ * Run a function in a child process, since INI errors exit the process
+ * @return exit code of the child
+ */
+static int exit_code_of(std::function<void()> const &function) {
+    // The child exits through std::exit, which would print what is buffered a second time
+    std::fflush(stdout);
+    auto child = fork();
+    if(child == 0) {
+        function();
+        _exit(0);
+    }
+    int status = 0;
+    waitpid(child, &status, 0);
+    return WIFEXITED(status) ? WEXITSTATUS(status) : -1;
+}
+
+TEST_CASE("values are read by group and key") {
+    auto ini = parse(
+        "; chimera.ini\r\n"
+        "top=level\r\n"
+        "\r\n"
+        "[halo]\r\n"
+        "path=C:\\Halo\r\n"
+        "  \t\r\n"
+        "[memory]\n"
+        "enable_map_memory_buffer=1\n"
+        "map_size=1024\n"
+        "benchmark=0.5\n"
+        "empty=\n"
+    );
+    CHECK(ini.get_value_string("top") == "level");
+    CHECK(ini.get_value_string("halo.path") == "C:\\Halo");
+    CHECK(ini.get_value_bool("memory.enable_map_memory_buffer") == true);
+    CHECK(ini.get_value_long("memory.map_size") == 1024);
+    CHECK(ini.get_value_size("memory.map_size") == 1024ull);
+    CHECK(ini.get_value_float("memory.benchmark") == 0.5);
+    CHECK(ini.get_value_string("memory.empty") == "");
+    CHECK(!ini.get_value("memory.missing"));
+    CHECK(!ini.get_value("map_size"));
+    CHECK(!ini.get_value_bool("halo.missing").has_value());
+}
+
+TEST_CASE("the last value of a key wins") {
+    auto ini = parse("[a]\nx=1\ny=2\n[b]\nx=3\n[a]\nx=4\n");
+    CHECK(ini.get_value_long("a.x") == 4);
+    CHECK(ini.get_value_long("a.y") == 2);
+    CHECK(ini.get_value_long("b.x") == 3);
+}
+
+TEST_CASE("values can be set and deleted") {
+    auto ini = parse("[b]\nkey=1\n");
+    ini.set_value("c.key", "3");
+    ini.set_value("a.key", "0");
+    ini.set_value({"b.key", "2"});
+    CHECK(ini.get_value_long("a.key") == 0);
+    CHECK(ini.get_value_long("b.key") == 2);
+    CHECK(ini.get_value_long("c.key") == 3);
+
+    ini.delete_value("b.key");
+    ini.delete_value("b.missing");
+    CHECK(!ini.get_value("b.key"));
+    CHECK(ini.get_value_long("a.key") == 0);
+    CHECK(ini.get_value_long("c.key") == 3);
+
+    // Copies are independent
+    Ini copy = ini;
+    copy.set_value("a.key", "5");
+    CHECK(ini.get_value_long("a.key") == 0);
+    CHECK(copy.get_value_long("a.key") == 5);
+
+    Ini empty;
+    CHECK(!empty.get_value("a.key"));
+    empty.set_value("a.key", "1");
+    CHECK(empty.get_value_long("a.key") == 1);
+}
+
+TEST_CASE("values are decoded from UTF-8; comments and keys are not") {
+    auto ini = parse(
+        "\xEF\xBB\xBF"
+        "; caf\xFF invalid UTF-8 in a comment\n"
+        "[font]\n"
+        "name=Caf\xC3\xA9\n"
+        "; \xC3\n"
+    );
+    CHECK(ini.get_value_string("font.name") == "Caf\xE9");
+    CHECK(HostTest::last_message_box().empty());
+}
+
+TEST_CASE("bad values and lines exit the process") {
+    // Invalid UTF-8, then a character the ANSI code page can not encode
+    CHECK(exit_code_of([]() { parse("[font]\nname=Caf\xFF\n"); }) == 136);
+    CHECK(exit_code_of([]() { parse("[font]\nname=\xE2\x82\xAC\n"); }) == 136);
+    CHECK(exit_code_of([]() { parse("[font\nname=x\n"); }) == 136);
+    CHECK(exit_code_of([]() { parse("[font]\nname\n"); }) == 136);
+    CHECK(exit_code_of([]() { parse("[memory]\nmap_size=big\n").get_value_long("memory.map_size"); }) == 136);
+    CHECK(exit_code_of([]() { parse("[memory]\nmap_size=1\n").get_value_long("memory.map_size"); }) == 0);
+}
+
+TEST_MAIN()
@@ -0,0 +1,268 @@
+// SPDX-License-Identifier: GPL-3.0-only
+
+#include <atomic>
+#include <csignal>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <balltze/features/job_system.hpp>
+#include <balltze/logger.hpp>
+#include "host_test.hpp"
+
+namespace Balltze {
+    Logger logger;
+}
+
+namespace Balltze::Features {
+    void dispatch_completed_jobs() noexcept;
+    void stop_job_workers() noexcept;
+}
+
+using namespace Balltze::Features;
+using namespace std::chrono_literals;
+
+/**
+ * Wait until a condition holds, giving up after a while so a broken job system fails instead of hanging
+ */
+template<typename Condition>
+static bool wait_until(Condition condition) {
+    auto deadline = std::chrono::steady_clock::now() + 10s;
+    while(!condition()) {
+        if(std::chrono::steady_clock::now() > deadline) {
+            return false;
+        }
+        std::this_thread::sleep_for(1ms);
+    }
+    return true;
+}
+
+/**
+ * Jobs that keep their worker busy until they are released
+ */
+class BlockingJobs {
+private:
+    std::mutex mutex;
+    std::condition_variable condition;
+    std::size_t started = 0;
+    std::size_t released = 0;
+
+public:
+    std::vector<JobHandle> handles;
+
+    /**
+     * Submit one job per worker and wait until every worker runs one; the job released first calls
+     * a function before returning, on its worker
+     */
+    void occupy_workers(std::function<void()> on_first_release = nullptr) {
+        auto worker_count = get_job_worker_count();
+        for(std::size_t i = 0; i < worker_count; i++) {
+            handles.push_back(submit_job([this, i, on_first_release]() {
+                std::unique_lock lock(mutex);
+                started++;
+                condition.notify_all();
+                condition.wait(lock, [this, i] { return released > i; });
+                lock.unlock();
+                if(i == 0 && on_first_release) {
+                    on_first_release();
+                }
+            }));
+        }
+        std::unique_lock lock(mutex);
+        CHECK(condition.wait_for(lock, 10s, [this, worker_count] { return started == worker_count; }));
+    }
+
+    /**
+     * Let the jobs return, the first ones first
+     */
+    void release(std::size_t count = SIZE_MAX) {
+        std::lock_guard lock(mutex);
+        released = std::min(count, handles.size());
+        condition.notify_all();
+    }
+
+    bool all_completed() {
+        for(auto handle : handles) {
+            if(get_job_status(handle) != JOB_STATUS_COMPLETED) {
+                return false;
+            }
+        }
+        return true;
+    }
+};
+
+/**
+ * Run a function in a child process which then exits through std::exit, destroying the statics
+ */
+static int exit_code_of(std::function<void()> const &function) {
+    std::fflush(stdout);
+    auto child = fork();
+    if(child == 0) {
+        // A child stuck destroying the job system is killed
+        alarm(10);
+        function();
+        std::exit(HostTest::failed_checks() == 0 ? 0 : 1);
+    }
+    int status = 0;
+    waitpid(child, &status, 0);
+    return WIFEXITED(status) ? WEXITSTATUS(status) : -1;
+}
+
+// This runs first, so the child starts its own workers; threads of the parent do not exist in a child
+TEST_CASE("workers which were not stopped do not keep the game from exiting") {
+    CHECK(exit_code_of([]() {
+        auto handle = submit_job([]() {});
+        CHECK(wait_until([&]() { return get_job_status(handle) == JOB_STATUS_COMPLETED; }));
+        dispatch_completed_jobs();
+    }) == 0);
+}
+
+TEST_CASE("completion functions are called on the game thread in the order the jobs finished") {
+    std::mutex mutex;
+    std::vector<int> finished;
+    std::vector<int> completed;
+    std::vector<JobHandle> handles;
+    auto game_thread = std::this_thread::get_id();
+    bool on_game_thread = true;
+    for(int i = 0; i < 64; i++) {
+        handles.push_back(submit_job([&, i]() {
+            std::this_thread::sleep_for(std::chrono::microseconds((i * 7919) % 500));
+            std::lock_guard lock(mutex);
+            finished.push_back(i);
+        }, [&, i]() {
+            on_game_thread = on_game_thread && std::this_thread::get_id() == game_thread;
+            completed.push_back(i);
+        }));
+    }
+    CHECK(wait_until([&]() {
+        std::lock_guard lock(mutex);
+        return finished.size() == handles.size();
+    }));
+    CHECK(completed.empty());
+
+    // A job counts as finished once its work returned, which is after it recorded itself
+    CHECK(wait_until([&]() {
+        for(auto handle : handles) {
+            if(get_job_status(handle) != JOB_STATUS_COMPLETED) {
+                return false;
+            }
+        }
+        return true;
+    }));
+    dispatch_completed_jobs();
+    CHECK(completed == finished);
+    CHECK(on_game_thread);
+    for(auto handle : handles) {
+        CHECK(!get_job_status(handle).has_value());
+    }
+}
+
+TEST_CASE("jobs submitted from a job run on its worker, newest first") {
+    std::mutex mutex;
+    std::vector<int> order;
+    BlockingJobs blocking_jobs;
+
+    // The other workers are busy, so nothing steals the jobs from the worker that submitted them
+    blocking_jobs.occupy_workers([&]() {
+        for(int i = 0; i < 4; i++) {
+            submit_job([&, i]() {
+                std::lock_guard lock(mutex);
+                order.push_back(i);
+            });
+        }
+    });
+    blocking_jobs.release(1);
+    CHECK(wait_until([&]() {
+        std::lock_guard lock(mutex);
+        return order.size() == 4;
+    }));
+    CHECK((order == std::vector<int>{3, 2, 1, 0}));
+
+    blocking_jobs.release();
+    CHECK(wait_until([&]() { return blocking_jobs.all_completed(); }));
+    dispatch_completed_jobs();
+}
+
+TEST_CASE("cancelled jobs never run nor complete") {
+    BlockingJobs blocking_jobs;
+    blocking_jobs.occupy_workers();
+
+    bool ran = false;
+    bool completed = false;
+    auto handle = submit_job([&]() { ran = true; }, [&]() { completed = true; });
+    CHECK(get_job_status(handle) == JOB_STATUS_PENDING);
+    CHECK(cancel_job(handle));
+    CHECK(!get_job_status(handle).has_value());
+    CHECK(!cancel_job(handle));
+
+    // Running jobs can not be cancelled
+    CHECK(get_job_status(blocking_jobs.handles[0]) == JOB_STATUS_RUNNING);
+    CHECK(!cancel_job(blocking_jobs.handles[0]));
+
+    // The cancelled job is dropped when its worker gets to it
+    bool after_ran = false;
+    auto after = submit_job([&]() { after_ran = true; });
+    blocking_jobs.release();
+    CHECK(wait_until([&]() { return blocking_jobs.all_completed() && get_job_status(after) == JOB_STATUS_COMPLETED; }));
+    dispatch_completed_jobs();
+    CHECK(after_ran);
+    CHECK(!ran);
+    CHECK(!completed);
+    CHECK(!cancel_job(0));
+}
+
+TEST_CASE("stopping the workers waits for running jobs and drops the others") {
+    // Stopping before the workers started, or while they are idle, does nothing else
+    stop_job_workers();
+    auto worker_count = get_job_worker_count();
+    CHECK(worker_count > 0);
+    stop_job_workers();
+
+    std::atomic<bool> child_ran = false;
+    bool child_completed = false;
+    BlockingJobs blocking_jobs;
+    blocking_jobs.occupy_workers([&]() {
+        submit_job([&]() { child_ran = true; }, [&]() { child_completed = true; });
+    });
+
+    std::atomic<bool> pending_ran = false;
+    std::vector<JobHandle> pending;
+    for(int i = 0; i < 16; i++) {
+        pending.push_back(submit_job([&]() { pending_ran = true; }));
+    }
+
+    std::thread stopping(stop_job_workers);
+    CHECK(wait_until([&]() {
+        for(auto handle : pending) {
+            if(get_job_status(handle).has_value()) {
+                return false;
+            }
+        }
+        return true;
+    }));
+
+    // The first job submits one more while the workers stop; it never starts either
+    blocking_jobs.release();
+    stopping.join();
+    CHECK(blocking_jobs.all_completed());
+    CHECK(!pending_ran);
+    CHECK(!child_ran);
+    dispatch_completed_jobs();
+    CHECK(!child_completed);
+
+    // Workers start again with the next job
+    bool ran = false;
+    bool completed = false;
+    auto handle = submit_job([&]() { ran = true; }, [&]() { completed = true; });
+    CHECK(get_job_worker_count() == worker_count);
+    CHECK(wait_until([&]() { return get_job_status(handle) == JOB_STATUS_COMPLETED; }));
+    dispatch_completed_jobs();
+    CHECK(ran);
+    CHECK(completed);
+    stop_job_workers();
+}
+
+TEST_MAIN()
@@ -0,0 +1,137 @@
+// SPDX-License-Identifier: GPL-3.0-only
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <vector>
+#include <fmt/chrono.h>
+#include <fmt/format.h>
+#include <output/log_file_queue.hpp>
+#include "host_test.hpp"
+
+using namespace Balltze;
+using Clock = std::chrono::steady_clock;
+
+/**
+ * Print the distribution of the time taken by each call
+ */
+static void print_latencies(const char *name, std::vector<double> &latencies) {
+    std::sort(latencies.begin(), latencies.end());
+    double total = 0.0;
+    for(auto latency : latencies) {
+        total += latency;
+    }
+    auto percentile = [&](double p) {
+        return latencies[std::min(latencies.size() - 1, static_cast<std::size_t>(p * latencies.size()))];
+    };
+    std::printf("%-40s mean %9.1f ns  p50 %9.1f ns  p99 %10.1f ns  max %12.1f ns\n", name, total / latencies.size(), percentile(0.5), percentile(0.99), latencies.back());
+}
+
+template<typename Function>
+static double time_call(Function function) {
+    auto start = Clock::now();
+    function();
+    return std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+}
+
+static std::string record_text(std::size_t thread, std::size_t index) {
+    return fmt::format("[INFO] benchmark: thread {} record {} with some text to make it look like a log line\n", thread, index);
+}
+
+static std::size_t count_lines(std::filesystem::path const &path) {
+    std::ifstream file(path);
+    std::string line;
+    std::size_t count = 0;
+    while(std::getline(file, line)) {
+        count++;
+    }
+    return count;
+}
+
+/**
+ * Time taken by each log call to write a line to a log file: writing and flushing on the caller, like
+ * the logger did before, against pushing the record to the log queue; usage:
+ *   log_file_queue_benchmark [--quick] [--records N] [--threads N]
+ */
+int main(int argc, const char **argv) {
+    bool quick = HostTest::quick_run(argc, argv);
+    std::size_t record_count = quick ? 1000 : 100000;
+    std::size_t thread_count = 4;
+    for(int i = 1; i + 1 < argc; i++) {
+        if(std::strcmp(argv[i], "--records") == 0) {
+            record_count = std::strtoull(argv[i + 1], nullptr, 10);
+        }
+        else if(std::strcmp(argv[i], "--threads") == 0) {
+            thread_count = std::strtoull(argv[i + 1], nullptr, 10);
+        }
+    }
+
+    auto directory = std::filesystem::temp_directory_path();
+    auto synchronous_path = directory / "balltze_log_benchmark_synchronous.txt";
+    auto queued_path = directory / "balltze_log_benchmark_queued.txt";
+    std::printf("%zu records, %zu threads\n", record_count, thread_count);
+
+    std::vector<double> latencies(record_count);
+    {
+        std::ofstream file(synchronous_path, std::ios::out | std::ios::trunc);
+        for(std::size_t i = 0; i < record_count; i++) {
+            auto text = record_text(0, i);
+            latencies[i] = time_call([&]() {
+                file << fmt::format("{:%Y-%m-%d %H:%M:%S}", fmt::localtime(std::time(nullptr))) << ' ' << text;
+                file.flush();
+            });
+        }
+    }
+    print_latencies("write and flush on the caller", latencies);
+
+    auto file = std::make_shared<std::ofstream>(queued_path, std::ios::out | std::ios::trunc);
+    for(std::size_t i = 0; i < record_count; i++) {
+        auto text = record_text(0, i);
+        latencies[i] = time_call([&]() {
+            enqueue_log_record({file, std::time(nullptr), std::move(text), false});
+        });
+    }
+    print_latencies("queued", latencies);
+
+    std::vector<std::vector<double>> thread_latencies(thread_count, std::vector<double>(record_count));
+    std::vector<std::thread> threads;
+    for(std::size_t t = 0; t < thread_count; t++) {
+        threads.emplace_back([&, t]() {
+            for(std::size_t i = 0; i < record_count; i++) {
+                auto text = record_text(t + 1, i);
+                thread_latencies[t][i] = time_call([&]() {
+                    enqueue_log_record({file, std::time(nullptr), std::move(text), false});
+                });
+            }
+        });
+    }
+    for(auto &thread : threads) {
+        thread.join();
+    }
+    std::vector<double> all_latencies;
+    for(auto &latencies : thread_latencies) {
+        all_latencies.insert(all_latencies.end(), latencies.begin(), latencies.end());
+    }
+    char name[64];
+    std::snprintf(name, sizeof(name), "queued, %zu threads", thread_count);
+    print_latencies(name, all_latencies);
+
+    // Every record has to be in the file once the queue is flushed
+    flush_log_files();
+    auto expected = record_count * (thread_count + 1);
+    auto written = count_lines(queued_path);
+    int result = EXIT_SUCCESS;
+    if(written != expected) {
+        std::fprintf(stderr, "%zu records were queued, %zu were written\n", expected, written);
+        result = EXIT_FAILURE;
+    }
+    std::filesystem::remove(synchronous_path);
+    std::filesystem::remove(queued_path);
+    return result;
+}
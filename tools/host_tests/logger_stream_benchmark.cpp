@@ -0,0 +1,110 @@
+// SPDX-License-Identifier: GPL-3.0-only
+
+#include <cstdio>
+#include <cstdlib>
+#include <ostream>
+#include <string>
+#include <balltze/logger.hpp>
+#include "host_test.hpp"
+
+using namespace Balltze;
+
+// The streams are built in headers plugins compile; the sinks are in Balltze. These stand-ins keep the
+// last message instead of printing it, so only the work done by the streams is timed.
+static std::string last_message;
+static std::size_t written_messages = 0;
+
+namespace Balltze {
+    Logger::LoggerStream::LoggerStream(Logger *logger, LogLevel level, std::string prefix, std::string console_format, std::string file_format, std::string ingame_format, fmt::text_style console_style) noexcept
+        : m_level(level), m_prefix(prefix), m_console_format(console_format), m_file_format(file_format), m_ingame_format(ingame_format), m_console_style(console_style), m_logger(logger) {
+    }
+
+    Logger::Logger(std::string name) noexcept : m_name(name) {
+        debug = LoggerStream(this, LOG_LEVEL_DEBUG, "DEBUG", "", "", "", {});
+        info = LoggerStream(this, LOG_LEVEL_INFO, "INFO", "", "", "", {});
+        warning = LoggerStream(this, LOG_LEVEL_WARNING, "WARN", "", "", "", {});
+        error = LoggerStream(this, LOG_LEVEL_ERROR, "ERROR", "", "", "", {});
+        fatal = LoggerStream(this, LOG_LEVEL_FATAL, "FATAL", "", "", "", {});
+    }
+
+    void Logger::mute_debug(bool setting) noexcept {
+        m_mute_debug = setting;
+    }
+
+    void Logger::endl_impl(HMODULE module, LoggerStream &stream) {
+        if(stream.enabled()) {
+            write_impl(module, stream, stream.m_stream.str());
+        }
+
+        // Plugins built against older headers fill the stream of muted levels too
+        stream.m_stream.str("");
+        stream.m_stream.clear();
+    }
+
+    void Logger::write_impl(HMODULE, LoggerStream &stream, std::string_view message) {
+        if(!stream.enabled()) {
+            return;
+        }
+        last_message = message;
+        written_messages++;
+    }
+}
+
+/**
+ * A value which can only be printed to a std::ostream, like many types of plugins
+ */
+struct StreamOnlyValue {
+    int id;
+
+    friend std::ostream &operator<<(std::ostream &stream, StreamOnlyValue const &value) {
+        return stream << "value #" << value.id;
+    }
+};
+
+/**
+ * Cost of log calls in the code plugins compile, for muted and printed levels; usage:
+ *   logger_stream_benchmark [--quick]
+ */
+int main(int argc, const char **argv) {
+    bool quick = HostTest::quick_run(argc, argv);
+    std::size_t iterations = quick ? 100 : 1000000;
+
+    Logger logger("benchmark");
+    logger.mute_debug(true);
+    std::string tag_path = "levels\\a10\\a10";
+    double ratio = 0.75;
+
+    HostTest::benchmark("muted, formatted", iterations, 1, [&]() {
+        logger.debug("Loaded tag {} at {:.2f} ({} of {})", tag_path, ratio, 3, 4);
+    });
+    HostTest::benchmark("muted, streamed", iterations, 1, [&]() {
+        logger.debug << "Loaded tag " << tag_path << " at " << ratio << Logger::endl;
+    });
+    HostTest::benchmark("printed, formatted", iterations, 1, [&]() {
+        logger.info("Loaded tag {} at {:.2f} ({} of {})", tag_path, ratio, 3, 4);
+    });
+    HostTest::benchmark("printed, streamed", iterations, 1, [&]() {
+        logger.info << "Loaded tag " << tag_path << " at " << ratio << Logger::endl;
+    });
+    HostTest::benchmark("printed, without arguments", iterations, 1, [&]() {
+        logger.info("Loaded every tag");
+    });
+
+    // Muted calls print nothing; the others print what plugins built against 1.2.0 expect
+    int result = EXIT_SUCCESS;
+    auto expect = [&](auto log, const char *expected) {
+        auto before = written_messages;
+        log();
+        if(written_messages != before + (expected ? 1 : 0) || (expected && last_message != expected)) {
+            std::fprintf(stderr, "expected \"%s\", got \"%s\"\n", expected ? expected : "nothing", last_message.c_str());
+            result = EXIT_FAILURE;
+        }
+    };
+    expect([&]() { logger.debug("{} {}", 1, 2); }, nullptr);
+    expect([&]() { logger.debug << StreamOnlyValue{1} << Logger::endl; }, nullptr);
+    expect([&]() { logger.info("{} {:.1f}", tag_path, ratio); }, "levels\\a10\\a10 0.8");
+    expect([&]() { logger.info(std::string("{} of {}"), 1, 2); }, "1 of 2");
+    expect([&]() { logger.info("100% {}"); }, "100% {}");
+    expect([&]() { logger.info << StreamOnlyValue{2} << ", " << 3 << Logger::endl; }, "value #2, 3");
+    return result;
+}
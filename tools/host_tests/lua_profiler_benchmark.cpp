@@ -0,0 +1,134 @@
+// SPDX-License-Identifier: GPL-3.0-only
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <lua.hpp>
+#include <plugins/lua/profiler_sampler.hpp>
+#include "host_test.hpp"
+
+using namespace Balltze::Plugins::Lua;
+
+/** Default of plugins.profiler_sample_interval */
+static constexpr std::size_t DEFAULT_SAMPLE_INTERVAL = 1000;
+
+// One function spends its time in the Lua VM: arithmetic, table accesses and calls to Lua functions, like
+// plugin code updating its own state. The other one spends it in C functions of the standard library, like
+// plugin code which mostly calls the Balltze API.
+static const char *benchmark_script = R"(
+local size = ...
+
+local function distance(a, b)
+    local dx, dy, dz = a.x - b.x, a.y - b.y, a.z - b.z
+    return dx * dx + dy * dy + dz * dz
+end
+
+local points = {}
+for i = 1, size do
+    points[i] = {x = i * 0.5, y = i % 7, z = -i}
+end
+
+function vmWork()
+    local sum = 0
+    for i = 2, #points do
+        sum = sum + distance(points[i], points[i - 1])
+        if sum > 1e9 then
+            sum = 0
+        end
+    end
+    return sum
+end
+
+function cWork()
+    local count = 0
+    for i = 1, size // 16 do
+        local line = string.format("%d %s %.3f", i, string.rep("x", 64), i * 0.25)
+        count = count + #line:upper()
+    end
+    return count
+end
+)";
+
+static void call(lua_State *state, const char *function) {
+    lua_getglobal(state, function);
+    if(lua_pcall(state, 0, 1, 0) != LUA_OK) {
+        std::fprintf(stderr, "%s: %s\n", function, lua_tostring(state, -1));
+        std::exit(EXIT_FAILURE);
+    }
+    HostTest::do_not_optimize(lua_tonumber(state, -1));
+    lua_pop(state, 1);
+}
+
+static void empty_hook(lua_State *, lua_Debug *) noexcept {
+}
+
+/**
+ * Time of a plugin function with the Lua profiler stopped, with a count hook which does nothing and with the
+ * sampler of the profiler at the default sample interval. Usage:
+ *   lua_profiler_benchmark [--quick]
+ */
+int main(int argc, const char **argv) {
+    bool quick = HostTest::quick_run(argc, argv);
+    std::size_t size = quick ? 1024 : 65536;
+    std::size_t iterations = quick ? 2 : 40;
+
+    lua_State *state = luaL_newstate();
+    luaL_openlibs(state);
+    if(luaL_loadstring(state, benchmark_script) != LUA_OK) {
+        std::fprintf(stderr, "%s\n", lua_tostring(state, -1));
+        return EXIT_FAILURE;
+    }
+    lua_pushinteger(state, size);
+    if(lua_pcall(state, 1, 0, 0) != LUA_OK) {
+        std::fprintf(stderr, "%s\n", lua_tostring(state, -1));
+        return EXIT_FAILURE;
+    }
+
+    // The modes take turns and the fastest round of each is kept, so the machine getting slower during the
+    // run does not count as overhead
+    int result = EXIT_SUCCESS;
+    std::size_t rounds = quick ? 1 : 5;
+    for(const char *function : {"vmWork", "cWork"}) {
+        // The buffer holds every sample of the run, so none is dropped
+        LuaProfilerSampler sampler(16 * LuaProfilerSampler::SAMPLE_BUFFER_SIZE);
+        double without_hook = 0.0, with_empty_hook = 0.0, with_profiler = 0.0;
+        auto keep_fastest = [](double &fastest, double time) {
+            fastest = fastest == 0.0 ? time : std::min(fastest, time);
+        };
+        char name[64];
+        for(std::size_t round = 0; round < rounds; round++) {
+            std::snprintf(name, sizeof(name), "%s, no hook", function);
+            keep_fastest(without_hook, HostTest::benchmark(name, iterations, size, [&]() {
+                call(state, function);
+            }));
+
+            lua_sethook(state, empty_hook, LUA_MASKCOUNT, DEFAULT_SAMPLE_INTERVAL);
+            std::snprintf(name, sizeof(name), "%s, empty count hook", function);
+            keep_fastest(with_empty_hook, HostTest::benchmark(name, iterations, size, [&]() {
+                call(state, function);
+            }));
+            lua_sethook(state, nullptr, 0, 0);
+
+            sampler.attach(state, DEFAULT_SAMPLE_INTERVAL);
+            std::snprintf(name, sizeof(name), "%s, profiler", function);
+            keep_fastest(with_profiler, HostTest::benchmark(name, iterations, size, [&]() {
+                call(state, function);
+            }));
+            LuaProfilerSampler::detach(state);
+        }
+        std::printf("%s: %+.1f%% with an empty count hook, %+.1f%% with the profiler, %zu samples\n", function,
+            (with_empty_hook / without_hook - 1.0) * 100.0, (with_profiler / without_hook - 1.0) * 100.0, sampler.sample_count());
+
+        // Every sample is taken in the benchmark chunk; functions called from C have no name, so the lines tell
+        bool in_chunk = true;
+        for(auto &[stack, count] : sampler.collapsed_stacks()) {
+            in_chunk = in_chunk && stack.starts_with("? ([string \"...\"]:");
+        }
+        if(sampler.sample_count() == 0 || sampler.dropped_samples() != 0 || !in_chunk) {
+            std::fprintf(stderr, "%s: %zu samples, %zu dropped\n", function, sampler.sample_count(), sampler.dropped_samples());
+            result = EXIT_FAILURE;
+        }
+    }
+    lua_close(state);
+    return result;
+}
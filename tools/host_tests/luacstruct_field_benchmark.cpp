@@ -0,0 +1,311 @@
+// SPDX-License-Identifier: GPL-3.0-only
+
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+#include <lua.hpp>
+#include <plugins/lua/helpers/luacstruct.hpp>
+#include "host_test.hpp"
+
+#ifndef LUACSTRUCT_FIELD_LOOKUP
+#define LUACSTRUCT_FIELD_LOOKUP "field map"
+#endif
+
+struct BenchmarkResourceHandle {
+    std::uint32_t value;
+};
+
+struct BenchmarkPoint3D {
+    float x;
+    float y;
+    float z;
+};
+
+struct BenchmarkObjectVitals {
+    float base_health;
+    float base_shield;
+    float health;
+    float shield;
+};
+
+/**
+ * Object with the fields of EngineBaseObject, by name and in the order they are declared in, so the
+ * struct has as many fields to look up as the one plugins read; nested structs and arrays the lookup
+ * does not care about are plain values
+ */
+struct BenchmarkObject {
+    BenchmarkResourceHandle tag_handle;
+    std::uint32_t network_role;
+    std::uint32_t existence_time;
+    std::uint32_t flags;
+    std::uint32_t object_marker_id;
+    std::uint32_t network;
+    BenchmarkPoint3D position;
+    BenchmarkPoint3D velocity;
+    BenchmarkPoint3D orientation;
+    BenchmarkPoint3D rotation_velocity;
+    std::uint32_t scenario_location;
+    BenchmarkPoint3D center_position;
+    float bounding_radius;
+    float scale;
+    std::uint16_t type;
+    std::int16_t team_owner;
+    std::uint16_t name_list_index;
+    std::uint16_t moving_time;
+    std::uint16_t variant_index;
+    BenchmarkResourceHandle player;
+    BenchmarkResourceHandle owner_object;
+    BenchmarkResourceHandle animation_tag_handle;
+    std::uint16_t animation_index;
+    std::uint16_t animation_frame;
+    std::uint16_t animation_interpolation_frame;
+    std::uint16_t animation_interpolation_frame_count;
+    BenchmarkObjectVitals vitals;
+    std::uint32_t cluster_partition;
+    BenchmarkResourceHandle unknown_object;
+    BenchmarkResourceHandle next_object;
+    BenchmarkResourceHandle first_object;
+    BenchmarkResourceHandle parent_object;
+    std::uint8_t parent_attachment_node;
+    bool force_shield_update;
+    std::uint8_t valid_outgoing_functions;
+    float incoming_function_values;
+    float outgoing_function_values;
+    std::uint32_t attachment_data;
+    BenchmarkResourceHandle cached_render_state;
+    std::uint16_t region_destroyeds;
+    std::int16_t shader_permutation;
+    std::uint8_t region_healths;
+    std::int8_t region_permutation_ids;
+    float color_change;
+    float color_change_2;
+    std::uint32_t node_orientations;
+    std::uint32_t node_matrices_block;
+};
+
+static void define_object_types(lua_State *state) noexcept {
+    luacs_newstruct(state, BenchmarkResourceHandle);
+    luacs_unsigned_field(state, BenchmarkResourceHandle, value, 0);
+    lua_pop(state, 1);
+
+    luacs_newstruct(state, BenchmarkPoint3D);
+    luacs_float_field(state, BenchmarkPoint3D, x, 0);
+    luacs_float_field(state, BenchmarkPoint3D, y, 0);
+    luacs_float_field(state, BenchmarkPoint3D, z, 0);
+    lua_pop(state, 1);
+
+    luacs_newstruct(state, BenchmarkObjectVitals);
+    luacs_float_field(state, BenchmarkObjectVitals, base_health, 0);
+    luacs_float_field(state, BenchmarkObjectVitals, base_shield, 0);
+    luacs_float_field(state, BenchmarkObjectVitals, health, 0);
+    luacs_float_field(state, BenchmarkObjectVitals, shield, 0);
+    lua_pop(state, 1);
+
+    luacs_newstruct(state, BenchmarkObject);
+    luacs_nested_field(state, BenchmarkObject, BenchmarkResourceHandle, tag_handle, 0);
+    luacs_unsigned_field(state, BenchmarkObject, network_role, 0);
+    luacs_unsigned_field(state, BenchmarkObject, existence_time, 0);
+    luacs_unsigned_field(state, BenchmarkObject, flags, 0);
+    luacs_unsigned_field(state, BenchmarkObject, object_marker_id, 0);
+    luacs_unsigned_field(state, BenchmarkObject, network, 0);
+    luacs_nested_field(state, BenchmarkObject, BenchmarkPoint3D, position, 0);
+    luacs_nested_field(state, BenchmarkObject, BenchmarkPoint3D, velocity, 0);
+    luacs_nested_field(state, BenchmarkObject, BenchmarkPoint3D, orientation, 0);
+    luacs_nested_field(state, BenchmarkObject, BenchmarkPoint3D, rotation_velocity, 0);
+    luacs_unsigned_field(state, BenchmarkObject, scenario_location, 0);
+    luacs_nested_field(state, BenchmarkObject, BenchmarkPoint3D, center_position, 0);
+    luacs_float_field(state, BenchmarkObject, bounding_radius, 0);
+    luacs_float_field(state, BenchmarkObject, scale, 0);
+    luacs_unsigned_field(state, BenchmarkObject, type, 0);
+    luacs_int_field(state, BenchmarkObject, team_owner, 0);
+    luacs_unsigned_field(state, BenchmarkObject, name_list_index, 0);
+    luacs_unsigned_field(state, BenchmarkObject, moving_time, 0);
+    luacs_unsigned_field(state, BenchmarkObject, variant_index, 0);
+    luacs_nested_field(state, BenchmarkObject, BenchmarkResourceHandle, player, 0);
+    luacs_nested_field(state, BenchmarkObject, BenchmarkResourceHandle, owner_object, 0);
+    luacs_nested_field(state, BenchmarkObject, BenchmarkResourceHandle, animation_tag_handle, 0);
+    luacs_unsigned_field(state, BenchmarkObject, animation_index, 0);
+    luacs_unsigned_field(state, BenchmarkObject, animation_frame, 0);
+    luacs_unsigned_field(state, BenchmarkObject, animation_interpolation_frame, 0);
+    luacs_unsigned_field(state, BenchmarkObject, animation_interpolation_frame_count, 0);
+    luacs_nested_field(state, BenchmarkObject, BenchmarkObjectVitals, vitals, 0);
+    luacs_unsigned_field(state, BenchmarkObject, cluster_partition, 0);
+    luacs_nested_field(state, BenchmarkObject, BenchmarkResourceHandle, unknown_object, 0);
+    luacs_nested_field(state, BenchmarkObject, BenchmarkResourceHandle, next_object, 0);
+    luacs_nested_field(state, BenchmarkObject, BenchmarkResourceHandle, first_object, 0);
+    luacs_nested_field(state, BenchmarkObject, BenchmarkResourceHandle, parent_object, 0);
+    luacs_unsigned_field(state, BenchmarkObject, parent_attachment_node, 0);
+    luacs_bool_field(state, BenchmarkObject, force_shield_update, 0);
+    luacs_unsigned_field(state, BenchmarkObject, valid_outgoing_functions, 0);
+    luacs_float_field(state, BenchmarkObject, incoming_function_values, 0);
+    luacs_float_field(state, BenchmarkObject, outgoing_function_values, 0);
+    luacs_unsigned_field(state, BenchmarkObject, attachment_data, 0);
+    luacs_nested_field(state, BenchmarkObject, BenchmarkResourceHandle, cached_render_state, 0);
+    luacs_unsigned_field(state, BenchmarkObject, region_destroyeds, 0);
+    luacs_int_field(state, BenchmarkObject, shader_permutation, 0);
+    luacs_unsigned_field(state, BenchmarkObject, region_healths, 0);
+    luacs_int_field(state, BenchmarkObject, region_permutation_ids, 0);
+    luacs_float_field(state, BenchmarkObject, color_change, 0);
+    luacs_float_field(state, BenchmarkObject, color_change_2, 0);
+    luacs_unsigned_field(state, BenchmarkObject, node_orientations, 0);
+    luacs_unsigned_field(state, BenchmarkObject, node_matrices_block, 0);
+    lua_pop(state, 1);
+}
+
+// Reads and writes fields from the start, the middle and the end of the struct on every object, like a
+// plugin going through the objects each tick; the objects are created once, so only the field lookups and
+// the conversions are timed
+static const char *benchmark_script = R"(
+local objects = ...
+
+function readFields()
+    local sum = 0
+    for i = 1, #objects do
+        local object = objects[i]
+        sum = sum + object.existenceTime + object.scale + object.teamOwner + object.animationFrame + object.clusterPartition + object.nodeMatricesBlock
+    end
+    return sum
+end
+
+-- Every field which is not a nested struct, which the splay tree cannot keep near its root all at once
+local scalarFields = {
+    "networkRole", "existenceTime", "flags", "objectMarkerId", "network", "scenarioLocation", "boundingRadius", "scale",
+    "type", "teamOwner", "nameListIndex", "movingTime", "variantIndex", "animationIndex", "animationFrame",
+    "animationInterpolationFrame", "animationInterpolationFrameCount", "clusterPartition", "parentAttachmentNode",
+    "validOutgoingFunctions", "incomingFunctionValues", "outgoingFunctionValues", "attachmentData", "regionDestroyeds",
+    "shaderPermutation", "regionHealths", "regionPermutationIds", "colorChange", "colorChange2", "nodeOrientations",
+    "nodeMatricesBlock"
+}
+scalarFieldCount = #scalarFields
+
+function readAllFields()
+    local sum = 0
+    for i = 1, #objects do
+        local object = objects[i]
+        for j = 1, #scalarFields do
+            sum = sum + object[scalarFields[j]]
+        end
+    end
+    return sum
+end
+
+function readNestedFields()
+    local sum = 0
+    for i = 1, #objects do
+        local object = objects[i]
+        local position = object.position
+        sum = sum + position.x + position.y + position.z + object.vitals.health + object.parentObject.value
+    end
+    return sum
+end
+
+function writeFields()
+    for i = 1, #objects do
+        local object = objects[i]
+        object.existenceTime = i
+        object.scale = 0.5
+        object.teamOwner = 2
+        object.animationFrame = i % 60
+        object.clusterPartition = i
+        object.nodeMatricesBlock = i
+    end
+    return 0
+end
+
+function writeNestedFields()
+    for i = 1, #objects do
+        local velocity = objects[i].velocity
+        velocity.x = i
+        velocity.y = 0.25
+        velocity.z = -i
+    end
+    return 0
+end
+)";
+
+static lua_Number call(lua_State *state, const char *function) {
+    lua_getglobal(state, function);
+    if(lua_pcall(state, 0, 1, 0) != LUA_OK) {
+        std::fprintf(stderr, "%s: %s\n", function, lua_tostring(state, -1));
+        std::exit(EXIT_FAILURE);
+    }
+    auto result = lua_tonumber(state, -1);
+    lua_pop(state, 1);
+    return result;
+}
+
+/**
+ * Reading and writing the fields of objects defined with luacstruct from Lua. The same source is built
+ * with the field map luacstruct resolves fields with, and with LUACS_SPLAY_LOOKUP for the splay tree it
+ * used before. Usage:
+ *   luacstruct_field_benchmark [--quick]
+ *   luacstruct_field_splay_benchmark [--quick]
+ */
+int main(int argc, const char **argv) {
+    bool quick = HostTest::quick_run(argc, argv);
+    std::size_t object_count = quick ? 16 : 1024;
+    std::size_t iterations = quick ? 2 : 2000;
+
+    std::vector<BenchmarkObject> objects(object_count);
+    for(std::size_t i = 0; i < object_count; i++) {
+        auto &object = objects[i];
+        object.existence_time = i;
+        object.scale = 1.0f;
+        object.team_owner = i % 4;
+        object.animation_frame = i % 30;
+        object.cluster_partition = i * 3;
+        object.node_matrices_block = i * 7;
+        object.position = {static_cast<float>(i), 2.0f, -3.0f};
+        object.vitals.health = 0.75f;
+        object.parent_object.value = 0xFFFFFFFF;
+    }
+
+    lua_State *state = luaL_newstate();
+    luaL_openlibs(state);
+    define_object_types(state);
+    if(luaL_loadstring(state, benchmark_script) != LUA_OK) {
+        std::fprintf(stderr, "%s\n", lua_tostring(state, -1));
+        return EXIT_FAILURE;
+    }
+    lua_createtable(state, object_count, 0);
+    for(std::size_t i = 0; i < object_count; i++) {
+        luacs_newobject0(state, "BenchmarkObject", &objects[i]);
+        lua_rawseti(state, -2, i + 1);
+    }
+    if(lua_pcall(state, 1, 0, 0) != LUA_OK) {
+        std::fprintf(stderr, "%s\n", lua_tostring(state, -1));
+        return EXIT_FAILURE;
+    }
+    std::printf("%zu objects, fields resolved with the %s\n", object_count, LUACSTRUCT_FIELD_LOOKUP);
+
+    // Items are field accesses
+    lua_Number sum = 0;
+    HostTest::benchmark("readFields", iterations, object_count * 6, [&]() {
+        sum = call(state, "readFields");
+    });
+    lua_getglobal(state, "scalarFieldCount");
+    std::size_t scalar_field_count = lua_tointeger(state, -1);
+    lua_pop(state, 1);
+    HostTest::benchmark("readAllFields", iterations, object_count * scalar_field_count, [&]() {
+        sum += call(state, "readAllFields");
+    });
+    HostTest::benchmark("readNestedFields", iterations, object_count * 8, [&]() {
+        sum += call(state, "readNestedFields");
+    });
+    HostTest::benchmark("writeFields", iterations, object_count * 6, [&]() {
+        call(state, "writeFields");
+    });
+    HostTest::benchmark("writeNestedFields", iterations, object_count * 4, [&]() {
+        call(state, "writeNestedFields");
+    });
+    HostTest::do_not_optimize(sum);
+
+    int result = EXIT_SUCCESS;
+    if(objects[object_count - 1].node_matrices_block != object_count || objects[1].velocity.z != -2.0f) {
+        std::fprintf(stderr, "writes did not reach the objects\n");
+        result = EXIT_FAILURE;
+    }
+    lua_close(state);
+    return result;
+}
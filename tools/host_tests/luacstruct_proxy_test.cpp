@@ -0,0 +1,293 @@
+// SPDX-License-Identifier: GPL-3.0-only
+
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <string>
+#include <lua.hpp>
+#include <plugins/lua/helpers/luacstruct.hpp>
+#include "host_test.hpp"
+
+struct ProxyTestPoint3D {
+    float x;
+    float y;
+    float z;
+};
+
+struct ProxyTestObject {
+    std::uint32_t id;
+    float health;
+    ProxyTestPoint3D position;
+    ProxyTestPoint3D velocity;
+};
+
+struct ProxyTestElement {
+    std::uint32_t value;
+    ProxyTestPoint3D offset;
+};
+
+/**
+ * Reflexive like Engine::TagBlock: the elements are somewhere else in the tag data
+ */
+struct ProxyTestBlock {
+    std::uint32_t count;
+    ProxyTestElement *elements;
+};
+
+struct ProxyTestTag {
+    std::uint32_t id;
+    ProxyTestBlock elements;
+};
+
+static void define_types(lua_State *state) noexcept {
+    luacs_newstruct(state, ProxyTestPoint3D);
+    luacs_float_field(state, ProxyTestPoint3D, x, 0);
+    luacs_float_field(state, ProxyTestPoint3D, y, 0);
+    luacs_float_field(state, ProxyTestPoint3D, z, 0);
+    lua_pop(state, 1);
+
+    luacs_newstruct(state, ProxyTestObject);
+    luacs_unsigned_field(state, ProxyTestObject, id, 0);
+    luacs_float_field(state, ProxyTestObject, health, 0);
+    luacs_nested_field(state, ProxyTestObject, ProxyTestPoint3D, position, 0);
+    luacs_nested_field(state, ProxyTestObject, ProxyTestPoint3D, velocity, 0);
+    lua_pop(state, 1);
+
+    luacs_newstruct(state, ProxyTestElement);
+    luacs_unsigned_field(state, ProxyTestElement, value, 0);
+    luacs_nested_field(state, ProxyTestElement, ProxyTestPoint3D, offset, 0);
+    lua_pop(state, 1);
+
+    // Declared like define_tag_block does
+    luacs_newstruct(state, ProxyTestBlock);
+    luacs_unsigned_field(state, ProxyTestBlock, count, LUACS_FREADONLY);
+    luacs_declare_field(state, LUACS_TOBJREF, "ProxyTestElement", "elements", sizeof(ProxyTestElement), offsetof(ProxyTestBlock, elements), 65535, LUACS_FREADONLY);
+    lua_pop(state, 1);
+
+    luacs_newstruct(state, ProxyTestTag);
+    luacs_unsigned_field(state, ProxyTestTag, id, 0);
+    luacs_nested_field(state, ProxyTestTag, ProxyTestBlock, elements, 0);
+    lua_pop(state, 1);
+}
+
+/**
+ * push(typeName, address): the object of a type at an address, like the functions of the plugin API push them
+ */
+static int lua_push(lua_State *state) noexcept {
+    auto *type_name = luaL_checkstring(state, 1);
+    auto *address = reinterpret_cast<void *>(static_cast<std::uintptr_t>(luaL_checkinteger(state, 2)));
+    luacs_newobject0(state, type_name, address);
+    return 1;
+}
+
+static lua_State *new_state() {
+    lua_State *state = luaL_newstate();
+    luaL_openlibs(state);
+    define_types(state);
+    lua_register(state, "push", lua_push);
+    lua_pushinteger(state, sizeof(ProxyTestObject));
+    lua_setglobal(state, "objectSize");
+    lua_pushinteger(state, offsetof(ProxyTestObject, position));
+    lua_setglobal(state, "positionOffset");
+    return state;
+}
+
+static void set_address(lua_State *state, const char *name, void const *address) {
+    lua_pushinteger(state, reinterpret_cast<std::uintptr_t>(address));
+    lua_setglobal(state, name);
+}
+
+/**
+ * Run a chunk; returns the error message, or an empty string if it ran
+ */
+static std::string run(lua_State *state, const char *chunk) {
+    if(luaL_dostring(state, chunk) != LUA_OK) {
+        std::string error = lua_tostring(state, -1);
+        lua_pop(state, 1);
+        return error;
+    }
+    return {};
+}
+
+TEST_CASE("objects pushed at the same address are the same proxy") {
+    ProxyTestObject objects[2] = {};
+    objects[0].id = 1;
+    objects[1].id = 2;
+    auto *state = new_state();
+    set_address(state, "first", &objects[0]);
+    set_address(state, "second", &objects[1]);
+    CHECK(run(state, R"(
+        local a, b = push("ProxyTestObject", first), push("ProxyTestObject", first)
+        assert(rawequal(a, b))
+        assert(not rawequal(a, push("ProxyTestObject", second)))
+        assert(a.id == 1 and push("ProxyTestObject", second).id == 2)
+
+        -- Writes through one are seen through the other, since both are the same object
+        a.health = 0.5
+        assert(b.health == 0.5)
+
+        -- The proxy of another struct at the same address is another object
+        local point = push("ProxyTestPoint3D", first)
+        assert(not rawequal(point, a))
+        assert(rawequal(point, push("ProxyTestPoint3D", first)))
+    )").empty());
+    CHECK(objects[0].health == 0.5f);
+    lua_close(state);
+}
+
+TEST_CASE("nested structs are cached by their parent and shared with the proxy of their address") {
+    ProxyTestObject object = {};
+    object.position = {1.0f, 2.0f, 3.0f};
+    auto *state = new_state();
+    set_address(state, "object", &object);
+    set_address(state, "position", &object.position);
+    CHECK(run(state, R"(
+        local parent = push("ProxyTestObject", object)
+        local child = parent.position
+        assert(rawequal(child, parent.position))
+        assert(rawequal(child, push("ProxyTestPoint3D", position)))
+        assert(not rawequal(child, parent.velocity))
+        assert(child.y == 2)
+
+        -- A child pushed on its own first is the one its parent hands out
+        local velocity = push("ProxyTestPoint3D", position + 12)
+        assert(rawequal(velocity, parent.velocity))
+        velocity.z = 4
+    )").empty());
+    CHECK(object.velocity.z == 4.0f);
+    lua_close(state);
+}
+
+TEST_CASE("proxies are collected when Lua no longer holds them") {
+    ProxyTestObject object = {};
+    object.id = 7;
+    auto *state = new_state();
+    set_address(state, "object", &object);
+    CHECK(run(state, R"(
+        local held = setmetatable({}, {__mode = "k"})
+        local function hold()
+            local proxy = push("ProxyTestObject", object)
+            held[proxy] = true
+            held[proxy.position] = true
+        end
+        hold()
+
+        -- Children are held by the table of their parent until the parent is finalized, and weak keys with a
+        -- finalizer are cleared in the cycle after they are finalized
+        for i = 1, 4 do
+            collectgarbage()
+        end
+        assert(next(held) == nil, "the proxy cache keeps proxies alive")
+
+        -- The cache does not hand out the collected proxy
+        local proxy = push("ProxyTestObject", object)
+        assert(proxy.id == 7 and proxy.position.x == 0)
+        held[proxy] = true
+        collectgarbage()
+        assert(next(held) == proxy)
+    )").empty());
+
+    // Nothing is left in the cache of the struct once its proxies are gone
+    CHECK(run(state, R"(
+        collectgarbage()
+        collectgarbage()
+        for _, proxies in pairs(debug.getregistry().luacstruct_proxies) do
+            assert(next(proxies) == nil)
+        end
+    )").empty());
+    lua_close(state);
+}
+
+TEST_CASE("invalidated proxies are not handed out again") {
+    ProxyTestObject objects[3] = {};
+    auto *state = new_state();
+    set_address(state, "objects", objects);
+    CHECK(run(state, R"(
+        proxies = {}
+        for i = 1, 3 do
+            proxies[i] = push("ProxyTestObject", objects + (i - 1) * objectSize)
+            proxies[i].id = i
+        end
+        positions = {proxies[1].position, proxies[2].position, proxies[3].position}
+    )").empty());
+
+    // A deleted object: the proxies in its memory go, the ones around it stay
+    luacs_invalidate_objects(state, &objects[1], sizeof(objects[1]));
+    CHECK(run(state, R"(
+        local size = objectSize
+        assert(rawequal(proxies[1], push("ProxyTestObject", objects)))
+        assert(rawequal(proxies[3], push("ProxyTestObject", objects + 2 * size)))
+        local new = push("ProxyTestObject", objects + size)
+        assert(not rawequal(proxies[2], new))
+        assert(not rawequal(positions[2], push("ProxyTestPoint3D", objects + size + positionOffset)))
+        assert(not rawequal(positions[2], new.position))
+
+        -- Proxies Lua still holds keep working
+        assert(proxies[2].id == 2 and new.id == 2)
+    )").empty());
+
+    // Map change or tag data reload: everything goes
+    luacs_invalidate_objects(state, nullptr, 0);
+    CHECK(run(state, R"(
+        for i = 1, 3 do
+            assert(not rawequal(proxies[i], push("ProxyTestObject", objects + (i - 1) * objectSize)))
+        end
+        assert(not rawequal(positions[1], push("ProxyTestPoint3D", objects + positionOffset)))
+    )").empty());
+    lua_close(state);
+}
+
+TEST_CASE("reflexives reallocated at a reused address give the elements of the new data") {
+    // Tag data, with the tag first and its reflexive elements after it
+    alignas(ProxyTestTag) std::byte tag_data[512] = {};
+    auto *tag = new(tag_data) ProxyTestTag();
+    auto *old_elements = new(tag_data + 64) ProxyTestElement[3]();
+    tag->id = 1;
+    tag->elements = {3, old_elements};
+    for(std::uint32_t i = 0; i < 3; i++) {
+        old_elements[i].value = 10 + i;
+    }
+
+    auto *state = new_state();
+    set_address(state, "tag", tag);
+    CHECK(run(state, R"(
+        tagProxy = push("ProxyTestTag", tag)
+        elements = tagProxy.elements.elements
+        oldFirst, oldSecond = elements[1], elements[2]
+        oldFirstOffset = oldFirst.offset
+        assert(rawequal(oldFirst, elements[1]))
+        assert(oldFirst.value == 10 and oldSecond.value == 11)
+    )").empty());
+
+    // The tag is reloaded: its reflexive now has 2 elements, and the first one is where the second one was
+    auto *new_elements = new(tag_data + 64 + sizeof(ProxyTestElement)) ProxyTestElement[2]();
+    new_elements[0].value = 20;
+    new_elements[0].offset.x = 2.5f;
+    new_elements[1].value = 21;
+    tag->elements = {2, new_elements};
+    CHECK(run(state, R"(
+        assert(tagProxy.elements.count == 2)
+        local first, second = elements[1], elements[2]
+        assert(not rawequal(first, oldFirst))
+
+        -- The proxy of the old second element has the same type and address, so it is the one reused
+        assert(rawequal(first, oldSecond))
+        assert(first.value == 20 and second.value == 21)
+        assert(first.offset.x == 2.5)
+    )").empty());
+
+    // After the reload drops the proxies, nothing from the old data is handed out
+    luacs_invalidate_objects(state, nullptr, 0);
+    CHECK(run(state, R"(
+        local reloaded = push("ProxyTestTag", tag)
+        assert(not rawequal(reloaded, tagProxy))
+        local first = reloaded.elements.elements[1]
+        assert(not rawequal(first, oldFirst) and not rawequal(first, oldSecond))
+        assert(not rawequal(first.offset, oldFirstOffset))
+        assert(first.value == 20 and first.offset.x == 2.5)
+        assert(reloaded.elements.elements[2].value == 21)
+    )").empty());
+    lua_close(state);
+}
+
+TEST_MAIN()
@@ -0,0 +1,177 @@
+// SPDX-License-Identifier: GPL-3.0-only
+
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+#include <lua.hpp>
+#include <plugins/lua/functions.hpp>
+#include "host_test.hpp"
+
+using namespace Balltze::Plugins::Lua;
+
+// Each function reads or writes fields of every object, in object-sized elements, like a plugin walking
+// the object table does: the position and velocity, 6 floats at 0x5C, or those with the 16-bit type
+// at 0xB4 and the 2 floats of health and shield at 0xE0, which the format has to skip to with padding
+static const char *benchmark_script = R"(
+local base, count, stride = ...
+local memory = Balltze.memory
+local readFloat, readInt16, readStruct, readStructArray = memory.readFloat, memory.readInt16, memory.readStruct, memory.readStructArray
+local writeFloat, writeStruct, writeStructArray = memory.writeFloat, memory.writeStruct, memory.writeStructArray
+local format = string.rep("x", 0x5C) .. "fff fff" .. string.rep("x", 0xB4 - 0x74) .. "h" .. string.rep("x", 0xE0 - 0xB6) .. "ff"
+
+function readVectorsPerField()
+    local sum = 0
+    for i = 0, count - 1 do
+        local address = base + i * stride
+        local x, y, z = readFloat(address + 0x5C), readFloat(address + 0x60), readFloat(address + 0x64)
+        local vx, vy, vz = readFloat(address + 0x68), readFloat(address + 0x6C), readFloat(address + 0x70)
+        sum = sum + x + y + z + vx + vy + vz
+    end
+    return sum
+end
+
+function readVectorsWithStruct()
+    local sum = 0
+    for i = 0, count - 1 do
+        local x, y, z, vx, vy, vz = readStruct(base + i * stride + 0x5C, "fff fff")
+        sum = sum + x + y + z + vx + vy + vz
+    end
+    return sum
+end
+
+function readPerField()
+    local sum = 0
+    for i = 0, count - 1 do
+        local address = base + i * stride
+        local x, y, z = readFloat(address + 0x5C), readFloat(address + 0x60), readFloat(address + 0x64)
+        local vx, vy, vz = readFloat(address + 0x68), readFloat(address + 0x6C), readFloat(address + 0x70)
+        local objectType = readInt16(address + 0xB4)
+        local health, shield = readFloat(address + 0xE0), readFloat(address + 0xE4)
+        sum = sum + x + y + z + vx + vy + vz + objectType + health + shield
+    end
+    return sum
+end
+
+function readWithStruct()
+    local sum = 0
+    for i = 0, count - 1 do
+        local x, y, z, vx, vy, vz, objectType, health, shield = readStruct(base + i * stride, format)
+        sum = sum + x + y + z + vx + vy + vz + objectType + health + shield
+    end
+    return sum
+end
+
+function readWithStructArray()
+    local values = readStructArray(base, format, count, stride)
+    local sum = 0
+    for i = 1, #values, 9 do
+        sum = sum + values[i] + values[i + 1] + values[i + 2] + values[i + 3] + values[i + 4] + values[i + 5] + values[i + 6] + values[i + 7] + values[i + 8]
+    end
+    return sum
+end
+
+local velocities = {}
+for i = 1, count * 3 do
+    velocities[i] = i * 0.25
+end
+
+function writePerField()
+    for i = 0, count - 1 do
+        local address = base + i * stride
+        local j = i * 3
+        writeFloat(address + 0x68, velocities[j + 1])
+        writeFloat(address + 0x6C, velocities[j + 2])
+        writeFloat(address + 0x70, velocities[j + 3])
+    end
+end
+
+function writeWithStruct()
+    for i = 0, count - 1 do
+        local j = i * 3
+        writeStruct(base + i * stride + 0x68, "fff", velocities[j + 1], velocities[j + 2], velocities[j + 3])
+    end
+end
+
+function writeWithStructArray()
+    writeStructArray(base + 0x68, "fff", velocities, stride)
+end
+)";
+
+static lua_Number call(lua_State *state, const char *function) {
+    lua_getglobal(state, function);
+    if(lua_pcall(state, 0, 1, 0) != LUA_OK) {
+        std::fprintf(stderr, "%s: %s\n", function, lua_tostring(state, -1));
+        std::exit(EXIT_FAILURE);
+    }
+    auto result = lua_tonumber(state, -1);
+    lua_pop(state, 1);
+    return result;
+}
+
+/**
+ * Reading and writing the fields of objects from Lua with readStruct against a readFloat/readInt call per field.
+ * The memory range checks of the struct functions are stubbed out on the host, so they cost more in the game. Usage:
+ *   memory_struct_benchmark [--quick] [--objects N]
+ */
+int main(int argc, const char **argv) {
+    bool quick = HostTest::quick_run(argc, argv);
+    std::size_t object_count = 2048;
+    for(int i = 1; i + 1 < argc; i++) {
+        if(std::strcmp(argv[i], "--objects") == 0) {
+            object_count = std::strtoull(argv[i + 1], nullptr, 10);
+        }
+    }
+    if(quick) {
+        object_count = 64;
+    }
+    std::size_t iterations = quick ? 2 : 200;
+
+    // Objects of the size of a biped
+    constexpr std::size_t stride = 0xDB4;
+    std::vector<std::uint8_t> objects(object_count * stride);
+    for(std::size_t i = 0; i < objects.size(); i++) {
+        objects[i] = static_cast<std::uint8_t>(i * 31 % 61);
+    }
+
+    lua_State *state = luaL_newstate();
+    luaL_openlibs(state);
+    lua_newtable(state);
+    set_memory_function(state);
+    lua_setglobal(state, "Balltze");
+    if(luaL_loadstring(state, benchmark_script) != LUA_OK) {
+        std::fprintf(stderr, "%s\n", lua_tostring(state, -1));
+        return EXIT_FAILURE;
+    }
+    lua_pushinteger(state, reinterpret_cast<std::uintptr_t>(objects.data()));
+    lua_pushinteger(state, object_count);
+    lua_pushinteger(state, stride);
+    if(lua_pcall(state, 3, 0, 0) != LUA_OK) {
+        std::fprintf(stderr, "%s\n", lua_tostring(state, -1));
+        return EXIT_FAILURE;
+    }
+    std::printf("%zu objects\n", object_count);
+
+    int result = EXIT_SUCCESS;
+    lua_Number sums[5];
+    const char *reads[] = {"readVectorsPerField", "readVectorsWithStruct", "readPerField", "readWithStruct", "readWithStructArray"};
+    for(std::size_t i = 0; i < 5; i++) {
+        HostTest::benchmark(reads[i], iterations, object_count, [&]() {
+            sums[i] = call(state, reads[i]);
+        });
+    }
+    for(const char *write : {"writePerField", "writeWithStruct", "writeWithStructArray"}) {
+        HostTest::benchmark(write, iterations, object_count, [&]() {
+            call(state, write);
+        });
+    }
+
+    // Every way of reading has to see the same values
+    if(sums[0] != sums[1] || sums[2] != sums[3] || sums[2] != sums[4]) {
+        std::fprintf(stderr, "reads differ: %f %f, %f %f %f\n", sums[0], sums[1], sums[2], sums[3], sums[4]);
+        result = EXIT_FAILURE;
+    }
+    lua_close(state);
+    return result;
+}
@@ -0,0 +1,103 @@
+// SPDX-License-Identifier: GPL-3.0-only
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <lua.hpp>
+#include <plugins/lua/functions.hpp>
+#include "host_test.hpp"
+
+using namespace Balltze::Plugins::Lua;
+
+/**
+ * Lua state with Balltze.memory, and the address of a buffer in the global "buffer"
+ */
+static lua_State *new_state(void *buffer) {
+    lua_State *state = luaL_newstate();
+    luaL_openlibs(state);
+    lua_newtable(state);
+    set_memory_function(state);
+    lua_setglobal(state, "Balltze");
+    lua_pushinteger(state, reinterpret_cast<std::uintptr_t>(buffer));
+    lua_setglobal(state, "buffer");
+    return state;
+}
+
+/**
+ * Run a chunk; returns the error message, or an empty string if it ran
+ */
+static std::string run(lua_State *state, const char *chunk) {
+    if(luaL_dostring(state, chunk) != LUA_OK) {
+        std::string error = lua_tostring(state, -1);
+        lua_pop(state, 1);
+        return error;
+    }
+    return {};
+}
+
+static bool contains(std::string const &string, const char *part) {
+    return string.find(part) != std::string::npos;
+}
+
+TEST_CASE("struct reads and writes go through every field of the format") {
+    alignas(8) std::uint8_t buffer[64] = {};
+    auto *state = new_state(buffer);
+    CHECK(run(state, R"(
+        Balltze.memory.writeStruct(buffer, "b B h H i I j f d x i2", -1, 255, -2, 65535, -3, 4000000000, -5, 1.5, 2.25, 7)
+        local values = {Balltze.memory.readStruct(buffer, "b B h H i I j f d x i2")}
+        assert(#values == 10)
+        assert(values[1] == -1 and values[2] == 255 and values[3] == -2 and values[4] == 65535)
+        assert(values[5] == -3 and values[6] == 4000000000 and values[7] == -5)
+        assert(values[8] == 1.5 and values[9] == 2.25 and values[10] == 7)
+
+        Balltze.memory.writeStructArray(buffer, "h f", {1, 0.5, 2, 1.5, 3, 2.5}, 8)
+        local array = Balltze.memory.readStructArray(buffer, "h f", 3, 8)
+        assert(#array == 6 and array[5] == 3 and array[6] == 2.5)
+    )").empty());
+    float value;
+    std::memcpy(&value, buffer + 16 + 2, sizeof(value));
+    CHECK(value == 2.5f);
+    lua_close(state);
+}
+
+TEST_CASE("nothing is written when one of the values is invalid") {
+    std::uint8_t buffer[64];
+    std::memset(buffer, 0xAA, sizeof(buffer));
+    auto *state = new_state(buffer);
+
+    // The last value is the invalid one, so every field before it would have been written
+    CHECK(contains(run(state, R"(Balltze.memory.writeStruct(buffer, "i i f i", 1, 2, 3.5, 4.5))"), "invalid value 4"));
+    CHECK(contains(run(state, R"(Balltze.memory.writeStruct(buffer, "B f", 1, "text"))"), "invalid value 2"));
+    CHECK(contains(run(state, R"(Balltze.memory.writeStructArray(buffer, "i f", {1, 1.5, 2, 2.5, 3, {}}))"), "invalid value 6"));
+    CHECK(contains(run(state, R"(Balltze.memory.writeStructArray(buffer, "i i", {1, 2, 3, 4, 5}))"), "number of values"));
+    bool untouched = true;
+    for(auto byte : buffer) {
+        untouched = untouched && byte == 0xAA;
+    }
+    CHECK(untouched);
+
+    // Numbers given as strings or floats with an integer value are written like luaL_checkinteger takes them
+    CHECK(run(state, R"(Balltze.memory.writeStruct(buffer, "i f", "12", "0.5"))").empty());
+    CHECK(run(state, R"(Balltze.memory.writeStructArray(buffer, "i", {3.0}, 4))").empty());
+    float value;
+    std::memcpy(&value, buffer + 4, sizeof(value));
+    CHECK(buffer[0] == 3 && value == 0.5f);
+    lua_close(state);
+}
+
+TEST_CASE("invalid formats raise errors without leaking the parsed fields") {
+    std::uint8_t buffer[256] = {};
+    auto *state = new_state(buffer);
+    CHECK(contains(run(state, R"(Balltze.memory.readStruct(buffer, "i i3"))"), "invalid integer size 3"));
+    CHECK(contains(run(state, R"(Balltze.memory.writeStruct(buffer, "f q", 1, 2))"), "invalid option 'q'"));
+    CHECK(contains(run(state, R"(Balltze.memory.readStructArray(buffer, "fz", 2))"), "invalid option 'z'"));
+    CHECK(contains(run(state, R"(Balltze.memory.writeStructArray(buffer, "i9", {1}))"), "invalid integer size 9"));
+
+    // 256 fields are allowed, one more is not
+    CHECK(run(state, R"(assert(select("#", Balltze.memory.readStruct(buffer, string.rep("B", 256))) == 256))").empty());
+    CHECK(contains(run(state, R"(Balltze.memory.readStruct(buffer, string.rep("B", 257)))"), "too many fields"));
+    CHECK(contains(run(state, R"(Balltze.memory.readStruct(0, "i"))"), "invalid memory range"));
+    lua_close(state);
+}
+
+TEST_MAIN()
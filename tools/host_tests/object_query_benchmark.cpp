@@ -0,0 +1,252 @@
+// SPDX-License-Identifier: GPL-3.0-only
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+#include <lua.hpp>
+#include <plugins/lua/helpers/luacstruct.hpp>
+#include <plugins/lua/functions/engine/object_query.hpp>
+#include "object_table_stand_in.hpp"
+#include "host_test.hpp"
+
+using namespace Balltze::Engine;
+using namespace Balltze::Plugins::Lua;
+
+using EngineResourceHandle = ResourceHandle;
+using EnginePoint3D = Point3D;
+using EngineBaseObjectVitals = BaseObjectVitals;
+using EngineBaseObject = BaseObject;
+
+static void define_object_types(lua_State *state) noexcept {
+    luacs_newstruct(state, EngineResourceHandle);
+    luacs_unsigned_field(state, EngineResourceHandle, value, 0);
+    luacs_unsigned_field(state, EngineResourceHandle, id, 0);
+    luacs_unsigned_field(state, EngineResourceHandle, index, 0);
+    lua_pop(state, 1);
+
+    luacs_newstruct(state, EnginePoint3D);
+    luacs_float_field(state, EnginePoint3D, x, 0);
+    luacs_float_field(state, EnginePoint3D, y, 0);
+    luacs_float_field(state, EnginePoint3D, z, 0);
+    lua_pop(state, 1);
+
+    luacs_newstruct(state, EngineBaseObjectVitals);
+    luacs_float_field(state, EngineBaseObjectVitals, base_health, 0);
+    luacs_float_field(state, EngineBaseObjectVitals, base_shield, 0);
+    luacs_float_field(state, EngineBaseObjectVitals, health, 0);
+    luacs_float_field(state, EngineBaseObjectVitals, shield, 0);
+    lua_pop(state, 1);
+
+    luacs_newstruct(state, EngineBaseObject);
+    luacs_nested_field(state, EngineBaseObject, EngineResourceHandle, tag_handle, 0);
+    luacs_nested_field(state, EngineBaseObject, EnginePoint3D, position, 0);
+    luacs_nested_field(state, EngineBaseObject, EnginePoint3D, velocity, 0);
+    luacs_nested_field(state, EngineBaseObject, EnginePoint3D, center_position, 0);
+    luacs_unsigned_field(state, EngineBaseObject, type, 0);
+    luacs_unsigned_field(state, EngineBaseObject, team_owner, 0);
+    luacs_nested_field(state, EngineBaseObject, EngineResourceHandle, player, 0);
+    luacs_nested_field(state, EngineBaseObject, EngineBaseObjectVitals, vitals, 0);
+    lua_pop(state, 1);
+}
+
+/**
+ * Engine.gameState.getObject with an integer handle: one userdata per object
+ */
+static int lua_get_object(lua_State *state) noexcept {
+    ObjectHandle handle = static_cast<std::uint32_t>(luaL_checkinteger(state, 1));
+    auto *object = handle.id != 0 ? get_object_table().get_object(handle) : get_object_table().get_object(handle.index);
+    if(object) {
+        luacs_newobject(state, EngineBaseObject, object);
+    }
+    else {
+        lua_pushnil(state);
+    }
+    return 1;
+}
+
+/**
+ * Engine.gameState.queryObjects with object types given as integers
+ */
+static int lua_query_objects(lua_State *state) noexcept {
+    ObjectQuery query;
+    std::vector<ObjectQueryField> fields;
+    luaL_checktype(state, 1, LUA_TTABLE);
+
+    lua_getfield(state, 1, "types");
+    if(!lua_isnil(state, -1)) {
+        query.type_mask = 0;
+        auto count = lua_rawlen(state, -1);
+        for(std::size_t i = 1; i <= count; i++) {
+            lua_rawgeti(state, -1, i);
+            query.type_mask |= 1 << luaL_checkinteger(state, -1);
+            lua_pop(state, 1);
+        }
+    }
+    lua_pop(state, 1);
+
+    lua_getfield(state, 1, "team");
+    if(!lua_isnil(state, -1)) {
+        query.team = luaL_checkinteger(state, -1);
+    }
+    lua_pop(state, 1);
+
+    lua_getfield(state, 1, "origin");
+    if(!lua_isnil(state, -1)) {
+        Point3D origin;
+        lua_rawgeti(state, -1, 1);
+        origin.x = luaL_checknumber(state, -1);
+        lua_rawgeti(state, -2, 2);
+        origin.y = luaL_checknumber(state, -1);
+        lua_rawgeti(state, -3, 3);
+        origin.z = luaL_checknumber(state, -1);
+        lua_pop(state, 3);
+        query.origin = origin;
+        lua_getfield(state, 1, "radius");
+        query.radius = luaL_checknumber(state, -1);
+        lua_pop(state, 1);
+    }
+    lua_pop(state, 1);
+
+    lua_getfield(state, 1, "fields");
+    if(!lua_isnil(state, -1)) {
+        auto count = lua_rawlen(state, -1);
+        for(std::size_t i = 1; i <= count; i++) {
+            lua_rawgeti(state, -1, i);
+            auto field = object_query_field_from_name(luaL_checkstring(state, -1));
+            if(!field) {
+                return luaL_error(state, "unknown field");
+            }
+            fields.push_back(*field);
+            lua_pop(state, 1);
+        }
+    }
+    lua_pop(state, 1);
+
+    if(fields.empty()) {
+        fields.push_back(OBJECT_QUERY_FIELD_HANDLE);
+    }
+
+    static ObjectQueryResult objects;
+    query_objects(query, objects);
+    push_object_query_result(state, fields, objects);
+    return 1;
+}
+
+// Both functions return the number of bipeds and the sum of their positions and health, or of
+// the ones within 50 units of the origin that belong to team 1
+static const char *benchmark_script = R"(
+local tableSize = ...
+
+function bipedsWithGetObject()
+    local count, sum = 0, 0
+    for index = 0, tableSize - 1 do
+        local object = getObject(index)
+        if object and object.type == 0 then
+            local position = object.position
+            sum = sum + position.x + position.y + position.z + object.vitals.health
+            count = count + 1
+        end
+    end
+    return count, sum
+end
+
+function bipedsWithQueryObjects()
+    local result = queryObjects({types = {0}, fields = {"position", "health"}})
+    local position, health = result.position, result.health
+    local sum = 0
+    for i = 1, result.count do
+        local j = (i - 1) * 3
+        sum = sum + position[j + 1] + position[j + 2] + position[j + 3] + health[i]
+    end
+    return result.count, sum
+end
+
+function nearbyWithGetObject()
+    local count, sum = 0, 0
+    for index = 0, tableSize - 1 do
+        local object = getObject(index)
+        if object and object.teamOwner == 1 then
+            local center = object.centerPosition
+            if center.x * center.x + center.y * center.y + center.z * center.z <= 50 * 50 then
+                sum = sum + object.tagHandle.value
+                count = count + 1
+            end
+        end
+    end
+    return count, sum
+end
+
+function nearbyWithQueryObjects()
+    local result = queryObjects({team = 1, origin = {0, 0, 0}, radius = 50, fields = {"tagHandle"}})
+    local sum = 0
+    for i = 1, result.count do
+        sum = sum + result.tagHandle[i]
+    end
+    return result.count, sum
+end
+)";
+
+static std::pair<lua_Integer, lua_Number> call(lua_State *state, const char *function) {
+    lua_getglobal(state, function);
+    if(lua_pcall(state, 0, 2, 0) != LUA_OK) {
+        std::fprintf(stderr, "%s: %s\n", function, lua_tostring(state, -1));
+        std::exit(EXIT_FAILURE);
+    }
+    std::pair<lua_Integer, lua_Number> result = {lua_tointeger(state, -2), lua_tonumber(state, -1)};
+    lua_pop(state, 2);
+    return result;
+}
+
+/**
+ * Read objects of a synthetic object table from Lua with a getObject loop and with queryObjects; usage:
+ *   object_query_benchmark [--quick] [--objects N] [--iterations N]
+ */
+int main(int argc, const char **argv) {
+    bool quick = HostTest::quick_run(argc, argv);
+    std::size_t table_size = 2048;
+    std::size_t iterations = quick ? 2 : 500;
+    for(int i = 1; i + 1 < argc; i++) {
+        if(std::strcmp(argv[i], "--objects") == 0) {
+            table_size = std::strtoull(argv[i + 1], nullptr, 10);
+        }
+        else if(std::strcmp(argv[i], "--iterations") == 0) {
+            iterations = std::strtoull(argv[i + 1], nullptr, 10);
+        }
+    }
+
+    HostTest::SyntheticObjectTable table(table_size, 1234);
+
+    auto *state = luaL_newstate();
+    luaL_openlibs(state);
+    define_object_types(state);
+    lua_register(state, "getObject", lua_get_object);
+    lua_register(state, "queryObjects", lua_query_objects);
+    if(luaL_loadstring(state, benchmark_script) != LUA_OK) {
+        std::fprintf(stderr, "%s\n", lua_tostring(state, -1));
+        return EXIT_FAILURE;
+    }
+    lua_pushinteger(state, table_size);
+    lua_call(state, 1, 0);
+
+    // Both ways of reading the objects have to see the same ones
+    int result = EXIT_SUCCESS;
+    for(auto [loop, query] : {std::pair{"bipedsWithGetObject", "bipedsWithQueryObjects"}, std::pair{"nearbyWithGetObject", "nearbyWithQueryObjects"}}) {
+        auto expected = call(state, loop);
+        auto actual = call(state, query);
+        if(expected != actual || expected.first == 0) {
+            std::fprintf(stderr, "%s returned %lld objects (%f), %s returned %lld (%f)\n", loop, static_cast<long long>(expected.first), expected.second, query, static_cast<long long>(actual.first), actual.second);
+            result = EXIT_FAILURE;
+        }
+    }
+
+    std::printf("%zu objects, %lld bipeds\n", table_size, static_cast<long long>(call(state, "bipedsWithQueryObjects").first));
+    for(auto *function : {"bipedsWithGetObject", "bipedsWithQueryObjects", "nearbyWithGetObject", "nearbyWithQueryObjects"}) {
+        HostTest::benchmark(function, iterations, table_size, [&]() {
+            HostTest::do_not_optimize(call(state, function));
+        });
+    }
+
+    lua_close(state);
+    return result;
+}
@@ -0,0 +1,132 @@
+// SPDX-License-Identifier: GPL-3.0-only
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <vector>
+#include <balltze/features/object_spatial_index.hpp>
+#include <balltze/math.hpp>
+#include "object_table_stand_in.hpp"
+#include "host_test.hpp"
+
+using namespace Balltze;
+using namespace Balltze::Engine;
+
+/**
+ * What a script does without the index: walk the whole object table
+ */
+static std::vector<ObjectHandle> scan_radius(Point3D const &center, float radius) {
+    std::vector<ObjectHandle> objects;
+    auto &table = get_object_table();
+    for(std::size_t i = 0; i < table.current_size; i++) {
+        auto &entry = table.first_element[i];
+        if(entry.id != 0 && entry.object && Math::distance_squared(entry.object->center_position, center) <= radius * radius) {
+            ObjectHandle handle;
+            handle.index = i;
+            handle.id = entry.id;
+            objects.push_back(handle);
+        }
+    }
+    return objects;
+}
+
+static std::vector<ObjectHandle> scan_nearest(Point3D const &point, std::size_t count) {
+    std::vector<std::pair<float, ObjectHandle>> candidates;
+    auto &table = get_object_table();
+    for(std::size_t i = 0; i < table.current_size; i++) {
+        auto &entry = table.first_element[i];
+        if(entry.id != 0 && entry.object) {
+            ObjectHandle handle;
+            handle.index = i;
+            handle.id = entry.id;
+            candidates.emplace_back(Math::distance_squared(entry.object->center_position, point), handle);
+        }
+    }
+    count = std::min(count, candidates.size());
+    std::partial_sort(candidates.begin(), candidates.begin() + count, candidates.end(), [](auto const &a, auto const &b) {
+        return a.first < b.first;
+    });
+    std::vector<ObjectHandle> objects;
+    for(std::size_t i = 0; i < count; i++) {
+        objects.push_back(candidates[i].second);
+    }
+    return objects;
+}
+
+/**
+ * Queries of the spatial index over a synthetic object table, against walking the table; usage:
+ *   object_spatial_index_benchmark [--quick] [--objects N] [--extent UNITS] [--queries N]
+ */
+int main(int argc, const char **argv) {
+    bool quick = HostTest::quick_run(argc, argv);
+    std::size_t object_count = 2048;
+    float extent = 100.0f;
+    std::size_t query_count = 64;
+    for(int i = 1; i + 1 < argc; i++) {
+        if(std::strcmp(argv[i], "--objects") == 0) {
+            object_count = std::strtoull(argv[i + 1], nullptr, 10);
+        }
+        else if(std::strcmp(argv[i], "--extent") == 0) {
+            extent = std::strtof(argv[i + 1], nullptr);
+        }
+        else if(std::strcmp(argv[i], "--queries") == 0) {
+            query_count = std::strtoull(argv[i + 1], nullptr, 10);
+        }
+    }
+    std::size_t iterations = quick ? 2 : 200;
+
+    HostTest::SyntheticObjectTable table(object_count, 1234, extent);
+    std::mt19937 random(5678);
+    std::uniform_real_distribution<float> coordinate(-extent, extent);
+    std::vector<Point3D> points(query_count);
+    for(auto &point : points) {
+        point = {coordinate(random), coordinate(random), coordinate(random)};
+    }
+
+    std::size_t tick = 1;
+    HostTest::set_tick_count(tick);
+    std::printf("%zu objects in a cube of %.0f units, %zu queries per call\n", object_count, extent * 2.0f, query_count);
+
+    HostTest::benchmark("rebuild and one radius query", iterations, object_count, [&]() {
+        HostTest::set_tick_count(++tick);
+        HostTest::do_not_optimize(Features::find_objects_in_radius(points[0], 5.0f));
+    });
+
+    for(float radius : {5.0f, 20.0f}) {
+        char name[64];
+        std::snprintf(name, sizeof(name), "radius %.0f, index", radius);
+        HostTest::benchmark(name, iterations, query_count, [&]() {
+            for(auto &point : points) {
+                HostTest::do_not_optimize(Features::find_objects_in_radius(point, radius));
+            }
+        });
+        std::snprintf(name, sizeof(name), "radius %.0f, table walk", radius);
+        HostTest::benchmark(name, iterations, query_count, [&]() {
+            for(auto &point : points) {
+                HostTest::do_not_optimize(scan_radius(point, radius));
+            }
+        });
+    }
+
+    HostTest::benchmark("nearest 8, index", iterations, query_count, [&]() {
+        for(auto &point : points) {
+            HostTest::do_not_optimize(Features::find_nearest_objects(point, 8));
+        }
+    });
+    HostTest::benchmark("nearest 8, table walk", iterations, query_count, [&]() {
+        for(auto &point : points) {
+            HostTest::do_not_optimize(scan_nearest(point, 8));
+        }
+    });
+
+    // Both have to find the same objects
+    for(auto &point : points) {
+        if(Features::find_nearest_objects(point, 1) != scan_nearest(point, 1)) {
+            std::fprintf(stderr, "the index and the table walk found different nearest objects\n");
+            return EXIT_FAILURE;
+        }
+    }
+    return EXIT_SUCCESS;
+}
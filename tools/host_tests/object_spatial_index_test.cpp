@@ -0,0 +1,198 @@
+// SPDX-License-Identifier: GPL-3.0-only
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <random>
+#include <vector>
+#include <balltze/events/map_load.hpp>
+#include <balltze/features/object_spatial_index.hpp>
+#include <balltze/math.hpp>
+#include "object_table_stand_in.hpp"
+#include "host_test.hpp"
+
+using namespace Balltze;
+using namespace Balltze::Engine;
+
+constexpr std::size_t object_count = 2500;
+constexpr float infinity = std::numeric_limits<float>::infinity();
+constexpr float not_a_number = std::numeric_limits<float>::quiet_NaN();
+
+static std::size_t tick = 0;
+
+/**
+ * Start a new tick, so the next query rebuilds the index
+ */
+static void next_tick() {
+    HostTest::set_tick_count(++tick);
+}
+
+static std::vector<std::uint32_t> sorted_values(std::vector<ObjectHandle> const &handles) {
+    std::vector<std::uint32_t> values;
+    for(auto &handle : handles) {
+        values.push_back(handle.value);
+    }
+    std::sort(values.begin(), values.end());
+    return values;
+}
+
+/**
+ * Handles of the live objects with a finite center that pass a filter, walking the whole table
+ */
+template<typename Filter>
+static std::vector<std::uint32_t> scan(HostTest::SyntheticObjectTable const &table, Filter filter) {
+    std::vector<std::uint32_t> values;
+    for(std::size_t i = 0; i < table.entries.size(); i++) {
+        auto *object = table.entries[i].object;
+        if(!object) {
+            continue;
+        }
+        auto &position = object->center_position;
+        if(std::isfinite(position.x) && std::isfinite(position.y) && std::isfinite(position.z) && filter(position)) {
+            values.push_back(table.handle(i).value);
+        }
+    }
+    std::sort(values.begin(), values.end());
+    return values;
+}
+
+static bool in_box(Point3D const &position, Point3D const &min, Point3D const &max) {
+    return position.x >= min.x && position.x <= max.x && position.y >= min.y && position.y <= max.y && position.z >= min.z && position.z <= max.z;
+}
+
+TEST_CASE("radius queries find the same objects as a scan of the table") {
+    HostTest::SyntheticObjectTable table(object_count, 1);
+    next_tick();
+    std::mt19937 random(2);
+    std::uniform_real_distribution<float> coordinate(-120.0f, 120.0f);
+    std::uniform_real_distribution<float> radius(0.0f, 40.0f);
+    for(int i = 0; i < 200; i++) {
+        Point3D center = {coordinate(random), coordinate(random), coordinate(random)};
+        auto r = radius(random);
+        auto expected = scan(table, [&](Point3D const &position) { return Math::distance_squared(position, center) <= r * r; });
+        CHECK(sorted_values(Features::find_objects_in_radius(center, r)) == expected);
+    }
+    CHECK(Features::find_objects_in_radius({0.0f, 0.0f, 0.0f}, -1.0f).empty());
+}
+
+TEST_CASE("box queries find the same objects as a scan of the table") {
+    HostTest::SyntheticObjectTable table(object_count, 3);
+    next_tick();
+    std::mt19937 random(4);
+    std::uniform_real_distribution<float> coordinate(-120.0f, 120.0f);
+    std::uniform_real_distribution<float> size(0.0f, 60.0f);
+    for(int i = 0; i < 200; i++) {
+        Point3D min = {coordinate(random), coordinate(random), coordinate(random)};
+        Point3D max = {min.x + size(random), min.y + size(random), min.z + size(random)};
+        auto expected = scan(table, [&](Point3D const &position) { return in_box(position, min, max); });
+        CHECK(sorted_values(Features::find_objects_in_box(min, max)) == expected);
+    }
+}
+
+TEST_CASE("nearest objects are the closest ones, closest first") {
+    HostTest::SyntheticObjectTable table(object_count, 5);
+    next_tick();
+    std::mt19937 random(6);
+    std::uniform_real_distribution<float> coordinate(-150.0f, 150.0f);
+    for(int i = 0; i < 100; i++) {
+        Point3D point = {coordinate(random), coordinate(random), coordinate(random)};
+        std::size_t count = 1 + random() % 16;
+        float max_distance = i % 2 == 0 ? infinity : 30.0f;
+
+        std::vector<float> expected;
+        scan(table, [&](Point3D const &position) {
+            auto distance = Math::distance_squared(position, point);
+            if(distance <= max_distance * max_distance) {
+                expected.push_back(distance);
+            }
+            return false;
+        });
+        std::sort(expected.begin(), expected.end());
+        expected.resize(std::min(expected.size(), count));
+
+        std::vector<float> found;
+        for(auto &handle : Features::find_nearest_objects(point, count, max_distance)) {
+            auto *object = get_object_table().get_object(handle);
+            CHECK(object != nullptr);
+            if(object) {
+                found.push_back(Math::distance_squared(object->center_position, point));
+            }
+        }
+        CHECK(found == expected);
+    }
+}
+
+TEST_CASE("queries with non-finite bounds do not reach the float to integer conversion") {
+    HostTest::SyntheticObjectTable table(object_count, 7);
+    next_tick();
+    auto everything = scan(table, [](Point3D const &) { return true; });
+    CHECK(!everything.empty());
+
+    // NaN never matches anything
+    CHECK(Features::find_objects_in_radius({not_a_number, 0.0f, 0.0f}, 10.0f).empty());
+    CHECK(Features::find_objects_in_radius({0.0f, 0.0f, 0.0f}, not_a_number).empty());
+    CHECK(Features::find_objects_in_box({not_a_number, not_a_number, not_a_number}, {1.0f, 1.0f, 1.0f}).empty());
+    CHECK(Features::find_objects_in_box({-1.0f, -1.0f, -1.0f}, {1.0f, not_a_number, 1.0f}).empty());
+    CHECK(Features::find_nearest_objects({0.0f, not_a_number, 0.0f}, 4).empty());
+    CHECK(Features::find_nearest_objects({0.0f, 0.0f, 0.0f}, 4, not_a_number).empty());
+
+    // Infinite bounds cover the whole grid
+    CHECK(sorted_values(Features::find_objects_in_radius({0.0f, 0.0f, 0.0f}, infinity)) == everything);
+    CHECK(sorted_values(Features::find_objects_in_box({-infinity, -infinity, -infinity}, {infinity, infinity, infinity})) == everything);
+    CHECK(Features::find_objects_in_box({infinity, 0.0f, 0.0f}, {infinity, 1.0f, 1.0f}).empty());
+    CHECK(Features::find_nearest_objects({0.0f, 0.0f, 0.0f}, everything.size() + 10).size() == everything.size());
+    CHECK(Features::find_nearest_objects({infinity, 0.0f, 0.0f}, 1).size() == 1);
+
+    // Finite values beyond the range of the cell coordinates
+    CHECK(sorted_values(Features::find_objects_in_box({-1e30f, -1e30f, -1e30f}, {1e30f, 1e30f, 1e30f})) == everything);
+    CHECK(Features::find_objects_in_radius({3e38f, -3e38f, 3e38f}, 1.0f).empty());
+}
+
+TEST_CASE("objects with a non-finite center are not indexed") {
+    HostTest::SyntheticObjectTable table(object_count, 8);
+    table.objects[0].center_position.x = not_a_number;
+    table.objects[1].center_position.y = infinity;
+    table.objects[2].center_position.z = -infinity;
+    table.objects[3].center_position = {1e30f, -1e30f, 1e30f};
+    for(std::size_t i = 0; i < 4; i++) {
+        table.entries[i].id = 0xE000 + i;
+        table.entries[i].object = &table.objects[i];
+    }
+    next_tick();
+
+    auto found = sorted_values(Features::find_objects_in_box({-infinity, -infinity, -infinity}, {infinity, infinity, infinity}));
+    CHECK(found == scan(table, [](Point3D const &) { return true; }));
+    for(std::size_t i = 0; i < 3; i++) {
+        CHECK(!std::binary_search(found.begin(), found.end(), table.handle(i).value));
+    }
+    CHECK(std::binary_search(found.begin(), found.end(), table.handle(3).value));
+}
+
+TEST_CASE("the index is rebuilt once per tick and when a map is loaded") {
+    static bool set_up = false;
+    if(!set_up) {
+        Features::set_up_object_spatial_index();
+        set_up = true;
+    }
+
+    HostTest::SyntheticObjectTable table(64, 9);
+    table.entries[0].id = 0xE000;
+    table.entries[0].object = &table.objects[0];
+    table.objects[0].center_position = {500.0f, 500.0f, 500.0f};
+    next_tick();
+    CHECK(Features::find_objects_in_radius({500.0f, 500.0f, 500.0f}, 1.0f).size() == 1);
+
+    // Moving an object is only seen on the next tick
+    table.objects[0].center_position = {-500.0f, -500.0f, -500.0f};
+    CHECK(Features::find_objects_in_radius({500.0f, 500.0f, 500.0f}, 1.0f).size() == 1);
+    next_tick();
+    CHECK(Features::find_objects_in_radius({500.0f, 500.0f, 500.0f}, 1.0f).empty());
+    CHECK(Features::find_objects_in_radius({-500.0f, -500.0f, -500.0f}, 1.0f).size() == 1);
+
+    // The tick count starts over with a new map, and may land on the tick the index was built on
+    table.objects[0].center_position = {500.0f, 500.0f, 500.0f};
+    Event::MapLoadEvent().dispatch();
+    CHECK(Features::find_objects_in_radius({500.0f, 500.0f, 500.0f}, 1.0f).size() == 1);
+}
+
+TEST_MAIN()
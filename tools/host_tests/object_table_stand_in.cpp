@@ -0,0 +1,52 @@
+// SPDX-License-Identifier: GPL-3.0-only
+
+#include <random>
+#include <balltze/engine/core.hpp>
+#include "object_table_stand_in.hpp"
+
+using namespace Balltze::Engine;
+
+static ObjectTable object_table = {};
+static std::size_t tick_count = 0;
+
+ObjectTable &Balltze::Engine::get_object_table() noexcept {
+    return object_table;
+}
+
+std::size_t Balltze::Engine::get_tick_count() noexcept {
+    return tick_count;
+}
+
+namespace HostTest {
+    SyntheticObjectTable::SyntheticObjectTable(std::size_t size, std::uint32_t seed, float extent) : objects(size), entries(size) {
+        std::mt19937 random(seed);
+        std::uniform_real_distribution<float> coordinate(-extent, extent);
+        std::uniform_real_distribution<float> ratio(0.0f, 1.0f);
+        for(std::size_t i = 0; i < size; i++) {
+            auto &object = objects[i];
+            object.tag_handle = 0xE0000000 + (random() % 64);
+            object.position = {coordinate(random), coordinate(random), coordinate(random)};
+            object.velocity = {ratio(random), ratio(random), ratio(random)};
+            object.center_position = {object.position.x, object.position.y, object.position.z + 0.5f};
+            object.type = static_cast<ObjectType>(random() % (OBJECT_TYPE_SOUND_SCENERY + 1));
+            object.team_owner = random() % 4;
+            object.player = ResourceHandle::null();
+            object.vitals = {75.0f, 100.0f, ratio(random), ratio(random)};
+            entries[i].id = random() % 8 == 0 ? 0 : 0xE000 + i;
+            entries[i].object = entries[i].id == 0 ? nullptr : &object;
+        }
+        object_table.current_size = size;
+        object_table.first_element = entries.data();
+    }
+
+    ObjectHandle SyntheticObjectTable::handle(std::size_t index) const noexcept {
+        ObjectHandle handle;
+        handle.index = index;
+        handle.id = entries[index].id;
+        return handle;
+    }
+
+    void set_tick_count(std::size_t count) noexcept {
+        tick_count = count;
+    }
+}
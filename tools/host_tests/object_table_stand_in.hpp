@@ -0,0 +1,44 @@
+// SPDX-License-Identifier: GPL-3.0-only
+
+#ifndef BALLTZE_HOST_TESTS__OBJECT_TABLE_STAND_IN_HPP
+#define BALLTZE_HOST_TESTS__OBJECT_TABLE_STAND_IN_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include <balltze/engine/game_state.hpp>
+
+/**
+ * In-memory stand-in for the object table and the tick count of the engine
+ */
+namespace HostTest {
+    /**
+     * Object table with a mix of object types and some free slots, like the one of a busy map.
+     * It becomes the object table returned by get_object_table() until another one is built.
+     */
+    struct SyntheticObjectTable {
+        std::vector<Balltze::Engine::BaseObject> objects;
+        std::vector<Balltze::Engine::ObjectTableEntry> entries;
+
+        /**
+         * @param size      Number of slots of the table
+         * @param seed      Seed of the object types, positions and free slots
+         * @param extent    Objects are placed in a cube from -extent to extent
+         */
+        SyntheticObjectTable(std::size_t size, std::uint32_t seed, float extent = 100.0f);
+
+        SyntheticObjectTable(SyntheticObjectTable const &) = delete;
+
+        /**
+         * Handle of the object in a slot
+         */
+        Balltze::Engine::ObjectHandle handle(std::size_t index) const noexcept;
+    };
+
+    /**
+     * Set the value returned by get_tick_count()
+     */
+    void set_tick_count(std::size_t tick_count) noexcept;
+}
+
+#endif
@@ -0,0 +1,276 @@
+// SPDX-License-Identifier: GPL-3.0-only
+
+#include <cstdint>
+#include <cstring>
+#include <optional>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include <invader/sound/sound_reader.hpp>
+#include <engine/sound_permutation_pcm_size.hpp>
+#include "host_test.hpp"
+
+using namespace Balltze::Engine;
+using Invader::SoundReader::Sound;
+
+/**
+ * Size of the samples a decoder returns, or its error
+ */
+struct SizeOrError {
+    std::size_t size = 0;
+    std::string error;
+
+    bool operator==(SizeOrError const &other) const = default;
+};
+
+template<typename Function>
+static SizeOrError size_or_error(Function const &function) {
+    try {
+        return {function(), {}};
+    }
+    catch(std::runtime_error &e) {
+        return {0, e.what()};
+    }
+}
+
+static std::vector<std::byte> random_bytes(std::mt19937 &random, std::size_t size) {
+    std::vector<std::byte> bytes(size);
+    for(auto &byte : bytes) {
+        byte = static_cast<std::byte>(random());
+    }
+    return bytes;
+}
+
+/**
+ * Check the size of every sample data size up to a limit against decoding the samples
+ */
+template<typename Decode>
+static void check_against_decoder(TagDefinitions::SoundFormat format, std::size_t channel_count, std::size_t max_size, Decode const &decode) {
+    std::mt19937 random(49 + format * 2 + channel_count);
+    std::size_t different = 0;
+    std::size_t decoded = 0;
+    for(std::size_t size = 0; size <= max_size; size++) {
+        auto samples = random_bytes(random, size);
+        auto expected = size_or_error([&]() {
+            Sound sound = decode(samples.data(), samples.size(), channel_count, 22050);
+            return sound.pcm.size();
+        });
+        auto computed = size_or_error([&]() {
+            return get_sound_permutation_pcm_size(format, samples.size(), channel_count);
+        });
+        if(computed != expected) {
+            std::fprintf(stderr, "%zu bytes of %zu channels: %zu \"%s\" instead of %zu \"%s\"\n", size, channel_count, computed.size, computed.error.c_str(), expected.size, expected.error.c_str());
+            different++;
+        }
+        if(expected.error.empty()) {
+            decoded++;
+        }
+    }
+    CHECK(different == 0);
+
+    // Both valid and invalid sizes were covered
+    CHECK(decoded > 1 && decoded < max_size);
+}
+
+TEST_CASE("16-bit PCM sizes are those of the decoded samples") {
+    check_against_decoder(TagDefinitions::SOUND_FORMAT_16_BIT_PCM, 1, 1000, Invader::SoundReader::sound_from_16_bit_pcm_big_endian);
+    check_against_decoder(TagDefinitions::SOUND_FORMAT_16_BIT_PCM, 2, 1000, Invader::SoundReader::sound_from_16_bit_pcm_big_endian);
+}
+
+TEST_CASE("Xbox ADPCM sizes are those of the decoded samples") {
+    // Stereo data can end with the first half of a block, which is not decoded
+    check_against_decoder(TagDefinitions::SOUND_FORMAT_XBOX_ADPCM, 1, 36 * 40, Invader::SoundReader::sound_from_xbox_adpcm);
+    check_against_decoder(TagDefinitions::SOUND_FORMAT_XBOX_ADPCM, 2, 36 * 40, Invader::SoundReader::sound_from_xbox_adpcm);
+    CHECK(get_sound_permutation_pcm_size(TagDefinitions::SOUND_FORMAT_XBOX_ADPCM, 36 * 3, 2) == 128 * 2);
+    CHECK(get_sound_permutation_pcm_size(TagDefinitions::SOUND_FORMAT_XBOX_ADPCM, 36 * 3, 1) == 128 * 3);
+}
+
+TEST_CASE("formats that are decoded to get their duration are not sized") {
+    for(auto format : {TagDefinitions::SOUND_FORMAT_IMA_ADPCM, TagDefinitions::SOUND_FORMAT_OGG_VORBIS}) {
+        auto result = size_or_error([&]() {
+            return get_sound_permutation_pcm_size(format, 36 * 4, 1);
+        });
+        CHECK(result.error == "Invalid sound format");
+    }
+}
+
+/**
+ * Writer of Ogg pages, with the CRC of the format
+ */
+class OggWriter {
+public:
+    /**
+     * Add a page holding a body, laced into segments of 255 bytes
+     */
+    void page(std::uint32_t serial, std::uint64_t granule_position, std::uint8_t header_type, std::vector<std::uint8_t> const &body) {
+        std::vector<std::uint8_t> page = {'O', 'g', 'g', 'S', 0, header_type};
+        append_little_endian(page, granule_position);
+        append_little_endian(page, serial);
+        append_little_endian(page, m_sequence[serial]++);
+        append_little_endian(page, std::uint32_t{0});
+        std::size_t segment_count = body.size() / 255 + 1;
+        if(segment_count > 255) {
+            throw std::logic_error("Ogg page body is too long");
+        }
+        page.push_back(static_cast<std::uint8_t>(segment_count));
+        for(std::size_t i = 0; i + 1 < segment_count; i++) {
+            page.push_back(255);
+        }
+        page.push_back(static_cast<std::uint8_t>(body.size() % 255));
+        page.insert(page.end(), body.begin(), body.end());
+
+        auto crc = page_crc(page);
+        std::memcpy(page.data() + 22, &crc, sizeof(crc));
+        for(auto byte : page) {
+            m_data.push_back(static_cast<std::byte>(byte));
+        }
+    }
+
+    /**
+     * Add the identification and setup pages of a Vorbis stream
+     */
+    void vorbis_headers(std::uint32_t serial, std::uint32_t sample_rate, std::uint8_t packet_type = 1) {
+        std::vector<std::uint8_t> identification = {packet_type, 'v', 'o', 'r', 'b', 'i', 's'};
+        append_little_endian(identification, std::uint32_t{0});
+        identification.push_back(2);
+        append_little_endian(identification, sample_rate);
+        append_little_endian(identification, std::uint32_t{0});
+        append_little_endian(identification, std::uint32_t{128000});
+        append_little_endian(identification, std::uint32_t{0});
+        identification.push_back(0xB8);
+        identification.push_back(1);
+        page(serial, 0, 0x02, identification);
+
+        // The comment and setup headers are not read
+        std::vector<std::uint8_t> setup = {3, 'v', 'o', 'r', 'b', 'i', 's'};
+        setup.resize(600, 0x5A);
+        page(serial, 0, 0x00, setup);
+    }
+
+    std::vector<std::byte> &data() noexcept {
+        return m_data;
+    }
+
+private:
+    std::vector<std::byte> m_data;
+    std::vector<std::uint32_t> m_sequence = std::vector<std::uint32_t>(16);
+
+    template<typename T>
+    static void append_little_endian(std::vector<std::uint8_t> &data, T value) {
+        for(std::size_t i = 0; i < sizeof(T); i++) {
+            data.push_back(static_cast<std::uint8_t>(value >> (i * 8)));
+        }
+    }
+
+    static std::uint32_t page_crc(std::vector<std::uint8_t> const &page) {
+        std::uint32_t crc = 0;
+        for(auto byte : page) {
+            crc ^= static_cast<std::uint32_t>(byte) << 24;
+            for(int bit = 0; bit < 8; bit++) {
+                crc = crc & 0x80000000 ? (crc << 1) ^ 0x04C11DB7 : crc << 1;
+            }
+        }
+        return crc;
+    }
+};
+
+/**
+ * Audio pages of a Vorbis stream; bodies are random, with the capture pattern now and then
+ */
+static void vorbis_audio(OggWriter &writer, std::mt19937 &random, std::uint32_t serial, std::uint64_t last_granule_position, std::size_t page_count, std::size_t last_body_size = 0) {
+    for(std::size_t i = 1; i <= page_count; i++) {
+        bool last = i == page_count;
+        std::vector<std::uint8_t> body(last && last_body_size ? last_body_size : 200 + random() % 4000);
+        for(auto &byte : body) {
+            byte = static_cast<std::uint8_t>(random());
+        }
+        if(body.size() > 64 && random() % 2) {
+            std::memcpy(body.data() + random() % (body.size() - 32), "OggS", 4);
+        }
+        writer.page(serial, last_granule_position * i / page_count, last ? 0x04 : 0x00, body);
+    }
+}
+
+static std::optional<double> duration_of(std::vector<std::byte> const &data) {
+    return Invader::SoundReader::ogg_vorbis_samples_duration_from_granule(data.data(), data.size());
+}
+
+TEST_CASE("Ogg Vorbis durations come from the granule position of the last page") {
+    std::mt19937 random(49);
+    for(std::uint32_t sample_rate : {22050U, 44100U, 48000U}) {
+        OggWriter writer;
+        writer.vorbis_headers(1, sample_rate);
+        vorbis_audio(writer, random, 1, 1234567, 20);
+        auto duration = duration_of(writer.data());
+        CHECK(duration.has_value() && *duration == 1234567.0 / sample_rate);
+    }
+
+    // The last page is as long as a page can be
+    OggWriter writer;
+    writer.vorbis_headers(1, 44100);
+    vorbis_audio(writer, random, 1, 441000, 3, 254 * 255 + 254);
+    auto duration = duration_of(writer.data());
+    CHECK(duration.has_value() && *duration == 10.0);
+
+    // A stream of headers only
+    OggWriter empty;
+    empty.vorbis_headers(1, 44100);
+    duration = duration_of(empty.data());
+    CHECK(duration.has_value() && *duration == 0.0);
+}
+
+TEST_CASE("chained Ogg Vorbis streams are left to the decoder") {
+    std::mt19937 random(49);
+    OggWriter writer;
+    writer.vorbis_headers(1, 44100);
+    vorbis_audio(writer, random, 1, 44100, 5);
+    writer.vorbis_headers(2, 22050);
+    vorbis_audio(writer, random, 2, 22050, 5);
+    CHECK(!duration_of(writer.data()).has_value());
+}
+
+TEST_CASE("truncated Ogg Vorbis streams are left to the decoder") {
+    std::mt19937 random(49);
+    OggWriter writer;
+    writer.vorbis_headers(1, 44100);
+    vorbis_audio(writer, random, 1, 441000, 10, 3000);
+    auto &data = writer.data();
+    CHECK(duration_of(data).has_value());
+
+    // The last page is cut anywhere in its header, segment table or body
+    for(std::size_t cut : {1, 2, 100, 2999, 3000, 3011, 3020, 3030}) {
+        std::vector<std::byte> truncated(data.begin(), data.end() - cut);
+        CHECK(!duration_of(truncated).has_value());
+    }
+
+    // Bytes after the last page
+    std::vector<std::byte> trailing = data;
+    trailing.resize(trailing.size() + 5);
+    CHECK(!duration_of(trailing).has_value());
+
+    // The last page has no granule position
+    OggWriter no_granule;
+    no_granule.vorbis_headers(1, 44100);
+    no_granule.page(1, UINT64_MAX, 0x04, std::vector<std::uint8_t>(500, 1));
+    CHECK(!duration_of(no_granule.data()).has_value());
+}
+
+TEST_CASE("streams other than Vorbis are left to the decoder") {
+    std::mt19937 random(49);
+    OggWriter not_vorbis;
+    not_vorbis.vorbis_headers(1, 44100, 5);
+    vorbis_audio(not_vorbis, random, 1, 44100, 2);
+    CHECK(!duration_of(not_vorbis.data()).has_value());
+
+    OggWriter no_sample_rate;
+    no_sample_rate.vorbis_headers(1, 0);
+    vorbis_audio(no_sample_rate, random, 1, 44100, 2);
+    CHECK(!duration_of(no_sample_rate.data()).has_value());
+
+    CHECK(!duration_of({}).has_value());
+    CHECK(!duration_of(random_bytes(random, 20)).has_value());
+    CHECK(!duration_of(random_bytes(random, 5000)).has_value());
+}
+
+TEST_MAIN()
@@ -0,0 +1,10 @@
+/* SPDX-License-Identifier: GPL-3.0-only */
+
+#include <stdio.h>
+#include <string.h>
+#include "strerror_s.h"
+
+int strerror_s(char *buffer, size_t size, int error) {
+    snprintf(buffer, size, "%s", strerror(error));
+    return 0;
+}
@@ -0,0 +1,11 @@
+/* SPDX-License-Identifier: GPL-3.0-only */
+
+#ifndef BALLTZE_HOST_TESTS__STRERROR_S_H
+#define BALLTZE_HOST_TESTS__STRERROR_S_H
+
+#include <stddef.h>
+
+/* strerror_s is only in the Windows C runtime; luacstruct uses it when an allocation fails */
+int strerror_s(char *buffer, size_t size, int error);
+
+#endif
@@ -0,0 +1,39 @@
+// SPDX-License-Identifier: GPL-3.0-only
+
+#ifndef BALLTZE_HOST_TESTS__STUBS__ENGINE__SCRIPT_HPP
+#define BALLTZE_HOST_TESTS__STUBS__ENGINE__SCRIPT_HPP
+
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * Stand-in for the script function entries of the engine. The real header describes the 32-bit game
+ * memory and does not build on the host; this one has the same members with the host pointer size.
+ */
+namespace Balltze::Engine {
+    enum HscDataType : std::uint16_t {
+        HSC_DATA_TYPE_PASSTHROUGH = 3,
+        HSC_DATA_TYPE_VOID,
+        HSC_DATA_TYPE_BOOLEAN,
+        HSC_DATA_TYPE_REAL,
+        HSC_DATA_TYPE_SHORT,
+        HSC_DATA_TYPE_LONG,
+        HSC_DATA_TYPE_STRING
+    };
+
+    struct HscFunctionEntry {
+        HscDataType return_type;
+        const char *name;
+        void *console_function;
+        void *script_function;
+        const char *help_message;
+        const char *help_parameters;
+
+        /** Named like the padding of the real header, which is written to */
+        std::byte gap_72[0x2];
+
+        std::uint16_t parameter_count;
+    };
+}
+
+#endif
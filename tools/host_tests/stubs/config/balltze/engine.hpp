@@ -0,0 +1,9 @@
+// SPDX-License-Identifier: GPL-3.0-only
+
+#ifndef BALLTZE_HOST_TESTS__STUBS__ENGINE_HPP
+#define BALLTZE_HOST_TESTS__STUBS__ENGINE_HPP
+
+// Only the core functions; the rest of the engine headers need Direct3D
+#include <balltze/engine/core.hpp>
+
+#endif
@@ -0,0 +1,15 @@
+// SPDX-License-Identifier: GPL-3.0-only
+
+#ifndef BALLTZE_HOST_TESTS__STUBS__ENGINE__CORE_HPP
+#define BALLTZE_HOST_TESTS__STUBS__ENGINE__CORE_HPP
+
+#include <cstddef>
+
+namespace Balltze::Engine {
+    /**
+     * Ticks since the map was loaded; set by the object table stand-in
+     */
+    std::size_t get_tick_count() noexcept;
+}
+
+#endif
@@ -0,0 +1,114 @@
+// SPDX-License-Identifier: GPL-3.0-only
+
+#ifndef BALLTZE_HOST_TESTS__STUBS__ENGINE__GAME_STATE_HPP
+#define BALLTZE_HOST_TESTS__STUBS__ENGINE__GAME_STATE_HPP
+
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * Stand-in for the engine object table. Objects only have the members the object query reads;
+ * the real headers describe the 32-bit game memory and do not build on the host.
+ */
+namespace Balltze::Engine {
+    union ResourceHandle {
+        std::uint32_t value;
+        struct {
+            std::uint16_t index;
+            std::uint16_t id;
+        };
+
+        ResourceHandle(std::uint32_t handle) {
+            this->value = handle;
+        }
+
+        ResourceHandle() = default;
+
+        static ResourceHandle null() noexcept {
+            return { 0xFFFFFFFF };
+        }
+
+        bool is_null() const noexcept {
+            return *this == null();
+        }
+
+        bool operator==(const ResourceHandle &other) const noexcept {
+            return this->value == other.value;
+        }
+
+        bool operator!=(const ResourceHandle &other) const noexcept {
+            return this->value != other.value;
+        }
+    };
+
+    using TagHandle = ResourceHandle;
+    using PlayerHandle = ResourceHandle;
+    using ObjectHandle = ResourceHandle;
+
+    struct Point3D {
+        float x;
+        float y;
+        float z;
+    };
+
+    enum ObjectType : std::uint16_t {
+        OBJECT_TYPE_BIPED = 0,
+        OBJECT_TYPE_VEHICLE,
+        OBJECT_TYPE_WEAPON,
+        OBJECT_TYPE_EQUIPMENT,
+        OBJECT_TYPE_GARBAGE,
+        OBJECT_TYPE_PROJECTILE,
+        OBJECT_TYPE_SCENERY,
+        OBJECT_TYPE_DEVICE_MACHINE,
+        OBJECT_TYPE_DEVICE_CONTROL,
+        OBJECT_TYPE_DEVICE_LIGHT_FIXTURE,
+        OBJECT_TYPE_PLACEHOLDER,
+        OBJECT_TYPE_SOUND_SCENERY
+    };
+
+    struct BaseObjectVitals {
+        float base_health;
+        float base_shield;
+        float health;
+        float shield;
+    };
+
+    struct BaseObject {
+        TagHandle tag_handle;
+        Point3D position;
+        Point3D velocity;
+        Point3D center_position;
+        ObjectType type;
+        std::uint16_t team_owner;
+        PlayerHandle player;
+        BaseObjectVitals vitals;
+    };
+
+    struct ObjectTableEntry {
+        std::uint16_t id;
+        BaseObject *object;
+    };
+
+    struct ObjectTable {
+        std::uint16_t current_size;
+        ObjectTableEntry *first_element;
+
+        ObjectTableEntry *get_element(std::size_t index) {
+            return index < current_size ? first_element + index : nullptr;
+        }
+
+        BaseObject *get_object(const ObjectHandle &object_handle) noexcept {
+            auto *entry = get_element(object_handle.index);
+            return entry && entry->id == object_handle.id ? entry->object : nullptr;
+        }
+
+        BaseObject *get_object(std::uint32_t index) noexcept {
+            auto *entry = get_element(index);
+            return entry ? entry->object : nullptr;
+        }
+    };
+
+    ObjectTable &get_object_table() noexcept;
+}
+
+#endif
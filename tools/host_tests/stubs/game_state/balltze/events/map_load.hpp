@@ -0,0 +1,34 @@
+// SPDX-License-Identifier: GPL-3.0-only
+
+#ifndef BALLTZE_HOST_TESTS__STUBS__EVENTS__MAP_LOAD_HPP
+#define BALLTZE_HOST_TESTS__STUBS__EVENTS__MAP_LOAD_HPP
+
+#include <functional>
+#include <vector>
+
+/**
+ * Stand-in for the map load event; listeners are kept so tests can dispatch it by hand
+ */
+namespace Balltze::Event {
+    class MapLoadEvent {
+    public:
+        using ConstCallback = std::function<void(MapLoadEvent const &)>;
+
+        static std::vector<ConstCallback> &const_listeners() {
+            static std::vector<ConstCallback> listeners;
+            return listeners;
+        }
+
+        static void subscribe_const(ConstCallback callback) {
+            const_listeners().push_back(std::move(callback));
+        }
+
+        void dispatch() const {
+            for(auto &listener : const_listeners()) {
+                listener(*this);
+            }
+        }
+    };
+}
+
+#endif
@@ -0,0 +1,21 @@
+// SPDX-License-Identifier: GPL-3.0-only
+
+#ifndef BALLTZE_HOST_TESTS__STUBS__FEATURES__OBJECT_SPATIAL_INDEX_HPP
+#define BALLTZE_HOST_TESTS__STUBS__FEATURES__OBJECT_SPATIAL_INDEX_HPP
+
+#include <cstddef>
+#include <limits>
+#include <vector>
+#include <balltze/engine/game_state.hpp>
+
+/**
+ * Same functions as include/balltze/features/object_spatial_index.hpp, which needs the Windows headers
+ */
+namespace Balltze::Features {
+    std::vector<Engine::ObjectHandle> find_objects_in_radius(Engine::Point3D const &center, float radius);
+    std::vector<Engine::ObjectHandle> find_objects_in_box(Engine::Point3D const &min, Engine::Point3D const &max);
+    std::vector<Engine::ObjectHandle> find_nearest_objects(Engine::Point3D const &point, std::size_t count, float max_distance = std::numeric_limits<float>::infinity());
+    void set_up_object_spatial_index() noexcept;
+}
+
+#endif
@@ -0,0 +1,24 @@
+// SPDX-License-Identifier: GPL-3.0-only
+
+#ifndef BALLTZE_HOST_TESTS__STUBS__MATH_HPP
+#define BALLTZE_HOST_TESTS__STUBS__MATH_HPP
+
+#include <balltze/engine/game_state.hpp>
+
+#define PI 3.1415926535897932384626433832795028841971693993751058209749445923078164062862089986280348253421170679
+
+namespace Balltze::Math {
+    using Point3D = Engine::Point3D;
+
+    /**
+     * Same as the one of src/balltze/math/trig.cpp
+     */
+    inline float distance_squared(const Point3D &a, const Point3D &b) noexcept {
+        float x = a.x - b.x;
+        float y = a.y - b.y;
+        float z = a.z - b.z;
+        return x*x + y*y + z*z;
+    }
+}
+
+#endif
@@ -0,0 +1,16 @@
+// SPDX-License-Identifier: GPL-3.0-only
+
+#ifndef BALLTZE_HOST_TESTS__STUBS__OUTPUT__ENGINE__TAG_HPP
+#define BALLTZE_HOST_TESTS__STUBS__OUTPUT__ENGINE__TAG_HPP
+
+#include <balltze/engine/data_types.hpp>
+
+/**
+ * Stand-in for the engine tag header, which describes the 32-bit game memory and does not build on
+ * the host. Text output only needs tag handles, which are resource handles like in the game.
+ */
+namespace Balltze::Engine {
+    using TagHandle = ResourceHandle;
+}
+
+#endif
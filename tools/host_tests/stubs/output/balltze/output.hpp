@@ -0,0 +1,22 @@
+// SPDX-License-Identifier: GPL-3.0-only
+
+#ifndef BALLTZE_HOST_TESTS__STUBS__OUTPUT_HPP
+#define BALLTZE_HOST_TESTS__STUBS__OUTPUT_HPP
+
+#include <cstdint>
+#include <balltze/engine/data_types.hpp>
+#include <balltze/engine/tag.hpp>
+
+/**
+ * Stand-in for the text output types. The real header takes the engine tag header next to it, which
+ * does not build on the host.
+ */
+namespace Balltze {
+    enum FontAlignment : std::int16_t {
+        ALIGN_LEFT = 0,
+        ALIGN_RIGHT,
+        ALIGN_CENTER
+    };
+}
+
+#endif
@@ -0,0 +1,21 @@
+// SPDX-License-Identifier: GPL-3.0-only
+
+#ifndef BALLTZE_HOST_TESTS__STUBS__ENGINE__TAG_DEFINITIONS__SOUND_HPP
+#define BALLTZE_HOST_TESTS__STUBS__ENGINE__TAG_DEFINITIONS__SOUND_HPP
+
+#include <cstdint>
+
+/**
+ * Stand-in for the sound tag definition. The real header takes the engine tag header, which describes
+ * the 32-bit game memory and does not build on the host; sample sizes only need the formats.
+ */
+namespace Balltze::Engine::TagDefinitions {
+    enum SoundFormat : std::uint16_t {
+        SOUND_FORMAT_16_BIT_PCM = 0,
+        SOUND_FORMAT_XBOX_ADPCM,
+        SOUND_FORMAT_IMA_ADPCM,
+        SOUND_FORMAT_OGG_VORBIS,
+    };
+}
+
+#endif
@@ -0,0 +1,58 @@
+// SPDX-License-Identifier: GPL-3.0-only
+
+#ifndef BALLTZE_HOST_TESTS__STUBS__ENGINE__MAP_HPP
+#define BALLTZE_HOST_TESTS__STUBS__ENGINE__MAP_HPP
+
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * Stand-in for the map header; it has no pointers, so the layout is the one of the cache files
+ */
+namespace Balltze::Engine {
+    enum MapGameType : std::uint16_t {
+        MAP_SINGLE_PLAYER = 0,
+        MAP_MULTIPLAYER,
+        MAP_USER_INTERFACE
+    };
+
+    enum CacheFileEngine : std::uint32_t {
+        CACHE_FILE_XBOX = 0x5,
+        CACHE_FILE_DEMO = 0x6,
+        CACHE_FILE_RETAIL = 0x7,
+        CACHE_FILE_CUSTOM_EDITION = 0x261,
+        CACHE_FILE_INVADER = 0x1A86,
+
+        CACHE_FILE_DEMO_COMPRESSED = 0x861A0006,
+        CACHE_FILE_RETAIL_COMPRESSED = 0x861A0007,
+        CACHE_FILE_CUSTOM_EDITION_COMPRESSED = 0x861A0261
+    };
+
+    struct MapHeader {
+        static const std::uint32_t HEAD_LITERAL = 0x68656164;
+        static const std::uint32_t FOOT_LITERAL = 0x666F6F74;
+
+        std::uint32_t head;
+        CacheFileEngine engine_type;
+        std::uint32_t file_size;
+        std::byte pad_4[4];
+        std::uint32_t tag_data_offset;
+        std::uint32_t tag_data_size;
+        std::byte pad_7[8];
+        char name[32];
+        char build[32];
+        MapGameType game_type;
+        std::byte pad_11[2];
+        std::uint32_t crc32;
+        std::byte pad_13[0x2B0 + 0x4E4];
+        std::uint32_t foot;
+    };
+    static_assert(sizeof(MapHeader) == 0x800);
+
+    /**
+     * Header of the loaded map; provided by the engine stand-in
+     */
+    MapHeader &get_map_header() noexcept;
+}
+
+#endif
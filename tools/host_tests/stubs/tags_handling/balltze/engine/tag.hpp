@@ -0,0 +1,132 @@
+// SPDX-License-Identifier: GPL-3.0-only
+
+#ifndef BALLTZE_HOST_TESTS__STUBS__ENGINE__TAG_HPP
+#define BALLTZE_HOST_TESTS__STUBS__ENGINE__TAG_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+/**
+ * Stand-in for the engine tag types. The real headers describe the 32-bit game memory and
+ * do not build on the host; these have the same members with the host pointer size.
+ */
+namespace Balltze::Engine {
+    enum TagClassInt : std::uint32_t {
+        TAG_CLASS_NONE = 0xFFFFFFFF,
+        TAG_CLASS_NULL = 0xFFFFFFFF,
+        TAG_CLASS_BITMAP = 0x6269746D,
+        TAG_CLASS_HUD_GLOBALS = 0x68756467,
+        TAG_CLASS_GLOBALS = 0x6D617467,
+        TAG_CLASS_METER = 0x6D657472,
+        TAG_CLASS_GBXMODEL = 0x6D6F6432,
+        TAG_CLASS_SCENARIO_STRUCTURE_BSP = 0x73627370,
+        TAG_CLASS_SCENARIO = 0x73636E72,
+        TAG_CLASS_SOUND = 0x736E6421,
+        TAG_CLASS_PATCH_TEST = 0x70746573,
+        TAG_CLASS_IMPORT_TEST = 0x696D7074,
+        TAG_CLASS_OTHER = 0x6F746872
+    };
+
+    union ResourceHandle {
+        std::uint32_t value;
+        struct {
+            std::uint16_t index;
+            std::uint16_t id;
+        };
+
+        ResourceHandle(std::uint32_t handle) {
+            this->value = handle;
+        }
+
+        ResourceHandle() = default;
+
+        static ResourceHandle null() noexcept {
+            return { 0xFFFFFFFF };
+        }
+
+        bool is_null() const noexcept {
+            return *this == null();
+        }
+
+        bool operator==(const ResourceHandle &other) const noexcept {
+            return this->value == other.value;
+        }
+
+        bool operator!=(const ResourceHandle &other) const noexcept {
+            return this->value != other.value;
+        }
+
+        bool operator<(const ResourceHandle& other) const noexcept {
+            return index < other.index;
+        }
+    };
+
+    using TagHandle = ResourceHandle;
+
+    struct Tag {
+        TagClassInt primary_class;
+        TagClassInt secondary_class;
+        TagClassInt tertiary_class;
+        TagHandle handle;
+        char *path;
+        std::byte *data;
+        std::uint32_t indexed;
+        std::byte pad_8[4];
+    };
+
+    struct TagDataHeader {
+        Tag *tag_array;
+        TagHandle scenario_tag;
+        std::uint32_t random_number;
+        std::uint32_t tag_count;
+        std::uint32_t model_part_count;
+        std::uint32_t model_data_file_offset;
+        std::uint32_t model_part_count_again;
+        std::uint32_t vertex_size;
+        std::uint32_t model_data_size;
+        std::uint32_t tags_literal;
+    };
+
+    template<typename T> struct TagBlock {
+        std::uint32_t count;
+        T *elements;
+        void *definition;
+    };
+
+    struct TagDependency {
+        TagClassInt tag_class;
+        char *path;
+        std::size_t path_size;
+        TagHandle tag_handle;
+    };
+
+    struct TagDataOffset {
+        std::uint32_t size;
+        std::uint32_t external;
+        std::uint32_t file_offset;
+        std::byte *pointer;
+        std::byte pad_5[4];
+    };
+
+    /**
+     * Address of the tag data of the loaded map; provided by the engine stand-in
+     */
+    std::byte *get_tag_data_address() noexcept;
+
+    inline TagDataHeader &get_tag_data_header() noexcept {
+        return *reinterpret_cast<TagDataHeader *>(get_tag_data_address());
+    }
+
+    /**
+     * Four character name of a tag class; provided by the engine stand-in
+     */
+    std::string tag_class_to_string(TagClassInt tag_class);
+
+    /**
+     * Look up a tag in the tag array of the tag data header; provided by the engine stand-in
+     */
+    Tag *get_tag(TagHandle tag_handle) noexcept;
+}
+
+#endif
@@ -0,0 +1,50 @@
+// SPDX-License-Identifier: GPL-3.0-only
+
+#ifndef BALLTZE_HOST_TESTS__STUBS__ENGINE__TAG_DEFINITIONS_HPP
+#define BALLTZE_HOST_TESTS__STUBS__ENGINE__TAG_DEFINITIONS_HPP
+
+#include "tag.hpp"
+
+#pragma pack(push)
+#pragma pack(1)
+
+/**
+ * Structs of data/patch_test.json and data/import_test.json, as the tag definition headers generator would write them
+ */
+namespace Balltze::Engine::TagDefinitions {
+    struct PatchTestBase {
+        std::uint32_t base_value;
+    };
+
+    struct PatchTestElement {
+        float value;
+        std::byte pad_2[4];
+        TagDataOffset data;
+    };
+
+    struct PatchTest : public PatchTestBase {
+        float scale;
+        std::int16_t count;
+        std::byte pad_3[2];
+        TagBlock<PatchTestElement> elements;
+        TagDataOffset blob;
+    };
+
+    struct ImportTestElement {
+        float value;
+        std::byte pad_2[4];
+        TagDependency reference;
+        TagDataOffset data;
+    };
+
+    struct ImportTest {
+        std::uint32_t flags;
+        TagDependency parent;
+        TagBlock<ImportTestElement> elements;
+        TagDataOffset blob;
+    };
+}
+
+#pragma pack(pop)
+
+#endif
@@ -0,0 +1,23 @@
+// SPDX-License-Identifier: GPL-3.0-only
+
+#ifndef BALLTZE_HOST_TESTS__STUBS__ENGINE__TAG_DEFINITIONS__BITMAP_HPP
+#define BALLTZE_HOST_TESTS__STUBS__ENGINE__TAG_DEFINITIONS__BITMAP_HPP
+
+#include <cstdint>
+#include "../tag.hpp"
+
+/**
+ * Stand-in for the bitmap tag definition, with the fields secondary maps fix up when they are imported.
+ * Synthetic maps have no bitmaps.
+ */
+namespace Balltze::Engine::TagDefinitions {
+    struct BitmapData {
+        std::uint32_t pixel_data_offset;
+    };
+
+    struct Bitmap {
+        TagBlock<BitmapData> bitmap_data;
+    };
+}
+
+#endif
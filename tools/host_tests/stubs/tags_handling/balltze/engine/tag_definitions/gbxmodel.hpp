@@ -0,0 +1,29 @@
+// SPDX-License-Identifier: GPL-3.0-only
+
+#ifndef BALLTZE_HOST_TESTS__STUBS__ENGINE__TAG_DEFINITIONS__GBXMODEL_HPP
+#define BALLTZE_HOST_TESTS__STUBS__ENGINE__TAG_DEFINITIONS__GBXMODEL_HPP
+
+#include <cstdint>
+#include "../tag.hpp"
+
+/**
+ * Stand-in for the gbxmodel tag definition, with the fields secondary maps fix up when they are imported.
+ * Synthetic maps have no models.
+ */
+namespace Balltze::Engine::TagDefinitions {
+    struct GBXModelGeometryPart {
+        std::uint32_t triangle_offset;
+        std::uint32_t triangle_offset_2;
+        std::uint32_t vertex_offset;
+    };
+
+    struct GBXModelGeometry {
+        TagBlock<GBXModelGeometryPart> parts;
+    };
+
+    struct Gbxmodel {
+        TagBlock<GBXModelGeometry> geometries;
+    };
+}
+
+#endif
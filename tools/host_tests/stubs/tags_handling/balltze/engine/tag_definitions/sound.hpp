@@ -0,0 +1,18 @@
+// SPDX-License-Identifier: GPL-3.0-only
+
+#ifndef BALLTZE_HOST_TESTS__STUBS__TAGS_HANDLING__ENGINE__TAG_DEFINITIONS__SOUND_HPP
+#define BALLTZE_HOST_TESTS__STUBS__TAGS_HANDLING__ENGINE__TAG_DEFINITIONS__SOUND_HPP
+
+#include "../tag.hpp"
+
+/**
+ * Stand-in for the sound tag definition, with the fields secondary maps fix up when they are imported.
+ * Synthetic maps have no sounds.
+ */
+namespace Balltze::Engine::TagDefinitions {
+    struct Sound {
+        TagDependency promotion_sound;
+    };
+}
+
+#endif
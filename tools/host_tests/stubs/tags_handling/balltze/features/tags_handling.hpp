@@ -0,0 +1,18 @@
+// SPDX-License-Identifier: GPL-3.0-only
+
+#ifndef BALLTZE_HOST_TESTS__STUBS__FEATURES__TAGS_HANDLING_HPP
+#define BALLTZE_HOST_TESTS__STUBS__FEATURES__TAGS_HANDLING_HPP
+
+#include <cstddef>
+
+namespace Balltze::Features {
+    // Same as in include/balltze/features/tags_handling.hpp
+    struct TagDataPatchSummary {
+        std::size_t fields_patched = 0;
+        std::size_t bytes_patched = 0;
+        std::size_t blocks_reallocated = 0;
+        std::size_t data_reallocated = 0;
+    };
+}
+
+#endif
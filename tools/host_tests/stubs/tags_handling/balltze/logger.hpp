@@ -0,0 +1,28 @@
+// SPDX-License-Identifier: GPL-3.0-only
+
+#ifndef BALLTZE_HOST_TESTS__STUBS__LOGGER_HPP
+#define BALLTZE_HOST_TESTS__STUBS__LOGGER_HPP
+
+#include <cstdio>
+
+/**
+ * Stand-in for the logger; messages are printed without their arguments
+ */
+namespace Balltze {
+    class Logger {
+    private:
+        template<typename... Args>
+        void print(const char *level, const char *format, Args &&...) {
+            std::fprintf(stderr, "[%s] %s\n", level, format);
+        }
+
+    public:
+        template<typename... Args> void debug(const char *, Args &&...) {}
+        template<typename... Args> void info(const char *, Args &&...) {}
+        template<typename... Args> void warning(const char *format, Args &&...args) { print("warning", format, args...); }
+        template<typename... Args> void error(const char *format, Args &&...args) { print("error", format, args...); }
+        template<typename... Args> void fatal(const char *format, Args &&...args) { print("fatal", format, args...); }
+    };
+}
+
+#endif
@@ -0,0 +1,8 @@
+// SPDX-License-Identifier: GPL-3.0-only
+
+#ifndef BALLTZE_HOST_TESTS__STUBS__INTRIN_H
+#define BALLTZE_HOST_TESTS__STUBS__INTRIN_H
+
+#define _ReturnAddress() __builtin_return_address(0)
+
+#endif
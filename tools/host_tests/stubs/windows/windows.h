@@ -0,0 +1,197 @@
+// SPDX-License-Identifier: GPL-3.0-only
+
+#ifndef BALLTZE_HOST_TESTS__STUBS__WINDOWS_H
+#define BALLTZE_HOST_TESTS__STUBS__WINDOWS_H
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <thread>
+
+/**
+ * Stand-in for the parts of the Windows API used by the public headers; there is a single module
+ */
+typedef void *HMODULE;
+typedef unsigned long DWORD;
+typedef int BOOL;
+typedef const char *LPCSTR;
+typedef const char *LPCTSTR;
+typedef unsigned int UINT;
+typedef wchar_t WCHAR;
+
+#define MB_OK 0x00000000L
+#define MB_ICONERROR 0x00000010L
+#define GET_MODULE_HANDLE_EX_FLAG_FROM_ADDRESS 0x00000004
+#define PAGE_NOACCESS 0x01
+#define PAGE_READONLY 0x02
+#define PAGE_READWRITE 0x04
+#define PAGE_WRITECOPY 0x08
+#define PAGE_EXECUTE_READ 0x20
+#define PAGE_EXECUTE_READWRITE 0x40
+#define PAGE_EXECUTE_WRITECOPY 0x80
+#define PAGE_GUARD 0x100
+#define MEM_COMMIT 0x1000
+#define MEM_FREE 0x10000
+#define CP_ACP 0
+#define CP_UTF8 65001
+#define MB_ERR_INVALID_CHARS 0x00000008
+
+inline BOOL GetModuleHandleEx(DWORD, LPCSTR, HMODULE *module) {
+    static char host_module;
+    *module = &host_module;
+    return 1;
+}
+
+inline BOOL VirtualProtect(void *, std::size_t, DWORD new_protection, DWORD *old_protection) {
+    *old_protection = new_protection;
+    return 1;
+}
+
+/**
+ * Only the 64-bit member of the union is used
+ */
+typedef struct {
+    long long QuadPart;
+} LARGE_INTEGER;
+
+/**
+ * The performance counter is the steady clock, in nanoseconds
+ */
+inline BOOL QueryPerformanceCounter(LARGE_INTEGER *counter) {
+    counter->QuadPart = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+    return 1;
+}
+
+inline BOOL QueryPerformanceFrequency(LARGE_INTEGER *frequency) {
+    frequency->QuadPart = 1000000000;
+    return 1;
+}
+
+/**
+ * Threads are numbered from 1 in the order they first ask for their identifier
+ */
+inline DWORD GetCurrentThreadId() {
+    static std::atomic<DWORD> next_thread_id = 1;
+    thread_local DWORD thread_id = next_thread_id++;
+    return thread_id;
+}
+
+inline BOOL SwitchToThread() {
+    std::this_thread::yield();
+    return 1;
+}
+
+typedef struct {
+    void *BaseAddress;
+    void *AllocationBase;
+    DWORD AllocationProtect;
+    std::size_t RegionSize;
+    DWORD State;
+    DWORD Protect;
+    DWORD Type;
+} MEMORY_BASIC_INFORMATION;
+
+/**
+ * The first page is free and the rest of the address space is committed read-write memory
+ */
+inline std::size_t VirtualQuery(const void *address, MEMORY_BASIC_INFORMATION *info, std::size_t) {
+    constexpr std::uintptr_t page_size = 0x1000;
+    auto page = reinterpret_cast<std::uintptr_t>(address) & ~(page_size - 1);
+    *info = {};
+    if(page == 0) {
+        info->RegionSize = page_size;
+        info->State = MEM_FREE;
+        info->Protect = PAGE_NOACCESS;
+    }
+    else {
+        info->BaseAddress = reinterpret_cast<void *>(page);
+        info->RegionSize = UINTPTR_MAX - page;
+        info->State = MEM_COMMIT;
+        info->Protect = PAGE_READWRITE;
+    }
+    return sizeof(*info);
+}
+
+/**
+ * Decode UTF-8 to UTF-16 code units; with MB_ERR_INVALID_CHARS, invalid input fails instead of being
+ * replaced with U+FFFD. Only CP_UTF8 is supported.
+ */
+inline int MultiByteToWideChar(UINT, DWORD flags, const char *input, int input_length, WCHAR *output, int output_length) {
+    auto *bytes = reinterpret_cast<const unsigned char *>(input);
+    int written = 0;
+    auto put = [&](std::uint32_t unit) {
+        if(output_length > 0 && written < output_length) {
+            output[written] = static_cast<WCHAR>(unit);
+        }
+        written++;
+    };
+    for(int i = 0; i < input_length;) {
+        std::uint32_t code_point = bytes[i];
+        int length = code_point < 0x80 ? 1 : (code_point >> 5) == 0x6 ? 2 : (code_point >> 4) == 0xE ? 3 : (code_point >> 3) == 0x1E ? 4 : 0;
+        bool valid = length > 0 && i + length <= input_length;
+        if(valid && length > 1) {
+            code_point &= 0x7F >> length;
+            for(int j = 1; j < length; j++) {
+                valid = valid && (bytes[i + j] & 0xC0) == 0x80;
+                code_point = code_point << 6 | (bytes[i + j] & 0x3F);
+            }
+            static const std::uint32_t minimum[] = {0, 0, 0x80, 0x800, 0x10000};
+            valid = valid && code_point >= minimum[length] && code_point <= 0x10FFFF && (code_point < 0xD800 || code_point > 0xDFFF);
+        }
+        if(!valid) {
+            if(flags & MB_ERR_INVALID_CHARS) {
+                return 0;
+            }
+            put(0xFFFD);
+            i++;
+            continue;
+        }
+        if(code_point >= 0x10000) {
+            put(0xD800 + ((code_point - 0x10000) >> 10));
+            put(0xDC00 + ((code_point - 0x10000) & 0x3FF));
+        }
+        else {
+            put(code_point);
+        }
+        i += length;
+    }
+    if(output_length > 0 && written > output_length) {
+        return 0;
+    }
+    return written;
+}
+
+/**
+ * Encode UTF-16 code units to the system code page, which is taken to be Latin-1
+ */
+inline int WideCharToMultiByte(UINT, DWORD, const WCHAR *input, int input_length, char *output, int output_length, const char *default_char, BOOL *used_default_char) {
+    if(used_default_char) {
+        *used_default_char = 0;
+    }
+    int written = 0;
+    for(int i = 0; i < input_length; i++) {
+        auto unit = static_cast<std::uint32_t>(input[i]);
+        char character = static_cast<char>(unit);
+        if(unit > 0xFF) {
+            character = default_char ? *default_char : '?';
+            if(used_default_char) {
+                *used_default_char = 1;
+            }
+            // A surrogate pair is one character
+            if(unit >= 0xD800 && unit <= 0xDBFF && i + 1 < input_length) {
+                i++;
+            }
+        }
+        if(output_length > 0 && written < output_length) {
+            output[written] = character;
+        }
+        written++;
+    }
+    if(output_length > 0 && written > output_length) {
+        return 0;
+    }
+    return written;
+}
+
+#endif
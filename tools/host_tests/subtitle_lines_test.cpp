@@ -0,0 +1,233 @@
+// SPDX-License-Identifier: GPL-3.0-only
+
+#include <cstdint>
+#include <cstdio>
+#include <random>
+#include <string>
+#include <vector>
+#include <output/subtitle_lines.hpp>
+#include "host_test.hpp"
+
+using namespace Balltze;
+
+/**
+ * Font tag characters with a mix of widths, characters listed twice and characters the font does not have
+ */
+static std::vector<FontCharacter> synthetic_font_characters(std::uint32_t seed) {
+    std::mt19937 random(seed);
+    std::vector<FontCharacter> characters;
+    auto add = [&](std::uint16_t character, std::uint16_t width) {
+        characters.push_back({character, width, {}});
+    };
+    add(' ', 4);
+    for(std::uint16_t c = '!'; c < 0x7F; c++) {
+        if(random() % 16 != 0) {
+            add(c, 3 + random() % 12);
+        }
+    }
+    for(std::uint16_t c = 0xA0; c < 0x100; c += 3) {
+        add(c, 6 + random() % 8);
+    }
+    for(std::uint16_t c = 0x3041; c < 0x3097; c++) {
+        add(c, 16);
+    }
+
+    // The first entry of a character wins; this one is listed again with other widths
+    add('e', 40);
+    add(0x3042, 2);
+    add(' ', 0);
+    std::shuffle(characters.begin() + 1, characters.end() - 3, random);
+    return characters;
+}
+
+/**
+ * get_text_pixel_length of a tag font before the character widths were cached: a search of the
+ * character table for every character, stopping before the width overflows
+ */
+template<typename T>
+static std::int16_t reference_pixel_length(const T *text, std::vector<FontCharacter> const &characters) {
+    std::int16_t length = 0;
+    while(*text != 0) {
+        auto old_length = length;
+        int char_length = 0;
+        for(auto &character : characters) {
+            bool same = false;
+            if(sizeof(T) == 1) {
+                same = *reinterpret_cast<const std::uint8_t *>(text) == character.character;
+            }
+            else {
+                same = *text == character.character;
+            }
+            if(same) {
+                char_length = character.character_width;
+                break;
+            }
+        }
+        if(char_length > 0) {
+            length += char_length;
+            if(old_length > length) {
+                return old_length;
+            }
+        }
+        text++;
+    }
+    return length;
+}
+
+/**
+ * Subtitle line splitting before the line width was kept as words are added
+ */
+template<typename T, typename MeasureLine>
+static std::vector<std::basic_string<T>> reference_split(std::basic_string<T> const &text, std::size_t width, MeasureLine const &measure_line) {
+    std::basic_string<T> line;
+    std::basic_string<T> word;
+    std::vector<std::basic_string<T>> lines;
+    for(auto c : text) {
+        if(c == ' ') {
+            if(static_cast<std::size_t>(measure_line(line.c_str())) < width) {
+                if(!line.empty()) {
+                    line += ' ';
+                }
+                line += word;
+                word.clear();
+            }
+            else {
+                lines.push_back(line);
+                line = word;
+                word.clear();
+            }
+        }
+        else {
+            word += c;
+        }
+    }
+    if(!word.empty()) {
+        if(!line.empty()) {
+            line += ' ';
+        }
+        line += word;
+    }
+    if(!line.empty()) {
+        lines.push_back(line);
+    }
+    return lines;
+}
+
+/**
+ * Random subtitle text: words of the font, characters it does not have, runs of spaces and line breaks
+ */
+template<typename T>
+static std::basic_string<T> random_text(std::mt19937 &random) {
+    std::basic_string<T> text;
+    auto word_count = 1 + random() % 40;
+    if(random() % 8 == 0) {
+        text += ' ';
+    }
+    for(std::size_t w = 0; w < word_count; w++) {
+        // Now and then a word too long for any line, or for the width of get_text_pixel_length
+        std::size_t length = random() % 256 == 0 ? 3000 + random() % 1500 : 1 + random() % 12;
+        for(std::size_t i = 0; i < length; i++) {
+            auto kind = random() % 32;
+            if(kind == 0) {
+                text += static_cast<T>(0xA0 + random() % 0x60);
+            }
+            else if(kind == 1 && sizeof(T) > 1) {
+                text += static_cast<T>(0x3041 + random() % 0x60);
+            }
+            else if(kind == 2) {
+                text += static_cast<T>('|');
+                text += static_cast<T>('n');
+            }
+            else {
+                text += static_cast<T>('!' + random() % 0x5E);
+            }
+        }
+        auto spaces = random() % 10 == 0 ? 2 + random() % 3 : 1;
+        if(w + 1 < word_count || random() % 8 == 0) {
+            text.append(spaces, ' ');
+        }
+    }
+    return text;
+}
+
+TEST_CASE("character widths are those a search of the font tag finds") {
+    auto characters = synthetic_font_characters(1);
+    FontGlyphAdvances advances(characters.data(), characters.size());
+    for(std::uint32_t c = 0; c < 0x10000; c++) {
+        std::uint16_t expected = 0;
+        for(auto &character : characters) {
+            if(character.character == c) {
+                expected = character.character_width;
+                break;
+            }
+        }
+        if(advances.get(c) != expected) {
+            std::fprintf(stderr, "width of U+%04X is %u instead of %u\n", c, advances.get(c), expected);
+            CHECK(advances.get(c) == expected);
+            break;
+        }
+    }
+    CHECK(advances.get(0x1F600) == 0);
+}
+
+TEST_CASE("words are wrapped once the line is as wide as the subtitles") {
+    std::vector<FontCharacter> characters = {{' ', 4, {}}, {'a', 10, {}}, {'b', 20, {}}};
+    FontGlyphAdvances advances(characters.data(), characters.size());
+    auto measure = [&](const char *line) { return reference_pixel_length(line, characters); };
+    auto split = [&](const char *text, std::size_t width) {
+        return split_subtitle_lines(std::string(text), width, &advances, measure);
+    };
+
+    // A word goes on a line narrower than the width, even if the line gets wider than it
+    CHECK((split("aa aa aa aa", 30) == std::vector<std::string>{"aa aa", "aa aa"}));
+    CHECK((split("aa aa aa aa", 20) == std::vector<std::string>{"aa", "aa", "aa aa"}));
+    CHECK((split("bbbb a a", 30) == std::vector<std::string>{"bbbb", "a a"}));
+
+    // The last word always goes on the last line
+    CHECK((split("bbbb bbbb", 10) == std::vector<std::string>{"bbbb bbbb"}));
+
+    // Past the width get_text_pixel_length can return, it returns the last width that did not overflow
+    auto overflowing = std::string(2000, 'b');
+    CHECK((split((overflowing + " a a").c_str(), 32761) == std::vector<std::string>{overflowing + " a a"}));
+    CHECK((split((overflowing + " a a").c_str(), 32760) == std::vector<std::string>{overflowing, "a a"}));
+
+    // Spaces between words are kept, those before the first one are not
+    CHECK((split("  a  b", 100) == std::vector<std::string>{"a  b"}));
+    CHECK(split("", 100).empty());
+    CHECK(split("   ", 100).empty());
+
+    // Without character widths, each line is measured
+    auto lines = split_subtitle_lines(std::string("aa aa aa aa"), 30, nullptr, measure);
+    CHECK((lines == std::vector<std::string>{"aa aa", "aa aa"}));
+}
+
+TEST_CASE("lines are the same as before on random text") {
+    std::mt19937 random(47);
+    std::size_t texts = 0;
+    std::size_t different = 0;
+    for(std::uint32_t font_seed = 1; font_seed <= 8; font_seed++) {
+        auto characters = synthetic_font_characters(font_seed);
+        FontGlyphAdvances advances(characters.data(), characters.size());
+        auto measure = [&](auto const *line) { return reference_pixel_length(line, characters); };
+        for(std::size_t i = 0; i < 100; i++) {
+            std::size_t width = 40 + random() % 600;
+            auto text = random_text<char>(random);
+            auto wide_text = random_text<wchar_t>(random);
+            auto expected = reference_split(text, width, measure);
+            auto wide_expected = reference_split(wide_text, width, measure);
+            if(split_subtitle_lines(text, width, &advances, measure) != expected || split_subtitle_lines(text, width, nullptr, measure) != expected) {
+                different++;
+            }
+            if(split_subtitle_lines(wide_text, width, &advances, measure) != wide_expected || split_subtitle_lines(wide_text, width, nullptr, measure) != wide_expected) {
+                different++;
+            }
+            texts += 2;
+        }
+    }
+    if(different > 0) {
+        std::fprintf(stderr, "%zu of %zu texts were split differently\n", different, texts);
+    }
+    CHECK(different == 0);
+}
+
+TEST_MAIN()
@@ -0,0 +1,187 @@
+// SPDX-License-Identifier: GPL-3.0-only
+
+#include <cstdio>
+#include <cstring>
+#include <stdexcept>
+#include <vector>
+#include <balltze/engine/tag.hpp>
+#include <balltze/engine/map.hpp>
+#include <balltze/engine/tag_definitions.hpp>
+#include "synthetic_map.hpp"
+
+namespace HostTest {
+    using namespace Balltze::Engine;
+    using namespace Balltze::Engine::TagDefinitions;
+
+    static std::uint32_t mix(std::uint32_t seed, std::size_t a, std::size_t b) noexcept {
+        std::uint32_t value = seed * 0x9E3779B1u + static_cast<std::uint32_t>(a) * 0x85EBCA77u + static_cast<std::uint32_t>(b) * 0xC2B2AE3Du;
+        value ^= value >> 15;
+        value *= 0x2C1B3C6Du;
+        value ^= value >> 12;
+        return value;
+    }
+
+    TagHandle synthetic_tag_handle(std::size_t index) noexcept {
+        TagHandle handle;
+        handle.index = static_cast<std::uint16_t>(index);
+        handle.id = static_cast<std::uint16_t>(0xE174 + index);
+        return handle;
+    }
+
+    std::string synthetic_tag_path(std::size_t index) {
+        return "synthetic\\tags\\import_test_" + std::to_string(index);
+    }
+
+    std::byte synthetic_data_byte(std::size_t tag_index, std::size_t block, std::size_t position) noexcept {
+        return static_cast<std::byte>(tag_index * 31 + block * 7 + position);
+    }
+
+    std::size_t synthetic_reference(SyntheticMapParameters const &parameters, std::size_t tag_index, std::size_t block) noexcept {
+        return mix(parameters.seed, tag_index, block) % parameters.tag_count;
+    }
+
+    std::size_t synthetic_blob_size(SyntheticMapParameters const &parameters, std::size_t tag_index) noexcept {
+        if(parameters.blob_size == 0) {
+            return 0;
+        }
+        return parameters.blob_size / 2 + mix(parameters.seed, tag_index, 0xB10B) % (parameters.blob_size + 1);
+    }
+
+    /**
+     * Tag data of the cache file being built; offsets are turned into addresses at the engine tag data address
+     */
+    class TagDataBuilder {
+    private:
+        std::vector<std::byte> m_data;
+
+    public:
+        std::size_t reserve(std::size_t size, std::size_t alignment = alignof(std::max_align_t)) {
+            auto offset = (m_data.size() + alignment - 1) / alignment * alignment;
+            m_data.resize(offset + size);
+            return offset;
+        }
+
+        template<typename T>
+        T *address(std::size_t offset) const noexcept {
+            return reinterpret_cast<T *>(reinterpret_cast<std::uintptr_t>(get_tag_data_address()) + offset);
+        }
+
+        template<typename T>
+        void write(std::size_t offset, T const &value) noexcept {
+            std::memcpy(m_data.data() + offset, &value, sizeof(T));
+        }
+
+        std::byte *at(std::size_t offset) noexcept {
+            return m_data.data() + offset;
+        }
+
+        std::vector<std::byte> const &data() const noexcept {
+            return m_data;
+        }
+    };
+
+    std::size_t write_synthetic_map(std::filesystem::path const &path, SyntheticMapParameters const &parameters) {
+        if(parameters.tag_count == 0 || parameters.tag_count > 0xFFFF) {
+            throw std::invalid_argument("Synthetic maps have between 1 and 65535 tags");
+        }
+
+        TagDataBuilder builder;
+        auto header_offset = builder.reserve(sizeof(TagDataHeader));
+        auto tag_array_offset = builder.reserve(sizeof(Tag) * parameters.tag_count, alignof(Tag));
+        auto file_offset = [](std::size_t tag_data_offset) -> std::uint32_t {
+            return static_cast<std::uint32_t>(sizeof(MapHeader) + tag_data_offset);
+        };
+
+        std::vector<std::size_t> path_offsets;
+        for(std::size_t i = 0; i < parameters.tag_count; i++) {
+            auto tag_path = synthetic_tag_path(i);
+            auto offset = builder.reserve(tag_path.size() + 1, 1);
+            std::memcpy(builder.at(offset), tag_path.c_str(), tag_path.size() + 1);
+            path_offsets.push_back(offset);
+        }
+
+        auto make_dependency = [&](std::size_t tag_index) {
+            TagDependency dependency = {};
+            dependency.tag_class = TAG_CLASS_IMPORT_TEST;
+            dependency.path = builder.address<char>(path_offsets[tag_index]);
+            dependency.path_size = synthetic_tag_path(tag_index).size();
+            dependency.tag_handle = synthetic_tag_handle(tag_index);
+            return dependency;
+        };
+
+        auto make_data = [&](std::size_t tag_index, std::size_t block, std::size_t size) {
+            TagDataOffset data_offset = {};
+            data_offset.size = static_cast<std::uint32_t>(size);
+            if(size > 0) {
+                auto offset = builder.reserve(size, 4);
+                for(std::size_t i = 0; i < size; i++) {
+                    *builder.at(offset + i) = synthetic_data_byte(tag_index, block, i);
+                }
+                data_offset.file_offset = file_offset(offset);
+                data_offset.pointer = builder.address<std::byte>(offset);
+            }
+            return data_offset;
+        };
+
+        for(std::size_t i = 0; i < parameters.tag_count; i++) {
+            auto data_offset = builder.reserve(sizeof(ImportTest), alignof(ImportTest));
+
+            ImportTest tag_data = {};
+            tag_data.flags = static_cast<std::uint32_t>(i);
+            tag_data.parent = make_dependency(synthetic_reference(parameters, i, parameters.elements_per_tag));
+            tag_data.elements.count = static_cast<std::uint32_t>(parameters.elements_per_tag);
+            if(parameters.elements_per_tag > 0) {
+                auto elements_offset = builder.reserve(sizeof(ImportTestElement) * parameters.elements_per_tag, alignof(ImportTestElement));
+                tag_data.elements.elements = builder.address<ImportTestElement>(elements_offset);
+                for(std::size_t j = 0; j < parameters.elements_per_tag; j++) {
+                    ImportTestElement element = {};
+                    element.value = static_cast<float>(i) + static_cast<float>(j) / 8.0f;
+                    element.reference = make_dependency(synthetic_reference(parameters, i, j));
+                    element.data = make_data(i, j, parameters.element_data_size);
+                    builder.write(elements_offset + sizeof(ImportTestElement) * j, element);
+                }
+            }
+            tag_data.blob = make_data(i, parameters.elements_per_tag, synthetic_blob_size(parameters, i));
+            builder.write(data_offset, tag_data);
+
+            Tag tag = {};
+            tag.primary_class = TAG_CLASS_IMPORT_TEST;
+            tag.secondary_class = TAG_CLASS_NONE;
+            tag.tertiary_class = TAG_CLASS_NONE;
+            tag.handle = synthetic_tag_handle(i);
+            tag.path = builder.address<char>(path_offsets[i]);
+            tag.data = builder.address<std::byte>(data_offset);
+            tag.indexed = 0;
+            builder.write(tag_array_offset + sizeof(Tag) * i, tag);
+        }
+
+        TagDataHeader tag_data_header = {};
+        tag_data_header.tag_array = builder.address<Tag>(tag_array_offset);
+        tag_data_header.scenario_tag = synthetic_tag_handle(0);
+        tag_data_header.tag_count = static_cast<std::uint32_t>(parameters.tag_count);
+        tag_data_header.tags_literal = 0x74616773;
+        builder.write(header_offset, tag_data_header);
+
+        auto &tag_data = builder.data();
+        MapHeader map_header = {};
+        map_header.head = MapHeader::HEAD_LITERAL;
+        map_header.engine_type = CACHE_FILE_CUSTOM_EDITION;
+        map_header.tag_data_offset = sizeof(MapHeader);
+        map_header.tag_data_size = static_cast<std::uint32_t>(tag_data.size());
+        map_header.file_size = static_cast<std::uint32_t>(sizeof(MapHeader) + tag_data.size());
+        std::snprintf(map_header.name, sizeof(map_header.name), "%s", path.stem().string().c_str());
+        map_header.game_type = MAP_MULTIPLAYER;
+        map_header.foot = MapHeader::FOOT_LITERAL;
+
+        std::FILE *file = std::fopen(path.string().c_str(), "wb");
+        if(!file) {
+            throw std::runtime_error("Failed to create synthetic map file");
+        }
+        bool written = std::fwrite(&map_header, sizeof(map_header), 1, file) == 1 && std::fwrite(tag_data.data(), 1, tag_data.size(), file) == tag_data.size();
+        std::fclose(file);
+        if(!written) {
+            throw std::runtime_error("Failed to write synthetic map file");
+        }
+        return tag_data.size();
+    }
+}
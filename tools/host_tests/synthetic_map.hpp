@@ -0,0 +1,79 @@
+// SPDX-License-Identifier: GPL-3.0-only
+
+#ifndef BALLTZE_HOST_TESTS__SYNTHETIC_MAP_HPP
+#define BALLTZE_HOST_TESTS__SYNTHETIC_MAP_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <balltze/engine/tag.hpp>
+
+namespace HostTest {
+    struct SyntheticMapParameters {
+        /** Number of import_test tags in the map */
+        std::size_t tag_count = 64;
+
+        /** Number of elements in the reflexive of each tag */
+        std::size_t elements_per_tag = 4;
+
+        /** Size of the data block of each element */
+        std::size_t element_data_size = 32;
+
+        /** Average size of the data block of each tag; sizes vary from half to one and a half times this */
+        std::size_t blob_size = 256;
+
+        /** Seed for the tag references and the data sizes */
+        std::uint32_t seed = 1;
+    };
+
+    /**
+     * Get the handle of a tag of a synthetic map
+     * @param index Index of the tag
+     * @return      Tag handle
+     */
+    Balltze::Engine::TagHandle synthetic_tag_handle(std::size_t index) noexcept;
+
+    /**
+     * Get the path of a tag of a synthetic map
+     * @param index Index of the tag
+     * @return      Tag path
+     */
+    std::string synthetic_tag_path(std::size_t index);
+
+    /**
+     * Get the byte at a position of a data block of a synthetic map, so contents can be checked after importing
+     * @param tag_index     Index of the tag the data belongs to
+     * @param block         Index of the element the data belongs to, or the element count for the tag blob
+     * @param position      Position of the byte in the data block
+     * @return              Byte value
+     */
+    std::byte synthetic_data_byte(std::size_t tag_index, std::size_t block, std::size_t position) noexcept;
+
+    /**
+     * Get the index of the tag referenced by the parent dependency of a tag, or by one of its elements
+     * @param parameters    Parameters the map was generated with
+     * @param tag_index     Index of the tag
+     * @param block         Index of the element, or the element count for the parent dependency
+     * @return              Index of the referenced tag
+     */
+    std::size_t synthetic_reference(SyntheticMapParameters const &parameters, std::size_t tag_index, std::size_t block) noexcept;
+
+    /**
+     * Get the size of the blob of a tag of a synthetic map
+     */
+    std::size_t synthetic_blob_size(SyntheticMapParameters const &parameters, std::size_t tag_index) noexcept;
+
+    /**
+     * Write a Custom Edition cache file made of import_test tags. Like a real cache file, the tag data
+     * is laid out for the address it is loaded at, which is the tag data address of the engine stand-in;
+     * pointers have the host size. Every tag has a parent dependency, references in its elements and data
+     * blocks with a file offset, so rebasing, dependency resolution and copying have work to do.
+     * @param path          Path of the cache file
+     * @param parameters    Size of the map
+     * @return              Size of the tag data
+     */
+    std::size_t write_synthetic_map(std::filesystem::path const &path, SyntheticMapParameters const &parameters);
+}
+
+#endif
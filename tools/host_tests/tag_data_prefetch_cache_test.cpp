@@ -0,0 +1,301 @@
+// SPDX-License-Identifier: GPL-3.0-only
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <list>
+#include <random>
+#include <thread>
+#include <vector>
+#include <features/tag_data_prefetch_cache.hpp>
+#include "host_test.hpp"
+
+using namespace Balltze::Features;
+using namespace std::chrono_literals;
+namespace fs = std::filesystem;
+
+/**
+ * Byte of the synthetic map files at an offset; files differ by their name
+ */
+static std::byte file_byte(fs::path const &file_path, std::size_t file_offset) {
+    return static_cast<std::byte>((file_offset * 7 + file_path.string().size()) & 0xFF);
+}
+
+static bool synthetic_reader(TagDataPrefetchRequest const &request, std::byte *data) {
+    for(std::size_t i = 0; i < request.size; i++) {
+        data[i] = file_byte(request.file_path, request.file_offset + i);
+    }
+    return true;
+}
+
+/**
+ * Data of the loaded map up to 100000 bytes, then of a secondary map it was imported from
+ */
+static std::optional<std::pair<fs::path, std::size_t>> locate(std::size_t map_offset) {
+    if(map_offset < 100000) {
+        return std::make_pair(fs::path("loaded.map"), map_offset);
+    }
+    if(map_offset < 200000) {
+        return std::make_pair(fs::path("secondary_map.map"), map_offset - 100000);
+    }
+    return std::nullopt;
+}
+
+/**
+ * Read the queued requests on this thread, like the worker does
+ */
+static std::size_t read_requests(TagDataPrefetchCache &cache) {
+    std::size_t count = 0;
+    while(auto request = cache.take_request()) {
+        auto data = std::make_unique<std::byte[]>(request->size);
+        synthetic_reader(*request, data.get());
+        cache.complete_request(*request, std::move(data));
+        count++;
+    }
+    return count;
+}
+
+/**
+ * Read a range through the cache and check it is the data of the map
+ */
+static bool read_matches(TagDataPrefetchCache &cache, std::size_t map_offset, std::size_t size) {
+    std::vector<std::byte> output(size);
+    if(!cache.read(map_offset, size, output.data())) {
+        return false;
+    }
+    auto location = locate(map_offset);
+    for(std::size_t i = 0; i < size; i++) {
+        if(output[i] != file_byte(location->first, location->second + i)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+TEST_CASE("requests are refused when the data is cached, queued, too large or nowhere") {
+    TagDataPrefetchCache cache(1000, synthetic_reader);
+    CHECK(cache.request(0, 100, locate));
+    CHECK(!cache.request(0, 100, locate));
+    CHECK(!cache.request(200, 0, locate));
+    CHECK(!cache.request(200, 1001, locate));
+    CHECK(!cache.request(250000, 100, locate));
+    CHECK(cache.stats().pending_requests == 1);
+    CHECK(cache.empty());
+
+    CHECK(read_requests(cache) == 1);
+    CHECK(!cache.empty());
+    CHECK(!cache.request(0, 100, locate));
+    auto stats = cache.stats();
+    CHECK(stats.cached_bytes == 100 && stats.bytes_prefetched == 100 && stats.pending_requests == 0);
+}
+
+TEST_CASE("reads are served when they fall inside one cached range") {
+    TagDataPrefetchCache cache(100000, synthetic_reader);
+    cache.request(1000, 500, locate);
+    cache.request(1500, 500, locate);
+    cache.request(150000, 300, locate);
+    read_requests(cache);
+
+    CHECK(read_matches(cache, 1000, 500));
+    CHECK(read_matches(cache, 1100, 50));
+    CHECK(read_matches(cache, 1999, 1));
+    CHECK(read_matches(cache, 150000, 300));
+    CHECK(read_matches(cache, 150299, 1));
+    auto stats = cache.stats();
+    CHECK(stats.hits == 5 && stats.misses == 0);
+
+    // Before the first range, past the end of a range, and across two ranges
+    std::vector<std::byte> output(1000);
+    CHECK(!cache.read(0, 10, output.data()));
+    CHECK(!cache.read(999, 2, output.data()));
+    CHECK(!cache.read(1900, 101, output.data()));
+    CHECK(!cache.read(1400, 200, output.data()));
+    CHECK(!cache.read(2000, 1, output.data()));
+    CHECK(!cache.read(150299, 2, output.data()));
+    stats = cache.stats();
+    CHECK(stats.hits == 5 && stats.misses == 6);
+}
+
+TEST_CASE("the least recently used data is evicted to stay within the cache size") {
+    TagDataPrefetchCache cache(100, synthetic_reader);
+    cache.request(0, 40, locate);
+    cache.request(100, 40, locate);
+    read_requests(cache);
+
+    // The first range was read last, so the second one goes
+    CHECK(read_matches(cache, 0, 40));
+    cache.request(200, 40, locate);
+    read_requests(cache);
+    CHECK(cache.stats().cached_bytes == 80);
+    CHECK(read_matches(cache, 0, 40));
+    CHECK(read_matches(cache, 200, 40));
+    std::byte output[40];
+    CHECK(!cache.read(100, 40, output));
+
+    // Data as large as the cache evicts everything else
+    cache.request(300, 100, locate);
+    read_requests(cache);
+    CHECK(cache.stats().cached_bytes == 100);
+    CHECK(read_matches(cache, 300, 100));
+    CHECK(!cache.read(0, 40, output));
+
+    // A smaller cache size applies to the next data
+    cache.set_cache_size(50);
+    cache.request(500, 30, locate);
+    read_requests(cache);
+    CHECK(cache.stats().cached_bytes == 30);
+    CHECK(read_matches(cache, 500, 30));
+}
+
+TEST_CASE("eviction follows the least recently used order on random reads") {
+    std::mt19937 random(29);
+    constexpr std::size_t cache_size = 4000;
+    TagDataPrefetchCache cache(cache_size, synthetic_reader);
+
+    // Model of the cache: offsets and sizes, most recently used first
+    std::list<std::pair<std::size_t, std::size_t>> model;
+    std::size_t model_bytes = 0;
+    std::size_t different = 0;
+    for(std::size_t i = 0; i < 5000; i++) {
+        std::size_t map_offset = (random() % 64) * 1000;
+        auto cached = std::find_if(model.begin(), model.end(), [&](auto &entry) { return entry.first == map_offset; });
+        if(random() % 2) {
+            std::size_t size = 100 + random() % 900;
+            bool queued = cache.request(map_offset, size, locate);
+            if(queued != (cached == model.end())) {
+                different++;
+            }
+            if(queued) {
+                read_requests(cache);
+                while(model_bytes + size > cache_size) {
+                    model_bytes -= model.back().second;
+                    model.pop_back();
+                }
+                model.emplace_front(map_offset, size);
+                model_bytes += size;
+            }
+        }
+        else {
+            std::byte output[100];
+            bool hit = cache.read(map_offset, 100, output);
+            if(hit != (cached != model.end())) {
+                different++;
+            }
+            if(hit) {
+                model.splice(model.begin(), model, cached);
+            }
+        }
+        if(cache.stats().cached_bytes != model_bytes) {
+            different++;
+        }
+    }
+    CHECK(different == 0);
+    CHECK(cache.stats().cached_bytes <= cache_size);
+}
+
+TEST_CASE("loading another map drops the cache and the reads made for the previous one") {
+    TagDataPrefetchCache cache(1000, synthetic_reader);
+    cache.request(0, 100, locate);
+    cache.request(200, 100, locate);
+    read_requests(cache);
+    std::byte output[100];
+    cache.read(0, 100, output);
+    cache.read(900, 100, output);
+
+    // Read when the map is loaded
+    cache.request(400, 100, locate);
+    auto in_flight = cache.take_request();
+    cache.request(600, 100, locate);
+    cache.reset();
+    auto stats = cache.stats();
+    CHECK(cache.empty());
+    CHECK(stats.hits == 0 && stats.misses == 0 && stats.bytes_prefetched == 0 && stats.cached_bytes == 0 && stats.pending_requests == 0);
+
+    // The same offset is requested for the new map before the old read is done; the old data is dropped
+    // and the new request stays queued
+    CHECK(cache.request(400, 100, locate));
+    cache.complete_request(*in_flight, std::make_unique<std::byte[]>(100));
+    CHECK(cache.empty());
+    CHECK(!cache.request(400, 100, locate));
+    CHECK(read_requests(cache) == 1);
+    CHECK(read_matches(cache, 400, 100));
+}
+
+TEST_CASE("failed reads are not cached and can be requested again") {
+    TagDataPrefetchCache cache(1000, synthetic_reader);
+    cache.request(0, 100, locate);
+    auto request = cache.take_request();
+    cache.complete_request(*request, nullptr);
+    CHECK(cache.empty());
+    CHECK(cache.stats().bytes_prefetched == 0);
+    CHECK(cache.request(0, 100, locate));
+}
+
+TEST_CASE("the worker reads map files and stops with the cache") {
+    auto file_path = fs::temp_directory_path() / "balltze_tag_data_prefetch_test.map";
+    {
+        std::ofstream file(file_path, std::ios::binary);
+        for(std::size_t i = 0; i < 10000; i++) {
+            file.put(static_cast<char>(i * 13));
+        }
+    }
+    auto locate_file = [&](std::size_t map_offset) -> std::optional<std::pair<fs::path, std::size_t>> {
+        return std::make_pair(file_path, map_offset);
+    };
+
+    {
+        TagDataPrefetchCache cache(100000);
+        cache.start_worker();
+        cache.start_worker();
+        CHECK(cache.request(1000, 3000, locate_file));
+        CHECK(cache.request(9000, 2000, locate_file));
+        cache.notify_worker();
+
+        auto deadline = std::chrono::steady_clock::now() + 10s;
+        while(cache.stats().bytes_prefetched < 3000 && std::chrono::steady_clock::now() < deadline) {
+            std::this_thread::sleep_for(1ms);
+        }
+        std::this_thread::sleep_for(10ms);
+
+        // The second read goes past the end of the file
+        auto stats = cache.stats();
+        CHECK(stats.bytes_prefetched == 3000 && stats.cached_bytes == 3000 && stats.pending_requests == 0);
+        std::byte output[3000];
+        CHECK(cache.read(1000, 3000, output));
+        bool same = true;
+        for(std::size_t i = 0; i < 3000; i++) {
+            same = same && output[i] == static_cast<std::byte>((1000 + i) * 13);
+        }
+        CHECK(same);
+
+        // Stopped workers start again
+        cache.stop_worker();
+        cache.stop_worker();
+        cache.start_worker();
+    }
+    fs::remove(file_path);
+
+    // The cache waits for a read in progress when it is destroyed
+    std::atomic<bool> reading = false;
+    std::atomic<bool> read_done = false;
+    {
+        TagDataPrefetchCache cache(1000, [&](TagDataPrefetchRequest const &request, std::byte *data) {
+            reading = true;
+            std::this_thread::sleep_for(50ms);
+            read_done = true;
+            return synthetic_reader(request, data);
+        });
+        cache.start_worker();
+        cache.request(0, 100, locate);
+        cache.notify_worker();
+        while(!reading) {
+            std::this_thread::yield();
+        }
+    }
+    CHECK(read_done);
+}
+
+TEST_MAIN()
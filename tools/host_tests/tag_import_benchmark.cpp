@@ -0,0 +1,148 @@
+// SPDX-License-Identifier: GPL-3.0-only
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <new>
+#include <vector>
+#include <features/tags_handling/map_cache.hpp>
+#include <features/tags_handling/secondary_map_cache.hpp>
+#include <features/tags_handling/tags_handling.hpp>
+#include "engine_stand_in.hpp"
+#include "synthetic_map.hpp"
+#include "host_test.hpp"
+
+using namespace Balltze::Engine;
+using namespace Balltze::Features;
+
+namespace fs = std::filesystem;
+
+static std::size_t heap_allocations = 0;
+static std::size_t heap_allocated_bytes = 0;
+
+void *operator new(std::size_t size) {
+    heap_allocations++;
+    heap_allocated_bytes += size;
+    if(auto *pointer = std::malloc(size ? size : 1)) {
+        return pointer;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void *pointer) noexcept {
+    std::free(pointer);
+}
+
+void operator delete(void *pointer, std::size_t) noexcept {
+    std::free(pointer);
+}
+
+// Same size as the virtual tag data buffer of the game
+constexpr std::size_t virtual_tag_data_buffer_size = 64 * 1024 * 1024;
+
+static std::size_t argument_value(int argc, const char **argv, const char *name, std::size_t default_value) {
+    for(int i = 1; i + 1 < argc; i++) {
+        if(std::strcmp(argv[i], name) == 0) {
+            return std::strtoull(argv[i + 1], nullptr, 10);
+        }
+    }
+    return default_value;
+}
+
+/**
+ * Import all the tags of a synthetic map; usage:
+ *   tag_import_benchmark [--quick] [--tags N] [--elements N] [--element-data-size BYTES] [--blob-size BYTES] [--iterations N]
+ */
+int main(int argc, const char **argv) {
+    bool quick = HostTest::quick_run(argc, argv);
+
+    HostTest::SyntheticMapParameters parameters;
+    parameters.tag_count = argument_value(argc, argv, "--tags", quick ? 64 : 4000);
+    parameters.elements_per_tag = argument_value(argc, argv, "--elements", 4);
+    parameters.element_data_size = argument_value(argc, argv, "--element-data-size", 64);
+    parameters.blob_size = argument_value(argc, argv, "--blob-size", 2048);
+    std::size_t iterations = argument_value(argc, argv, "--iterations", quick ? 2 : 20);
+
+    HostTest::reset_engine_stand_in();
+    auto path = fs::temp_directory_path() / "balltze_tag_import_benchmark.map";
+    auto tag_data_size = HostTest::write_synthetic_map(path, parameters);
+    auto tag_data_mib = static_cast<double>(tag_data_size) / (1024 * 1024);
+    std::printf("Synthetic map: %zu tags, %zu elements per tag, %.2f MiB of tag data\n", parameters.tag_count, parameters.elements_per_tag, tag_data_mib);
+
+    std::vector<std::byte> raw_tag_data;
+    {
+        MapCache map(path);
+        map.read_header_from_file();
+        map.read_tag_data_from_file();
+        raw_tag_data.assign(map.tag_data(), map.tag_data() + tag_data_size);
+    }
+
+    auto ns = HostTest::benchmark("read map header and tag data from file", iterations, parameters.tag_count, [&]() {
+        MapCache map(path);
+        map.read_header_from_file();
+        map.read_tag_data_from_file();
+        HostTest::do_not_optimize(map.tag_data_header().tag_count);
+    });
+    std::printf("%-48s %12.1f MiB/s\n", "", tag_data_mib * 1e9 / ns);
+
+    // Address translations are kept per cache, so every run takes a new one
+    auto copy_ns = HostTest::benchmark("read tag data from buffer", iterations, parameters.tag_count, [&]() {
+        MapCache map(path);
+        map.read_header_from_file();
+        map.read_tag_data_from_buffer(raw_tag_data.data());
+        HostTest::do_not_optimize(map.tag_data());
+    });
+
+    auto rebase_ns = HostTest::benchmark("read tag data from buffer + rebase all tags", iterations, parameters.tag_count, [&]() {
+        MapCache map(path);
+        map.read_header_from_file();
+        map.read_tag_data_from_buffer(raw_tag_data.data());
+        auto *tag_array = reinterpret_cast<Tag *>(map.tag_data() + sizeof(TagDataHeader));
+        for(std::size_t i = 0; i < parameters.tag_count; i++) {
+            tag_array[i].data = map.translate_address(tag_array[i].data);
+            rebase_tag_data_offsets(tag_array + i, map.tag_data());
+        }
+        HostTest::do_not_optimize(map.tag_data());
+    });
+    std::printf("%-48s %12.1f ns/tag for the rebase\n", "", (rebase_ns - copy_ns) / parameters.tag_count);
+
+    // The map is read from the file like the game does, then imported
+    auto import = [&](VirtualTagData &virtual_tag_data) {
+        SecondaryMapCache map(path);
+        map.import_all_tags();
+        map.load_tag_data(virtual_tag_data, map.header().file_size, 0, 0);
+        virtual_tag_data.update_tag_data_header();
+    };
+
+    HostTest::benchmark("import all tags", iterations, parameters.tag_count, [&]() {
+        VirtualTagData virtual_tag_data(virtual_tag_data_buffer_size);
+        import(virtual_tag_data);
+        HostTest::do_not_optimize(virtual_tag_data.tag_count());
+    });
+
+    // Allocations of a single import; the virtual tag data buffer is allocated up front like in the game
+    VirtualTagData virtual_tag_data(virtual_tag_data_buffer_size);
+    auto allocations_before = heap_allocations;
+    auto allocated_bytes_before = heap_allocated_bytes;
+    import(virtual_tag_data);
+    std::printf("Import allocations: %zu heap allocations (%.2f MiB), %zu tag data allocations (%.2f MiB)\n",
+        heap_allocations - allocations_before, static_cast<double>(heap_allocated_bytes - allocated_bytes_before) / (1024 * 1024),
+        virtual_tag_data.tag_data_allocations(), static_cast<double>(virtual_tag_data.tag_data_size()) / (1024 * 1024));
+
+    // Resolving again with a resolver that keeps the handles leaves the imported tags as they are
+    auto &tag_data_header = get_tag_data_header();
+    std::size_t dependencies = 0;
+    HostTest::benchmark("resolve tag dependencies of all tags", iterations, tag_data_header.tag_count, [&]() {
+        for(std::size_t i = 0; i < tag_data_header.tag_count; i++) {
+            resolve_tag_dependencies(tag_data_header.tag_array + i, [&dependencies](TagHandle handle) -> TagHandle {
+                dependencies++;
+                return handle;
+            });
+        }
+    });
+    HostTest::do_not_optimize(dependencies);
+
+    fs::remove(path);
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,247 @@
+// SPDX-License-Identifier: GPL-3.0-only
+
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <set>
+#include <stdexcept>
+#include <balltze/engine/tag_definitions.hpp>
+#include <features/tags_handling/map_cache.hpp>
+#include <features/tags_handling/secondary_map_cache.hpp>
+#include <features/tags_handling/tags_handling.hpp>
+#include "engine_stand_in.hpp"
+#include "synthetic_map.hpp"
+#include "host_test.hpp"
+
+using namespace Balltze::Engine;
+using namespace Balltze::Engine::TagDefinitions;
+using namespace Balltze::Features;
+
+namespace fs = std::filesystem;
+
+static fs::path synthetic_map_path(const char *name) {
+    return fs::temp_directory_path() / (std::string("balltze_") + name + ".map");
+}
+
+static bool data_matches(TagDataOffset const &data, std::size_t tag_index, std::size_t block) {
+    for(std::size_t i = 0; i < data.size; i++) {
+        if(data.pointer[i] != HostTest::synthetic_data_byte(tag_index, block, i)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static bool is_within(void const *pointer, std::byte const *begin, std::size_t size) {
+    auto *byte = reinterpret_cast<std::byte const *>(pointer);
+    return byte >= begin && byte < begin + size;
+}
+
+TEST_CASE("map header and tag data are read from a synthetic cache file") {
+    HostTest::reset_engine_stand_in();
+    HostTest::SyntheticMapParameters parameters;
+    parameters.tag_count = 10;
+    auto path = synthetic_map_path("parse");
+    auto tag_data_size = HostTest::write_synthetic_map(path, parameters);
+
+    MapCache map(path);
+    map.read_header_from_file();
+    CHECK(map.name() == "balltze_parse");
+    CHECK(map.header().head == MapHeader::HEAD_LITERAL);
+    CHECK(map.header().foot == MapHeader::FOOT_LITERAL);
+    CHECK(map.header().engine_type == CACHE_FILE_CUSTOM_EDITION);
+    CHECK(map.header().tag_data_size == tag_data_size);
+    CHECK(map.header().file_size == sizeof(MapHeader) + tag_data_size);
+
+    map.read_tag_data_from_file();
+    CHECK(map.tag_data_header().tag_count == 10);
+    CHECK(map.tag_data_header().tags_literal == 0x74616773);
+
+    auto *tag = map.get_raw_tag(HostTest::synthetic_tag_handle(7));
+    CHECK(tag != nullptr);
+    CHECK(map.get_raw_tag(TagHandle::null()) == nullptr);
+
+    // Addresses are translated from where the engine loads the tag data to where the cache holds it
+    auto *path_string = map.translate_address(tag->path);
+    CHECK(is_within(path_string, map.tag_data(), tag_data_size));
+    CHECK(std::strcmp(path_string, HostTest::synthetic_tag_path(7).c_str()) == 0);
+    CHECK(map.translate_address(path_string) == path_string);
+    CHECK(map.translate_address(static_cast<char *>(nullptr)) == nullptr);
+
+    fs::remove(path);
+}
+
+TEST_CASE("rebased tag data points into the map cache and external offsets are resolved") {
+    HostTest::reset_engine_stand_in();
+    HostTest::SyntheticMapParameters parameters;
+    parameters.tag_count = 4;
+    parameters.elements_per_tag = 3;
+    auto path = synthetic_map_path("rebase");
+    auto tag_data_size = HostTest::write_synthetic_map(path, parameters);
+
+    MapCache map(path);
+    map.read_header_from_file();
+    map.read_tag_data_from_file();
+    auto *tag_array = reinterpret_cast<Tag *>(map.tag_data() + sizeof(TagDataHeader));
+    auto &tag = tag_array[2];
+    tag.data = map.translate_address(tag.data);
+    auto original_file_offset = reinterpret_cast<ImportTest *>(tag.data)->blob.file_offset;
+    rebase_tag_data_offsets(&tag, map.tag_data(), [](std::uint32_t offset) -> std::uint32_t {
+        return offset + 0x1000;
+    });
+
+    auto &tag_data = *reinterpret_cast<ImportTest *>(tag.data);
+    CHECK(tag_data.flags == 2);
+    CHECK(is_within(tag_data.elements.elements, map.tag_data(), tag_data_size));
+    CHECK(is_within(tag_data.blob.pointer, map.tag_data(), tag_data_size));
+    CHECK(tag_data.blob.file_offset == original_file_offset + 0x1000);
+    CHECK(data_matches(tag_data.blob, 2, 3));
+    auto parent = HostTest::synthetic_reference(parameters, 2, 3);
+    CHECK(std::strcmp(tag_data.parent.path, HostTest::synthetic_tag_path(parent).c_str()) == 0);
+    for(std::size_t i = 0; i < tag_data.elements.count; i++) {
+        auto &element = tag_data.elements.elements[i];
+        CHECK(element.value == 2.0f + static_cast<float>(i) / 8.0f);
+        CHECK(data_matches(element.data, 2, i));
+        CHECK(std::strcmp(element.reference.path, HostTest::synthetic_tag_path(HostTest::synthetic_reference(parameters, 2, i)).c_str()) == 0);
+    }
+
+    fs::remove(path);
+}
+
+TEST_CASE("imported tags are copied into the virtual tag data with their dependencies resolved") {
+    HostTest::reset_engine_stand_in();
+    HostTest::SyntheticMapParameters parameters;
+    parameters.tag_count = 50;
+    parameters.elements_per_tag = 2;
+    parameters.blob_size = 100;
+    auto path = synthetic_map_path("import");
+    auto tag_data_size = HostTest::write_synthetic_map(path, parameters);
+
+    SecondaryMapCache map(path);
+    map.import_all_tags();
+
+    // Pretend the loaded map has tags of its own, so imported handles do not match the original ones
+    VirtualTagData virtual_tag_data(4 * tag_data_size);
+    Tag loaded_tags[3] = {};
+    for(std::size_t i = 0; i < 3; i++) {
+        loaded_tags[i].handle.index = static_cast<std::uint16_t>(i);
+        loaded_tags[i].handle.id = static_cast<std::uint16_t>(0xE174 + i);
+    }
+    virtual_tag_data.insert_tags_entries_front(loaded_tags, 3);
+
+    map.load_tag_data(virtual_tag_data, 0x4000, 0, 0);
+    virtual_tag_data.update_tag_data_header();
+
+    CHECK(virtual_tag_data.tag_count() == 53);
+    CHECK(get_tag_data_header().tag_count == 53);
+    CHECK(virtual_tag_data.tag_data_size() <= tag_data_size);
+
+    for(std::size_t i = 0; i < parameters.tag_count; i++) {
+        auto handle = map.translate_tag_handle(HostTest::synthetic_tag_handle(i));
+        CHECK(handle.has_value());
+        if(!handle) {
+            continue;
+        }
+        CHECK(handle->index >= 3);
+
+        auto *tag = get_tag(*handle);
+        CHECK(tag != nullptr);
+        if(!tag) {
+            continue;
+        }
+        CHECK(std::strcmp(tag->path, HostTest::synthetic_tag_path(i).c_str()) == 0);
+        CHECK(!is_within(tag->data, map.tag_data(), tag_data_size));
+
+        auto &tag_data = *reinterpret_cast<ImportTest *>(tag->data);
+        CHECK(tag_data.flags == i);
+        CHECK(tag_data.parent.tag_handle == *map.translate_tag_handle(HostTest::synthetic_tag_handle(HostTest::synthetic_reference(parameters, i, 2))));
+        CHECK(tag_data.blob.size == HostTest::synthetic_blob_size(parameters, i));
+        CHECK(!is_within(tag_data.blob.pointer, map.tag_data(), tag_data_size));
+        CHECK(data_matches(tag_data.blob, i, 2));
+        CHECK(!is_within(tag_data.elements.elements, map.tag_data(), tag_data_size));
+        for(std::size_t j = 0; j < tag_data.elements.count; j++) {
+            auto &element = tag_data.elements.elements[j];
+            auto reference = HostTest::synthetic_reference(parameters, i, j);
+            CHECK(element.reference.tag_handle == *map.translate_tag_handle(HostTest::synthetic_tag_handle(reference)));
+            CHECK(get_tag(element.reference.tag_handle) != nullptr);
+            CHECK(!is_within(element.data.pointer, map.tag_data(), tag_data_size));
+            CHECK(data_matches(element.data, i, j));
+        }
+    }
+
+    fs::remove(path);
+}
+
+TEST_CASE("tags imported by path bring the tags they depend on") {
+    HostTest::reset_engine_stand_in();
+    HostTest::SyntheticMapParameters parameters;
+    parameters.tag_count = 200;
+    parameters.elements_per_tag = 1;
+    auto path = synthetic_map_path("import_by_path");
+    auto tag_data_size = HostTest::write_synthetic_map(path, parameters);
+
+    SecondaryMapCache map(path);
+    map.add_tag_import(HostTest::synthetic_tag_path(5), TAG_CLASS_IMPORT_TEST);
+    map.add_tag_import(HostTest::synthetic_tag_path(5), TAG_CLASS_IMPORT_TEST);
+    map.add_tag_import("missing\\tag", TAG_CLASS_NULL);
+    VirtualTagData virtual_tag_data(4 * tag_data_size);
+    map.load_tag_data(virtual_tag_data, 0x4000, 0, 0);
+    virtual_tag_data.update_tag_data_header();
+
+    // Tags referenced by the parent dependency and the element of each tag, from the requested one
+    std::set<std::size_t> expected;
+    std::vector<std::size_t> pending = {5};
+    while(!pending.empty()) {
+        auto index = pending.back();
+        pending.pop_back();
+        if(expected.insert(index).second) {
+            for(std::size_t block = 0; block <= parameters.elements_per_tag; block++) {
+                pending.push_back(HostTest::synthetic_reference(parameters, index, block));
+            }
+        }
+    }
+    CHECK(virtual_tag_data.tag_count() == expected.size());
+    for(std::size_t i = 0; i < parameters.tag_count; i++) {
+        CHECK(map.translate_tag_handle(HostTest::synthetic_tag_handle(i)).has_value() == (expected.count(i) > 0));
+    }
+
+    // Imported tags are found by path, and lead back to the tag of the map
+    auto *tag = map.get_tag(HostTest::synthetic_tag_path(5), TAG_CLASS_IMPORT_TEST);
+    CHECK(tag != nullptr);
+    if(tag) {
+        CHECK(map.get_origin_tag_handle(tag->handle) == HostTest::synthetic_tag_handle(5));
+    }
+    CHECK(map.get_tag(HostTest::synthetic_tag_path(5), TAG_CLASS_OTHER) == nullptr);
+
+    fs::remove(path);
+}
+
+TEST_CASE("maps which are not Custom Edition maps are not imported from") {
+    HostTest::reset_engine_stand_in();
+    HostTest::SyntheticMapParameters parameters;
+    parameters.tag_count = 4;
+    auto path = synthetic_map_path("engine");
+    HostTest::write_synthetic_map(path, parameters);
+
+    auto error_for_engine = [&](CacheFileEngine engine) -> std::string {
+        {
+            std::fstream file(path, std::ios::binary | std::ios::in | std::ios::out);
+            file.seekp(offsetof(MapHeader, engine_type));
+            file.write(reinterpret_cast<const char *>(&engine), sizeof(engine));
+        }
+        try {
+            SecondaryMapCache map(path);
+        }
+        catch(std::runtime_error &e) {
+            return e.what();
+        }
+        return {};
+    };
+    CHECK(error_for_engine(CACHE_FILE_CUSTOM_EDITION_COMPRESSED) == "Map file is compressed");
+    CHECK(error_for_engine(CACHE_FILE_RETAIL) == "Map file is not a Halo Custom Edition map");
+    CHECK(error_for_engine(CACHE_FILE_CUSTOM_EDITION).empty());
+
+    fs::remove(path);
+}
+
+TEST_MAIN()
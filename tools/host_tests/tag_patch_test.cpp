@@ -0,0 +1,225 @@
+// SPDX-License-Identifier: GPL-3.0-only
+
+#include <deque>
+#include <memory>
+#include <balltze/engine/tag.hpp>
+#include <balltze/engine/tag_definitions.hpp>
+#include <balltze/features/tags_handling.hpp>
+#include "host_test.hpp"
+
+using namespace Balltze;
+using namespace Balltze::Engine;
+using namespace Balltze::Engine::TagDefinitions;
+using Features::TagDataPatchSummary;
+
+namespace Balltze::Features {
+    // Generated from data/patch_test.json by lua/code_gen/tag_copy_data_function.lua
+    bool patch_tag_data(Tag *tag, Tag *source_tag, std::function<std::byte *(std::byte *, std::size_t)> data_allocator, TagDataPatchSummary &summary);
+}
+
+/**
+ * A patch_test tag and the memory its reflexive and data blocks point to
+ */
+struct SyntheticTag {
+    PatchTest data = {};
+    std::vector<PatchTestElement> elements;
+    std::deque<std::vector<std::byte>> buffers;
+    Tag tag = {};
+
+    SyntheticTag(std::uint32_t base_value, float scale, std::vector<std::pair<float, std::string>> const &element_values, std::string const &blob) {
+        data.base_value = base_value;
+        data.scale = scale;
+        data.count = static_cast<std::int16_t>(element_values.size());
+        for(auto &[value, element_data] : element_values) {
+            PatchTestElement element = {};
+            element.value = value;
+            element.data = make_data(element_data);
+            elements.push_back(element);
+        }
+        data.elements.count = elements.size();
+        data.elements.elements = elements.empty() ? nullptr : elements.data();
+        data.blob = make_data(blob);
+        tag.primary_class = TAG_CLASS_PATCH_TEST;
+        tag.data = reinterpret_cast<std::byte *>(&data);
+    }
+
+    SyntheticTag(SyntheticTag const &) = delete;
+
+    TagDataOffset make_data(std::string const &bytes) {
+        TagDataOffset data_offset = {};
+        data_offset.size = bytes.size();
+        if(!bytes.empty()) {
+            auto &buffer = buffers.emplace_back(bytes.size());
+            std::memcpy(buffer.data(), bytes.data(), bytes.size());
+            data_offset.pointer = buffer.data();
+        }
+        return data_offset;
+    }
+};
+
+/**
+ * Allocator that copies the data like the virtual tag data one does
+ */
+struct TestAllocator {
+    std::deque<std::unique_ptr<std::byte[]>> allocations;
+
+    std::function<std::byte *(std::byte *, std::size_t)> function() {
+        return [this](std::byte *data, std::size_t size) {
+            auto &allocation = allocations.emplace_back(std::make_unique<std::byte[]>(size));
+            std::memcpy(allocation.get(), data, size);
+            return allocation.get();
+        };
+    }
+
+    bool owns(void const *pointer) const {
+        for(auto &allocation : allocations) {
+            if(allocation.get() == pointer) {
+                return true;
+            }
+        }
+        return false;
+    }
+};
+
+static bool data_equals(TagDataOffset const &data_offset, std::string const &bytes) {
+    return data_offset.size == bytes.size() && (bytes.empty() ? data_offset.pointer == nullptr : std::memcmp(data_offset.pointer, bytes.data(), bytes.size()) == 0);
+}
+
+static TagDataPatchSummary patch(SyntheticTag &tag, SyntheticTag &source, TestAllocator &allocator) {
+    TagDataPatchSummary summary;
+    CHECK(Features::patch_tag_data(&tag.tag, &source.tag, allocator.function(), summary));
+    return summary;
+}
+
+TEST_CASE("identical tags are left untouched") {
+    SyntheticTag tag(1, 2.0f, {{1.0f, "abc"}, {2.0f, ""}}, "blob");
+    SyntheticTag source(1, 2.0f, {{1.0f, "abc"}, {2.0f, ""}}, "blob");
+    TestAllocator allocator;
+    auto *elements = tag.data.elements.elements;
+    auto *blob = tag.data.blob.pointer;
+
+    auto summary = patch(tag, source, allocator);
+    CHECK(summary.fields_patched == 0);
+    CHECK(summary.bytes_patched == 0);
+    CHECK(summary.blocks_reallocated == 0);
+    CHECK(summary.data_reallocated == 0);
+    CHECK(allocator.allocations.empty());
+    CHECK(tag.data.elements.elements == elements);
+    CHECK(tag.data.blob.pointer == blob);
+}
+
+TEST_CASE("changed scalar fields are patched in place, including inherited ones") {
+    SyntheticTag tag(1, 2.0f, {{1.0f, ""}}, "");
+    SyntheticTag source(7, 3.0f, {{1.0f, ""}}, "");
+    TestAllocator allocator;
+
+    auto summary = patch(tag, source, allocator);
+    CHECK(summary.fields_patched == 2);
+    CHECK(summary.bytes_patched == sizeof(std::uint32_t) + sizeof(float));
+    CHECK(tag.data.base_value == 7);
+    CHECK(tag.data.scale == 3.0f);
+    CHECK(tag.data.count == 1);
+    CHECK(allocator.allocations.empty());
+}
+
+TEST_CASE("elements of a reflexive with the same count are patched in place") {
+    SyntheticTag tag(1, 2.0f, {{1.0f, "abc"}, {2.0f, "def"}}, "");
+    SyntheticTag source(1, 2.0f, {{1.0f, "abc"}, {5.0f, "xyz"}}, "");
+    TestAllocator allocator;
+    auto *elements = tag.data.elements.elements;
+    auto *element_data = tag.elements[1].data.pointer;
+
+    auto summary = patch(tag, source, allocator);
+    CHECK(summary.fields_patched == 2);
+    CHECK(summary.bytes_patched == sizeof(float) + 3);
+    CHECK(summary.blocks_reallocated == 0);
+    CHECK(summary.data_reallocated == 0);
+    CHECK(allocator.allocations.empty());
+    CHECK(tag.data.elements.elements == elements);
+    CHECK(tag.elements[1].value == 5.0f);
+    CHECK(tag.elements[1].data.pointer == element_data);
+    CHECK(data_equals(tag.elements[1].data, "xyz"));
+    CHECK(data_equals(tag.elements[0].data, "abc"));
+}
+
+TEST_CASE("a reflexive with a different count is reallocated from the source") {
+    SyntheticTag tag(1, 2.0f, {{1.0f, "abc"}}, "");
+    SyntheticTag source(1, 2.0f, {{4.0f, "four"}, {5.0f, ""}, {6.0f, "six"}}, "");
+    TestAllocator allocator;
+
+    auto summary = patch(tag, source, allocator);
+    CHECK(summary.blocks_reallocated == 1);
+    CHECK(summary.data_reallocated == 0);
+    CHECK(tag.data.elements.count == 3);
+    CHECK(allocator.owns(tag.data.elements.elements));
+    CHECK(tag.data.elements.elements != source.data.elements.elements);
+    CHECK(tag.data.elements.elements[0].value == 4.0f);
+    CHECK(tag.data.elements.elements[2].value == 6.0f);
+
+    // The data blocks of the new elements are copies, not the source memory
+    CHECK(data_equals(tag.data.elements.elements[0].data, "four"));
+    CHECK(allocator.owns(tag.data.elements.elements[0].data.pointer));
+    CHECK(tag.data.elements.elements[1].data.pointer == nullptr);
+    CHECK(allocator.owns(tag.data.elements.elements[2].data.pointer));
+}
+
+TEST_CASE("an emptied reflexive is cleared") {
+    SyntheticTag tag(1, 2.0f, {{1.0f, "abc"}}, "");
+    SyntheticTag source(1, 2.0f, {}, "");
+    TestAllocator allocator;
+
+    auto summary = patch(tag, source, allocator);
+    CHECK(summary.blocks_reallocated == 1);
+    CHECK(tag.data.elements.count == 0);
+    CHECK(tag.data.elements.elements == nullptr);
+    CHECK(allocator.allocations.empty());
+}
+
+TEST_CASE("data with the same size is patched in place") {
+    SyntheticTag tag(1, 2.0f, {}, "aaaa");
+    SyntheticTag source(1, 2.0f, {}, "abba");
+    TestAllocator allocator;
+    auto *blob = tag.data.blob.pointer;
+
+    auto summary = patch(tag, source, allocator);
+    CHECK(summary.fields_patched == 1);
+    CHECK(summary.bytes_patched == 4);
+    CHECK(summary.data_reallocated == 0);
+    CHECK(tag.data.blob.pointer == blob);
+    CHECK(data_equals(tag.data.blob, "abba"));
+}
+
+TEST_CASE("data with a different size is reallocated") {
+    SyntheticTag tag(1, 2.0f, {}, "aaaa");
+    SyntheticTag source(1, 2.0f, {}, "longer blob");
+    TestAllocator allocator;
+
+    auto summary = patch(tag, source, allocator);
+    CHECK(summary.data_reallocated == 1);
+    CHECK(summary.bytes_patched == 11);
+    CHECK(allocator.owns(tag.data.blob.pointer));
+    CHECK(data_equals(tag.data.blob, "longer blob"));
+
+    SyntheticTag empty_source(1, 2.0f, {}, "");
+    summary = patch(tag, empty_source, allocator);
+    CHECK(summary.data_reallocated == 1);
+    CHECK(tag.data.blob.pointer == nullptr);
+    CHECK(tag.data.blob.size == 0);
+}
+
+TEST_CASE("tags of another class are not patched") {
+    SyntheticTag tag(1, 2.0f, {}, "");
+    SyntheticTag source(7, 2.0f, {}, "");
+    source.tag.primary_class = TAG_CLASS_OTHER;
+    TestAllocator allocator;
+
+    TagDataPatchSummary summary;
+    CHECK(!Features::patch_tag_data(&tag.tag, &source.tag, allocator.function(), summary));
+    CHECK(tag.data.base_value == 1);
+
+    tag.tag.primary_class = TAG_CLASS_OTHER;
+    CHECK(!Features::patch_tag_data(&tag.tag, &source.tag, allocator.function(), summary));
+    CHECK(summary.fields_patched == 0);
+}
+
+TEST_MAIN()
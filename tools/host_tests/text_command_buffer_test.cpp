@@ -0,0 +1,223 @@
+// SPDX-License-Identifier: GPL-3.0-only
+
+#include <algorithm>
+#include <cstdint>
+#include <random>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <output/text_command_buffer.hpp>
+#include "host_test.hpp"
+
+using namespace Balltze;
+
+/**
+ * Backend recording what the buffer submits, in the order it comes
+ */
+struct RecordingBackend {
+    struct Draw {
+        std::size_t group;
+        std::int16_t x;
+        std::uint32_t font;
+        ID3DXFont *override;
+        std::u16string text;
+    };
+
+    std::vector<Draw> draws;
+    std::vector<TextCommand> group_firsts;
+    std::size_t open_groups = 0;
+    bool unpaired = false;
+
+    void begin_group(TextCommand const &first) {
+        unpaired |= open_groups != 0;
+        open_groups++;
+        group_firsts.push_back(first);
+    }
+
+    void draw(TextCommand const &command, void const *text) {
+        unpaired |= open_groups != 1;
+        std::u16string copy;
+        if(command.wide) {
+            for(auto *c = static_cast<wchar_t const *>(text); *c; c++) {
+                copy += static_cast<char16_t>(*c);
+            }
+        }
+        else {
+            for(auto *c = static_cast<char const *>(text); *c; c++) {
+                copy += static_cast<char16_t>(static_cast<unsigned char>(*c));
+            }
+        }
+        draws.push_back({group_firsts.size() - 1, command.x, command.font.value, command.override, copy});
+    }
+
+    void end_group() {
+        unpaired |= open_groups != 1;
+        open_groups--;
+    }
+};
+
+static ID3DXFont *override_font(std::uintptr_t id) {
+    return reinterpret_cast<ID3DXFont *>(id);
+}
+
+/**
+ * Command of a font; x is used to tell commands apart
+ */
+static TextCommand text_command(std::int16_t x, std::uint32_t font, ID3DXFont *override = nullptr) {
+    TextCommand command = {};
+    command.x = x;
+    command.font = Engine::TagHandle(font);
+    command.override = override;
+    command.alignment = ALIGN_LEFT;
+    return command;
+}
+
+TEST_CASE("nothing is submitted from an empty buffer") {
+    TextCommandBuffer buffer;
+    RecordingBackend backend;
+    CHECK(buffer.empty());
+    buffer.submit(backend);
+    CHECK(backend.group_firsts.empty());
+    CHECK(backend.draws.empty());
+}
+
+TEST_CASE("commands are grouped by font with tag fonts first, keeping the order they were added in") {
+    TextCommandBuffer buffer;
+    buffer.add(std::string_view("a"), text_command(0, 0xE0020002));
+    buffer.add(std::string_view("b"), text_command(1, 0xE0010001, override_font(0x2000)));
+    buffer.add(std::string_view("c"), text_command(2, 0xE0010001));
+    buffer.add(std::string_view("d"), text_command(3, 0xE0020002));
+    buffer.add(std::string_view("e"), text_command(4, 0xE0010001, override_font(0x1000)));
+    buffer.add(std::string_view("f"), text_command(5, 0xE0010001));
+    buffer.add(std::string_view("g"), text_command(6, 0xE0010001, override_font(0x2000)));
+    buffer.add(std::string_view("h"), text_command(7, 0xE0020002));
+    CHECK(!buffer.empty());
+
+    RecordingBackend backend;
+    buffer.submit(backend);
+    CHECK(!backend.unpaired);
+    CHECK(backend.open_groups == 0);
+
+    std::u16string order;
+    std::vector<std::size_t> groups;
+    for(auto &draw : backend.draws) {
+        order += draw.text;
+        groups.push_back(draw.group);
+    }
+    CHECK(order == u"cfadhebg");
+    CHECK((groups == std::vector<std::size_t>{0, 0, 1, 1, 1, 2, 3, 3}));
+
+    // Each group begins with its first command
+    CHECK(backend.group_firsts.size() == 4);
+    CHECK(backend.group_firsts[0].x == 2);
+    CHECK(backend.group_firsts[1].x == 0);
+    CHECK(backend.group_firsts[2].x == 4 && backend.group_firsts[2].override == override_font(0x1000));
+    CHECK(backend.group_firsts[3].x == 1 && backend.group_firsts[3].override == override_font(0x2000));
+
+    // Submitting does not change the recorded commands
+    auto &commands = buffer.commands();
+    CHECK(commands.size() == 8);
+    for(std::size_t i = 0; i < commands.size(); i++) {
+        CHECK(commands[i].x == static_cast<std::int16_t>(i));
+    }
+}
+
+TEST_CASE("narrow and wide text is copied with a terminator and aligned") {
+    TextCommandBuffer buffer;
+
+    // The views are not null-terminated
+    std::string narrow = "narrow text";
+    std::wstring wide = L"wide éあ text";
+    buffer.add(std::string_view(narrow).substr(0, 6), text_command(0, 1));
+    buffer.add(std::wstring_view(wide).substr(0, 7), text_command(1, 1));
+    buffer.add(std::string_view("odd"), text_command(2, 1));
+    buffer.add(std::wstring_view(L"x"), text_command(3, 1));
+    buffer.add(std::string_view(""), text_command(4, 1));
+
+    auto &commands = buffer.commands();
+    CHECK(!commands[0].wide && commands[1].wide && !commands[2].wide && commands[3].wide);
+    CHECK(std::string_view(buffer.text<char>(commands[0])) == "narrow");
+    CHECK(std::wstring_view(buffer.text<wchar_t>(commands[1])) == L"wide éあ");
+    CHECK(std::string_view(buffer.text<char>(commands[2])) == "odd");
+    CHECK(std::wstring_view(buffer.text<wchar_t>(commands[3])) == L"x");
+    CHECK(std::string_view(buffer.text<char>(commands[4])).empty());
+    for(auto &command : commands) {
+        if(command.wide) {
+            CHECK(command.text_offset % alignof(wchar_t) == 0);
+        }
+    }
+
+    RecordingBackend backend;
+    buffer.submit(backend);
+    CHECK(backend.draws.size() == 5);
+    CHECK(backend.draws[1].text == u"wide éあ");
+    CHECK(backend.draws[3].text == u"x");
+}
+
+TEST_CASE("a cleared buffer is reused for the next frame") {
+    TextCommandBuffer buffer;
+    buffer.add(std::string_view("first frame"), text_command(0, 1));
+    buffer.add(std::wstring_view(L"first frame"), text_command(1, 2));
+    buffer.clear();
+    CHECK(buffer.empty());
+    CHECK(buffer.commands().empty());
+
+    RecordingBackend backend;
+    buffer.submit(backend);
+    CHECK(backend.draws.empty());
+
+    buffer.add(std::wstring_view(L"second"), text_command(0, 2));
+    buffer.add(std::string_view("frame"), text_command(1, 1));
+    buffer.submit(backend);
+    CHECK(backend.draws.size() == 2);
+    CHECK(backend.draws[0].text == u"frame");
+    CHECK(backend.draws[1].text == u"second");
+    CHECK(buffer.commands()[0].text_offset == 0);
+}
+
+TEST_CASE("random commands are submitted like a stable sort by font") {
+    std::mt19937 random(48);
+    TextCommandBuffer buffer;
+    for(std::size_t frame = 0; frame < 200; frame++) {
+        buffer.clear();
+        auto count = random() % 64;
+        for(std::size_t i = 0; i < count; i++) {
+            // Few fonts, so there are plenty of ties
+            auto override = random() % 4 == 0 ? override_font(0x1000 * (1 + random() % 3)) : nullptr;
+            auto command = text_command(static_cast<std::int16_t>(i), 0xE0000000 + random() % 5, override);
+            auto text = std::to_string(i);
+            if(random() % 2) {
+                buffer.add(std::string_view(text), command);
+            }
+            else {
+                buffer.add(std::wstring_view(std::wstring(text.begin(), text.end())), command);
+            }
+        }
+
+        auto expected = buffer.commands();
+        std::stable_sort(expected.begin(), expected.end(), [](TextCommand const &a, TextCommand const &b) {
+            auto a_override = reinterpret_cast<std::uintptr_t>(a.override);
+            auto b_override = reinterpret_cast<std::uintptr_t>(b.override);
+            return a_override != b_override ? a_override < b_override : a.font.value < b.font.value;
+        });
+
+        RecordingBackend backend;
+        buffer.submit(backend);
+        CHECK(!backend.unpaired && backend.open_groups == 0);
+        CHECK(backend.draws.size() == expected.size());
+        std::size_t groups = 0;
+        for(std::size_t i = 0; i < expected.size() && i < backend.draws.size(); i++) {
+            auto &draw = backend.draws[i];
+            CHECK(draw.x == expected[i].x);
+            auto text = std::to_string(expected[i].x);
+            CHECK(draw.text == std::u16string(text.begin(), text.end()));
+            if(i == 0 || expected[i - 1].override != expected[i].override || expected[i - 1].font.value != expected[i].font.value) {
+                groups++;
+            }
+            CHECK(draw.group + 1 == groups);
+        }
+        CHECK(backend.group_firsts.size() == groups);
+    }
+}
+
+TEST_MAIN()
@@ -0,0 +1,118 @@
+// SPDX-License-Identifier: GPL-3.0-only
+
+#include <chrono>
+#include <vector>
+#include <features/map_textures_preloading.hpp>
+#include "host_test.hpp"
+
+using namespace Balltze::Features;
+using namespace std::chrono_literals;
+
+// The scheduler only passes bitmap pointers to the loader, so the test gives them an identifier
+namespace Balltze::Engine::TagDefinitions {
+    struct BitmapData {
+        int id;
+    };
+}
+
+using Balltze::Engine::TagDefinitions::BitmapData;
+
+/**
+ * Loader that records the bitmaps it gets and moves a fake clock forward for each of them
+ */
+struct MockLoader {
+    std::vector<int> loaded;
+    std::chrono::steady_clock::time_point now = {};
+    std::chrono::microseconds load_time = 1000us;
+
+    TexturePreloadScheduler scheduler() {
+        return TexturePreloadScheduler([this](BitmapData *bitmap_data) {
+            loaded.push_back(bitmap_data->id);
+            now += load_time;
+        }, [this]() {
+            return now;
+        });
+    }
+};
+
+TEST_CASE("bitmaps are loaded by priority and in queue order within a priority") {
+    MockLoader loader;
+    auto scheduler = loader.scheduler();
+    BitmapData bitmaps[] = {{0}, {1}, {2}, {3}, {4}, {5}};
+    scheduler.enqueue(&bitmaps[0], TEXTURE_PRELOAD_PRIORITY_OTHER);
+    scheduler.enqueue(&bitmaps[1], TEXTURE_PRELOAD_PRIORITY_SCENARIO);
+    scheduler.enqueue(&bitmaps[2], TEXTURE_PRELOAD_PRIORITY_HUD);
+    scheduler.enqueue(&bitmaps[3], TEXTURE_PRELOAD_PRIORITY_OTHER);
+    scheduler.enqueue(&bitmaps[4], TEXTURE_PRELOAD_PRIORITY_HUD);
+    scheduler.enqueue(&bitmaps[5], TEXTURE_PRELOAD_PRIORITY_SCENARIO);
+    CHECK(scheduler.pending() == 6);
+
+    CHECK(scheduler.run(1h) == 6);
+    CHECK((loader.loaded == std::vector<int>{2, 4, 1, 5, 0, 3}));
+    CHECK(scheduler.pending() == 0);
+    CHECK(scheduler.loaded() == 6);
+    CHECK(scheduler.run(1h) == 0);
+}
+
+TEST_CASE("each run stops when the budget runs out") {
+    MockLoader loader;
+    auto scheduler = loader.scheduler();
+    std::vector<BitmapData> bitmaps(10);
+    for(int i = 0; i < 10; i++) {
+        bitmaps[i].id = i;
+        scheduler.enqueue(&bitmaps[i], TEXTURE_PRELOAD_PRIORITY_OTHER);
+    }
+
+    CHECK(scheduler.run(3ms) == 3);
+    CHECK(scheduler.pending() == 7);
+    CHECK(scheduler.run(2500us) == 3);
+    CHECK(scheduler.run(3ms) == 3);
+    CHECK(scheduler.run(3ms) == 1);
+    CHECK(scheduler.loaded() == 10);
+    CHECK((loader.loaded == std::vector<int>{0, 1, 2, 3, 4, 5, 6, 7, 8, 9}));
+}
+
+TEST_CASE("a run loads at least one bitmap even without budget") {
+    MockLoader loader;
+    loader.load_time = 50ms;
+    auto scheduler = loader.scheduler();
+    BitmapData bitmaps[] = {{0}, {1}};
+    scheduler.enqueue(&bitmaps[0], TEXTURE_PRELOAD_PRIORITY_OTHER);
+    scheduler.enqueue(&bitmaps[1], TEXTURE_PRELOAD_PRIORITY_OTHER);
+
+    CHECK(scheduler.run(0us) == 1);
+    CHECK(scheduler.run(1ms) == 1);
+    CHECK(scheduler.pending() == 0);
+}
+
+TEST_CASE("bitmaps queued between runs are ordered with the remaining ones") {
+    MockLoader loader;
+    auto scheduler = loader.scheduler();
+    BitmapData bitmaps[] = {{0}, {1}, {2}, {3}};
+    scheduler.enqueue(&bitmaps[0], TEXTURE_PRELOAD_PRIORITY_OTHER);
+    scheduler.enqueue(&bitmaps[1], TEXTURE_PRELOAD_PRIORITY_OTHER);
+    scheduler.enqueue(&bitmaps[2], TEXTURE_PRELOAD_PRIORITY_OTHER);
+    CHECK(scheduler.run(1ms) == 1);
+
+    scheduler.enqueue(&bitmaps[3], TEXTURE_PRELOAD_PRIORITY_HUD);
+    CHECK(scheduler.run(1h) == 3);
+    CHECK((loader.loaded == std::vector<int>{0, 3, 1, 2}));
+}
+
+TEST_CASE("clearing drops the queue and the loaded count") {
+    MockLoader loader;
+    auto scheduler = loader.scheduler();
+    BitmapData bitmaps[] = {{0}, {1}, {2}};
+    for(auto &bitmap : bitmaps) {
+        scheduler.enqueue(&bitmap, TEXTURE_PRELOAD_PRIORITY_SCENARIO);
+    }
+    CHECK(scheduler.run(1ms) == 1);
+
+    scheduler.clear();
+    CHECK(scheduler.pending() == 0);
+    CHECK(scheduler.loaded() == 0);
+    CHECK(scheduler.run(1h) == 0);
+    CHECK(loader.loaded.size() == 1);
+}
+
+TEST_MAIN()
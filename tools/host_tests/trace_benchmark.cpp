@@ -0,0 +1,81 @@
+// SPDX-License-Identifier: GPL-3.0-only
+
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <balltze/trace.hpp>
+#include <output/trace.hpp>
+#include "host_test.hpp"
+
+using namespace Balltze::Trace;
+namespace fs = std::filesystem;
+
+/** Size of the header of a trace file: magic, version, counter frequency and start counter */
+static constexpr std::size_t TRACE_FILE_HEADER_SIZE = 8 + 4 + 8 + 8;
+
+/** Size of a tick record: counter, event identifier, tick count and delta time */
+static constexpr std::size_t TICK_RECORD_SIZE = 8 + 2 + 4 + 4;
+
+/**
+ * Count the records in the records chunks of a trace file
+ */
+static std::size_t count_records(fs::path const &path) {
+    std::ifstream file(path, std::ios::binary);
+    std::string data(std::istreambuf_iterator<char>(file), {});
+    std::size_t offset = TRACE_FILE_HEADER_SIZE;
+    std::size_t records = 0;
+    while(offset + 8 <= data.size()) {
+        std::uint32_t header[2];
+        std::memcpy(header, data.data() + offset, sizeof(header));
+        if(header[0] == 2) {
+            records += (header[1] - 4) / TICK_RECORD_SIZE;
+        }
+        offset += 8 + header[1];
+    }
+    return offset == data.size() ? records : 0;
+}
+
+/**
+ * Time of a trace record with the trace stopped, where only the check of the flag is left, and with the trace
+ * running, including the writes of the full thread buffers to the file. Usage:
+ *   trace_benchmark [--quick]
+ */
+int main(int argc, const char **argv) {
+    bool quick = HostTest::quick_run(argc, argv);
+    constexpr std::size_t batch = 1000;
+    std::size_t iterations = quick ? 100 : 10000;
+    static TraceEvent<std::uint32_t, float> tick_trace("tick", {"tick_count", "delta_time"});
+
+    std::uint32_t tick_count = 0;
+    auto write_batch = [&]() {
+        for(std::size_t i = 0; i < batch; i++) {
+            tick_trace(tick_count++, 1.0f / 30.0f);
+        }
+    };
+    auto stopped = HostTest::benchmark("1000 records, trace stopped", iterations, batch, write_batch);
+
+    auto trace_path = start_trace();
+    if(!trace_path) {
+        std::fprintf(stderr, "the trace could not be started\n");
+        return EXIT_FAILURE;
+    }
+    tick_count = 0;
+    auto running = HostTest::benchmark("1000 records, trace running", iterations, batch, write_batch);
+    stop_trace();
+    std::printf("%.1f ns/record with the trace stopped, %.1f ns/record with the trace running\n", stopped / batch, running / batch);
+
+    // Every record made it to the file, including the ones of the warm up call
+    auto written = count_records(*trace_path);
+    auto expected = (iterations + 1) * batch;
+    fs::remove(*trace_path);
+    if(written != expected) {
+        std::fprintf(stderr, "%zu records written, expected %zu\n", written, expected);
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
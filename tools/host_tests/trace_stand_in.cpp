@@ -0,0 +1,23 @@
+// SPDX-License-Identifier: GPL-3.0-only
+
+#include <balltze/command.hpp>
+#include <balltze/engine/core.hpp>
+
+// The trace command is registered with the game hooks and printed to the console of the game; the tests start
+// and stop the trace themselves, so these do nothing.
+namespace Balltze {
+    Command::Command(std::string name, std::string category, std::string help, std::optional<std::string> params_help, CommandFunction function, bool autosave, std::size_t min_args, std::size_t max_args, bool can_call_from_console, bool is_public) :
+        m_name(name), m_category(category), m_help(help), m_params_help(params_help), m_function(function), m_autosave(autosave), m_min_args(min_args), m_max_args(max_args), m_can_call_from_console(can_call_from_console), m_public(is_public) {}
+
+    CommandResult Command::call(std::size_t, const char **) const noexcept {
+        return COMMAND_RESULT_FAILED_ERROR;
+    }
+
+    void Command::register_command_impl(HMODULE) {
+    }
+}
+
+namespace Balltze::Engine {
+    void console_print(std::string, ColorARGB) noexcept {
+    }
+}
@@ -0,0 +1,202 @@
+// SPDX-License-Identifier: GPL-3.0-only
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <thread>
+#include <vector>
+#include <sys/wait.h>
+#include <balltze/trace.hpp>
+#include <output/trace.hpp>
+#include "host_test.hpp"
+
+using namespace Balltze::Trace;
+namespace fs = std::filesystem;
+
+/** Size of the header of a trace file: magic, version, counter frequency and start counter */
+static constexpr std::size_t TRACE_FILE_HEADER_SIZE = 8 + 4 + 8 + 8;
+
+/** Size of a records chunk before its records: chunk type, chunk size and thread identifier */
+static constexpr std::size_t TRACE_RECORDS_CHUNK_HEADER_SIZE = 4 + 4 + 4;
+
+/** Size of the counter and the event identifier of a record */
+static constexpr std::size_t TRACE_RECORD_HEADER_SIZE = 8 + 2;
+
+struct DecodedTrace {
+    /** Records as JSON lines, without the time and the thread, which differ between runs */
+    std::vector<std::string> records;
+    std::string errors;
+    int exit_status;
+};
+
+/**
+ * Decode a trace file with the trace decoder
+ */
+static DecodedTrace decode(fs::path const &trace_path) {
+    DecodedTrace trace;
+    auto errors_path = fs::path(trace_path).concat(".errors");
+    auto command = std::string(TRACE_DECODER_PATH) + " --json \"" + trace_path.string() + "\" 2>\"" + errors_path.string() + "\"";
+    auto *output = popen(command.c_str(), "r");
+    char line[1024];
+    while(output && std::fgets(line, sizeof(line), output)) {
+        std::string record = line;
+        auto event = record.find("\"event\":");
+        record = record.substr(event == std::string::npos ? 0 : event);
+        while(!record.empty() && record.back() == '\n') {
+            record.pop_back();
+        }
+        trace.records.push_back(record);
+    }
+    auto status = output ? pclose(output) : -1;
+    trace.exit_status = WIFEXITED(status) ? WEXITSTATUS(status) : -1;
+    std::ifstream errors(errors_path);
+    trace.errors.assign(std::istreambuf_iterator<char>(errors), std::istreambuf_iterator<char>());
+    errors.close();
+    fs::remove(errors_path);
+    return trace;
+}
+
+static std::string read_file(fs::path const &path) {
+    std::ifstream file(path, std::ios::binary);
+    return std::string(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+}
+
+static void write_file(fs::path const &path, std::string const &data) {
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    file.write(data.data(), data.size());
+}
+
+static std::string sample_record(std::uint32_t index) {
+    return "\"event\":\"sample\",\"fields\":{\"index\":" + std::to_string(index) + "}}";
+}
+
+TEST_CASE("records of every thread are decoded with their fields") {
+    static TraceEvent<std::uint32_t, float> tick_trace("tick", {"tick_count", "delta_time"});
+    static TraceEvent<bool, std::int8_t, std::uint16_t, std::int64_t, double> mixed_trace("mixed", {"flag", "small", "medium", "large", "value"});
+
+    auto trace_path = start_trace();
+    CHECK(trace_path.has_value());
+    CHECK(trace_enabled());
+
+    // Registered while the trace is written, so its descriptor comes after the first ones
+    static TraceEvent<std::uint64_t> late_trace("late", {"value"});
+
+    // More records than a thread buffer holds, so the main thread writes them in several chunks
+    constexpr std::uint32_t tick_count = 10000;
+    for(std::uint32_t i = 0; i < tick_count; i++) {
+        tick_trace(i, 0.25f * (i % 8));
+    }
+
+    // The buffer of this thread is written when the thread exits
+    std::thread thread([]() {
+        for(std::int32_t i = 0; i < 1000; i++) {
+            mixed_trace(i % 2 == 0, static_cast<std::int8_t>(-(i % 100)), static_cast<std::uint16_t>(i * 7), -static_cast<std::int64_t>(i) * 1000000000000, i * 1.5);
+        }
+    });
+    thread.join();
+    late_trace(0xFFFFFFFFFFFFFFFF);
+    CHECK(stop_trace() == trace_path);
+    CHECK(!trace_enabled());
+
+    // Nothing is written once the trace is stopped
+    tick_trace(tick_count, 0.0f);
+
+    auto trace = decode(*trace_path);
+    CHECK(trace.exit_status == 0);
+    CHECK(trace.errors.empty());
+    CHECK(trace.records.size() == tick_count + 1000 + 1);
+
+    // Records of a thread keep their order when the decoder sorts them by time
+    std::vector<std::string> ticks, mixed, late;
+    for(auto &record : trace.records) {
+        auto &records = record.starts_with("\"event\":\"tick\"") ? ticks : record.starts_with("\"event\":\"mixed\"") ? mixed : late;
+        records.push_back(record);
+    }
+    bool ticks_match = ticks.size() == tick_count;
+    for(std::uint32_t i = 0; ticks_match && i < tick_count; i++) {
+        char expected[128];
+        std::snprintf(expected, sizeof(expected), "\"event\":\"tick\",\"fields\":{\"tick_count\":%u,\"delta_time\":%.9g}}", i, 0.25f * (i % 8));
+        ticks_match = ticks[i] == expected;
+    }
+    CHECK(ticks_match);
+    CHECK(mixed.size() == 1000);
+    CHECK(mixed.size() == 1000 && mixed[3] == "\"event\":\"mixed\",\"fields\":{\"flag\":false,\"small\":-3,\"medium\":21,\"large\":-3000000000000,\"value\":4.5}}");
+    CHECK(late.size() == 1 && late[0] == "\"event\":\"late\",\"fields\":{\"value\":18446744073709551615}}");
+    fs::remove(*trace_path);
+}
+
+TEST_CASE("a trace cut short keeps the records of the chunks before the cut") {
+    static TraceEvent<std::uint32_t> sample_trace("sample", {"index"});
+
+    // Only this event is written, so every records chunk holds records of the same size
+    auto trace_path = start_trace();
+    constexpr std::uint32_t sample_count = 20000;
+    for(std::uint32_t i = 0; i < sample_count; i++) {
+        sample_trace(i);
+    }
+    stop_trace();
+    auto data = read_file(*trace_path);
+
+    // Find where the chunks end and how many records were written before each end
+    struct ChunkEnd {
+        std::size_t offset;
+        std::size_t records;
+    };
+    std::vector<ChunkEnd> chunk_ends;
+    std::size_t offset = TRACE_FILE_HEADER_SIZE;
+    std::size_t records = 0;
+    std::size_t descriptors_end = 0;
+    while(offset + 8 <= data.size()) {
+        std::uint32_t header[2];
+        std::memcpy(header, data.data() + offset, sizeof(header));
+        if(header[0] == 2) {
+            records += (header[1] - 4) / (TRACE_RECORD_HEADER_SIZE + sizeof(std::uint32_t));
+        }
+        else {
+            descriptors_end = offset + 8 + header[1];
+        }
+        offset += 8 + header[1];
+        chunk_ends.push_back({offset, records});
+    }
+    CHECK(offset == data.size());
+    CHECK(records == sample_count);
+    CHECK(chunk_ends.size() > 4);
+
+    auto cut_path = fs::path(*trace_path).concat(".cut");
+    auto check_cut = [&](std::size_t size, std::size_t expected_records, bool complete) {
+        write_file(cut_path, data.substr(0, size));
+        auto trace = decode(cut_path);
+        bool same = trace.exit_status == 0 && trace.records.size() == expected_records;
+        for(std::size_t i = 0; same && i < expected_records; i++) {
+            same = trace.records[i] == sample_record(i);
+        }
+        same = same && (trace.errors.find("Stopped reading") != std::string::npos) == !complete;
+        if(!same) {
+            std::fprintf(stderr, "cut at %zu: %zu records, expected %zu; %s", size, trace.records.size(), expected_records, trace.errors.c_str());
+        }
+        return same;
+    };
+
+    // At the end of a chunk, in the header of the next one, in its thread identifier and in the middle of a record
+    auto &middle = chunk_ends[chunk_ends.size() / 2];
+    CHECK(check_cut(middle.offset, middle.records, true));
+    CHECK(check_cut(middle.offset + 5, middle.records, false));
+    CHECK(check_cut(middle.offset + 10, middle.records, false));
+    CHECK(check_cut(middle.offset + TRACE_RECORDS_CHUNK_HEADER_SIZE + TRACE_RECORD_HEADER_SIZE + 1, middle.records, false));
+
+    // One byte short of the whole file loses the last chunk
+    CHECK(check_cut(data.size() - 1, chunk_ends[chunk_ends.size() - 2].records, false));
+    CHECK(check_cut(data.size(), sample_count, true));
+
+    // Records of events whose descriptor was cut off are not decoded
+    CHECK(check_cut(descriptors_end - 1, 0, false));
+    CHECK(check_cut(TRACE_FILE_HEADER_SIZE, 0, true));
+    fs::remove(cut_path);
+    fs::remove(*trace_path);
+}
+
+TEST_MAIN()
@@ -0,0 +1,63 @@
+// SPDX-License-Identifier: GPL-3.0-only
+
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <vector>
+#include <invader/sound/sound_reader.hpp>
+#include "xbox_adpcm_reference.hpp"
+#include "host_test.hpp"
+
+/**
+ * Decoding Xbox ADPCM with the block decoder against the sample decoder, in mono and stereo; usage:
+ *   xbox_adpcm_benchmark [--quick] [--seconds N]
+ * N is the length of the decoded sound at 22050 Hz, 30 seconds by default.
+ */
+int main(int argc, const char **argv) {
+    bool quick = HostTest::quick_run(argc, argv);
+    std::size_t seconds = 30;
+    for(int i = 1; i + 1 < argc; i++) {
+        if(std::strcmp(argv[i], "--seconds") == 0) {
+            seconds = std::strtoull(argv[i + 1], nullptr, 10);
+        }
+    }
+    if(quick) {
+        seconds = 1;
+    }
+    std::size_t iterations = quick ? 2 : 20;
+
+    // Random headers and codes; the decoders take the same time whatever the samples are
+    std::mt19937 random(50);
+    std::size_t block_count = (seconds * 22050 + 63) / 64;
+    std::vector<std::byte> data(block_count * 2 * 36);
+    for(auto &byte : data) {
+        byte = static_cast<std::byte>(random());
+    }
+    std::printf("%zu blocks per channel\n", block_count);
+
+    int result = EXIT_SUCCESS;
+    for(std::size_t channel_count = 1; channel_count <= 2; channel_count++) {
+        auto size = block_count * channel_count * 36;
+        auto samples = block_count * channel_count * 64;
+        auto name = channel_count == 1 ? "mono" : "stereo";
+
+        char label[64];
+        std::snprintf(label, sizeof(label), "sample decoder, %s (samples)", name);
+        HostTest::benchmark(label, iterations, samples, [&]() {
+            HostTest::do_not_optimize(HostTest::reference_xbox_adpcm_decode(data.data(), size, channel_count).data());
+        });
+        std::snprintf(label, sizeof(label), "block decoder, %s (samples)", name);
+        HostTest::benchmark(label, iterations, samples, [&]() {
+            HostTest::do_not_optimize(Invader::SoundReader::sound_from_xbox_adpcm(data.data(), size, channel_count, 22050).pcm.data());
+        });
+
+        // Both decoders have to give the same samples
+        if(Invader::SoundReader::sound_from_xbox_adpcm(data.data(), size, channel_count, 22050).pcm != HostTest::reference_xbox_adpcm_decode(data.data(), size, channel_count)) {
+            std::fprintf(stderr, "%s samples are decoded differently\n", name);
+            result = EXIT_FAILURE;
+        }
+    }
+    return result;
+}
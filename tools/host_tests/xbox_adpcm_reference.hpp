@@ -0,0 +1,21 @@
+// SPDX-License-Identifier: GPL-3.0-only
+
+#ifndef BALLTZE_HOST_TESTS__XBOX_ADPCM_REFERENCE_HPP
+#define BALLTZE_HOST_TESTS__XBOX_ADPCM_REFERENCE_HPP
+
+#include <cstddef>
+#include <vector>
+
+namespace HostTest {
+    /**
+     * Decode Xbox ADPCM with the decoder Invader had before it decoded a block at a time: one sample
+     * at a time through an ADPCM state, with range checks in the loop
+     * @param data          Encoded blocks
+     * @param data_length   Size of the blocks; it has to be a multiple of 36
+     * @param channel_count Number of channels, 1 or 2
+     * @return              Decoded 16-bit PCM
+     */
+    std::vector<std::byte> reference_xbox_adpcm_decode(const std::byte *data, std::size_t data_length, std::size_t channel_count);
+}
+
+#endif
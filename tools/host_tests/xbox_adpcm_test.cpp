@@ -0,0 +1,172 @@
+// SPDX-License-Identifier: GPL-3.0-only
+
+#include <cstdint>
+#include <cstdio>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include <invader/sound/sound_reader.hpp>
+#include "xbox_adpcm_reference.hpp"
+#include "host_test.hpp"
+
+using Invader::SoundReader::sound_from_xbox_adpcm;
+using HostTest::reference_xbox_adpcm_decode;
+
+/**
+ * Kind of random blocks to write
+ */
+enum BlockKind {
+    // Random headers and codes
+    BLOCK_RANDOM,
+
+    // Step indices past both ends of the step table, which the decoders clamp
+    BLOCK_OUT_OF_RANGE_INDICES,
+
+    // Codes of one sign and large steps, so samples saturate
+    BLOCK_SATURATING,
+
+    // Codes which keep the step index at the bottom of the table
+    BLOCK_QUIET
+};
+
+/**
+ * Random Xbox ADPCM data: a 4-byte header then 32 bytes of codes for each channel of a block
+ */
+static std::vector<std::byte> random_blocks(std::mt19937 &random, std::size_t block_count, std::size_t channel_count, BlockKind kind) {
+    std::vector<std::byte> data;
+    auto push = [&](std::uint32_t byte) {
+        data.push_back(static_cast<std::byte>(byte));
+    };
+    for(std::size_t block = 0; block < block_count; block++) {
+        for(std::size_t channel = 0; channel < channel_count; channel++) {
+            std::int16_t sample = static_cast<std::int16_t>(random());
+            std::uint8_t index = static_cast<std::uint8_t>(random() % 89);
+            switch(kind) {
+                case BLOCK_OUT_OF_RANGE_INDICES:
+                    index = static_cast<std::uint8_t>(random() % 2 ? 89 + random() % 167 : random() % 256);
+                    break;
+                case BLOCK_SATURATING:
+                    sample = random() % 2 ? INT16_MAX - random() % 64 : INT16_MIN + random() % 64;
+                    index = static_cast<std::uint8_t>(70 + random() % 19);
+                    break;
+                case BLOCK_QUIET:
+                    index = static_cast<std::uint8_t>(random() % 4);
+                    break;
+                default:
+                    break;
+            }
+            push(static_cast<std::uint16_t>(sample) & 0xFF);
+            push(static_cast<std::uint16_t>(sample) >> 8);
+            push(index);
+            push(random());
+        }
+        for(std::size_t chunk = 0; chunk < 8; chunk++) {
+            for(std::size_t channel = 0; channel < channel_count; channel++) {
+                for(std::size_t i = 0; i < 4; i++) {
+                    std::uint32_t codes = random();
+                    if(kind == BLOCK_SATURATING) {
+                        // All 7s or all 15s, now and then a random code
+                        codes = (random() % 2 ? 0x77 : 0xFF) ^ (random() % 8 == 0 ? random() : 0);
+                    }
+                    else if(kind == BLOCK_QUIET) {
+                        codes &= 0x33;
+                    }
+                    push(codes);
+                }
+            }
+        }
+    }
+    return data;
+}
+
+/**
+ * Decode random streams of a number of blocks with both decoders and count those that differ
+ */
+static std::size_t different_streams(std::mt19937 &random, std::size_t block_count, std::size_t channel_count, std::size_t stream_count) {
+    std::size_t different = 0;
+    for(std::size_t i = 0; i < stream_count; i++) {
+        auto kind = static_cast<BlockKind>(i % 4);
+        auto data = random_blocks(random, block_count, channel_count, kind);
+        auto expected = reference_xbox_adpcm_decode(data.data(), data.size(), channel_count);
+        auto sound = sound_from_xbox_adpcm(data.data(), data.size(), channel_count, 22050);
+        if(sound.pcm != expected) {
+            if(different == 0) {
+                std::fprintf(stderr, "%zu blocks of %zu channels of kind %d decode differently\n", block_count, channel_count, kind);
+            }
+            different++;
+        }
+    }
+    return different;
+}
+
+TEST_CASE("random blocks decode the same as with the sample decoder") {
+    // Every number of blocks up to a few vector widths, for the blocks left to the scalar decoder
+    std::mt19937 random(50);
+    std::size_t different = 0;
+    std::size_t streams = 0;
+    for(std::size_t channel_count = 1; channel_count <= 2; channel_count++) {
+        for(std::size_t block_count = 0; block_count <= 40; block_count++) {
+            different += different_streams(random, block_count, channel_count, 100);
+            streams += 100;
+        }
+
+        // Longer streams, like those of the sound tags of the game
+        for(std::size_t block_count : {257, 1000, 4099}) {
+            different += different_streams(random, block_count, channel_count, 8);
+            streams += 8;
+        }
+    }
+    if(different > 0) {
+        std::fprintf(stderr, "%zu of %zu streams decoded differently\n", different, streams);
+    }
+    CHECK(different == 0);
+}
+
+TEST_CASE("stereo data ending with half a block is decoded the same") {
+    std::mt19937 random(50);
+    for(std::size_t block_count = 0; block_count <= 17; block_count++) {
+        auto data = random_blocks(random, block_count, 2, BLOCK_RANDOM);
+        auto half = random_blocks(random, 1, 1, BLOCK_RANDOM);
+        data.insert(data.end(), half.begin(), half.end());
+        auto expected = reference_xbox_adpcm_decode(data.data(), data.size(), 2);
+        auto sound = sound_from_xbox_adpcm(data.data(), data.size(), 2, 44100);
+        CHECK(sound.pcm == expected);
+        CHECK(sound.pcm.size() == block_count * 128 * 2);
+    }
+}
+
+TEST_CASE("the first sample of each channel is the one in the block header") {
+    std::mt19937 random(50);
+    auto data = random_blocks(random, 9, 2, BLOCK_RANDOM);
+    auto sound = sound_from_xbox_adpcm(data.data(), data.size(), 2, 44100);
+    auto *pcm = reinterpret_cast<const std::int16_t *>(sound.pcm.data());
+    for(std::size_t block = 0; block < 9; block++) {
+        for(std::size_t channel = 0; channel < 2; channel++) {
+            auto *header = reinterpret_cast<const std::uint8_t *>(data.data() + block * 72 + channel * 4);
+            auto sample = static_cast<std::int16_t>(header[0] | header[1] << 8);
+            CHECK(pcm[block * 128 + channel] == sample);
+        }
+    }
+    CHECK(sound.channel_count == 2 && sound.sample_rate == 44100 && sound.bits_per_sample == 16);
+}
+
+TEST_CASE("data which is not whole blocks of one or two channels is rejected") {
+    auto error_of = [](std::size_t data_length, std::size_t channel_count) -> std::string {
+        std::vector<std::byte> data(data_length);
+        try {
+            sound_from_xbox_adpcm(data.data(), data.size(), channel_count, 22050);
+        }
+        catch(std::runtime_error &e) {
+            return e.what();
+        }
+        return {};
+    };
+    CHECK(error_of(35, 1) == "Data length is not divisible by Xbox ADPCM block size");
+    CHECK(error_of(72 + 4, 2) == "Data length is not divisible by Xbox ADPCM block size");
+    CHECK(error_of(36, 0) == "Only mono or stereo streams are supported");
+    CHECK(error_of(36 * 3, 3) == "Only mono or stereo streams are supported");
+    CHECK(error_of(0, 1).empty());
+}
+
+TEST_MAIN()
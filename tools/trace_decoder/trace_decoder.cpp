@@ -0,0 +1,327 @@
+// SPDX-License-Identifier: GPL-3.0-only
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+/**
+ * Reader of the trace files written by Balltze (see include/balltze/trace.hpp).
+ *
+ * File layout, little endian:
+ *   header:  "BLTZTRCE", u32 version, u64 counter frequency, u64 counter at the start of the trace
+ *   chunks:  u32 type, u32 size, data
+ *     event descriptor (1): u16 id, u8 field count, string name, then per field: u8 type, string name
+ *     records (2):          u32 thread id, then records: u64 counter, u16 event id, packed field values
+ *   strings are a u16 length followed by the characters.
+ */
+
+enum TraceFieldType : std::uint8_t {
+    TRACE_FIELD_BOOL = 0,
+    TRACE_FIELD_INT8,
+    TRACE_FIELD_UINT8,
+    TRACE_FIELD_INT16,
+    TRACE_FIELD_UINT16,
+    TRACE_FIELD_INT32,
+    TRACE_FIELD_UINT32,
+    TRACE_FIELD_INT64,
+    TRACE_FIELD_UINT64,
+    TRACE_FIELD_FLOAT,
+    TRACE_FIELD_DOUBLE
+};
+
+enum TraceChunkType : std::uint32_t {
+    TRACE_CHUNK_EVENT_DESCRIPTOR = 1,
+    TRACE_CHUNK_RECORDS = 2
+};
+
+static constexpr char TRACE_FILE_MAGIC[8] = {'B', 'L', 'T', 'Z', 'T', 'R', 'C', 'E'};
+static constexpr std::uint32_t TRACE_FILE_VERSION = 1;
+
+struct TraceEvent {
+    std::string name;
+    std::vector<std::string> field_names;
+    std::vector<TraceFieldType> field_types;
+    std::size_t payload_size = 0;
+};
+
+struct TraceRecord {
+    std::uint64_t counter;
+    std::uint32_t thread_id;
+    std::uint16_t event;
+    std::size_t payload_offset;
+};
+
+class Reader {
+public:
+    Reader(std::uint8_t const *data, std::size_t size) : m_data(data), m_size(size) {}
+
+    template<typename T>
+    T read() {
+        T value;
+        require(sizeof(T));
+        std::memcpy(&value, m_data + m_offset, sizeof(T));
+        m_offset += sizeof(T);
+        return value;
+    }
+
+    std::string read_string() {
+        auto length = read<std::uint16_t>();
+        require(length);
+        std::string string(reinterpret_cast<const char *>(m_data + m_offset), length);
+        m_offset += length;
+        return string;
+    }
+
+    void skip(std::size_t size) {
+        require(size);
+        m_offset += size;
+    }
+
+    std::size_t offset() const noexcept {
+        return m_offset;
+    }
+
+    std::size_t remaining() const noexcept {
+        return m_size - m_offset;
+    }
+
+private:
+    std::uint8_t const *m_data;
+    std::size_t m_size;
+    std::size_t m_offset = 0;
+
+    void require(std::size_t size) const {
+        if(size > m_size - m_offset) {
+            throw std::runtime_error("unexpected end of data");
+        }
+    }
+};
+
+static std::size_t field_size(TraceFieldType type) {
+    switch(type) {
+        case TRACE_FIELD_BOOL:
+        case TRACE_FIELD_INT8:
+        case TRACE_FIELD_UINT8:
+            return 1;
+        case TRACE_FIELD_INT16:
+        case TRACE_FIELD_UINT16:
+            return 2;
+        case TRACE_FIELD_INT32:
+        case TRACE_FIELD_UINT32:
+        case TRACE_FIELD_FLOAT:
+            return 4;
+        case TRACE_FIELD_INT64:
+        case TRACE_FIELD_UINT64:
+        case TRACE_FIELD_DOUBLE:
+            return 8;
+        default:
+            throw std::runtime_error("unknown field type " + std::to_string(type));
+    }
+}
+
+static std::string format_field(Reader &reader, TraceFieldType type) {
+    char buffer[64];
+    switch(type) {
+        case TRACE_FIELD_BOOL:
+            return reader.read<std::uint8_t>() ? "true" : "false";
+        case TRACE_FIELD_INT8:
+            return std::to_string(reader.read<std::int8_t>());
+        case TRACE_FIELD_UINT8:
+            return std::to_string(reader.read<std::uint8_t>());
+        case TRACE_FIELD_INT16:
+            return std::to_string(reader.read<std::int16_t>());
+        case TRACE_FIELD_UINT16:
+            return std::to_string(reader.read<std::uint16_t>());
+        case TRACE_FIELD_INT32:
+            return std::to_string(reader.read<std::int32_t>());
+        case TRACE_FIELD_UINT32:
+            return std::to_string(reader.read<std::uint32_t>());
+        case TRACE_FIELD_INT64:
+            return std::to_string(reader.read<std::int64_t>());
+        case TRACE_FIELD_UINT64:
+            return std::to_string(reader.read<std::uint64_t>());
+        case TRACE_FIELD_FLOAT:
+            std::snprintf(buffer, sizeof(buffer), "%.9g", reader.read<float>());
+            return buffer;
+        case TRACE_FIELD_DOUBLE:
+            std::snprintf(buffer, sizeof(buffer), "%.17g", reader.read<double>());
+            return buffer;
+        default:
+            throw std::runtime_error("unknown field type " + std::to_string(type));
+    }
+}
+
+static std::string json_string(std::string const &string) {
+    std::string output = "\"";
+    for(char c : string) {
+        switch(c) {
+            case '"':
+                output += "\\\"";
+                break;
+            case '\\':
+                output += "\\\\";
+                break;
+            case '\n':
+                output += "\\n";
+                break;
+            default:
+                if(static_cast<unsigned char>(c) < 0x20) {
+                    char escaped[8];
+                    std::snprintf(escaped, sizeof(escaped), "\\u%04x", c);
+                    output += escaped;
+                }
+                else {
+                    output += c;
+                }
+        }
+    }
+    return output + "\"";
+}
+
+static void print_usage(const char *program) {
+    std::cerr << "Usage: " << program << " [--json] <trace file>\n";
+    std::cerr << "Prints the records of a Balltze trace file sorted by time, as text or as JSON lines.\n";
+}
+
+int main(int argc, const char **argv) {
+    bool json = false;
+    const char *path = nullptr;
+    for(int i = 1; i < argc; i++) {
+        if(std::strcmp(argv[i], "--json") == 0) {
+            json = true;
+        }
+        else if(!path && argv[i][0] != '-') {
+            path = argv[i];
+        }
+        else {
+            print_usage(argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+    if(!path) {
+        print_usage(argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    std::ifstream file(path, std::ios::binary);
+    if(!file) {
+        std::cerr << "Failed to open " << path << "\n";
+        return EXIT_FAILURE;
+    }
+    std::vector<std::uint8_t> data((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+
+    std::map<std::uint16_t, TraceEvent> events;
+    std::vector<TraceRecord> records;
+    double frequency;
+    std::uint64_t start_counter;
+    Reader reader(data.data(), data.size());
+
+    try {
+        char magic[sizeof(TRACE_FILE_MAGIC)];
+        for(auto &c : magic) {
+            c = reader.read<char>();
+        }
+        if(std::memcmp(magic, TRACE_FILE_MAGIC, sizeof(magic)) != 0) {
+            throw std::runtime_error("not a Balltze trace file");
+        }
+        auto version = reader.read<std::uint32_t>();
+        if(version != TRACE_FILE_VERSION) {
+            throw std::runtime_error("unsupported trace file version " + std::to_string(version));
+        }
+        frequency = static_cast<double>(reader.read<std::uint64_t>());
+        start_counter = reader.read<std::uint64_t>();
+        if(frequency == 0) {
+            throw std::runtime_error("invalid counter frequency");
+        }
+    }
+    catch(std::exception &e) {
+        std::cerr << "Failed to read header: " << e.what() << "\n";
+        return EXIT_FAILURE;
+    }
+
+    // A trace cut short (e.g. by a crash) may end in a partial chunk; keep everything before it
+    while(reader.remaining() > 0) {
+        try {
+            auto type = reader.read<std::uint32_t>();
+            auto size = reader.read<std::uint32_t>();
+            if(size > reader.remaining()) {
+                throw std::runtime_error("truncated chunk");
+            }
+            Reader chunk(data.data() + reader.offset(), size);
+            auto chunk_offset = reader.offset();
+            reader.skip(size);
+
+            if(type == TRACE_CHUNK_EVENT_DESCRIPTOR) {
+                TraceEvent event;
+                auto id = chunk.read<std::uint16_t>();
+                auto field_count = chunk.read<std::uint8_t>();
+                event.name = chunk.read_string();
+                for(std::size_t i = 0; i < field_count; i++) {
+                    auto field_type = static_cast<TraceFieldType>(chunk.read<std::uint8_t>());
+                    event.payload_size += field_size(field_type);
+                    event.field_types.push_back(field_type);
+                    event.field_names.push_back(chunk.read_string());
+                }
+                events[id] = std::move(event);
+            }
+            else if(type == TRACE_CHUNK_RECORDS) {
+                auto thread_id = chunk.read<std::uint32_t>();
+                while(chunk.remaining() > 0) {
+                    TraceRecord record;
+                    record.counter = chunk.read<std::uint64_t>();
+                    record.event = chunk.read<std::uint16_t>();
+                    record.thread_id = thread_id;
+                    record.payload_offset = chunk_offset + chunk.offset();
+                    auto event = events.find(record.event);
+                    if(event == events.end()) {
+                        throw std::runtime_error("record of unknown event " + std::to_string(record.event));
+                    }
+                    chunk.skip(event->second.payload_size);
+                    records.push_back(record);
+                }
+            }
+        }
+        catch(std::exception &e) {
+            std::cerr << "Stopped reading at offset " << reader.offset() << ": " << e.what() << "\n";
+            break;
+        }
+    }
+
+    std::stable_sort(records.begin(), records.end(), [](TraceRecord const &a, TraceRecord const &b) {
+        return a.counter < b.counter;
+    });
+
+    for(auto &record : records) {
+        auto &event = events[record.event];
+        Reader payload(data.data() + record.payload_offset, event.payload_size);
+        double time_ms = (static_cast<double>(record.counter) - static_cast<double>(start_counter)) * 1000.0 / frequency;
+        char time[32];
+        std::snprintf(time, sizeof(time), "%.6f", time_ms);
+
+        std::ostringstream line;
+        if(json) {
+            line << "{\"time_ms\":" << time << ",\"thread\":" << record.thread_id << ",\"event\":" << json_string(event.name) << ",\"fields\":{";
+            for(std::size_t i = 0; i < event.field_types.size(); i++) {
+                line << (i > 0 ? "," : "") << json_string(event.field_names[i]) << ":" << format_field(payload, event.field_types[i]);
+            }
+            line << "}}";
+        }
+        else {
+            line << time << " [" << record.thread_id << "] " << event.name;
+            for(std::size_t i = 0; i < event.field_types.size(); i++) {
+                line << " " << event.field_names[i] << "=" << format_field(payload, event.field_types[i]);
+            }
+        }
+        std::cout << line.str() << "\n";
+    }
+
+    return EXIT_SUCCESS;
+}